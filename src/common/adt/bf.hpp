@@ -8,13 +8,19 @@
 #pragma once
 
 #include "lemiere_mod_reduce.hpp"
+#include "utils/verify.hpp"
 
+#include <algorithm>
 #include <functional>
 #include <vector>
 #include <atomic>
 
 #include <cassert>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 namespace bf {
 
 namespace {
@@ -25,11 +31,33 @@ inline constexpr uint64_t cell_num(uint64_t x, uint64_t num) {
 inline constexpr uint64_t pairhash(uint64_t x, uint64_t y, uint64_t i) {
     return x + i * y + i * i;
 }
+
+// Odd multipliers used to derive in-block positions from a single 32-bit digest
+// part (see "Split block Bloom filters", as used in Impala / Parquet)
+static constexpr uint32_t block_salts[8] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+inline constexpr uint32_t block_pos(uint32_t h, unsigned i, unsigned bits) {
+    return (h * block_salts[i]) >> (32 - bits);
 }
 
+inline constexpr unsigned ilog2(uint64_t x) {
+    return x <= 1 ? 0 : 1 + ilog2(x >> 1);
+}
+}
 
-/// The ordinary Bloom filter.
+/// The type-erased hasher. Filters are parametrized by the hasher type, so
+/// prefer a stateless functor with
+///   uint64_t operator()(const T &, uint64_t seed) const
+/// in hot places: it would be inlined into add / lookup.
 template<class T>
+using dynamic_hasher = std::function<uint64_t(const T &, uint64_t seed)>;
+
+
+/// The ordinary Bloom filter.
+template<class T, class Hasher = dynamic_hasher<T>>
 class bloom_filter {
     bloom_filter(const bloom_filter &) = delete;
     bloom_filter &operator=(const bloom_filter &) = delete;
@@ -42,7 +70,7 @@ public:
     typedef uint64_t digest;
 
     /// The hash function type.
-    typedef std::function<digest(const T &, uint64_t seed)> hasher;
+    typedef Hasher hasher;
 
     // FIXME disable default constructor
     bloom_filter() = default;
@@ -108,7 +136,7 @@ public:
         std::fill(data_.begin(), data_.end(), 0);
     }
 
-    void merge(const bloom_filter<T> &other) {
+    void merge(const bloom_filter<T, Hasher> &other) {
         VERIFY(data_.size() == other.data_.size());
         VERIFY(num_hashes_ == other.num_hashes_);
         VERIFY(cells_ = other.cells_);
@@ -143,14 +171,17 @@ protected:
     std::vector<std::atomic<uint64_t>> data_;
 };
 
-template<class T, size_t depth_>
+// Note that cascading filter is kept on top of ordinary (non-blocked) Bloom
+// filters: blocked filters have higher false positive rate for the same number
+// of cells and this would propagate to every level.
+template<class T, size_t depth_, class Hasher = dynamic_hasher<T>>
 class cascading_bloom_filter {
     cascading_bloom_filter(const cascading_bloom_filter &) = delete;
     cascading_bloom_filter &operator=(const cascading_bloom_filter &) = delete;
 
 public:
-    using hasher = typename bloom_filter<T>::hasher;
-    using digets = typename bloom_filter<T>::digest;
+    using hasher = typename bloom_filter<T, Hasher>::hasher;
+    using digets = typename bloom_filter<T, Hasher>::digest;
 
     cascading_bloom_filter(hasher h,
                            size_t cells, size_t num_hashes = 3, double damp_factor = 0.1) {
@@ -186,11 +217,11 @@ public:
     }
 
 private:
-    std::vector<bloom_filter<T>> filters_;
+    std::vector<bloom_filter<T, Hasher>> filters_;
 };
 
 /// The counting Bloom filter.
-template<class T, unsigned width_ = 4>
+template<class T, unsigned width_ = 4, class Hasher = dynamic_hasher<T>>
 class counting_bloom_filter {
     counting_bloom_filter(const counting_bloom_filter &) = delete;
     counting_bloom_filter &operator=(const counting_bloom_filter &) = delete;
@@ -204,7 +235,7 @@ public:
     typedef size_t digest;
 
     /// The hash function type.
-    typedef std::function<digest(const T &, uint64_t seed)> hasher;
+    typedef Hasher hasher;
 
     // FIXME disable default constructor
     counting_bloom_filter() = default;
@@ -300,7 +331,7 @@ public:
       return double(loaded) / double(cells_);
     }
     
-    void merge(const counting_bloom_filter<T, width_> &other) {
+    void merge(const counting_bloom_filter<T, width_, Hasher> &other) {
         VERIFY(data_.size() == other.data_.size());
         VERIFY(num_hashes_ == other.num_hashes_);
         VERIFY(cells_ = other.cells_);
@@ -347,15 +378,15 @@ protected:
 };
 
 /// The counting Bloom filter.
-template<class T, unsigned width_ = 4>
-class bitcounting_bloom_filter : public counting_bloom_filter<T, width_> {
-    using typename counting_bloom_filter<T, width_>::digest;
-    using typename counting_bloom_filter<T, width_>::hasher;
+template<class T, unsigned width_ = 4, class Hasher = dynamic_hasher<T>>
+class bitcounting_bloom_filter : public counting_bloom_filter<T, width_, Hasher> {
+    using typename counting_bloom_filter<T, width_, Hasher>::digest;
+    using typename counting_bloom_filter<T, width_, Hasher>::hasher;
 
 public:
     bitcounting_bloom_filter(hasher h,
                              size_t cells, size_t num_hashes = 3)
-            : counting_bloom_filter<T, width_>(h, cells, num_hashes) { }
+            : counting_bloom_filter<T, width_, Hasher>(h, cells, num_hashes) { }
 
     /// Adds an element to the Bloom filter.
     /// @tparam T The type of the element to insert.
@@ -417,4 +448,348 @@ public:
 };
 
 
+namespace {
+// A single cache line worth of filter data
+struct alignas(64) filter_block {
+    static constexpr size_t words = 64 / sizeof(uint64_t);
+    uint64_t data[words];
+};
+
+static_assert(sizeof(filter_block) == 64, "Filter block must occupy exactly one cache line");
+
+// Number of elements for which the digests are computed and the blocks are
+// prefetched ahead during batched operations
+static constexpr size_t filter_batch_size = 16;
+}
+
+/// The register-blocked Bloom filter.
+/// Every element is mapped to a single 512-bit block (one cache line) and sets
+/// exactly one bit in every 64-bit word of it. Therefore each operation incurs
+/// at most one cache miss and the membership test is a single mask test that
+/// could be done via SIMD. The price is somewhat higher false positive rate
+/// compared to the ordinary Bloom filter of the same size.
+template<class T, class Hasher = dynamic_hasher<T>>
+class blocked_bloom_filter {
+    blocked_bloom_filter(const blocked_bloom_filter &) = delete;
+    blocked_bloom_filter &operator=(const blocked_bloom_filter &) = delete;
+
+protected:
+    static constexpr size_t words_per_block_ = filter_block::words;
+    static constexpr size_t cells_per_block_ = 8 * sizeof(filter_block);
+    static constexpr uint64_t seed_ = 0xDEAD;
+
+public:
+    /// The hash digest type.
+    typedef uint64_t digest;
+
+    /// The hash function type.
+    typedef Hasher hasher;
+
+    blocked_bloom_filter() = default;
+    ~blocked_bloom_filter() = default;
+
+    /// Constructs a blocked Bloom filter.
+    /// @param h The hasher.
+    /// @param cells The number of cells, rounded up to the block size.
+    /// The memory consumption will be cells bits
+    blocked_bloom_filter(hasher h, size_t cells)
+            : hasher_(std::move(h)),
+              data_(std::max<size_t>(1, (cells + cells_per_block_ - 1) / cells_per_block_)) {}
+
+    /// Move-constructs a blocked Bloom filter.
+    blocked_bloom_filter(blocked_bloom_filter &&) = default;
+
+    /// Adds an element to the Bloom filter.
+    /// @return true if the element was not (likely) present before
+    bool add(const T &o) {
+        return add_digest(hasher_(o, seed_));
+    }
+
+    /// Adds a range of elements to the Bloom filter. Digests are computed and
+    /// the corresponding blocks are prefetched ahead in small batches.
+    template<class It>
+    void add(It begin, It end) {
+        digest ds[filter_batch_size];
+        while (begin != end) {
+            size_t n = 0;
+            for (; n < filter_batch_size && begin != end; ++n, ++begin) {
+                ds[n] = hasher_(*begin, seed_);
+                __builtin_prefetch(&data_[block_id(ds[n])], 1);
+            }
+            for (size_t i = 0; i < n; ++i)
+                add_digest(ds[i]);
+        }
+    }
+
+    /// Retrieves the count (0 or 1) of an element.
+    size_t lookup(const T &o) const {
+        return lookup_digest(hasher_(o, seed_));
+    }
+
+    /// Retrieves the counts of a range of elements.
+    /// @return The output iterator past the last written value
+    template<class It, class OutIt>
+    OutIt lookup(It begin, It end, OutIt out) const {
+        digest ds[filter_batch_size];
+        while (begin != end) {
+            size_t n = 0;
+            for (; n < filter_batch_size && begin != end; ++n, ++begin) {
+                ds[n] = hasher_(*begin, seed_);
+                __builtin_prefetch(&data_[block_id(ds[n])], 0);
+            }
+            for (size_t i = 0; i < n; ++i)
+                *out++ = lookup_digest(ds[i]);
+        }
+
+        return out;
+    }
+
+    /// Removes all items from the Bloom filter.
+    void clear() {
+        std::fill(data_.begin(), data_.end(), filter_block{});
+    }
+
+    void merge(const blocked_bloom_filter<T, Hasher> &other) {
+        VERIFY(data_.size() == other.data_.size());
+
+        for (size_t i = 0; i < data_.size(); ++i)
+            for (size_t j = 0; j < words_per_block_; ++j)
+                data_[i].data[j] |= other.data_[i].data[j];
+    }
+
+    template <typename Archive>
+    void BinArchiveSave(Archive &ar) const {
+        ar(data_.size());
+        ar.raw_array(data_.data(), data_.size());
+    }
+
+    template <typename Archive>
+    void BinArchiveLoad(Archive &ar) {
+        size_t size;
+        ar(size);
+        data_.resize(size);
+        ar.raw_array(data_.data(), data_.size());
+    }
+
+private:
+    size_t block_id(digest d) const {
+        return cell_num(d, data_.size());
+    }
+
+    static void make_mask(digest d, uint64_t mask[words_per_block_]) {
+        uint32_t h = uint32_t(d);
+        for (unsigned i = 0; i < words_per_block_; ++i)
+            mask[i] = uint64_t(1) << block_pos(h, i, 6);
+    }
+
+    bool add_digest(digest d) {
+        alignas(64) uint64_t mask[words_per_block_];
+        make_mask(d, mask);
+
+        auto &block = data_[block_id(d)];
+        bool dup = true;
+        for (unsigned i = 0; i < words_per_block_; ++i) {
+            uint64_t oldval = __atomic_fetch_or(&block.data[i], mask[i], __ATOMIC_RELAXED);
+            dup &= (oldval & mask[i]) != 0;
+        }
+
+        return !dup;
+    }
+
+    size_t lookup_digest(digest d) const {
+        alignas(64) uint64_t mask[words_per_block_];
+        make_mask(d, mask);
+
+        // Note that lookups are not synchronized with concurrent insertions,
+        // the filter is expected to be filled before being queried.
+        const auto &block = data_[block_id(d)];
+#if defined(__AVX2__)
+        const __m256i *b = reinterpret_cast<const __m256i*>(block.data);
+        const __m256i *m = reinterpret_cast<const __m256i*>(mask);
+        return _mm256_testc_si256(_mm256_load_si256(b), _mm256_load_si256(m)) &&
+               _mm256_testc_si256(_mm256_load_si256(b + 1), _mm256_load_si256(m + 1));
+#else
+        uint64_t missing = 0;
+        for (unsigned i = 0; i < words_per_block_; ++i)
+            missing |= mask[i] & ~block.data[i];
+
+        return missing == 0;
+#endif
+    }
+
+protected:
+    hasher hasher_;
+    std::vector<filter_block> data_;
+};
+
+/// The register-blocked counting Bloom filter.
+/// All counters of an element reside in a single 512-bit block (one cache
+/// line). Up to 8 hash functions are supported.
+template<class T, unsigned width_ = 4, class Hasher = dynamic_hasher<T>>
+class blocked_counting_bloom_filter {
+    blocked_counting_bloom_filter(const blocked_counting_bloom_filter &) = delete;
+    blocked_counting_bloom_filter &operator=(const blocked_counting_bloom_filter &) = delete;
+
+protected:
+    static constexpr uint64_t cell_mask_ = (1ull << width_) - 1;
+    static constexpr size_t cells_per_entry_ = 8 * sizeof(uint64_t) / width_;
+    static constexpr size_t cells_per_block_ = 8 * sizeof(filter_block) / width_;
+    static constexpr unsigned cell_bits_ = ilog2(cells_per_block_);
+    static constexpr uint64_t seed_ = 0xDEAD;
+
+public:
+    /// The hash digest type.
+    typedef uint64_t digest;
+
+    /// The hash function type.
+    typedef Hasher hasher;
+
+    blocked_counting_bloom_filter() = default;
+    ~blocked_counting_bloom_filter() = default;
+
+    /// Constructs a blocked counting Bloom filter.
+    /// @param h The hasher.
+    /// @param cells The number of cells, rounded up to the block size.
+    /// @param num_hashes The number of hash functions to use
+    /// The memory consumption will be cells * width bits
+    blocked_counting_bloom_filter(hasher h,
+                                  size_t cells, size_t num_hashes = 3)
+            : hasher_(std::move(h)),
+              num_hashes_(num_hashes),
+              data_(std::max<size_t>(1, (cells + cells_per_block_ - 1) / cells_per_block_)) {
+        static_assert((width_ & (width_ - 1)) == 0, "Width must be power of two");
+        VERIFY(num_hashes_ > 0 && num_hashes_ <= filter_block::words);
+    }
+
+    /// Move-constructs a blocked counting Bloom filter.
+    blocked_counting_bloom_filter(blocked_counting_bloom_filter &&) = default;
+
+    /// Adds an element to the Bloom filter.
+    void add(const T &o) {
+        add_digest(hasher_(o, seed_));
+    }
+
+    /// Adds a range of elements to the Bloom filter.
+    template<class It>
+    void add(It begin, It end) {
+        digest ds[filter_batch_size];
+        while (begin != end) {
+            size_t n = 0;
+            for (; n < filter_batch_size && begin != end; ++n, ++begin) {
+                ds[n] = hasher_(*begin, seed_);
+                __builtin_prefetch(&data_[block_id(ds[n])], 1);
+            }
+            for (size_t i = 0; i < n; ++i)
+                add_digest(ds[i]);
+        }
+    }
+
+    /// Retrieves the count of an element.
+    /// @return A frequency estimate for *x*.
+    size_t lookup(const T &o) const {
+        return lookup_digest(hasher_(o, seed_));
+    }
+
+    /// Retrieves the counts of a range of elements.
+    /// @return The output iterator past the last written value
+    template<class It, class OutIt>
+    OutIt lookup(It begin, It end, OutIt out) const {
+        digest ds[filter_batch_size];
+        while (begin != end) {
+            size_t n = 0;
+            for (; n < filter_batch_size && begin != end; ++n, ++begin) {
+                ds[n] = hasher_(*begin, seed_);
+                __builtin_prefetch(&data_[block_id(ds[n])], 0);
+            }
+            for (size_t i = 0; i < n; ++i)
+                *out++ = lookup_digest(ds[i]);
+        }
+
+        return out;
+    }
+
+    /// Removes all items from the Bloom filter.
+    void clear() {
+        std::fill(data_.begin(), data_.end(), filter_block{});
+    }
+
+    double load_factor() const {
+        size_t loaded = 0;
+        for (const auto &block : data_) {
+            for (uint64_t entry : block.data) {
+                for (size_t epos = 0; epos < cells_per_entry_; ++epos)
+                    loaded += ((entry >> (width_ * epos)) & cell_mask_) != 0;
+            }
+        }
+
+        return double(loaded) / double(data_.size() * cells_per_block_);
+    }
+
+    template <typename Archive>
+    void BinArchiveSave(Archive &ar) const {
+        ar(num_hashes_, data_.size());
+        ar.raw_array(data_.data(), data_.size());
+    }
+
+    template <typename Archive>
+    void BinArchiveLoad(Archive &ar) {
+        size_t size;
+        ar(num_hashes_, size);
+        data_.resize(size);
+        ar.raw_array(data_.data(), data_.size());
+    }
+
+private:
+    size_t block_id(digest d) const {
+        return cell_num(d, data_.size());
+    }
+
+    void add_digest(digest d) {
+        auto &block = data_[block_id(d)];
+        uint32_t h = uint32_t(d);
+        for (unsigned i = 0; i < num_hashes_; ++i) {
+            size_t cell_id = block_pos(h, i, cell_bits_);
+            size_t pos = cell_id / cells_per_entry_;
+            size_t epos = cell_id - pos * cells_per_entry_;
+            uint64_t *entry = &block.data[pos];
+            uint64_t mask = cell_mask_ << (width_ * epos);
+
+            // Add counter
+            uint64_t val = __atomic_load_n(entry, __ATOMIC_RELAXED);
+            while (true) {
+                // Overflow, do nothing
+                if ((val & mask) == mask)
+                    break;
+
+                uint64_t newval = val + (1ull << (width_ * epos));
+                if (__atomic_compare_exchange_n(entry, &val, newval,
+                                                /* weak */ true,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                    break;
+            }
+        }
+    }
+
+    size_t lookup_digest(digest d) const {
+        const auto &block = data_[block_id(d)];
+        uint32_t h = uint32_t(d);
+        size_t val = cell_mask_;
+        for (unsigned i = 0; i < num_hashes_; ++i) {
+            size_t cell_id = block_pos(h, i, cell_bits_);
+            size_t pos = cell_id / cells_per_entry_;
+            size_t epos = cell_id - pos * cells_per_entry_;
+            size_t cval = (__atomic_load_n(&block.data[pos], __ATOMIC_RELAXED) >> (width_ * epos)) & cell_mask_;
+            if (val > cval)
+                val = cval;
+        }
+
+        return val;
+    }
+
+protected:
+    hasher hasher_;
+    size_t num_hashes_;
+    std::vector<filter_block> data_;
+};
+
 } // namespace bf
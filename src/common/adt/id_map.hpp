@@ -10,11 +10,18 @@
 #include "adt/iterator_range.hpp"
 #include <boost/iterator/iterator_facade.hpp>
 
+#include <algorithm>
 #include <functional>
 #include <type_traits>
 #include <vector>
 
 namespace adt {
+
+/**
+ * @brief Map from the dense integer ids (e.g. graph edges and vertices) backed by a vector.
+ * @detail Keys are either integers or have int_id(). Lookups are plain indexing and the
+ *         iteration goes in the order of ids, which is deterministic unlike hash maps.
+ */
 template<typename V, typename K = uint64_t>
 class id_map {
   public:
@@ -38,7 +45,7 @@ class id_map {
                  const std::vector<bool> &map,
                  data_type &data)
                 : map_(map), data_(data), cur_(start) {
-            if (cur_ != NPOS && !map_.get()[cur_])
+            if (cur_ != NPOS && (cur_ >= map_.get().size() || !map_.get()[cur_]))
                 cur_ = next_occupied(cur_);
         }
 
@@ -84,41 +91,91 @@ class id_map {
 
     typedef iterator<true> const_iterator;
 
-    id_map(size_t max_id) {
-        data_.resize(max_id);
-        occ_map_.resize(max_id, false);
+    /// @param max_id exclusive bound on the key ids, the map grows on insertion of larger ids
+    id_map(size_t max_id = 0) {
+        reserve(max_id);
     }
-    
+
     mapped_type& at(const key_type key) {
-        return data_.at(key.int_id());
+        return data_.at(id(key));
     }
     const mapped_type& at(const key_type key) const {
-        return data_.at(key.int_id());
+        return data_.at(id(key));
     }
 
-    mapped_type& operator[](const key_type key) noexcept {
-        size_t id = key.int_id();
-        if (!occ_map_[id]) occ_map_[id] = true;
-        return data_[id];
+    /// Inserts the default value if the key is absent. Concurrent calls are safe only for
+    /// the keys that are already present
+    mapped_type& operator[](const key_type key) {
+        size_t i = id(key);
+        grow(i);
+        if (!occ_map_[i]) occ_map_[i] = true;
+        return data_[i];
     }
 
     const mapped_type& operator[](const key_type key) const noexcept {
-        return data_[key.int_id()];
+        return data_[id(key)];
     }
 
     bool count(const key_type key) const {
-        return occ_map_[key.int_id()];
+        size_t i = id(key);
+        return i < occ_map_.size() && occ_map_[i];
     }
-    
+
     template<typename... Args>
     std::pair<iterator<>, bool> emplace(key_type key, Args &&... args) {
-        size_t id = key.int_id();
-        if (occ_map_[id])
-            return { iterator<>(id, occ_map_, data_), false };
-            
-        occ_map_[id] = true;
-        new(data_.data() + id) mapped_type(std::forward<Args>(args)...);
-        return { iterator<>(id, occ_map_, data_), true};
+        size_t i = id(key);
+        grow(i);
+        if (occ_map_[i])
+            return { iterator<>(i, occ_map_, data_), false };
+
+        occ_map_[i] = true;
+        data_[i] = mapped_type(std::forward<Args>(args)...);
+        return { iterator<>(i, occ_map_, data_), true};
+    }
+
+    /// Removes the key resetting its value to the default one
+    size_t erase(const key_type key) {
+        if (!count(key))
+            return 0;
+
+        size_t i = id(key);
+        occ_map_[i] = false;
+        data_[i] = mapped_type();
+        return 1;
+    }
+
+    void clear() {
+        std::fill(occ_map_.begin(), occ_map_.end(), false);
+        std::fill(data_.begin(), data_.end(), mapped_type());
+    }
+
+    /// Makes room for the ids below max_id, so the subsequent insertions do not reallocate
+    void reserve(size_t max_id) {
+        if (max_id <= data_.size())
+            return;
+        data_.resize(max_id);
+        occ_map_.resize(max_id, false);
+    }
+
+    size_t max_id() const { return data_.size(); }
+
+    /// Calls f(key, value) for all the present keys in parallel
+    template<class F>
+    void parallel_for_each(F f) {
+#       pragma omp parallel for schedule(guided)
+        for (size_t i = 0; i < data_.size(); ++i) {
+            if (occ_map_[i])
+                f(key_type(i), data_[i]);
+        }
+    }
+
+    template<class F>
+    void parallel_for_each(F f) const {
+#       pragma omp parallel for schedule(guided)
+        for (size_t i = 0; i < data_.size(); ++i) {
+            if (occ_map_[i])
+                f(key_type(i), data_[i]);
+        }
     }
 
     iterator<>      begin()         { return iterator<>(0, occ_map_, data_); }
@@ -129,9 +186,20 @@ class id_map {
     const_iterator  cend()   const  { return const_iterator(const_iterator::NPOS, occ_map_, data_); }
 
   private:
+    static size_t id(const key_type key) {
+        if constexpr (std::is_integral_v<key_type>)
+            return key;
+        else
+            return key.int_id();
+    }
+
+    void grow(size_t i) {
+        if (i >= data_.size())
+            reserve(std::max(i + 1, 2 * data_.size()));
+    }
+
     std::vector<mapped_type> data_;
     std::vector<bool> occ_map_;
-};  
-
 };
 
+}
@@ -147,31 +147,22 @@ LongReadMapper::LongReadMapper(const Graph& g,
 void LongReadMapper::ProcessSingleRead(size_t thread_index, const MappingPath<EdgeId>& mapping) {
     DEBUG("Processing read");
     for (const auto& path : path_extractor_(mapping))
-        buffer_storages_[thread_index].AddPath(path.Path_, 1, false);
+        storage_.AddPath(path.Path_, 1, false);
     DEBUG("Read processed");
 }
 
 void LongReadMapper::StartProcessLibrary(size_t threads_count) {
-    buffer_storages_.reserve(threads_count);
-    trusted_path_buffer_storages_.reserve(threads_count);
-    for (size_t i = 0; i < threads_count; ++i) {
-        buffer_storages_.emplace_back(g_);
-        trusted_path_buffer_storages_.emplace_back();
-    }
+    trusted_path_buffer_storages_.resize(threads_count);
 }
 
 void LongReadMapper::StopProcessLibrary() {
-    buffer_storages_.clear();
     trusted_path_buffer_storages_.clear();
 }
 
 void LongReadMapper::MergeBuffer(size_t thread_index) {
-    DEBUG("Merge buffer " << thread_index << " with size " << buffer_storages_[thread_index].size());
-    storage_.AddStorage(buffer_storages_[thread_index]);
-    buffer_storages_[thread_index].Clear();
+    DEBUG("Merge buffer " << thread_index << " with size " << trusted_path_buffer_storages_[thread_index].size());
     std::move(trusted_path_buffer_storages_[thread_index].begin(), trusted_path_buffer_storages_[thread_index].end(), std::back_inserter(trusted_paths_storage_));
     trusted_path_buffer_storages_[thread_index].clear();
-    DEBUG("Now size " << storage_.size());
 }
 
 void LongReadMapper::ProcessSingleRead(size_t thread_index,
@@ -192,7 +183,7 @@ void LongReadMapper::ProcessSingleRead(size_t thread_index, const MappingPath<Ed
     DEBUG("Processing single read");
     auto paths = path_extractor_(mapping);
     for (const auto& path : paths)
-        buffer_storages_[thread_index].AddPath(path.Path_, 1, false);
+        storage_.AddPath(path.Path_, 1, false);
 
     if (lib_type_ == io::LibraryType::TrustedContigs && !paths.empty()) {
         auto gapped_paths = MergePaths(paths, g_, r);
@@ -64,7 +64,6 @@ private:
     const Graph& g_;
     PathStorage<Graph>& storage_;
     path_extend::GappedPathStorage& trusted_paths_storage_;
-    std::vector<PathStorage<Graph>> buffer_storages_;
     std::vector<path_extend::GappedPathStorage> trusted_path_buffer_storages_;
     io::LibraryType lib_type_;
     PathExtractionF path_extractor_;
@@ -12,9 +12,15 @@
 #include "utils/filesystem/file_opener.hpp"
 #include "utils/logger/logger.hpp"
 
+#include <parallel_hashmap/phmap.h>
+
+#define XXH_INLINE_ALL
+#include "xxh/xxhash.h"
 
 #include <algorithm>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -63,98 +69,149 @@ public:
     }
 };
 
+/**
+ * @brief Weighted multiset of long read paths.
+ *
+ * @detail Paths are interned: the edges of every distinct path are stored once in an arena
+ * and are found by the hash of the path, so adding a path does not depend on the number of
+ * paths sharing its edges. The storage is split into independently locked shards selected by
+ * the path hash, thus AddPath() / AddStorage() could be called from several threads at once.
+ * Reading methods are not synchronized with the concurrent inserts. All the paths are reported
+ * in the lexicographic order of their edges.
+ */
 template<class Graph>
 class PathStorage {
     friend class PathInfo<Graph> ;
     typedef typename Graph::EdgeId EdgeId;
-    typedef std::map<EdgeId, std::set<PathInfo<Graph>>> InnerIndex;
 
-    const Graph &g_;
-    InnerIndex inner_index_;
     static const size_t kLongEdgeForStats = 500;
+    static constexpr unsigned kShardBits = 6;
+    static constexpr size_t kShards = 1ull << kShardBits;
+    static constexpr size_t kNoRecord = -1ull;
+
+    /// Path stored in the shard arena as arena[offset, offset + length)
+    struct PathRecord {
+        size_t offset;
+        size_t length;
+        size_t weight;
+        size_t next; // next record with the same hash
+    };
+
+    struct Shard {
+        std::mutex lock;
+        std::vector<EdgeId> arena;
+        std::vector<PathRecord> records;
+        phmap::flat_hash_map<uint64_t, size_t> index; // path hash -> last record with this hash
+    };
+
+    /// Lightweight reference to the interned path
+    struct PathRef {
+        const EdgeId *edges;
+        size_t length;
+        size_t weight;
+
+        EdgeId front() const { return edges[0]; }
+        const EdgeId *begin() const { return edges; }
+        const EdgeId *end() const { return edges + length; }
+
+        bool operator<(const PathRef &other) const {
+            return std::lexicographical_compare(begin(), end(), other.begin(), other.end());
+        }
+    };
+
+    const Graph &g_;
+    std::unique_ptr<Shard[]> shards_;
 
-    void HiddenAddPath(const std::vector<EdgeId> &p, int w) {
-        if (p.size() == 0 ) return;
-        for (typename std::set<PathInfo<Graph>>::iterator iter = inner_index_[p[0]].begin(); iter != inner_index_[p[0]].end(); ++iter) {
-            if (iter->path() == p) {
-                iter->increase_weight(w);
-                return;
+    static uint64_t PathHash(const EdgeId *p, size_t length) {
+        static_assert(std::is_trivially_copyable<EdgeId>::value, "edge ids are hashed as raw bytes");
+        return XXH3_64bits(p, length * sizeof(EdgeId));
+    }
+
+    void HiddenAddPath(const EdgeId *p, size_t length, size_t w) {
+        if (length == 0) return;
+
+        uint64_t h = PathHash(p, length);
+        Shard &shard = shards_[h >> (64 - kShardBits)];
+        std::lock_guard<std::mutex> guard(shard.lock);
+
+        auto [it, inserted] = shard.index.try_emplace(h, shard.records.size());
+        size_t next = kNoRecord;
+        if (!inserted) {
+            for (size_t r = it->second; r != kNoRecord; r = shard.records[r].next) {
+                PathRecord &rec = shard.records[r];
+                if (rec.length == length &&
+                    std::equal(p, p + length, shard.arena.begin() + rec.offset)) {
+                    rec.weight += w;
+                    return;
+                }
             }
+            next = it->second;
+            it->second = shard.records.size();
+        }
+
+        shard.records.push_back({ shard.arena.size(), length, w, next });
+        shard.arena.insert(shard.arena.end(), p, p + length);
+    }
+
+    template<class F>
+    void ForEachRecord(F f) const {
+        for (size_t i = 0; i < kShards; ++i) {
+            const Shard &shard = shards_[i];
+            for (const PathRecord &rec : shard.records)
+                f(PathRef{ shard.arena.data() + rec.offset, rec.length, rec.weight });
         }
-        inner_index_[p[0]].insert(PathInfo<Graph>(p, w));
-        size_++;
+    }
+
+    std::vector<PathRef> SortedPaths() const {
+        std::vector<PathRef> res;
+        res.reserve(size());
+        ForEachRecord([&](const PathRef &p) { res.push_back(p); });
+        std::sort(res.begin(), res.end());
+        return res;
     }
 
 public:
     PathStorage(const Graph &g)
             : g_(g),
-              inner_index_(),
-              size_(0) {
+              shards_(new Shard[kShards]) {
     }
 
-    PathStorage(const PathStorage & p)
-            : g_(p.g_),
-              inner_index_(),
-              size_(0) {
-        for (auto iter = p.inner_index_.begin(); iter != p.inner_index_.end();
-                iter++) {
-            for (auto j_iter = iter->second.begin();
-                    j_iter != iter->second.end(); j_iter++) {
-                this->AddPath(j_iter->path(), (int) j_iter->weight());
-            }
-        }
+    PathStorage(const PathStorage &p)
+            : PathStorage(p.g_) {
+        AddStorage(p);
     }
 
-    void ReplaceEdges(std::map<EdgeId, EdgeId> &old_to_new){
-        std::map<int, EdgeId> tmp_map;
-//        for (auto iter = g_.SmartEdgeBegin(); !iter.IsEnd(); ++iter ){
-//            tmp_map[g_.int_id(*iter)] = *iter;
-//        }
-        InnerIndex new_index;
-        for (auto iter = inner_index_.begin(); iter != inner_index_.end(); iter++) {
-            auto tmp = iter->second;
-            EdgeId new_first;
-            if (old_to_new.find(iter->first) == old_to_new.end())
-                new_first = iter->first;
-            else {
-                DEBUG("new first edge: "<< g_.int_id(old_to_new[iter->first]) << " with " << tmp.size() << " edges ");
-                new_first = old_to_new[iter->first];
-            }
-            std::set<PathInfo<Graph>> new_tmp;
-            for (auto j_iter = tmp.begin(); j_iter != tmp.end(); j_iter++) {
-                PathInfo<Graph> pi = *(j_iter);
-                for (size_t k = 0; k < pi.path().size(); k++)
-                    if (old_to_new.find(pi.path()[k]) != old_to_new.end()) {
-//                        INFO(g_.int_id(old_to_new[pi.path[k]]));
-                        pi.path()[k] = old_to_new[pi.path()[k]];
-                    }
-                DEBUG(pi.str(g_));
-                new_tmp.insert(pi);
-
-            }
-            if (new_first != iter->first) {
-                TRACE("and mmew_tmp.size: "<< new_tmp.size());
-            }
-            if (new_index.find(new_first) == new_index.end()) {
-                new_index[new_first] = new_tmp;
-            } else {
-                for (auto j_iter = new_tmp.begin(); j_iter != new_tmp.end(); j_iter++) {
-                    new_index[new_first].insert(*j_iter);
+    PathStorage(PathStorage &&) = default;
+
+    void ReplaceEdges(std::map<EdgeId, EdgeId> &old_to_new) {
+        // Replacement changes the hashes, so the paths are re-interned into the new shards
+        // and the paths which become equal are merged
+        std::unique_ptr<Shard[]> old_shards(new Shard[kShards]);
+        std::swap(old_shards, shards_);
+
+        std::vector<EdgeId> path;
+        for (size_t i = 0; i < kShards; ++i) {
+            const Shard &shard = old_shards[i];
+            for (const PathRecord &rec : shard.records) {
+                path.assign(shard.arena.begin() + rec.offset,
+                            shard.arena.begin() + rec.offset + rec.length);
+                for (EdgeId &e : path) {
+                    auto it = old_to_new.find(e);
+                    if (it != old_to_new.end())
+                        e = it->second;
                 }
+                HiddenAddPath(path.data(), path.size(), rec.weight);
             }
-
         }
-
-        inner_index_ = new_index;
     }
 
     void AddPath(const std::vector<EdgeId> &p, int w, bool add_rc = false) {
-        HiddenAddPath(p, w);
+        HiddenAddPath(p.data(), p.size(), w);
         if (add_rc) {
             std::vector<EdgeId> rc_p(p.size());
             for (size_t i = 0; i < p.size(); i++)
                 rc_p[i] = g_.conjugate(p[p.size() - 1 - i]);
-            HiddenAddPath(rc_p, w);
+            HiddenAddPath(rc_p.data(), rc_p.size(), w);
         }
     }
 
@@ -163,38 +220,46 @@ public:
         DumpToFile(filename, auxilary);
     }
 
+    /// Paths are written grouped by the first edge: the number of groups, then the size of
+    /// each group followed by weight, length and edge ids of its paths
     void BinWrite(std::ostream &str) const {
         using io::binary::BinWrite;
-        BinWrite(str, inner_index_.size());
-        for (const auto &i : inner_index_) {
-            BinWrite(str, (size_t)i.second.size());
-            for (const auto &j : i.second) {
-                BinWrite(str, j.weight());
-                BinWrite(str, j.path().size());
-                for (const auto &p : j.path()) {
-                    BinWrite(str, g_.int_id(p));
-                }
+        auto paths = SortedPaths();
+        std::vector<size_t> group_sizes;
+        for (auto group = paths.begin(); group != paths.end(); ) {
+            auto group_end = std::find_if(group, paths.end(),
+                                          [&](const PathRef &p) { return p.front() != group->front(); });
+            group_sizes.push_back(size_t(group_end - group));
+            group = group_end;
+        }
+
+        BinWrite(str, group_sizes.size());
+        auto p = paths.begin();
+        for (size_t group_size : group_sizes) {
+            BinWrite(str, group_size);
+            for (size_t i = 0; i < group_size; ++i, ++p) {
+                BinWrite(str, p->weight, p->length);
+                for (EdgeId e : *p)
+                    BinWrite(str, uint64_t(g_.int_id(e)));
             }
         }
     }
 
     void BinRead(std::istream &str) {
-        inner_index_.clear();
+        Clear();
         using io::binary::BinRead;
 
         auto size = BinRead<size_t>(str);
+        std::vector<EdgeId> path;
         while (size--) {
             auto count = BinRead<size_t>(str);
             while (count--) {
                 auto weight = BinRead<size_t>(str);
                 auto length = BinRead<size_t>(str);
-                std::vector<EdgeId> path;
-                path.reserve(length);
-                while (length--) {
-                    auto eid = BinRead<uint64_t>(str);
-                    path.push_back(eid);
-                }
-                AddPath(path, (int)weight);
+                path.clear();
+                while (length--)
+                    path.push_back(EdgeId(BinRead<uint64_t>(str)));
+                HiddenAddPath(path.data(), path.size(), weight);
             }
         }
     }
@@ -204,14 +269,17 @@ public:
         std::ofstream filestr(filename);
         std::set<EdgeId> continued_edges;
 
-        for (auto iter = inner_index_.begin(); iter != inner_index_.end(); ++iter){
-            filestr << iter->second.size() << std::endl;
-            for (auto j_iter = iter->second.begin(); j_iter != iter->second.end(); ++j_iter) {
-                filestr << " Weight: " << j_iter->weight();
-
-                filestr << " length: " << j_iter->path().size() << " ";
-                for (auto p_iter = j_iter->path().begin(); p_iter != j_iter->path().end(); ++p_iter) {
-                    if (p_iter != j_iter->path().end() - 1 && j_iter->weight() > stats_weight_cutoff) {
+        auto paths = SortedPaths();
+        for (auto group = paths.begin(); group != paths.end(); ) {
+            auto group_end = std::find_if(group, paths.end(),
+                                          [&](const PathRef &p) { return p.front() != group->front(); });
+            filestr << (group_end - group) << std::endl;
+            for (auto j_iter = group; j_iter != group_end; ++j_iter) {
+                filestr << " Weight: " << j_iter->weight;
+
+                filestr << " length: " << j_iter->length << " ";
+                for (auto p_iter = j_iter->begin(); p_iter != j_iter->end(); ++p_iter) {
+                    if (p_iter != j_iter->end() - 1 && j_iter->weight > stats_weight_cutoff) {
                         continued_edges.insert(*p_iter);
                     }
 
@@ -220,6 +288,7 @@ public:
                 filestr << std::endl;
             }
             filestr << std::endl;
+            group = group_end;
         }
 
         int noncontinued = 0;
@@ -254,11 +323,10 @@ public:
     }
 
     void SaveAllPaths(std::vector<PathInfo<Graph>> &res) const {
-        for (auto iter = inner_index_.begin(); iter != inner_index_.end(); ++iter) {
-            for (auto j_iter = iter->second.begin(); j_iter != iter->second.end(); ++j_iter) {
-                res.push_back(*j_iter);
-            }
-        }
+        auto paths = SortedPaths();
+        res.reserve(res.size() + paths.size());
+        for (const auto &p : paths)
+            res.emplace_back(std::vector<EdgeId>(p.begin(), p.end()), p.weight);
     }
 
     void LoadFromFile(const std::filesystem::path &s, bool force_exists = true) {
@@ -312,35 +380,27 @@ public:
         INFO("Loading finished.");
     }
 
-    void AddStorage(PathStorage<Graph> &to_add) {
-        for (auto iter = to_add.inner_index_.begin(); iter != to_add.inner_index_.end(); iter++) {
-            for (auto j_iter = iter->second.begin(); j_iter != iter->second.end(); j_iter ++) {
-                this->AddPath(j_iter->path(), (int) j_iter->weight());
-            }
-        }
+    void AddStorage(const PathStorage<Graph> &to_add) {
+        to_add.ForEachRecord([&](const PathRef &p) {
+            HiddenAddPath(p.edges, p.length, p.weight);
+        });
     }
 
     void Clear() {
-        inner_index_.clear();
-        size_ = 0;
+        for (size_t i = 0; i < kShards; ++i) {
+            Shard &shard = shards_[i];
+            shard.arena.clear();
+            shard.records.clear();
+            shard.index.clear();
+        }
     }
 
     size_t size() const {
-        return size_;
+        size_t res = 0;
+        for (size_t i = 0; i < kShards; ++i)
+            res += shards_[i].records.size();
+        return res;
     }
-
-//    typename InnerIndex::iterator begin() const {
-//        return inner_index.begin();
-//    }
-//
-//    typename InnerIndex::iterator end() const {
-//        return inner_index.end();
-//    }
-//    typename InnerIndex::iterator operator*(){
-//        return this->first;
-//    }
-private:
-    size_t size_;
 };
 
 template<class Graph>
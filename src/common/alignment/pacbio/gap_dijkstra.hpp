@@ -35,6 +35,8 @@ struct DijkstraParams {
     bool find_shortest_path = true;
     bool restore_mapping = false;
     float penalty_ratio = 200;
+    // Use BitParallelGraphAligner instead of the per-state Dijkstra
+    bool bit_parallel = false;
 
     int max_ed_proportion = 3;
     int ed_lower_bound = 200;
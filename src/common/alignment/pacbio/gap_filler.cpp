@@ -6,6 +6,7 @@
 //***************************************************************************
 
 #include "gap_filler.hpp"
+#include "graph_bit_aligner.hpp"
 
 #include "assembly_graph/paths/path_utils.hpp"
 
@@ -65,19 +66,28 @@ GapFillerResult GapFiller::BestScoredPathDijkstra(const string &s,
         }
         return dijkstra_res;
     }
+    auto collect_result = [&](const auto &gap_filler) {
+        dijkstra_res.score = gap_filler.edit_distance();
+        dijkstra_res.return_code = gap_filler.return_code();
+        if (dijkstra_res.score == numeric_limits<int>::max()) {
+            DEBUG("Dijkstra didn't find anything")
+            return dijkstra_res;
+        }
+        dijkstra_res.full_intermediate_path = gap_filler.path();
+        return dijkstra_res;
+    };
+    if (gap_cfg.bit_parallel) {
+        BitParallelGraphAligner gap_filler(g_, gap_cfg, s,
+                                           start_pos.edgeid, (int) start_pos.position, ed_limit);
+        gap_filler.CloseGap(end_pos.edgeid, (int) end_pos.position, vertex_pathlen);
+        return collect_result(gap_filler);
+    }
     DijkstraGapFiller gap_filler(g_, gap_cfg, s,
                                  start_pos.edgeid, end_pos.edgeid,
                                  (int) start_pos.position, (int) end_pos.position,
                                  ed_limit, vertex_pathlen);
     gap_filler.CloseGap();
-    dijkstra_res.score = gap_filler.edit_distance();
-    dijkstra_res.return_code = gap_filler.return_code();
-    if (dijkstra_res.score == numeric_limits<int>::max()) {
-        DEBUG("Dijkstra didn't find anything")
-        return dijkstra_res;
-    }
-    dijkstra_res.full_intermediate_path = gap_filler.path();
-    return dijkstra_res;
+    return collect_result(gap_filler);
 }
 
 GapFillerResult GapFiller::BestScoredPathBruteForce(const string &seq_string,
@@ -269,19 +279,27 @@ GapFillerResult GapFiller::Run(Sequence &s,
         return res;
     }
     utils::perf_counter pc;
-    DijkstraEndsReconstructor algo(g_, ends_cfg, s.str(), start_pos.edgeid, (int) start_pos.position, score);
-    algo.CloseGap();
-    score = algo.edit_distance();
-    res.return_code = algo.return_code();
-    if (score == numeric_limits<int>::max()) {
-        DEBUG("EdgeDijkstra didn't find anything edge=" << start_pos.edgeid.int_id()
-              << " s_start=" << start_pos.position << " seq_len=" << s.size())
+    auto update_path = [&](const auto &algo) {
+        score = algo.edit_distance();
+        res.return_code = algo.return_code();
+        if (score == numeric_limits<int>::max()) {
+            DEBUG("EdgeDijkstra didn't find anything edge=" << start_pos.edgeid.int_id()
+                  << " s_start=" << start_pos.position << " seq_len=" << s.size())
+            return res;
+        }
+        vector<EdgeId> ans = algo.path();
+        MappingPoint p(forward ? algo.seq_end_position() + range.path_end.seq_pos : range.path_start.seq_pos - algo.seq_end_position(), algo.path_end_position());
+        UpdatePath(path, ans, p, range, forward, old_start_pos);
         return res;
+    };
+    if (ends_cfg.bit_parallel) {
+        BitParallelGraphAligner algo(g_, ends_cfg, s.str(), start_pos.edgeid, (int) start_pos.position, score);
+        algo.RestoreEnd();
+        return update_path(algo);
     }
-    vector<EdgeId> ans = algo.path();
-    MappingPoint p(forward ? algo.seq_end_position() + range.path_end.seq_pos : range.path_start.seq_pos - algo.seq_end_position(), algo.path_end_position());
-    UpdatePath(path, ans, p, range, forward, old_start_pos);
-    return res;
+    DijkstraEndsReconstructor algo(g_, ends_cfg, s.str(), start_pos.edgeid, (int) start_pos.position, score);
+    algo.CloseGap();
+    return update_path(algo);
 }
 
 } // namespace sensitive_aligner
@@ -0,0 +1,375 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "graph_bit_aligner.hpp"
+
+#include "sequence/nucl.hpp"
+
+#include <algorithm>
+
+namespace sensitive_aligner {
+
+using namespace std;
+using debruijn_graph::VertexId;
+
+BitParallelGraphAligner::BitParallelGraphAligner(const debruijn_graph::Graph &g,
+                                                 const DijkstraParams &cfg,
+                                                 const string &ss,
+                                                 EdgeId start_e, int start_p, int path_max_length)
+        : g_(g), cfg_(cfg), ss_(ss), start_e_(start_e), start_p_(start_p), bound_(path_max_length) {
+    size_t m = ss_.size();
+    best_values_.assign(m + 1, path_max_length);
+    words_ = max<size_t>(1, (m + 63) / 64);
+    last_mask_ = m ? Word(1) << ((m - 1) % 64) : 0;
+
+    codes_.resize(m);
+    peq_.assign(4 * words_, 0);
+    for (size_t i = 0; i < m; ++i) {
+        // Characters other than nucleotides match nothing
+        codes_[i] = is_nucl(ss_[i]) ? uint8_t(dignucl(ss_[i])) : uint8_t(4);
+        if (codes_[i] < 4)
+            peq_[codes_[i] * words_ + i / 64] |= Word(1) << (i % 64);
+    }
+    // Rows below the pattern match everything and do not affect the rows above
+    if (m % 64) {
+        for (size_t c = 0; c < 4; ++c)
+            peq_[c * words_ + words_ - 1] |= ~Word(0) << (m % 64);
+    }
+}
+
+void BitParallelGraphAligner::CloseGap(EdgeId end_e, int end_p, const ReachableVertices &reachable) {
+    ends_mode_ = false;
+    end_e_ = end_e;
+    end_p_ = end_p;
+    reachable_ = &reachable;
+    Run();
+}
+
+void BitParallelGraphAligner::RestoreEnd() {
+    ends_mode_ = true;
+    Run();
+}
+
+BitParallelGraphAligner::Column BitParallelGraphAligner::InitialColumn() const {
+    // Both the sequence and the path start here, so the value of row i is i
+    Column column{ vector<Word>(words_, ~Word(0)), vector<Word>(words_, 0), vector<int>(words_), 0 };
+    for (size_t b = 0; b < words_; ++b)
+        column.score[b] = (int) min(64 * (b + 1), ss_.size());
+    return column;
+}
+
+void BitParallelGraphAligner::Advance(Column &column, uint8_t nucl) const {
+    const Word *eq = &peq_[nucl * words_];
+    // Zero row grows by one with every character of the path
+    int hin = 1;
+    column.top += 1;
+    for (size_t b = 0; b < words_; ++b) {
+        Word pv = column.vp[b], mv = column.vn[b], pm = eq[b];
+        Word xv = pm | mv;
+        if (hin < 0)
+            pm |= Word(1);
+        Word xh = (((pm & pv) + pv) ^ pv) | pm;
+        Word ph = mv | ~(xh | pv);
+        Word mh = pv & xh;
+
+        int hout = int(ph >> 63) - int(mh >> 63);
+        if (b + 1 < words_)
+            column.score[b] += hout;
+        else
+            column.score[b] += int((ph & last_mask_) != 0) - int((mh & last_mask_) != 0);
+
+        ph <<= 1;
+        mh <<= 1;
+        if (hin < 0)
+            mh |= Word(1);
+        else if (hin > 0)
+            ph |= Word(1);
+        column.vp[b] = mh | ~(xv | ph);
+        column.vn[b] = ph & xv;
+        hin = hout;
+    }
+}
+
+int BitParallelGraphAligner::Value(const Column &column, size_t row) const {
+    int value = column.top;
+    size_t w = row / 64;
+    for (size_t b = 0; b < w; ++b)
+        value += __builtin_popcountll(column.vp[b]) - __builtin_popcountll(column.vn[b]);
+    if (row % 64) {
+        Word mask = (Word(1) << (row % 64)) - 1;
+        value += __builtin_popcountll(column.vp[w] & mask) - __builtin_popcountll(column.vn[w] & mask);
+    }
+    return value;
+}
+
+int BitParallelGraphAligner::Score(const Column &column) const {
+    return ss_.empty() ? column.top : column.score.back();
+}
+
+int BitParallelGraphAligner::LowerBound(const Column &column) const {
+    if (ss_.empty())
+        return column.top;
+
+    // Values within a block differ from its last row by at most 63
+    int result = column.top;
+    for (int score : column.score)
+        result = min(result, score - 63);
+    return max(result, 0);
+}
+
+vector<int> BitParallelGraphAligner::Decode(const Column &column) const {
+    vector<int> values(ss_.size() + 1);
+    values[0] = column.top;
+    for (size_t i = 1; i < values.size(); ++i) {
+        size_t b = (i - 1) / 64;
+        Word bit = Word(1) << ((i - 1) % 64);
+        values[i] = values[i - 1] + int((column.vp[b] & bit) != 0) - int((column.vn[b] & bit) != 0);
+    }
+    return values;
+}
+
+void BitParallelGraphAligner::Encode(const vector<int> &values, Column &column) const {
+    size_t m = ss_.size();
+    column.top = values[0];
+    std::fill(column.vp.begin(), column.vp.end(), ~Word(0));
+    std::fill(column.vn.begin(), column.vn.end(), 0);
+    for (size_t i = 1; i <= m; ++i) {
+        size_t b = (i - 1) / 64;
+        Word bit = Word(1) << ((i - 1) % 64);
+        int delta = values[i] - values[i - 1];
+        if (delta <= 0)
+            column.vp[b] &= ~bit;
+        if (delta < 0)
+            column.vn[b] |= bit;
+    }
+    for (size_t b = 0; b < words_; ++b)
+        column.score[b] = values[min(64 * (b + 1), m)];
+}
+
+int BitParallelGraphAligner::LowerBound(VertexId v, const vector<int> &values) const {
+    if (ends_mode_ || !reachable_ || reachable_->empty())
+        return *min_element(values.begin(), values.end());
+
+    // At least the shortest path to the end is to be spelled for the rest of the sequence
+    int rest = (int) reachable_->at(v) + end_p_, m = (int) ss_.size();
+    int result = numeric_limits<int>::max();
+    for (int i = 0; i <= m; ++i)
+        result = min(result, values[i] + max(0, rest - (m - i)));
+    return result;
+}
+
+bool BitParallelGraphAligner::IsBetter(const vector<int> &values) {
+    // Same band as in DijkstraGraphSequenceBase::IsBetter applied to all the positions at once
+    bool result = false;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (values[i] > bound_)
+            continue;
+        if (i == ss_.size() || i < SHORT_SEQ_LENGTH ||
+            max(best_values_[i] + (int) ((double) i * cfg_.penalty_ratio), ED_DEVIATION) >= values[i]) {
+            best_values_[i] = min(best_values_[i], values[i]);
+            result = true;
+        }
+    }
+    return result;
+}
+
+void BitParallelGraphAligner::MergeInto(VertexId v, const Column &column) {
+    vector<int> update = Decode(column);
+    if (LowerBound(v, update) > bound_ || !IsBetter(update))
+        return;
+
+    auto it = states_.find(v);
+    if (it == states_.end()) {
+        states_.emplace(v, VertexState{ column, true });
+        queue_.emplace(LowerBound(v, update), v);
+        return;
+    }
+
+    // Cell-wise minimum of the columns keeps the differences of the adjacent cells within one
+    Column &stored = it->second.column;
+    vector<int> values = Decode(stored);
+    bool changed = false;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (update[i] < values[i]) {
+            values[i] = update[i];
+            changed = true;
+        }
+    }
+    if (!changed)
+        return;
+
+    Encode(values, stored);
+    it->second.dirty = true;
+    queue_.emplace(LowerBound(v, values), v);
+}
+
+void BitParallelGraphAligner::AddCandidate(EdgeId e, int p, int score) {
+    if (score > bound_)
+        return;
+
+    found_ = true;
+    best_score_ = score;
+    best_e_ = e;
+    best_p_ = p;
+    // Only strictly better alignments are of interest from now on
+    bound_ = score - 1;
+    if (!cfg_.find_shortest_path)
+        stop_ = true;
+}
+
+void BitParallelGraphAligner::Propagate(Column column, EdgeId e, int begin) {
+    ++updates_;
+    int len = (int) g_.length(e);
+    bool merge = ends_mode_ || !reachable_ || reachable_->empty() || reachable_->count(g_.EdgeEnd(e));
+    bool target = !ends_mode_ && e == end_e_ && end_p_ >= begin;
+
+    int stop = merge ? len : begin;
+    // The sequence may end within the k-mer of the end vertex
+    if (ends_mode_)
+        stop = len + (int) g_.k();
+    if (target)
+        stop = max(stop, end_p_);
+
+    const Sequence &nucls = g_.EdgeNucls(e);
+    for (int p = begin; ; ++p) {
+        if (LowerBound(column) > bound_)
+            return;
+        if (merge && p == len)
+            MergeInto(g_.EdgeEnd(e), column);
+        if (target && p == end_p_)
+            AddCandidate(e, p, Score(column));
+        if (ends_mode_ && p > begin)
+            AddCandidate(e, p, Score(column));
+        if (p == stop || stop_)
+            return;
+        Advance(column, nucls[p]);
+    }
+}
+
+void BitParallelGraphAligner::Run() {
+    Propagate(InitialColumn(), start_e_, start_p_);
+
+    size_t iter = 0;
+    while (!queue_.empty() && !stop_) {
+        return_code_.queue_limit = queue_.size() > cfg_.queue_limit;
+        return_code_.iter_limit = iter > cfg_.iteration_limit;
+        if (return_code_.status || updates_ >= cfg_.updates_limit)
+            break;
+
+        auto [lower_bound, v] = queue_.top();
+        queue_.pop();
+        // Bounds of the columns never increase, so the rest of the queue is hopeless too
+        if (lower_bound > bound_)
+            break;
+
+        VertexState &state = states_.at(v);
+        if (!state.dirty)
+            continue;
+        state.dirty = false;
+        if (reachable_ && !reachable_->empty() && !reachable_->count(v))
+            continue;
+
+        ++iter;
+        // Merges may rehash the states
+        Column column = state.column;
+        for (EdgeId e : g_.OutgoingEdges(v)) {
+            Propagate(column, e, 0);
+            if (stop_)
+                break;
+        }
+    }
+    DEBUG("updates=" << updates_ << " vertices=" << states_.size());
+
+    if (!found_) {
+        return_code_.no_path = true;
+        return;
+    }
+    RestorePath();
+}
+
+int BitParallelGraphAligner::EdgeEndValue(EdgeId e, int p, size_t row, bool from_start) const {
+    Column column;
+    int begin = 0;
+    if (from_start) {
+        if (e != start_e_ || p < start_p_)
+            return numeric_limits<int>::max();
+        column = InitialColumn();
+        begin = start_p_;
+    } else {
+        auto it = states_.find(g_.EdgeStart(e));
+        if (it == states_.end())
+            return numeric_limits<int>::max();
+        column = it->second.column;
+    }
+
+    const Sequence &nucls = g_.EdgeNucls(e);
+    for (int j = begin; j < p; ++j)
+        Advance(column, nucls[j]);
+    return Value(column, row);
+}
+
+void BitParallelGraphAligner::RestorePath() {
+    vector<pair<EdgeId, omnigraph::MappingRange>> pieces;
+    EdgeId e = best_e_;
+    int p = best_p_;
+    size_t row = ss_.size();
+    int value = best_score_;
+    // Every step either decreases the value or keeps it and decreases the row
+    while (true) {
+        bool from_start = EdgeEndValue(e, p, row, true) <= value;
+        int begin = from_start ? start_p_ : 0;
+        const Sequence &nucls = g_.EdgeNucls(e);
+
+        vector<Column> columns{ from_start ? InitialColumn() : states_.at(g_.EdgeStart(e)).column };
+        columns.reserve(p - begin + 1);
+        for (int j = begin; j < p; ++j) {
+            columns.push_back(columns.back());
+            Advance(columns.back(), nucls[j]);
+        }
+
+        size_t i = row;
+        for (int j = p; j > begin; ) {
+            const Column &cur = columns[j - begin], &prev = columns[j - begin - 1];
+            int d = Value(cur, i);
+            if (i > 0 && Value(prev, i - 1) + int(codes_[i - 1] != nucls[j - 1]) == d) {
+                --i;
+                --j;
+            } else if (Value(prev, i) + 1 == d) {
+                --j;
+            } else {
+                VERIFY(i > 0 && Value(cur, i - 1) + 1 == d);
+                --i;
+            }
+        }
+        pieces.emplace_back(e, omnigraph::MappingRange(Range(from_start ? 0 : i, row), Range(begin, p)));
+        if (from_start)
+            break;
+
+        // Find the incoming edge the value at the start vertex came from
+        VertexId u = g_.EdgeStart(e);
+        value = Value(columns.front(), i);
+        row = i;
+        int best_value = numeric_limits<int>::max();
+        EdgeId best_in;
+        for (EdgeId in : g_.IncomingEdges(u)) {
+            int len = (int) g_.length(in);
+            int in_value = min(EdgeEndValue(in, len, row, true), EdgeEndValue(in, len, row, false));
+            if (in_value < best_value) {
+                best_value = in_value;
+                best_in = in;
+            }
+        }
+        VERIFY(best_value <= value);
+        e = best_in;
+        p = (int) g_.length(e);
+        value = best_value;
+    }
+
+    for (auto it = pieces.rbegin(); it != pieces.rend(); ++it)
+        mapping_path_.push_back(it->first, it->second);
+}
+
+} // namespace sensitive_aligner
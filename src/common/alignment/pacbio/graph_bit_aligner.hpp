@@ -0,0 +1,149 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "gap_dijkstra.hpp"
+
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace sensitive_aligner {
+
+/**
+ * @brief Bit-parallel alignment of a sequence to the graph paths going from the given position.
+ *
+ * @detail The whole sequence is the pattern of the Myers algorithm: a DP column holds the edit
+ * distances of all the sequence prefixes to the graph path spelled so far, packed as vertical
+ * deltas in 64-bit words. Columns are advanced over a whole edge at once and are stored only at
+ * the vertices, where the columns coming from different edges are merged by the cell-wise minimum.
+ * Vertices are processed in the order of the lower bounds of their columns (accounting for the
+ * distance to the gap end when it is known). Columns are dropped when all their cells are either
+ * above the score bound, which tightens as the alignments are found, or far from the best values
+ * seen for the same sequence positions (the penalty_ratio band of the Dijkstra). The path is
+ * restored by tracing back through the stored vertex columns.
+ *
+ * In contrast to DijkstraGraphSequenceBase, the alignments for all the positions of the sequence
+ * share the same column, so every edge is aligned once per column update instead of once per
+ * (edge, sequence position) state.
+ */
+class BitParallelGraphAligner {
+  public:
+    typedef std::unordered_map<debruijn_graph::VertexId, size_t> ReachableVertices;
+
+    BitParallelGraphAligner(const debruijn_graph::Graph &g,
+                            const DijkstraParams &cfg,
+                            const std::string &ss,
+                            EdgeId start_e, int start_p, int path_max_length);
+
+    /// Aligns the sequence globally ending right before end_p on end_e. The paths
+    /// go only through the reachable vertices unless the map is empty
+    void CloseGap(EdgeId end_e, int end_p, const ReachableVertices &reachable);
+
+    /// Aligns the sequence ending anywhere in the graph
+    void RestoreEnd();
+
+    std::vector<EdgeId> path() const {
+        return mapping_path_.simple_path();
+    }
+
+    omnigraph::MappingPath<EdgeId> mapping_path() const {
+        return mapping_path_;
+    }
+
+    int edit_distance() const {
+        return found_ ? best_score_ : std::numeric_limits<int>::max();
+    }
+
+    DijkstraReturnCode return_code() const {
+        return return_code_;
+    }
+
+    int path_end_position() const {
+        return best_p_;
+    }
+
+    int seq_end_position() const {
+        return (int) ss_.size();
+    }
+
+  private:
+    typedef uint64_t Word;
+
+    static const int SHORT_SEQ_LENGTH = 100;
+    static const int ED_DEVIATION = 20;
+
+    struct Column {
+        std::vector<Word> vp, vn;
+        // Value at the last row of each block
+        std::vector<int> score;
+        // Value at the zero row
+        int top;
+    };
+
+    struct VertexState {
+        Column column;
+        bool dirty;
+    };
+
+    Column InitialColumn() const;
+    void Advance(Column &column, uint8_t nucl) const;
+    int Value(const Column &column, size_t row) const;
+    int Score(const Column &column) const;
+    int LowerBound(const Column &column) const;
+    std::vector<int> Decode(const Column &column) const;
+    void Encode(const std::vector<int> &values, Column &column) const;
+    int LowerBound(debruijn_graph::VertexId v, const std::vector<int> &values) const;
+    bool IsBetter(const std::vector<int> &values);
+    void MergeInto(debruijn_graph::VertexId v, const Column &column);
+
+    void Run();
+    void Propagate(Column column, EdgeId e, int begin);
+    void AddCandidate(EdgeId e, int p, int score);
+    int EdgeEndValue(EdgeId e, int p, size_t row, bool from_start) const;
+    void RestorePath();
+
+    const debruijn_graph::Graph &g_;
+    const DijkstraParams cfg_;
+    const std::string ss_;
+    const EdgeId start_e_;
+    const int start_p_;
+
+    size_t words_;
+    Word last_mask_;
+    // Match masks of the pattern for every nucleotide
+    std::vector<Word> peq_;
+    std::vector<uint8_t> codes_;
+
+    bool ends_mode_ = false;
+    EdgeId end_e_;
+    int end_p_ = 0;
+    const ReachableVertices *reachable_ = nullptr;
+
+    int bound_;
+    // Best values seen for every sequence position
+    std::vector<int> best_values_;
+    int best_score_ = std::numeric_limits<int>::max();
+    bool found_ = false;
+    bool stop_ = false;
+    EdgeId best_e_;
+    int best_p_ = 0;
+    size_t updates_ = 0;
+
+    std::unordered_map<debruijn_graph::VertexId, VertexState> states_;
+    std::priority_queue<std::pair<int, debruijn_graph::VertexId>,
+                        std::vector<std::pair<int, debruijn_graph::VertexId>>,
+                        std::greater<std::pair<int, debruijn_graph::VertexId>>> queue_;
+
+    omnigraph::MappingPath<EdgeId> mapping_path_;
+    DijkstraReturnCode return_code_;
+
+    DECL_LOGGER("BitParallelGraphAligner");
+};
+
+} // namespace sensitive_aligner
@@ -10,6 +10,7 @@
 
 #include "gap_filler.hpp"
 #include "pacbio_read_structures.hpp"
+#include "vertex_distance_oracle.hpp"
 
 #include "alignment/bwa_sequence_mapper.hpp"
 #include "alignment/edge_index_refiller.hpp"
@@ -18,6 +19,7 @@
 
 #include <algorithm>
 #include <set>
+#include <unordered_map>
 #include <vector>
 
 namespace sensitive_aligner {
@@ -38,6 +40,7 @@ class PacBioMappingIndex {
                        debruijn_graph::config::pacbio_processor pb_config,
                        alignment::BWAIndex::AlignmentMode mode)
         : g_(g),
+          distance_oracle_(g, pb_config.max_path_in_dijkstra, pb_config.max_vertex_in_dijkstra),
           pb_config_(pb_config),
           bwa_mapper_(g, mode) {
         DEBUG("PB Mapping Index construction started");
@@ -52,32 +55,34 @@ class PacBioMappingIndex {
     }
     std::vector<std::vector<QualityRange>> GetChainingPaths(const io::SingleRead &read) const {
         std::vector<ColoredRange> ranged_colors = GetRangedColors(read);
-        size_t len = ranged_colors.size();
+
+        // Group the ranges by colour in a single sweep, groups are ordered by the first
+        // range of the colour
+        std::vector<std::vector<QualityRange>> paths;
+        std::unordered_map<int, size_t> color_path;
+        for (auto &colored_range : ranged_colors) {
+            if (colored_range.second == static_cast<int>(InvalidColors::DELETED_COLOR))
+                continue;
+            auto it = color_path.try_emplace(colored_range.second, paths.size()).first;
+            if (it->second == paths.size())
+                paths.emplace_back();
+            paths[it->second].push_back(std::move(colored_range.first));
+        }
+
         std::vector<std::vector<QualityRange>> res;
-        for (size_t i = 0; i < len; i++) {
-            if (ranged_colors[i].second != static_cast<int>(InvalidColors::DELETED_COLOR)) {
-                std::vector<QualityRange> path;
-                int cur_color = ranged_colors[i].second;
-                for (size_t j = 0; j < len; j++) {
-                    if (ranged_colors[j].second == cur_color) {
-                        path.push_back(ranged_colors[j].first);
-                        ranged_colors[j].second = static_cast<int>(InvalidColors::DELETED_COLOR);
-                    }
-                }
-                auto prev_iter = path.begin();
-                for (auto iter = path.begin(); iter != path.end(); ++iter) {
-                    auto next_iter = iter + 1;
-                    if (next_iter == path.end() || !IsConsistent(*iter, *next_iter)) {
-                        if (next_iter != path.end()) {
-                            DEBUG("clusters split:");
-                            DEBUG("on " << iter->str(g_));
-                            DEBUG("and " << next_iter->str(g_));
-                        }
-                        res.push_back(std::vector<QualityRange>(prev_iter, next_iter));
-                        prev_iter = next_iter;
+        for (const auto &path : paths) {
+            auto prev_iter = path.begin();
+            for (auto iter = path.begin(); iter != path.end(); ++iter) {
+                auto next_iter = iter + 1;
+                if (next_iter == path.end() || !IsConsistent(*iter, *next_iter)) {
+                    if (next_iter != path.end()) {
+                        DEBUG("clusters split:");
+                        DEBUG("on " << iter->str(g_));
+                        DEBUG("and " << next_iter->str(g_));
                     }
+                    res.push_back(std::vector<QualityRange>(prev_iter, next_iter));
+                    prev_iter = next_iter;
                 }
-
             }
         }
         return res;
@@ -93,8 +98,7 @@ class PacBioMappingIndex {
 
     static const size_t DISTANT_IN_GRAPH = 1000;
     static const size_t MAX_VERTICES_IN_DIJKSTRA_FILTERING = 500;
-    //presumably separate class for this and GetDistance
-    mutable std::map<std::pair<VertexId, VertexId>, size_t> distance_cashed_;
+    VertexDistanceOracle distance_oracle_;
     size_t read_count_;
     
     mutable size_t rna_filtering_count_;
@@ -316,7 +320,7 @@ class PacBioMappingIndex {
 //Currently unused but useful for debug purposes
     std::string DebugEmptyBestScoredPath(VertexId start_v, VertexId end_v, EdgeId prev_edge, EdgeId cur_edge,
                                          size_t prev_last_edge_position, size_t cur_first_edge_position, int seq_len) const {
-        size_t result = GetDistance(start_v, end_v, /*update cache*/false);
+        size_t result = GetDistance(start_v, end_v);
         std::ostringstream ss;
         ss << "Tangled region between edges " << g_.int_id(prev_edge) << " " << g_.int_id(cur_edge) <<  " is not closed, additions from edges: "
            << int(g_.length(prev_edge)) - int(prev_last_edge_position) << " " << int(cur_first_edge_position)
@@ -397,37 +401,8 @@ class PacBioMappingIndex {
         return res;
     }
 
-    size_t GetDistance(VertexId start_v, VertexId end_v,
-                       bool update_cache = true) const {
-        size_t result = size_t(-1);
-        auto vertex_pair = std::make_pair(start_v, end_v);
-        bool not_found;
-        auto distance_it = distance_cashed_.begin();
-        //FIXME should permit multiple readers
-        #pragma omp critical(pac_index)
-        {
-            distance_it = distance_cashed_.find(vertex_pair);
-            not_found = (distance_it == distance_cashed_.end());
-        }
-        if (not_found) {
-            omnigraph::DijkstraHelper<debruijn_graph::Graph>::BoundedDijkstra dijkstra(
-                omnigraph::DijkstraHelper<debruijn_graph::Graph>::CreateBoundedDijkstra(g_,
-                        pb_config_.max_path_in_dijkstra,
-                        pb_config_.max_vertex_in_dijkstra));
-            dijkstra.Run(start_v);
-            if (dijkstra.DistanceCounted(end_v)) {
-                result = dijkstra.GetDistance(end_v);
-            }
-            if (update_cache) {
-                #pragma omp critical(pac_index)
-                distance_cashed_.insert({vertex_pair, result});
-            }
-        } else {
-            TRACE("taking from cashed");
-            result = distance_it->second;
-        }
-
-        return result;
+    size_t GetDistance(VertexId start_v, VertexId end_v) const {
+        return distance_oracle_.GetDistance(start_v, end_v);
     }
 
     bool IsConsistent(const QualityRange &a,
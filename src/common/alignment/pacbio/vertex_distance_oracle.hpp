@@ -0,0 +1,107 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "assembly_graph/core/graph.hpp"
+#include "assembly_graph/dijkstra/dijkstra_helper.hpp"
+
+#include <parallel_hashmap/phmap.h>
+
+#include <algorithm>
+#include <atomic>
+#include <shared_mutex>
+#include <vector>
+
+namespace sensitive_aligner {
+
+/**
+ * @brief Thread-safe bounded graph distances between the vertices.
+ *
+ * @detail A single bounded Dijkstra run from the source vertex gives the distances to all
+ * the vertices reached within the bound, so the whole row is memoized at once and the
+ * subsequent queries from the same source are answered by a binary search. Rows are kept
+ * in a concurrent hash map: lookups take only a shared lock of the corresponding submap.
+ * The memoized distances are bounded by max_cached, once it is exceeded the whole cache is
+ * dropped and filled in from scratch by the subsequent queries.
+ */
+class VertexDistanceOracle {
+  public:
+    typedef debruijn_graph::Graph Graph;
+    typedef debruijn_graph::VertexId VertexId;
+
+    static constexpr size_t kInfiniteDistance = size_t(-1);
+
+    VertexDistanceOracle(const Graph &g, size_t max_path_length, size_t max_vertices,
+                         size_t max_cached = 1 << 24)
+            : g_(g), max_path_length_(max_path_length), max_vertices_(max_vertices),
+              max_cached_(max_cached), cached_(0) {}
+
+    /// Distance from start to end or kInfiniteDistance if end is not reached within the bounds
+    size_t GetDistance(VertexId start, VertexId end) const {
+        size_t result = kInfiniteDistance;
+        bool found = rows_.if_contains(start, [&](const auto &row) {
+            result = Lookup(row.second, end);
+        });
+        if (found)
+            return result;
+
+        DistanceRow row = CountRow(start);
+        result = Lookup(row, end);
+        size_t row_size = row.size();
+        if (rows_.try_emplace(start, std::move(row)).second &&
+            cached_.fetch_add(row_size) + row_size > max_cached_)
+            DropCache();
+        return result;
+    }
+
+    void Clear() {
+        DropCache();
+    }
+
+    /// Number of the memoized distances
+    size_t cached() const {
+        return cached_;
+    }
+
+  private:
+    void DropCache() const {
+        rows_.clear();
+        cached_ = 0;
+    }
+
+    // Reached vertices with the distances, sorted by vertex
+    typedef std::vector<std::pair<VertexId, size_t>> DistanceRow;
+
+    DistanceRow CountRow(VertexId start) const {
+        auto dijkstra = omnigraph::DijkstraHelper<Graph>::CreateBoundedDijkstra(g_, max_path_length_, max_vertices_);
+        dijkstra.Run(start);
+
+        DistanceRow row(dijkstra.reached_begin(), dijkstra.reached_end());
+        std::sort(row.begin(), row.end());
+        return row;
+    }
+
+    static size_t Lookup(const DistanceRow &row, VertexId v) {
+        auto it = std::lower_bound(row.begin(), row.end(), v,
+                                   [](const std::pair<VertexId, size_t> &p, VertexId v) { return p.first < v; });
+        return (it != row.end() && it->first == v) ? it->second : kInfiniteDistance;
+    }
+
+    const Graph &g_;
+    size_t max_path_length_;
+    size_t max_vertices_;
+    size_t max_cached_;
+
+    mutable std::atomic<size_t> cached_;
+    mutable phmap::parallel_flat_hash_map<VertexId, DistanceRow,
+                                          phmap::priv::hash_default_hash<VertexId>,
+                                          phmap::priv::hash_default_eq<VertexId>,
+                                          phmap::priv::Allocator<phmap::priv::Pair<const VertexId, DistanceRow>>,
+                                          4, std::shared_mutex> rows_;
+};
+
+}
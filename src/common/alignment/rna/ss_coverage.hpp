@@ -12,20 +12,33 @@
 #include "io/binary/binary.hpp"
 #include "sequence/range.hpp"
 
+#include <algorithm>
+#include <vector>
+
 namespace debruijn_graph {
 
 
+/**
+ * @brief Strand-specific coverage of the edges.
+ *
+ * @detail Coverage is kept in a dense array indexed by the edge id, so the per-thread
+ * storages could be reduced with a plain vectorized loop.
+ */
 class SSCoverageStorage {
-public:
-    typedef std::unordered_map<EdgeId, double> InnerMap;
-
 private:
     const Graph& g_;
 
-    InnerMap storage_;
+    // Indexed by the edge int id
+    std::vector<double> storage_;
+
+    void EnsureSize(EdgeId e) {
+        if (e.int_id() >= storage_.size())
+            storage_.resize(std::max<size_t>(g_.max_eid(), e.int_id() + 1), 0.0);
+    }
 
     void SetCoverage(EdgeId e, double cov) {
-        storage_[e] = cov;
+        EnsureSize(e);
+        storage_[e.int_id()] = cov;
     }
 
     DECL_LOGGER("SSCoverage");
@@ -38,34 +51,52 @@ public:
             e = g_.conjugate(e);
         }
 
-        auto it = storage_.find(e);
-        if (it == storage_.end())
+        if (e.int_id() >= storage_.size())
             return 0.0;
-        return it->second;
+        return storage_[e.int_id()];
     }
 
     void IncreaseKmerCount(EdgeId e, size_t count, bool add_reverse = false) {
-        storage_[e] += (double) count;
-        if (add_reverse)
-            storage_[g_.conjugate(e)] += (double) count;
+        EnsureSize(e);
+        storage_[e.int_id()] += (double) count;
+        if (add_reverse) {
+            EdgeId conj = g_.conjugate(e);
+            EnsureSize(conj);
+            storage_[conj.int_id()] += (double) count;
+        }
+    }
+
+    /// Preallocates the storage for all the edges of the graph
+    void Reserve() {
+        if (storage_.size() < g_.max_eid())
+            storage_.resize(g_.max_eid(), 0.0);
+    }
+
+    /// Drops the coverage values but keeps the storage allocated
+    void Reset() {
+        std::fill(storage_.begin(), storage_.end(), 0.0);
     }
 
     void Clear() {
         storage_.clear();
     }
 
-    void RecalculateCoverage() {
-        for (auto& it : storage_) {
-            it.second = it.second / double(g_.length(it.first));
-        }
-    }
+    void MergeOther(const SSCoverageStorage& other) {
+        if (storage_.size() < other.storage_.size())
+            storage_.resize(other.storage_.size(), 0.0);
 
-    InnerMap::const_iterator begin() const {
-        return storage_.begin();
+        double *dst = storage_.data();
+        const double *src = other.storage_.data();
+#       pragma omp simd
+        for (size_t i = 0; i < other.storage_.size(); ++i)
+            dst[i] += src[i];
     }
 
-    InnerMap::const_iterator end() const {
-        return storage_.end();
+    void RecalculateCoverage() {
+        for (EdgeId e : g_.edges()) {
+            if (e.int_id() < storage_.size())
+                storage_[e.int_id()] /= double(g_.length(e));
+        }
     }
 
     void Save(EdgeId e, std::ostream& out) const {
@@ -80,10 +111,13 @@ public:
 
     template <typename Archive>
     void BinArchiveSave(Archive &ar) const {
-        ar(storage_.size());
-        for (const auto &it : storage_) {
-            ar(it.first.int_id());
-            ar(it.second);
+        size_t size = storage_.size() - std::count(storage_.begin(), storage_.end(), 0.0);
+        ar(size);
+        for (size_t id = 0; id < storage_.size(); ++id) {
+            if (storage_[id] == 0.0)
+                continue;
+            ar(uint64_t(id));
+            ar(storage_[id]);
         }
     }
 
@@ -134,12 +168,17 @@ public:
 };
 
 
+/**
+ * @brief Splits the edges where the strand-specific coverage switches between the strands.
+ *
+ * @detail Coverage bins of all the edges are stored back to back in a single array, the
+ * bins of the edge start at its offset (indexed by the edge id). Thread-local bins refer
+ * to the layout of the splitter, only the array of bins is allocated per thread.
+ */
 class SSCoverageSplitter {
-public:
-    typedef std::vector<size_t> EdgeBucketT;
-    typedef std::unordered_map<EdgeId, EdgeBucketT> InnerSplitMap;
-
 private:
+    static constexpr size_t kNoBins = -1ull;
+
     Graph& g_;
 
     size_t bin_size_;
@@ -152,12 +191,66 @@ private:
 
     double min_flanking_coverage_;
 
-    InnerSplitMap storage_;
-
-    std::unordered_map<EdgeId, size_t> first_bin_size_;
+    // Edges having the coverage bins and the offsets of their bins indexed by the edge id
+    std::vector<EdgeId> edges_;
+    std::vector<size_t> bin_offset_;
+    std::vector<size_t> bins_;
 
     DECL_LOGGER("SSCoverage");
 
+    size_t BinCount(EdgeId e) const {
+        return g_.length(e) / bin_size_ + 1;
+    }
+
+    size_t FirstBinSize(EdgeId e) const {
+        return e < g_.conjugate(e) ? bin_size_ : g_.length(e) % bin_size_;
+    }
+
+    bool HasBins(EdgeId e) const {
+        return e.int_id() < bin_offset_.size() && bin_offset_[e.int_id()] != kNoBins;
+    }
+
+    const size_t *Bins(EdgeId e) const {
+        VERIFY(HasBins(e));
+        return bins_.data() + bin_offset_[e.int_id()];
+    }
+
+    // Adds the k-mers of the range into the bins laid out as the ones of the splitter
+    void IncreaseKmerCount(std::vector<size_t> &all_bins, EdgeId e, Range mapped_range) const {
+        if (!HasBins(e))
+            return;
+
+        size_t first_bin_size = FirstBinSize(e);
+        int lpos = (int) mapped_range.start_pos - (int) first_bin_size;
+        size_t left_bin = lpos < 0 ? 0 : lpos / bin_size_ + 1;
+        int rpos = (int) mapped_range.end_pos - (int) first_bin_size;
+        size_t right_bin = rpos < 0 ? 0 : rpos / bin_size_ + 1;
+
+        size_t *bins = all_bins.data() + bin_offset_[e.int_id()];
+        if (left_bin == right_bin) {
+            bins[left_bin] += mapped_range.end_pos - mapped_range.start_pos;
+        } else {
+            VERIFY(right_bin > 0);
+            size_t left_kmers = lpos < 0 ? abs(lpos) : bin_size_ - size_t(lpos % bin_size_);
+            size_t right_kmers = size_t(rpos % bin_size_);
+            bins[left_bin] += left_kmers;
+            bins[right_bin] += right_kmers;
+            for (size_t i = left_bin + 1; i < right_bin; ++i) {
+                bins[i] += bin_size_;
+            }
+        }
+    }
+
+    static void MergeBins(std::vector<size_t> &dst_bins, const std::vector<size_t> &src_bins) {
+        VERIFY(src_bins.size() == dst_bins.size());
+
+        size_t *dst = dst_bins.data();
+        const size_t *src = src_bins.data();
+#       pragma omp simd
+        for (size_t i = 0; i < dst_bins.size(); ++i)
+            dst[i] += src[i];
+    }
+
     bool IsCoverageDifferent(double cov1, double cov2) const {
         if (math::eq(cov2, 0.0) && math::eq(cov1, 0.0)) {
             return false;
@@ -171,28 +264,27 @@ private:
         }
     }
 
-    size_t DetectEdgeSplit(EdgeId e, const EdgeBucketT& cov_bins) const {
-        VERIFY(cov_bins.size() >= 3);
+    size_t DetectEdgeSplit(EdgeId e) const {
+        size_t bin_count = BinCount(e);
+        VERIFY(bin_count >= 3);
         DEBUG("Detecting split of edge " << g_.int_id(e) << ", l = " << g_.length(e) <<
-             ", bins " << cov_bins.size() << ", coverage");
-        auto conj_it = storage_.find(g_.conjugate(e));
-        VERIFY(conj_it != storage_.end());
-        const EdgeBucketT& conj_cov_bins = conj_it->second;
-        VERIFY(cov_bins.size() == conj_cov_bins.size());
+             ", bins " << bin_count << ", coverage");
+        const size_t *cov_bins = Bins(e);
+        const size_t *conj_cov_bins = Bins(g_.conjugate(e));
 
-        if (!CheckCoverageCondition(cov_bins, conj_cov_bins))
+        if (!CheckCoverageCondition(cov_bins, conj_cov_bins, bin_count))
             return 0;
 
-        bool e_coverage_descends = IsCoverageDescending(cov_bins);
+        bool e_coverage_descends = IsCoverageDescending(cov_bins, bin_count);
         size_t index = 0;
-        while (index < cov_bins.size() &&
-            !HasCoverageIntersected(e_coverage_descends, index, cov_bins, conj_cov_bins)) {
-            TRACE(cov_bins[index] << " : " << conj_cov_bins[cov_bins.size() - 1 - index]);
+        while (index < bin_count &&
+            !HasCoverageIntersected(e_coverage_descends, index, cov_bins, conj_cov_bins, bin_count)) {
+            TRACE(cov_bins[index] << " : " << conj_cov_bins[bin_count - 1 - index]);
             ++index;
         }
         DEBUG("Index found " << index);
 
-        if (index == cov_bins.size()) {
+        if (index == bin_count) {
             DEBUG("Did not find coverage intersection");
             return 0;
         }
@@ -203,20 +295,20 @@ private:
         return pos;
     }
 
-    bool IsCoverageDescending(const EdgeBucketT& cov_bins) const {
-        size_t last_whole_bin = cov_bins.size() - 2;
-        double fwd_front_cov = double(cov_bins.front()) / double(bin_size_);
+    bool IsCoverageDescending(const size_t *cov_bins, size_t bin_count) const {
+        size_t last_whole_bin = bin_count - 2;
+        double fwd_front_cov = double(cov_bins[0]) / double(bin_size_);
         double fwd_back_cov = double(cov_bins[last_whole_bin]) / double(bin_size_);
         return math::gr(fwd_front_cov, fwd_back_cov);
     }
 
-    bool CheckCoverageCondition(const EdgeBucketT& cov_bins, const EdgeBucketT& conj_cov_bins) const {
-        size_t last_whole_bin = cov_bins.size() - 2;
-        double fwd_front_cov = double(cov_bins.front()) / double(bin_size_);
+    bool CheckCoverageCondition(const size_t *cov_bins, const size_t *conj_cov_bins, size_t bin_count) const {
+        size_t last_whole_bin = bin_count - 2;
+        double fwd_front_cov = double(cov_bins[0]) / double(bin_size_);
         double fwd_back_cov = double(cov_bins[last_whole_bin]) / double(bin_size_);
 
         double bcwd_front_cov = double(conj_cov_bins[1]) / double(bin_size_);
-        double bcwd_back_cov = double(conj_cov_bins.back()) / double(bin_size_);
+        double bcwd_back_cov = double(conj_cov_bins[bin_count - 1]) / double(bin_size_);
 
         if (!IsCoverageDifferent(fwd_front_cov, fwd_back_cov) ||
             !IsCoverageDifferent(bcwd_front_cov, bcwd_back_cov) ||
@@ -229,7 +321,7 @@ private:
         DEBUG("Coverage is different: " << fwd_front_cov << "->" << fwd_back_cov <<
                                         "; " << bcwd_front_cov << " ->" << bcwd_back_cov);
 
-        bool e_coverage_descends = IsCoverageDescending(cov_bins);
+        bool e_coverage_descends = IsCoverageDescending(cov_bins, bin_count);
 
         if (e_coverage_descends) {
             if (math::ls(fwd_front_cov, bcwd_back_cov) || math::ls(bcwd_front_cov, fwd_back_cov)) {
@@ -246,11 +338,11 @@ private:
     }
 
     bool HasCoverageIntersected(bool e_coverage_descends, size_t index,
-        const EdgeBucketT& cov_bins, const EdgeBucketT& conj_cov_bins) const {
+        const size_t *cov_bins, const size_t *conj_cov_bins, size_t bin_count) const {
         if (e_coverage_descends)
-            return cov_bins[index] < conj_cov_bins[cov_bins.size() - 1 - index];
+            return cov_bins[index] < conj_cov_bins[bin_count - 1 - index];
         else
-            return cov_bins[index] > conj_cov_bins[cov_bins.size() - 1 - index];
+            return cov_bins[index] > conj_cov_bins[bin_count - 1 - index];
     }
 
     bool IsEdgeValid(EdgeId e) const {
@@ -258,12 +350,27 @@ private:
     }
 
 public:
+    /// Thread-local coverage bins, valid until the splitter is re-initialized
+    class LocalBins {
+        const SSCoverageSplitter &splitter_;
+        std::vector<size_t> bins_;
+
+        friend class SSCoverageSplitter;
+
+    public:
+        explicit LocalBins(const SSCoverageSplitter &splitter)
+                : splitter_(splitter), bins_(splitter.bins_.size(), 0) {}
+
+        void IncreaseKmerCount(EdgeId e, Range mapped_range) {
+            splitter_.IncreaseKmerCount(bins_, e, mapped_range);
+        }
+    };
+
     SSCoverageSplitter(Graph& g, size_t bin_size, size_t min_edge_len,
                        double min_edge_coverage, double coverage_margin, double min_flanking_coverage): g_(g),
                 bin_size_(bin_size), min_edge_len_(min_edge_len),
                 min_edge_coverage_(min_edge_coverage), coverage_margin_(coverage_margin),
-                min_flanking_coverage_(min_flanking_coverage),
-                storage_(), first_bin_size_() {
+                min_flanking_coverage_(min_flanking_coverage) {
         VERIFY(min_edge_len_ >= bin_size_ * 3);
         Init();
     }
@@ -293,86 +400,59 @@ public:
     }
 
     void Init() {
-        storage_.clear();
-        first_bin_size_.clear();
+        edges_.clear();
+        bin_offset_.assign(g_.max_eid(), kNoBins);
+        size_t total_bins = 0;
         for (EdgeId e : g_.edges()) {
             if (!IsEdgeValid(e))
                 continue;
-            storage_.emplace(e, std::vector<size_t>(g_.length(e) / bin_size_ + 1, 0));
-            if (e < g_.conjugate(e)) {
-                first_bin_size_.emplace(e, bin_size_);
-            } else {
-                first_bin_size_.emplace(e, g_.length(e) % bin_size_);
-            }
+            edges_.push_back(e);
+            bin_offset_[e.int_id()] = total_bins;
+            total_bins += BinCount(e);
         }
+        bins_.assign(total_bins, 0);
     }
 
     void IncreaseKmerCount(EdgeId e, Range mapped_range) {
-        if (!IsEdgeValid(e))
-            return;
-
-        int lpos = (int) mapped_range.start_pos - (int) first_bin_size_[e];
-        size_t left_bin = lpos < 0 ? 0 : lpos / bin_size_ + 1;
-        int rpos = (int) mapped_range.end_pos - (int) first_bin_size_[e];
-        size_t right_bin = rpos < 0 ? 0 : rpos / bin_size_ + 1;
-
-        auto it = storage_.find(e);
-        VERIFY(it != storage_.end());
-        auto& bins = it->second;
-
-        if (left_bin == right_bin) {
-            bins[left_bin] += mapped_range.end_pos - mapped_range.start_pos;
-        } else {
-            VERIFY(right_bin > 0);
-            size_t left_kmers = lpos < 0 ? abs(lpos) : bin_size_ - size_t(lpos % bin_size_);
-            size_t right_kmers = size_t(rpos % bin_size_);
-            bins[left_bin] += left_kmers;
-            bins[right_bin] += right_kmers;
-            for (size_t i = left_bin + 1; i < right_bin; ++i) {
-                bins[i] += bin_size_;
-            }
-        }
+        IncreaseKmerCount(bins_, e, mapped_range);
     }
 
     void Clear() {
-        for (auto& it : storage_) {
-            for (auto& bin : it.second) {
-                bin = 0;
-            }
-        }
+        std::fill(bins_.begin(), bins_.end(), 0);
     }
 
     void MergeOther(const SSCoverageSplitter& other) {
         VERIFY(other.bin_size_ == bin_size_);
         VERIFY(other.min_edge_len_ == min_edge_len_);
         VERIFY(other.min_edge_coverage_ == min_edge_coverage_);
+        MergeBins(bins_, other.bins_);
+    }
 
-        for (auto it = other.storage_.begin(); it != other.storage_.end(); ++it) {
-            auto to_insert = storage_.find(it->first);
-            VERIFY(to_insert != storage_.end());
-            VERIFY(to_insert->second.size() == it->second.size());
-            for (size_t i = 0; i < it->second.size(); ++i) {
-                to_insert->second[i] += it->second[i];
-            }
-        }
+    void MergeOther(const LocalBins& other) {
+        VERIFY(&other.splitter_ == this);
+        MergeBins(bins_, other.bins_);
     }
 
     void SplitEdges() {
         INFO("Detecting split positions");
-        std::unordered_map<EdgeId, size_t> edge_breaks;
-        for (const auto& it : storage_) {
-            if (it.first < g_.conjugate(it.first))
+        std::vector<size_t> split_pos(edges_.size(), 0);
+#       pragma omp parallel for schedule(guided)
+        for (size_t i = 0; i < edges_.size(); ++i) {
+            EdgeId e = edges_[i];
+            if (e < g_.conjugate(e))
                 continue;
-            auto pos = DetectEdgeSplit(it.first, it.second);
-            if (pos != 0)
-                edge_breaks.emplace(it.first, pos);
+            split_pos[i] = DetectEdgeSplit(e);
         }
 
         INFO("Splitting edges");
-        for (const auto& it : edge_breaks) {
-            g_.SplitEdge(it.first, it.second);
+        size_t splits = 0;
+        for (size_t i = 0; i < edges_.size(); ++i) {
+            if (split_pos[i] == 0)
+                continue;
+            g_.SplitEdge(edges_[i], split_pos[i]);
+            splits += 1;
         }
-        INFO("Total edges splits performed " << edge_breaks.size());
+        INFO("Total edges splits performed " << splits);
     }
 
 };
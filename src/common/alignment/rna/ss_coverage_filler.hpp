@@ -15,6 +15,8 @@
 
 namespace debruijn_graph {
 
+// Thread-local storages of the fillers are dense and do not grow with the number of reads,
+// so they are reduced only once per library instead of on every merge of the read buffers
 class SSCoverageFiller: public SequenceMapperListener {
 private:
     const Graph& g_;
@@ -41,14 +43,17 @@ public:
     void StartProcessLibrary(size_t threads_count) override {
         tmp_storages_.clear();
 
+        storage_.Reserve();
         for (size_t i = 0; i < threads_count; ++i) {
             tmp_storages_.emplace_back(g_);
+            tmp_storages_.back().Reserve();
         }
     }
 
     void StopProcessLibrary() override {
-        for (auto& storage : tmp_storages_)
-            storage.Clear();
+        for (const auto &tmp_storage : tmp_storages_)
+            storage_.MergeOther(tmp_storage);
+        tmp_storages_.clear();
         storage_.RecalculateCoverage();
     }
 
@@ -60,11 +65,6 @@ public:
         ProcessRange(thread_index, read);
     }
 
-    void MergeBuffer(size_t thread_index) override {
-        for (const auto& it : tmp_storages_[thread_index])
-            storage_.IncreaseKmerCount(it.first, size_t(it.second));
-        tmp_storages_[thread_index].Clear();
-    }
 };
 
 
@@ -72,7 +72,7 @@ class SSBinCoverageFiller: public SequenceMapperListener {
 private:
     SSCoverageSplitter& storage_;
 
-    std::vector<SSCoverageSplitter> tmp_storages_;
+    std::vector<SSCoverageSplitter::LocalBins> tmp_storages_;
 
     void ProcessRange(size_t thread_index, const omnigraph::MappingPath<EdgeId>& read) {
         for (size_t i = 0; i < read.size(); ++i) {
@@ -89,15 +89,15 @@ public:
     void StartProcessLibrary(size_t threads_count) override {
         tmp_storages_.clear();
 
-        for (size_t i = 0; i < threads_count; ++i) {
-            tmp_storages_.emplace_back(storage_.g(), storage_.bin_size(), storage_.min_edge_len(),
-                storage_.min_edge_coverage(), storage_.coverage_margin(), storage_.min_flanking_coverage());
-        }
+        tmp_storages_.reserve(threads_count);
+        for (size_t i = 0; i < threads_count; ++i)
+            tmp_storages_.emplace_back(storage_);
     }
 
     void StopProcessLibrary() override {
-        for (auto& storage : tmp_storages_)
-            storage.Clear();
+        for (const auto &tmp_storage : tmp_storages_)
+            storage_.MergeOther(tmp_storage);
+        tmp_storages_.clear();
     }
 
     void ProcessSingleRead(size_t thread_index, const io::SingleRead& /* r */, const omnigraph::MappingPath<EdgeId>& read) override {
@@ -108,10 +108,6 @@ public:
         ProcessRange(thread_index, read);
     }
 
-    void MergeBuffer(size_t thread_index) override {
-        storage_.MergeOther(tmp_storages_[thread_index]);
-        tmp_storages_[thread_index].Clear();
-    }
 };
 
 }
@@ -1,4 +1,3 @@
-
 //***************************************************************************
 //* Copyright (c) 2023-2024 SPAdes team
 //* All Rights Reserved
@@ -10,81 +9,69 @@
 //
 
 #include "connected_component.hpp"
+#include "graph_analytics.hpp"
+
 #include <algorithm>
-#include <map>
-#include <stack>
-#include <vector>
-#include <set>
-#include <unordered_set>
+#include <iterator>
+#include <numeric>
 
 namespace debruijn_graph {
 
 void ConnectedComponentCounter::CalculateComponents() const {
-    std::map<EdgeId, size_t> component_ids;
-    std::vector<std::pair<size_t, size_t>> to_sort;
-    std::map<size_t, size_t> comp_size;
-    size_t cur_id = 0;
-    for (EdgeId e : g_.edges()) {
-        if (component_ids.find(e) != component_ids.end())
-            continue;
-        
-        std::unordered_set <EdgeId> next;
-        next.insert(e);
-        std::set<EdgeId> used;
-        size_t ans = 0;
-        while (!next.empty()) {
-            auto cur = *next.begin();
-            next.erase(next.begin());
-            if (used.find(cur) != used.end())
-                continue;
-
-            ans += g_.length(cur);
-            used.insert(cur);
-            std::vector<EdgeId> neighbours;
-            neighbours.push_back(g_.conjugate(cur));
-            auto start = g_.EdgeStart(cur);
-            auto tmp = g_.IncidentEdges(start);
+    omnigraph::ConnectedComponents<Graph> components(g_);
+    components.Calculate(/*join_conjugate*/ true);
 
-            neighbours.insert(neighbours.end(), tmp.begin(), tmp.end());
-            auto end = g_.EdgeEnd(cur);
-            tmp = g_.IncidentEdges(end);
-            neighbours.insert(neighbours.end(), tmp.begin(), tmp.end());
-            for (auto ee:neighbours) {
-                if (used.find(ee) == used.end()) {
-                    next.insert(ee);
-                }
-            }
+    // Number the components with edges in the order of their discovery along the edges
+    std::vector<size_t> discovered(components.size(), omnigraph::ConnectedComponents<Graph>::kNoComponent);
+    std::vector<size_t> discovery_order;
+    for (EdgeId e : g_.edges()) {
+        size_t c = components.component(e);
+        if (discovered[c] == omnigraph::ConnectedComponents<Graph>::kNoComponent) {
+            discovered[c] = discovery_order.size();
+            discovery_order.push_back(c);
         }
-        
-        for (auto edge: used)
-            component_ids[edge] = cur_id;
-
-        to_sort.push_back(std::make_pair(ans, cur_id));
-        comp_size[cur_id] = ans;
-        cur_id ++;
-    }
-    
-    //TODO: sort in descending order
-    std::sort(to_sort.begin(), to_sort.end());
-    std::reverse(to_sort.begin(), to_sort.end());
-    std::vector<size_t> perm(to_sort.size());
-    for (size_t i = 0; i < to_sort.size(); i++) {
-        perm[to_sort[i].second] = i;
-        component_total_len_[i] = comp_size[to_sort[i].second];
     }
-    for (auto pair:component_ids) {
-        component_ids_[pair.first] = perm[pair.second];
-        component_edges_quantity_[perm[pair.second]]++;
+
+    // Longer components go first, the ties are broken in the reverse order of discovery
+    std::vector<size_t> perm(discovery_order.size());
+    std::iota(perm.begin(), perm.end(), 0);
+    std::sort(perm.begin(), perm.end(), [&](size_t a, size_t b) {
+        size_t len_a = components.length(discovery_order[a]), len_b = components.length(discovery_order[b]);
+        return len_a != len_b ? len_a > len_b : a > b;
+    });
+
+    component_edges_quantity_.assign(perm.size(), 0);
+    component_total_len_.assign(perm.size(), 0);
+    std::vector<size_t> new_ids(components.size());
+    for (size_t i = 0; i < perm.size(); i++) {
+        size_t c = discovery_order[perm[i]];
+        new_ids[c] = i;
+        auto edges = components.edges(c);
+        component_edges_quantity_[i] = size_t(std::distance(edges.begin(), edges.end()));
+        component_total_len_[i] = components.length(c);
     }
-    return;
+
+    component_ids_.assign(g_.max_eid(), omnigraph::ConnectedComponents<Graph>::kNoComponent);
+    for (EdgeId e : g_.edges())
+        component_ids_[e.int_id()] = new_ids[components.component(e)];
+    filled_ = true;
 }
 
 size_t ConnectedComponentCounter::GetComponent(EdgeId e) const {
-    if (component_ids_.size() == 0) {
-        CalculateComponents();
-    }
-    return component_ids_.at(e);
+    std::call_once(calculated_, [this] { CalculateComponents(); });
+    VERIFY(e.int_id() < component_ids_.size() &&
+           component_ids_[e.int_id()] != omnigraph::ConnectedComponents<Graph>::kNoComponent);
+    return component_ids_[e.int_id()];
 }
 
+size_t ConnectedComponentCounter::ComponentEdgesQuantity(size_t component) const {
+    std::call_once(calculated_, [this] { CalculateComponents(); });
+    return component_edges_quantity_.at(component);
+}
+
+size_t ConnectedComponentCounter::ComponentTotalLength(size_t component) const {
+    std::call_once(calculated_, [this] { CalculateComponents(); });
+    return component_total_len_.at(component);
+}
 
 }
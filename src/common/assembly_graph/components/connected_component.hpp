@@ -1,4 +1,3 @@
-
 //***************************************************************************
 //* Copyright (c) 2023-2024 SPAdes team
 //* All Rights Reserved
@@ -10,21 +9,32 @@
 //
 #pragma once
 #include "assembly_graph/core/graph.hpp"
-#include <map>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
 
 namespace debruijn_graph {
 
+// Components of the graph (together with the conjugate edges) numbered in the order of
+// decreasing total length. Calculated lazily on the first query.
 class ConnectedComponentCounter {
 public:
-    mutable std::map<EdgeId, size_t> component_ids_;
-    mutable std::map<size_t, size_t> component_edges_quantity_;
-    mutable std::map<size_t, size_t> component_total_len_;
     const Graph &g_;
-    ConnectedComponentCounter(const Graph &g):g_(g) {}
+    ConnectedComponentCounter(const Graph &g):g_(g), filled_(false) {}
     void CalculateComponents() const;
     size_t GetComponent(EdgeId e) const;
+    size_t ComponentEdgesQuantity(size_t component) const;
+    size_t ComponentTotalLength(size_t component) const;
     bool IsFilled() const {
-        return (component_ids_.size() != 0);
+        return filled_;
     }
+
+private:
+    mutable std::once_flag calculated_;
+    mutable std::atomic<bool> filled_;
+    mutable std::vector<size_t> component_ids_;
+    mutable std::vector<size_t> component_edges_quantity_;
+    mutable std::vector<size_t> component_total_len_;
 };
 }
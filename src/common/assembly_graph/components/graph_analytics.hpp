@@ -0,0 +1,267 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "adt/concurrent_dsu.hpp"
+#include "adt/iterator_range.hpp"
+#include "utils/parallel/openmp_wrapper.h"
+#include "utils/verify.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace omnigraph {
+
+/**
+ * @brief Connected components of the graph computed via the concurrent union-find.
+ * @detail Vertices are united along the edges satisfying the predicate (regardless of their
+ *         direction) and, optionally, with their conjugates. The union is done in parallel over
+ *         the vertices, afterwards the components are numbered in the order of the vertex
+ *         iteration and both vertices and edges of each component are stored contiguously.
+ *         All the tables are indexed by the ids, so the results refer to the graph at the
+ *         moment of Calculate() and are not updated on graph modifications.
+ */
+template<class Graph>
+class ConnectedComponents {
+    typedef typename Graph::VertexId VertexId;
+    typedef typename Graph::EdgeId EdgeId;
+
+  public:
+    static constexpr size_t kNoComponent = size_t(-1);
+
+    typedef adt::iterator_range<typename std::vector<VertexId>::const_iterator> VertexRange;
+    typedef adt::iterator_range<typename std::vector<EdgeId>::const_iterator> EdgeRange;
+
+    explicit ConnectedComponents(const Graph &g)
+            : g_(g) {}
+
+    /// @param edge_predicate is called concurrently
+    template<class EdgePredicate>
+    void Calculate(bool join_conjugate, EdgePredicate edge_predicate) {
+        std::vector<VertexId> vertices(g_.begin(), g_.end());
+
+        dsu::ConcurrentDSU dsu(g_.max_vid());
+#       pragma omp parallel for schedule(guided)
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            VertexId v = vertices[i];
+            if (join_conjugate)
+                dsu.unite(v.int_id(), g_.conjugate(v).int_id());
+            for (EdgeId e : g_.OutgoingEdges(v)) {
+                if (edge_predicate(e))
+                    dsu.unite(v.int_id(), g_.EdgeEnd(e).int_id());
+            }
+        }
+
+        std::vector<size_t> roots(vertices.size());
+#       pragma omp parallel for
+        for (size_t i = 0; i < vertices.size(); ++i)
+            roots[i] = dsu.find_set(vertices[i].int_id());
+
+        // Number the components by their first vertex
+        std::vector<size_t> root_component(g_.max_vid(), kNoComponent);
+        vertex_component_.assign(g_.max_vid(), kNoComponent);
+        std::vector<size_t> vertex_counts;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            size_t &c = root_component[roots[i]];
+            if (c == kNoComponent) {
+                c = vertex_counts.size();
+                vertex_counts.push_back(0);
+            }
+            vertex_component_[vertices[i].int_id()] = c;
+            vertex_counts[c] += 1;
+        }
+
+        edge_component_.assign(g_.max_eid(), kNoComponent);
+#       pragma omp parallel for schedule(guided)
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            VertexId v = vertices[i];
+            for (EdgeId e : g_.OutgoingEdges(v)) {
+                if (edge_predicate(e))
+                    edge_component_[e.int_id()] = vertex_component_[v.int_id()];
+            }
+        }
+
+        size_t ncomponents = vertex_counts.size();
+        std::vector<size_t> edge_counts(ncomponents, 0);
+        lengths_.assign(ncomponents, 0);
+        for (VertexId v : vertices) {
+            for (EdgeId e : g_.OutgoingEdges(v)) {
+                size_t c = edge_component_[e.int_id()];
+                if (c == kNoComponent)
+                    continue;
+                edge_counts[c] += 1;
+                lengths_[c] += g_.length(e);
+            }
+        }
+
+        Fill(vertex_offsets_, vertex_counts);
+        Fill(edge_offsets_, edge_counts);
+        vertices_.resize(vertices.size());
+        edges_.resize(edge_offsets_.back());
+        for (VertexId v : vertices) {
+            size_t c = vertex_component_[v.int_id()];
+            vertices_[vertex_counts[c]++] = v;
+            for (EdgeId e : g_.OutgoingEdges(v)) {
+                if (edge_component_[e.int_id()] == c)
+                    edges_[edge_counts[c]++] = e;
+            }
+        }
+    }
+
+    void Calculate(bool join_conjugate = false) {
+        Calculate(join_conjugate, [](EdgeId) { return true; });
+    }
+
+    size_t size() const { return lengths_.size(); }
+
+    /// Component of the vertex or kNoComponent if it was added after the calculation
+    size_t component(VertexId v) const {
+        return v.int_id() < vertex_component_.size() ? vertex_component_[v.int_id()] : kNoComponent;
+    }
+
+    /// Component of the edge or kNoComponent if it does not satisfy the predicate
+    /// or was added after the calculation
+    size_t component(EdgeId e) const {
+        return e.int_id() < edge_component_.size() ? edge_component_[e.int_id()] : kNoComponent;
+    }
+
+    VertexRange vertices(size_t c) const {
+        VERIFY(c < size());
+        return adt::make_range(vertices_.begin() + vertex_offsets_[c], vertices_.begin() + vertex_offsets_[c + 1]);
+    }
+
+    EdgeRange edges(size_t c) const {
+        VERIFY(c < size());
+        return adt::make_range(edges_.begin() + edge_offsets_[c], edges_.begin() + edge_offsets_[c + 1]);
+    }
+
+    /// Total length of the edges of the component
+    size_t length(size_t c) const {
+        VERIFY(c < size());
+        return lengths_[c];
+    }
+
+  private:
+    // Turns the counts into the offsets and the counts themselves into the fill positions
+    static void Fill(std::vector<size_t> &offsets, std::vector<size_t> &counts) {
+        offsets.assign(counts.size() + 1, 0);
+        for (size_t c = 0; c < counts.size(); ++c) {
+            offsets[c + 1] = offsets[c] + counts[c];
+            counts[c] = offsets[c];
+        }
+    }
+
+    const Graph &g_;
+
+    std::vector<size_t> vertex_component_;
+    std::vector<size_t> edge_component_;
+    std::vector<size_t> vertex_offsets_;
+    std::vector<VertexId> vertices_;
+    std::vector<size_t> edge_offsets_;
+    std::vector<EdgeId> edges_;
+    std::vector<size_t> lengths_;
+};
+
+/**
+ * @brief Bounded-radius neighbourhoods of the vertices.
+ * @detail Neighbourhood consists of the vertices reachable from the sources within the given
+ *         number of steps along the edges not longer than the bound (in any direction). Visited
+ *         vertices are marked with the query number, so the marks are reused between the
+ *         queries without clearing and the cost of a query is proportional to the size of the
+ *         neighbourhood. A single extractor must not be used concurrently.
+ */
+template<class Graph>
+class NeighbourhoodExtractor {
+    typedef typename Graph::VertexId VertexId;
+    typedef typename Graph::EdgeId EdgeId;
+
+  public:
+    explicit NeighbourhoodExtractor(const Graph &g,
+                                    size_t edge_length_bound = size_t(-1),
+                                    size_t max_size = size_t(-1))
+            : g_(g), edge_length_bound_(edge_length_bound), max_size_(max_size), query_(0) {}
+
+    /// @return vertices in the order of their discovery, sources first
+    template<class It>
+    std::vector<VertexId> Extract(It begin, It end, size_t radius) {
+        NextQuery();
+
+        std::vector<VertexId> result;
+        for (; begin != end && result.size() < max_size_; ++begin) {
+            if (Visit(*begin))
+                result.push_back(*begin);
+        }
+
+        // Vertices of the current layer occupy [layer_begin, layer_end) of the result
+        size_t layer_begin = 0, layer_end = result.size();
+        for (size_t layer = 0; layer < radius && layer_begin < layer_end; ++layer) {
+            for (size_t i = layer_begin; i < layer_end && result.size() < max_size_; ++i) {
+                VertexId v = result[i];
+                for (EdgeId edge : g_.OutgoingEdges(v))
+                    Relax(edge, g_.EdgeEnd(edge), result);
+                for (EdgeId edge : g_.IncomingEdges(v))
+                    Relax(edge, g_.EdgeStart(edge), result);
+            }
+            layer_begin = layer_end;
+            layer_end = result.size();
+        }
+        return result;
+    }
+
+    std::vector<VertexId> Extract(VertexId v, size_t radius) {
+        return Extract(&v, &v + 1, radius);
+    }
+
+  private:
+    void NextQuery() {
+        if (marks_.size() < g_.max_vid())
+            marks_.resize(g_.max_vid(), 0);
+        if (++query_ == 0) {
+            std::fill(marks_.begin(), marks_.end(), 0);
+            query_ = 1;
+        }
+    }
+
+    bool Visit(VertexId v) {
+        uint32_t &mark = marks_[v.int_id()];
+        if (mark == query_)
+            return false;
+        mark = query_;
+        return true;
+    }
+
+    void Relax(EdgeId edge, VertexId u, std::vector<VertexId> &result) {
+        if (result.size() < max_size_ && g_.length(edge) <= edge_length_bound_ && Visit(u))
+            result.push_back(u);
+    }
+
+    const Graph &g_;
+    size_t edge_length_bound_;
+    size_t max_size_;
+
+    std::vector<uint32_t> marks_;
+    uint32_t query_;
+};
+
+/// Neighbourhoods of the vertices computed in parallel, one query per vertex
+template<class Graph>
+std::vector<std::vector<typename Graph::VertexId>>
+ExtractNeighbourhoods(const Graph &g, const std::vector<typename Graph::VertexId> &sources, size_t radius,
+                      size_t edge_length_bound = size_t(-1), size_t max_size = size_t(-1)) {
+    std::vector<std::vector<typename Graph::VertexId>> result(sources.size());
+#   pragma omp parallel
+    {
+        NeighbourhoodExtractor<Graph> extractor(g, edge_length_bound, max_size);
+#       pragma omp for schedule(dynamic, 16)
+        for (size_t i = 0; i < sources.size(); ++i)
+            result[i] = extractor.Extract(sources[i], radius);
+    }
+    return result;
+}
+
+}
@@ -11,6 +11,7 @@
 #include "graph_component.hpp"
 #include "assembly_graph/dijkstra/dijkstra_helper.hpp"
 #include "component_filters.hpp"
+#include "graph_analytics.hpp"
 
 namespace omnigraph {
 
@@ -408,27 +409,6 @@ private:
     typedef typename Graph::VertexId VertexId;
     typedef typename Graph::EdgeId EdgeId;
 
-    std::set<VertexId> FindNeighbours(const std::set<VertexId> &s) const {
-        std::set<VertexId> result(s.begin(), s.end());
-        for (VertexId v : result) {
-            for (EdgeId e : this->graph().IncidentEdges(v)) {
-                if (this->graph().length(e) <= edge_length_bound_) {
-                    result.insert(this->graph().EdgeEnd(e));
-                    result.insert(this->graph().EdgeStart(e));
-                }
-            }
-        }
-        return result;
-    }
-
-    std::set<VertexId> FindNeighbours(const std::set<VertexId> &s, size_t eps) const {
-        std::set<VertexId> result = s;
-        for (size_t i = 0; i < eps; i++) {
-            result = FindNeighbours(result);
-        }
-        return result;
-    }
-
     std::set<VertexId> FindBorder(const GraphComponent<Graph> &component) const {
         std::set<VertexId> result;
         utils::insert_all(result, component.entrances());
@@ -443,12 +423,18 @@ public:
     const size_t edge_length_bound_;
     const size_t max_size_;
 
+private:
+    // Marks are reused by the consecutive components of the splitter
+    mutable NeighbourhoodExtractor<Graph> neighbourhood_extractor_;
+
+public:
     ReliableNeighbourhoodFinder(const Graph &graph, size_t edge_length_bound =
                                         DEFAULT_EDGE_LENGTH_BOUND,
                                 size_t max_size = DEFAULT_MAX_SIZE)
             : AbstractNeighbourhoodFinder<Graph>(graph),
               edge_length_bound_(edge_length_bound),
-              max_size_(max_size) {
+              max_size_(max_size),
+              neighbourhood_extractor_(graph, edge_length_bound) {
     }
 
     GraphComponent<Graph> Find(typename Graph::VertexId v) const {
@@ -463,7 +449,9 @@ public:
     }
 
     std::vector<VertexId> InnerVertices(const GraphComponent<Graph> &component) const {
-        std::set<VertexId> border = FindNeighbours(FindBorder(component), 2);
+        std::set<VertexId> sources = FindBorder(component);
+        auto neighbourhood = neighbourhood_extractor_.Extract(sources.begin(), sources.end(), 2);
+        std::set<VertexId> border(neighbourhood.begin(), neighbourhood.end());
         std::vector<VertexId> result;
         std::set_difference(component.vertices().begin(), component.vertices().end(),
                             border.begin(), border.end(),
@@ -13,6 +13,7 @@
 #include "utils/parallel/openmp_wrapper.h"
 #include "utils/parallel/parallel_wrapper.hpp"
 #include <numeric>
+#include <unordered_set>
 
 namespace debruijn_graph {
 
@@ -422,7 +423,7 @@ private:
     typedef RtSeq Kmer;
     typedef kmers::DeBruijnExtensionIndex<> Index;
     size_t kmer_size_;
-    Index &origin_;
+    Index *origin_;
 
     class LinkRecord {
     private:
@@ -457,22 +458,79 @@ private:
         }
     };
 
+    // Without the index vertices are keyed by the k-mer hash, the collisions
+    // are resolved by SeparateCollisions(). The keys are kept below the one of
+    // the invalid record.
+    static constexpr uint64_t KeyMask = (1ull << 61) - 1;
+
+    uint64_t VertexKey(const Kmer &kmer) const {
+        if (origin_)
+            return origin_->ConstructKWH(kmer).idx();
+        return kmer.GetHash() & KeyMask;
+    }
+
     LinkRecord StartLink(const EdgeId &edge, const Sequence &sequence) const {
         Kmer kmer(kmer_size_, sequence);
         Kmer kmer_rc = !kmer;
         if (kmer < kmer_rc)
-            return LinkRecord(origin_.ConstructKWH(kmer).idx(), edge, true, false);
+            return LinkRecord(VertexKey(kmer), edge, true, false);
         else
-            return LinkRecord(origin_.ConstructKWH(kmer_rc).idx(), edge, true, true);
+            return LinkRecord(VertexKey(kmer_rc), edge, true, true);
     }
 
     LinkRecord EndLink(const EdgeId &edge, const Sequence &sequence) const {
         Kmer kmer(kmer_size_, sequence, sequence.size() - kmer_size_);
         Kmer kmer_rc = !kmer;
         if (kmer < kmer_rc)
-            return LinkRecord(origin_.ConstructKWH(kmer).idx(), edge, false, false);
+            return LinkRecord(VertexKey(kmer), edge, false, false);
         else
-            return LinkRecord(origin_.ConstructKWH(kmer_rc).idx(), edge, false, true);
+            return LinkRecord(VertexKey(kmer_rc), edge, false, true);
+    }
+
+    // Canonical vertex k-mer the record refers to
+    Kmer RecordKMer(const Graph &graph, const LinkRecord &record) const {
+        const Sequence &nucls = graph.EdgeNucls(record.GetEdge());
+        Kmer kmer = record.IsStart() ? Kmer(kmer_size_, nucls) : Kmer(kmer_size_, nucls, nucls.size() - kmer_size_);
+        return record.IsRC() ? !kmer : kmer;
+    }
+
+    // Gives distinct unused keys to the different k-mers sharing the hash. Returns
+    // true if some records were changed, so the records need to be sorted again.
+    bool SeparateCollisions(const Graph &graph, std::vector<LinkRecord> &records) const {
+        auto has_key = [&records](uint64_t key) {
+            auto it = std::lower_bound(records.begin(), records.end(), key,
+                                       [](const LinkRecord &r, uint64_t k) { return r.GetHash() < k; });
+            return it != records.end() && it->GetHash() == key;
+        };
+
+        std::unordered_set<uint64_t> used;
+        bool changed = false;
+        for (size_t i = 0, j = 0; i < records.size(); i = j) {
+            for (j = i + 1; j < records.size() && records[j].GetHash() == records[i].GetHash(); ++j) {}
+            if (j - i == 1 || records[i].IsInvalid())
+                continue;
+
+            std::vector<std::pair<Kmer, uint64_t>> keys = {{ RecordKMer(graph, records[i]), records[i].GetHash() }};
+            for (size_t r = i + 1; r < j; ++r) {
+                Kmer kmer = RecordKMer(graph, records[r]);
+                auto it = std::find_if(keys.begin(), keys.end(),
+                                       [&kmer](const auto &entry) { return entry.first == kmer; });
+                if (it == keys.end()) {
+                    uint64_t key = (records[i].GetHash() + 1) & KeyMask;
+                    while (has_key(key) || used.count(key))
+                        key = (key + 1) & KeyMask;
+                    used.insert(key);
+                    it = keys.emplace(keys.end(), kmer, key);
+                    TRACE("Hash collision of vertex k-mers " << keys.front().first << " and " << kmer);
+                }
+                if (it->second != records[r].GetHash()) {
+                    records[r] = LinkRecord(it->second, records[r].GetEdge(), records[r].IsStart(), records[r].IsRC());
+                    changed = true;
+                }
+            }
+        }
+
+        return changed;
     }
 
     void CollectLinkRecords(typename Graph::HelperT &helper, const Graph &graph,
@@ -506,7 +564,11 @@ private:
 
 public:
     FastGraphFromSequencesConstructor(size_t k, Index &origin)
-            : kmer_size_(k), origin_(origin) {}
+            : kmer_size_(k), origin_(&origin) {}
+
+    /// Vertices are identified by the k-mers themselves, no index is required
+    explicit FastGraphFromSequencesConstructor(size_t k)
+            : kmer_size_(k), origin_(nullptr) {}
 
     void ConstructGraph(Graph &graph, const std::vector<Sequence> &sequences) const {
         typename Graph::HelperT helper = graph.GetConstructionHelper();
@@ -521,6 +583,8 @@ public:
         INFO("Ordering link records")
         // We sort by Vertex and then by EdgeID and RC/Start mask in order to combine together records accociated with the same vertex with a special order in each group
         parallel::sort(records.begin(), records.end(), LinkRecord::CompareByVertexKMerEdgeIdAndMask);
+        if (!origin_ && SeparateCollisions(graph, records))
+            parallel::sort(records.begin(), records.end(), LinkRecord::CompareByVertexKMerEdgeIdAndMask);
         INFO("Sorting done");
 
         // Now we extract starting positions of each vertex group
@@ -0,0 +1,701 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "debruijn_graph_constructor.hpp"
+
+#include "adt/lemiere_mod_reduce.hpp"
+#include "kmer_index/extension_index/inout_mask.hpp"
+#include "kmer_index/kmer_mph/kmer_index_builder.hpp"
+#include "sequence/kmer_width.hpp"
+#include "sequence/sequence.hpp"
+#include "utils/filesystem/temporary.hpp"
+#include "utils/logger/logger.hpp"
+#include "utils/memory_limit.hpp"
+#include "utils/parallel/openmp_wrapper.h"
+#include "utils/parallel/parallel_wrapper.hpp"
+#include "utils/verify.hpp"
+
+#include <parallel_hashmap/phmap.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+namespace debruijn_graph {
+
+namespace superkmer {
+
+/// Mixes the bits of the packed l-mer (MurmurHash3 finalizer), so the minimizers
+/// are not biased towards the poly-A l-mers
+inline uint64_t MixHash(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key;
+}
+
+/**
+ * @brief Computes minimizers of all k-mers of a nucleotide sequence.
+ * @detail The minimizer of a k-mer is the minimal hash over its canonical l-mers,
+ *         so a k-mer and its reverse complement share the minimizer.
+ */
+class MinimizerScanner {
+  public:
+    MinimizerScanner(unsigned k, unsigned l)
+            : k_(k), l_(std::min(k, l)) {
+        VERIFY(l_ > 0 && l_ <= 32);
+    }
+
+    /// Fills res[i] with the minimizer of the k-mer starting at the position i
+    template<class Codes>
+    void Scan(const Codes &codes, size_t size, std::vector<uint64_t> &res) {
+        res.clear();
+        window_.clear();
+        if (size < k_)
+            return;
+
+        const size_t width = k_ - l_ + 1;
+        const uint64_t mask = l_ == 32 ? uint64_t(-1) : (uint64_t(1) << (2 * l_)) - 1;
+        const unsigned shift = 2 * (l_ - 1);
+        uint64_t fwd = 0, rev = 0;
+        for (size_t i = 0; i < size; ++i) {
+            uint64_t c = uint64_t(codes[i]);
+            fwd = ((fwd << 2) | c) & mask;
+            rev = (rev >> 2) | ((3 - c) << shift);
+            if (i + 1 < l_)
+                continue;
+
+            size_t pos = i + 1 - l_;
+            uint64_t hash = MixHash(std::min(fwd, rev));
+            while (!window_.empty() && window_.back().second >= hash)
+                window_.pop_back();
+            window_.emplace_back(pos, hash);
+            if (pos + 1 < width)
+                continue;
+
+            while (window_.front().first + width <= pos)
+                window_.pop_front();
+            res.push_back(window_.front().second);
+        }
+    }
+
+  private:
+    unsigned k_;
+    unsigned l_;
+    std::deque<std::pair<size_t, uint64_t>> window_;
+};
+
+// Super-k-mer record: 32-bit header with the length and the flank flags followed by
+// the nucleotides packed 4 per byte
+static const uint32_t LeftFlank = 1u << 31;
+static const uint32_t RightFlank = 1u << 30;
+static const uint32_t LengthMask = RightFlank - 1;
+
+/// Appends super-k-mer record for the vertices [0, size - k] of codes; the flanking vertices
+/// are owned by other buckets. Returns the size of the record.
+inline size_t AppendSuperKMer(std::string &buffer, const char *codes, size_t size,
+                              bool left_flank, bool right_flank) {
+    VERIFY_MSG(size <= LengthMask, "Too long super-k-mer: " << size);
+    uint32_t header = uint32_t(size) | (left_flank ? LeftFlank : 0) | (right_flank ? RightFlank : 0);
+    buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    size_t start = buffer.size(), bytes = (size + 3) / 4;
+    buffer.resize(start + bytes, '\0');
+    for (size_t i = 0; i < size; ++i)
+        buffer[start + i / 4] = char(buffer[start + i / 4] | (codes[i] << (2 * (i % 4))));
+
+    return sizeof(header) + bytes;
+}
+
+/// Part of a unitig, which ends at the vertices owned by other buckets are open
+struct Piece {
+    Sequence seq;
+    bool left_open;
+    bool right_open;
+};
+
+/// Unitigs produced by the compaction of a single bucket
+struct BucketUnitigs {
+    std::vector<Sequence> unitigs;
+    std::vector<Sequence> loops;
+    std::vector<Piece> pieces;
+};
+
+/**
+ * @brief Unitig compaction of a single minimizer bucket.
+ * @detail Every vertex (k-mer) is owned by the bucket of its minimizer. The super-k-mers
+ *         of the bucket contain all the edges (k+1-mers) incident to the owned vertices,
+ *         so the extension masks of the owned vertices are complete. The maximal paths
+ *         through the owned non-junction vertices are compacted here; the paths leaving
+ *         the owned vertices are open pieces, which are stitched afterwards by their
+ *         boundary edges.
+ */
+template<class KMer>
+class BucketCompactor {
+    struct VertexInfo {
+        kmers::InOutMask mask;
+        bool visited = false;
+    };
+    typedef phmap::flat_hash_map<KMer, VertexInfo, typename KMer::hash> VertexMap;
+
+    enum class PathEnd { Junction, Open, Loop };
+
+  public:
+    explicit BucketCompactor(unsigned k)
+            : k_(k) {}
+
+    /// Compacts the super-k-mers of the bucket. Canonical edges starting at the owned
+    /// vertices are written to the edges file in the raw k+1-mer format.
+    void Compact(const std::filesystem::path &superkmers, const std::filesystem::path &edges,
+                 BucketUnitigs &res) {
+        vertices_.clear();
+        CollectVertices(superkmers);
+        WriteEdges(edges);
+        CollectPaths(res);
+        CollectJunctionEdges(res);
+        VertexMap().swap(vertices_);
+    }
+
+  private:
+    void CollectVertices(const std::filesystem::path &superkmers) {
+        std::ifstream ifs(superkmers, std::ios::binary);
+        CHECK_FATAL_ERROR(ifs, "Failed to open " << superkmers);
+        std::vector<char> data(std::filesystem::file_size(superkmers));
+        ifs.read(data.data(), std::streamsize(data.size()));
+        CHECK_FATAL_ERROR(ifs, "Failed to read " << superkmers);
+
+        std::vector<char> codes;
+        for (size_t pos = 0; pos < data.size(); ) {
+            uint32_t header;
+            memcpy(&header, data.data() + pos, sizeof(header));
+            pos += sizeof(header);
+
+            size_t size = header & LengthMask;
+            codes.resize(size);
+            for (size_t i = 0; i < size; ++i)
+                codes[i] = char((data[pos + i / 4] >> (2 * (i % 4))) & 3);
+            pos += (size + 3) / 4;
+
+            AddSuperKMer(codes, (header & LeftFlank) != 0, (header & RightFlank) != 0);
+        }
+    }
+
+    void AddSuperKMer(const std::vector<char> &codes, bool left_flank, bool right_flank) {
+        size_t nvertices = codes.size() - k_ + 1;
+        size_t first = left_flank ? 1 : 0, last = nvertices - (right_flank ? 1 : 0);
+
+        KMer kmer(k_, codes), rc = !kmer;
+        for (size_t i = 0; i < nvertices; ++i) {
+            if (i) {
+                kmer <<= codes[i + k_ - 1];
+                rc >>= complement(codes[i + k_ - 1]);
+            }
+            if (i < first || i >= last)
+                continue;
+
+            bool minimal = kmer.IsMinimal();
+            kmers::InOutMask &mask = vertices_[minimal ? kmer : rc].mask;
+            if (i > 0)
+                mask.AddIncoming(codes[i - 1], minimal);
+            if (i + 1 < nvertices)
+                mask.AddOutgoing(codes[i + k_], minimal);
+        }
+    }
+
+    // Returns the entry of the owned vertex and its mask in the given orientation
+    VertexInfo *Find(const KMer &kmer, kmers::InOutMask &mask) {
+        bool minimal = kmer.IsMinimal();
+        auto it = vertices_.find(minimal ? kmer : !kmer);
+        if (it == vertices_.end())
+            return nullptr;
+
+        mask = minimal ? it->second.mask : it->second.mask.conjugate(kmer);
+        return &it->second;
+    }
+
+    // Both orientations of the canonical vertex (the single one for the self-complementary vertex)
+    template<class F>
+    void ForEachOrientation(const KMer &kmer, kmers::InOutMask mask, F &&f) const {
+        f(kmer, mask);
+        KMer rc = !kmer;
+        if (rc != kmer)
+            f(rc, mask.conjugate(kmer));
+    }
+
+    void WriteEdges(const std::filesystem::path &edges) const {
+        FILE *f = fopen(edges.c_str(), "wb");
+        if (!f)
+            FATAL_ERROR("Cannot open temporary file " << edges << " for writing");
+        const size_t words = KMer::GetDataSize(k_ + 1);
+        for (const auto &entry : vertices_) {
+            ForEachOrientation(entry.first, entry.second.mask, [&](const KMer &kmer, kmers::InOutMask mask) {
+                for (char c = 0; c < 4; ++c) {
+                    if (!mask.CheckOutgoing(c))
+                        continue;
+                    KMer edge = kmer.pushBack(c);
+                    if (!edge.IsMinimal())
+                        continue;
+                    size_t res = fwrite(edge.data(), sizeof(typename KMer::DataType), words, f);
+                    if (res != words)
+                        FATAL_ERROR("I/O error! Incomplete write! Reason: " << strerror(errno) << ". Error code: " << errno);
+                }
+            });
+        }
+        fclose(f);
+    }
+
+    // Extends the path to the right of the non-junction vertex through the owned non-junction
+    // vertices. Appended nucleotides include the one of the edge leading to the final vertex.
+    PathEnd ExtendRight(const KMer &start, kmers::InOutMask mask, std::vector<char> &nucls) {
+        KMer kmer = start;
+        while (true) {
+            char c = mask.GetUniqueOutgoing();
+            nucls.push_back(c);
+            kmer <<= c;
+            if (kmer == start)
+                return PathEnd::Loop;
+
+            VertexInfo *info = Find(kmer, mask);
+            if (!info)
+                return PathEnd::Open;
+            if (mask.IsJunction())
+                return PathEnd::Junction;
+            info->visited = true;
+        }
+    }
+
+    void CollectPaths(BucketUnitigs &res) {
+        std::vector<char> left, right;
+        SequenceBuilder builder;
+        for (auto &entry : vertices_) {
+            if (entry.second.visited || entry.second.mask.IsJunction())
+                continue;
+            entry.second.visited = true;
+
+            const KMer &kmer = entry.first;
+            kmers::InOutMask mask = entry.second.mask;
+            right.clear();
+            builder.clear();
+            PathEnd right_end = ExtendRight(kmer, mask, right);
+            if (right_end == PathEnd::Loop) {
+                builder.append(kmer).append(right);
+                res.loops.push_back(builder.BuildSequence());
+                continue;
+            }
+
+            // Path to the left is the one to the right from the reverse complement
+            left.clear();
+            PathEnd left_end = ExtendRight(!kmer, mask.conjugate(kmer), left);
+            for (size_t i = left.size(); i > 0; --i)
+                builder.append(complement(left[i - 1]));
+            builder.append(kmer).append(right);
+
+            bool left_open = left_end == PathEnd::Open, right_open = right_end == PathEnd::Open;
+            if (left_open || right_open)
+                res.pieces.push_back({ builder.BuildSequence(), left_open, right_open });
+            else
+                res.unitigs.push_back(builder.BuildSequence());
+        }
+    }
+
+    // Single-edge unitigs between the junctions. The edges leading to the vertices of
+    // other buckets are open pieces, they are either continued by the path there or are
+    // single-edge unitigs themselves.
+    void CollectJunctionEdges(BucketUnitigs &res) {
+        for (const auto &entry : vertices_) {
+            if (!entry.second.mask.IsJunction())
+                continue;
+
+            ForEachOrientation(entry.first, entry.second.mask, [&](const KMer &kmer, kmers::InOutMask mask) {
+                for (char c = 0; c < 4; ++c) {
+                    if (!mask.CheckOutgoing(c))
+                        continue;
+
+                    KMer edge = kmer.pushBack(c);
+                    kmers::InOutMask next_mask;
+                    if (!Find(kmer << c, next_mask))
+                        res.pieces.push_back({ Sequence(edge, edge.size()), false, true });
+                    else if (next_mask.IsJunction() && edge.IsMinimal())
+                        res.unitigs.push_back(Sequence(edge, edge.size()));
+                }
+            });
+        }
+    }
+
+    unsigned k_;
+    VertexMap vertices_;
+};
+
+/**
+ * @brief Joins the open pieces of all buckets into unitigs and perfect loops.
+ * @detail Open end of a piece is identified by its outward edge: the last edge for the
+ *         right end and the reverse complement of the first one for the left end. The
+ *         continuation of the path is the piece having the reverse complement outward edge,
+ *         the two pieces overlap by this edge.
+ */
+template<class KMer>
+class PieceStitcher {
+    struct EndRecord {
+        KMer edge;
+        bool minimal;
+        size_t end;
+    };
+
+  public:
+    PieceStitcher(unsigned k, std::vector<Piece> &pieces)
+            : k_(k), pieces_(pieces) {
+        CollectRecords();
+    }
+
+    /// Unitigs starting at the closed ends of the pieces
+    void CollectUnitigs(std::vector<Sequence> &res) {
+        visited_.assign(pieces_.size(), false);
+        for (size_t i = 0; i < pieces_.size(); ++i) {
+            if (visited_[i] || (pieces_[i].left_open && pieces_[i].right_open))
+                continue;
+
+            res.push_back(Walk(pieces_[i].left_open ? 2 * i + 1 : 2 * i, false));
+        }
+    }
+
+    /// Perfect loops formed by the remaining pieces, the last k nucleotides repeat the first ones
+    void CollectLoops(std::vector<Sequence> &res) {
+        for (size_t i = 0; i < pieces_.size(); ++i) {
+            if (visited_[i])
+                continue;
+
+            Sequence loop = Walk(2 * i, true);
+            res.push_back(loop.Subseq(0, loop.size() - 1));
+        }
+    }
+
+  private:
+    // Ends are numbered as 2 * i for the left end of i-th piece and 2 * i + 1 for the right one
+    bool IsOpen(size_t end) const {
+        return end & 1 ? pieces_[end / 2].right_open : pieces_[end / 2].left_open;
+    }
+
+    // Piece oriented so that the given end is on the left
+    Sequence Oriented(size_t end) const {
+        const Sequence &seq = pieces_[end / 2].seq;
+        return end & 1 ? !seq : seq;
+    }
+
+    KMer OutwardEdge(size_t end) const {
+        const Sequence &seq = pieces_[end / 2].seq;
+        if (end & 1)
+            return KMer(k_ + 1, seq, seq.size() - k_ - 1);
+        return !KMer(k_ + 1, seq);
+    }
+
+    static bool Less(const EndRecord &r1, const EndRecord &r2) {
+        typename KMer::less3 less;
+        if (less(r1.edge, r2.edge))
+            return true;
+        if (less(r2.edge, r1.edge))
+            return false;
+        return std::make_pair(r1.minimal, r1.end) < std::make_pair(r2.minimal, r2.end);
+    }
+
+    void CollectRecords() {
+        record_of_end_.assign(2 * pieces_.size(), -1ull);
+        for (size_t end = 0; end < 2 * pieces_.size(); ++end) {
+            if (!IsOpen(end))
+                continue;
+            KMer edge = OutwardEdge(end);
+            bool minimal = edge.IsMinimal();
+            records_.push_back({ minimal ? edge : !edge, minimal, end });
+        }
+        parallel::sort(records_.begin(), records_.end(), Less);
+        for (size_t i = 0; i < records_.size(); ++i)
+            record_of_end_[records_[i].end] = i;
+    }
+
+    // The end of the piece continuing the path through the given open end. Ends of the
+    // self-complementary piece are equivalent, the left one is used.
+    size_t Partner(size_t end) const {
+        const EndRecord &record = records_[record_of_end_[end]];
+        EndRecord key = { record.edge, !record.minimal, 0 };
+        auto it = std::lower_bound(records_.begin(), records_.end(), key, Less);
+        CHECK_FATAL_ERROR(it != records_.end() && it->edge == record.edge && it->minimal != record.minimal,
+                          "No continuation of the path through " << record.edge);
+        return it->end;
+    }
+
+    // Joins the pieces starting from the given end until the closed end or, for the loop, the
+    // starting end is reached
+    Sequence Walk(size_t start, bool loop) {
+        SequenceBuilder builder;
+        builder.append(Oriented(start));
+        visited_[start / 2] = true;
+        size_t steps = 0;
+        for (size_t end = start ^ 1; IsOpen(end); ) {
+            ++steps;
+            CHECK_FATAL_ERROR(steps <= 2 * pieces_.size(), "Looped walk over the pieces starting from piece " << start / 2);
+            size_t next = Partner(end);
+            if (loop && next == start)
+                break;
+
+            visited_[next / 2] = true;
+            Sequence seq = Oriented(next);
+            for (size_t i = k_ + 1; i < seq.size(); ++i)
+                builder.append(seq[i]);
+            end = next ^ 1;
+        }
+        return builder.BuildSequence();
+    }
+
+    unsigned k_;
+    std::vector<Piece> &pieces_;
+    std::vector<EndRecord> records_;
+    std::vector<size_t> record_of_end_;
+    std::vector<bool> visited_;
+};
+
+}
+
+/**
+ * @brief Constructs the condensed de Bruijn graph from the super-k-mers of the reads.
+ * @detail Reads are split into super-k-mers (maximal runs of k-mers sharing the minimizer
+ *         bucket) which are written to the bucket files. Each bucket is compacted
+ *         independently in parallel using a small hash map of its vertices, so neither the
+ *         global k-mer index nor random access walks over it are needed. The unitig parts
+ *         crossing the buckets are stitched in the final pass and the graph is built by
+ *         FastGraphFromSequencesConstructor. The result is the same as the one of
+ *         DeBruijnGraphExtentionConstructor without the early tip clipping.
+ */
+template<class Graph>
+class SuperKMerGraphConstructor {
+  public:
+    SuperKMerGraphConstructor(Graph &graph, fs::TmpDir workdir, size_t read_buffer_size = 0,
+                              unsigned num_buckets = 256, unsigned minimizer_size = 15)
+            : graph_(graph), workdir_(workdir), k_(unsigned(graph.k())),
+              read_buffer_size_(read_buffer_size), num_buckets_(num_buckets),
+              minimizer_size_(minimizer_size) {}
+
+    /// Builds the graph and returns the canonical k+1-mers of the reads
+    template<class Streams>
+    kmers::KMerDiskStorage<RtSeq> ConstructGraph(Streams &streams, bool keep_perfect_loops) {
+        VERIFY_MSG(streams.size(), "No input streams specified");
+        unsigned nthreads = unsigned(streams.size());
+
+        kmers::KMerDiskStorage<RtSeq> edges(workdir_, k_ + 1, kmers::KMerDiskStorage<RtSeq>::KMerSegmentPolicy(1));
+        std::vector<Sequence> sequences = DispatchKMerWidth(k_ + 1, [&](auto width) {
+            return ExtractUnitigs<typename decltype(width)::type>(streams, edges, nthreads, keep_perfect_loops);
+        });
+
+        INFO("Sorting edges...");
+        parallel::sort(sequences.begin(), sequences.end(), Sequence::RawCompare);
+        INFO("Edges sorted");
+        FastGraphFromSequencesConstructor<Graph>(k_).ConstructGraph(graph_, sequences);
+
+        return edges;
+    }
+
+  private:
+    size_t Bucket(uint64_t minimizer) const {
+        return mod_reduce::multiply_high_u64(minimizer, num_buckets_);
+    }
+
+    void Flush(std::vector<std::string> &buffers) {
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            if (buffers[i].empty())
+                continue;
+
+            std::lock_guard<std::mutex> lock(locks_[i]);
+            FILE *f = fopen(superkmers_[i]->file().c_str(), "ab");
+            if (!f)
+                FATAL_ERROR("Cannot open temporary file " << superkmers_[i]->file() << " for writing");
+            size_t res = fwrite(buffers[i].data(), 1, buffers[i].size(), f);
+            if (res != buffers[i].size())
+                FATAL_ERROR("I/O error! Incomplete write! Reason: " << strerror(errno) << ". Error code: " << errno);
+            fclose(f);
+            buffers[i].clear();
+        }
+    }
+
+    template<class ReadStream>
+    size_t SplitStream(ReadStream &stream, size_t buffer_size) {
+        superkmer::MinimizerScanner scanner(k_, minimizer_size_);
+        std::vector<std::string> buffers(num_buckets_);
+        std::vector<char> codes;
+        std::vector<uint64_t> minimizers;
+        std::vector<size_t> buckets;
+        size_t buffered = 0, reads = 0;
+
+        typename ReadStream::ReadT r;
+        while (!stream.eof()) {
+            stream >> r;
+            reads += 1;
+
+            const Sequence &seq = r.sequence();
+            if (seq.size() < k_ + 1)
+                continue;
+
+            codes.resize(seq.size());
+            for (size_t i = 0; i < seq.size(); ++i)
+                codes[i] = seq[i];
+            scanner.Scan(codes, codes.size(), minimizers);
+            buckets.resize(minimizers.size());
+            for (size_t i = 0; i < minimizers.size(); ++i)
+                buckets[i] = Bucket(minimizers[i]);
+
+            // Each super-k-mer includes the vertices adjacent to its run of k-mers
+            size_t nvertices = buckets.size();
+            for (size_t start = 0, end; start < nvertices; start = end) {
+                for (end = start + 1; end < nvertices && buckets[end] == buckets[start]; ++end) {}
+                size_t first = start ? start - 1 : start, last = end < nvertices ? end : end - 1;
+                buffered += superkmer::AppendSuperKMer(buffers[buckets[start]],
+                                                       codes.data() + first, last - first + k_,
+                                                       first != start, last != end - 1);
+            }
+
+            if (buffered > buffer_size) {
+                Flush(buffers);
+                buffered = 0;
+            }
+        }
+        Flush(buffers);
+
+        return reads;
+    }
+
+    template<class Streams>
+    void Split(Streams &streams, unsigned nthreads) {
+        size_t buffer_size = read_buffer_size_;
+        if (buffer_size == 0) {
+            buffer_size = 536870912ull;
+            size_t mem_limit = (size_t)((double)(utils::get_free_memory()) / (nthreads * 3));
+            buffer_size = std::min(buffer_size, mem_limit);
+        }
+
+        auto prefix = workdir_->tmp_file("superkmers");
+        superkmers_.clear();
+        for (unsigned i = 0; i < num_buckets_; ++i) {
+            superkmers_.emplace_back(prefix->CreateDep(std::to_string(i)));
+            FILE *f = fopen(superkmers_.back()->file().c_str(), "wb");
+            if (!f)
+                FATAL_ERROR("Cannot open temporary file " << superkmers_.back()->file() << " for writing");
+            fclose(f);
+        }
+        locks_ = std::vector<std::mutex>(num_buckets_);
+
+        INFO("Splitting reads into super-k-mers, " << num_buckets_ << " buckets");
+        size_t reads = 0;
+        streams.reset();
+#       pragma omp parallel for num_threads(nthreads) schedule(dynamic) reduction(+ : reads)
+        for (size_t i = 0; i < streams.size(); ++i)
+            reads += SplitStream(streams[i], buffer_size);
+        INFO("Used " << reads << " reads");
+    }
+
+    // Canonical orientation of the perfect loop: it is rotated to start from the minimal k-mer
+    // and split at the first self-complementary edge as UnbranchingPathExtractor does
+    template<class KMer>
+    void AddLoop(const Sequence &loop, std::vector<Sequence> &res) const {
+        size_t len = loop.size() - k_;
+        Sequence loop_rc = !loop;
+        KMer best(k_, loop);
+        bool best_rc = false;
+        size_t best_pos = 0;
+        for (bool rc : { false, true }) {
+            const Sequence &s = rc ? loop_rc : loop;
+            KMer kmer(k_, s);
+            for (size_t i = 0; i < len; ++i) {
+                if (i)
+                    kmer <<= s[i + k_ - 1];
+                if (kmer < best) {
+                    best = kmer;
+                    best_rc = rc;
+                    best_pos = i;
+                }
+            }
+        }
+
+        const Sequence &s = best_rc ? loop_rc : loop;
+        Sequence rotated = s.Subseq(best_pos) + s.Subseq(k_, k_ + best_pos);
+        std::vector<Sequence> parts = { rotated };
+        KMer edge = KMer(k_ + 1, rotated) >> 'A';
+        for (size_t i = k_; i < rotated.size(); ++i) {
+            edge <<= rotated[i];
+            if (edge == !edge) {
+                size_t pos = i - k_;
+                parts = { rotated.Subseq(pos, pos + k_ + 1),
+                          rotated.Subseq(pos + 1, rotated.size() - k_) + rotated.Subseq(0, pos + k_) };
+                break;
+            }
+        }
+        for (const Sequence &part : parts)
+            res.push_back(std::max(part, !part));
+    }
+
+    template<class KMer, class Streams>
+    std::vector<Sequence> ExtractUnitigs(Streams &streams, kmers::KMerDiskStorage<RtSeq> &edges,
+                                         unsigned nthreads, bool keep_perfect_loops) {
+        Split(streams, nthreads);
+
+        INFO("Compacting unitigs in buckets");
+        edges.resize(num_buckets_);
+        std::vector<fs::DependentTmpFile> edge_files;
+        for (unsigned i = 0; i < num_buckets_; ++i)
+            edge_files.push_back(edges.create(i));
+
+        std::vector<superkmer::BucketUnitigs> buckets(num_buckets_);
+#       pragma omp parallel for num_threads(nthreads) schedule(dynamic)
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            superkmer::BucketCompactor<KMer>(k_).Compact(*superkmers_[i], *edge_files[i], buckets[i]);
+            superkmers_[i].reset();
+        }
+        superkmers_.clear();
+
+        std::vector<Sequence> unitigs, loops;
+        std::vector<superkmer::Piece> pieces;
+        for (auto &bucket : buckets) {
+            std::move(bucket.unitigs.begin(), bucket.unitigs.end(), std::back_inserter(unitigs));
+            std::move(bucket.loops.begin(), bucket.loops.end(), std::back_inserter(loops));
+            std::move(bucket.pieces.begin(), bucket.pieces.end(), std::back_inserter(pieces));
+        }
+        buckets.clear();
+
+        INFO("Stitching " << pieces.size() << " unitig parts");
+        superkmer::PieceStitcher<KMer> stitcher(k_, pieces);
+        stitcher.CollectUnitigs(unitigs);
+        stitcher.CollectLoops(loops);
+
+        std::vector<Sequence> res;
+        res.reserve(unitigs.size() + loops.size());
+        for (const Sequence &s : unitigs)
+            res.push_back(std::max(s, !s));
+        if (keep_perfect_loops) {
+            for (const Sequence &loop : loops)
+                AddLoop<KMer>(loop, res);
+        }
+        INFO("Extracting unbranching paths finished. " << unitigs.size() << " sequences and "
+             << loops.size() << " perfect loops extracted");
+
+        return res;
+    }
+
+    Graph &graph_;
+    fs::TmpDir workdir_;
+    unsigned k_;
+    size_t read_buffer_size_;
+    unsigned num_buckets_;
+    unsigned minimizer_size_;
+    std::vector<fs::DependentTmpFile> superkmers_;
+    std::vector<std::mutex> locks_;
+
+    DECL_LOGGER("SuperKMerGraphConstructor");
+};
+
+}
@@ -9,6 +9,8 @@
 #ifndef __OMNI_ACTION_HANDLERS_HPP__
 #define __OMNI_ACTION_HANDLERS_HPP__
 
+#include "graph_event_log.hpp"
+
 #include "utils/verify.hpp"
 #include "utils/logger/logger.hpp"
 
@@ -127,6 +129,27 @@ public:
         return false;
     }
 
+    /**
+     * Handlers which do not need to observe the graph changes immediately could override this
+     * method. While graph is in batch mode, events for such handlers are recorded into the log
+     * which is passed to HandleBatch() when the batch is over. Note that by that time the edges
+     * mentioned in the events might be already removed from the graph.
+     */
+    virtual bool IsDeferrable() const {
+        return false;
+    }
+
+    /**
+     * Event triggered at the end of graph batch for deferrable handlers. Default implementation
+     * replays the events one by one, handlers could override it to process the whole batch at once.
+     * Deferrable handlers could process their batches concurrently with each other.
+     * @param log events of the batch
+     */
+    virtual void HandleBatch(const GraphEventLog<VertexId, EdgeId> &log) {
+        for (const auto &event : log)
+            log.Apply(*this, event);
+    }
+
     bool IsAttached() const {
         return attached_;
     }
@@ -146,8 +169,12 @@ template<class Graph>
 class GraphActionHandler : public ActionHandler<typename Graph::VertexId,
         typename Graph::EdgeId> {
     typedef ActionHandler<typename Graph::VertexId, typename Graph::EdgeId> base;
+    typedef GraphEventLog<typename Graph::VertexId, typename Graph::EdgeId> EventLog;
 
     const Graph *g_;
+    // Log and event being replayed by HandleBatch()
+    const EventLog *log_ = nullptr;
+    const typename EventLog::Event *event_ = nullptr;
 
     void DetachAndIsolate() {
         TRACE("Removing action handler: " << this->name());
@@ -182,6 +209,16 @@ public:
         DetachAndIsolate();
     }
 
+    void HandleBatch(const EventLog &log) override {
+        log_ = &log;
+        for (const auto &event : log) {
+            event_ = &event;
+            log.Apply(*this, event);
+        }
+        log_ = nullptr;
+        event_ = nullptr;
+    }
+
     GraphActionHandler(GraphActionHandler<Graph> &&other) noexcept : base(other.name()), g_(other.g_) {
         if (other.IsAttached())
             other.Detach();
@@ -194,6 +231,25 @@ public:
     virtual ~GraphActionHandler() {
         DetachAndIsolate();
     }
+
+protected:
+    /**
+     * Length and conjugate of the edge, which are safe to use in deferrable handlers: if the
+     * edge is mentioned in the event being handled, the values are taken from the event log.
+     */
+    size_t length(typename Graph::EdgeId e) const {
+        if (event_)
+            if (auto info = log_->Find(*event_, e))
+                return info->length;
+        return g_->length(e);
+    }
+
+    typename Graph::EdgeId conjugate(typename Graph::EdgeId e) const {
+        if (event_)
+            if (auto info = log_->Find(*event_, e))
+                return info->conj;
+        return g_->conjugate(e);
+    }
 };
 
 /**
@@ -11,6 +11,7 @@
 #include "utils/verify.hpp"
 #include "utils/logger/logger.hpp"
 #include "utils/stl_utils.hpp"
+#include "utils/parallel/openmp_wrapper.h"
 
 #include "adt/iterator_range.hpp"
 #include "adt/small_pod_vector.hpp"
@@ -276,12 +277,12 @@ private:
         id_iterator id_end() const { return id_distributor_.end(); }
         uint64_t max_id() const { return id_distributor_.max_id(); }
 
+        // Besides, guarantees that the next sz - size() ids are allocated without any resize
         void reserve(size_t sz) {
-            if (storage_size_ >= sz + bias_)
-                return;
-
-            id_distributor_.resize(sz);
-            resize(sz + bias_);
+            if (id_distributor_.size() < sz)
+                id_distributor_.resize(sz);
+            if (storage_size_ < sz + bias_)
+                resize(sz + bias_);
         }
 
         // FIXME: Count!
@@ -291,12 +292,17 @@ private:
             return id < storage_size_ && id_distributor_.occupied(id);
         }
 
+        // Could be called concurrently only if enough ids were reserved beforehand
         template<typename... ArgTypes>
         uint64_t create(ArgTypes &&... args) {
-            uint64_t id = id_distributor_.allocate();
+            uint64_t id;
+#pragma omp critical
+            id = id_distributor_.allocate();
 
-            while (storage_size_ < id + 1)
+            while (storage_size_ < id + 1) {
+                VERIFY_MSG(!omp_in_parallel(), "Storage could not be resized concurrently, reserve it first");
                 resize(storage_size_ * 2 + 1);
+            }
 
             new(storage_ + id) T(std::forward<ArgTypes>(args)...);;
             size_ += 1;
@@ -0,0 +1,199 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "utils/verify.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <vector>
+
+namespace omnigraph {
+
+/**
+* GraphEventLog records graph events while the graph is in batch mode (see
+* ObservableGraph::BeginBatch()). Since the handlers process the log after the
+* whole batch was applied to the graph, the edges mentioned in the events
+* might already be removed (and their ids reused). Therefore, together with
+* the ids, the log stores the conjugates and lengths of all the edges (and
+* conjugates of the vertices) involved as they were at the moment of the
+* event.
+*/
+template<typename VertexId, typename EdgeId>
+class GraphEventLog {
+public:
+    enum class EventType : uint8_t {
+        AddVertex, AddEdge, DeleteVertex, DeleteEdge, Merge, Glue, Split
+    };
+
+    struct EdgeInfo {
+        EdgeId e, conj;
+        size_t length;
+    };
+
+    struct VertexInfo {
+        VertexId v, conj;
+    };
+
+    struct Event {
+        EventType type;
+        VertexInfo vertex;
+        // Edges of the event in the log edge storage:
+        //   add / delete edge:  edge
+        //   merge:              old edges of the path, new edge
+        //   glue:               new edge, edge1, edge2
+        //   split:              old edge, new edge 1, new edge 2
+        size_t edges_begin, edges_end;
+    };
+
+    typedef typename std::vector<Event>::const_iterator const_iterator;
+
+    template<class Graph>
+    void AddVertex(const Graph &g, VertexId v) { AddVertexEvent(g, EventType::AddVertex, v); }
+    template<class Graph>
+    void DeleteVertex(const Graph &g, VertexId v) { AddVertexEvent(g, EventType::DeleteVertex, v); }
+
+    template<class Graph>
+    void AddEdge(const Graph &g, EdgeId e) { AddEdgeEvent(g, EventType::AddEdge, { e }); }
+    template<class Graph>
+    void DeleteEdge(const Graph &g, EdgeId e) { AddEdgeEvent(g, EventType::DeleteEdge, { e }); }
+
+    template<class Graph>
+    void Merge(const Graph &g, const std::vector<EdgeId> &old_edges, EdgeId new_edge) {
+        size_t begin = edges_.size();
+        for (EdgeId e : old_edges)
+            edges_.push_back(Info(g, e));
+        edges_.push_back(Info(g, new_edge));
+        events_.push_back({ EventType::Merge, {}, begin, edges_.size() });
+    }
+
+    template<class Graph>
+    void Glue(const Graph &g, EdgeId new_edge, EdgeId edge1, EdgeId edge2) {
+        AddEdgeEvent(g, EventType::Glue, { new_edge, edge1, edge2 });
+    }
+
+    template<class Graph>
+    void Split(const Graph &g, EdgeId old_edge, EdgeId new_edge1, EdgeId new_edge2) {
+        AddEdgeEvent(g, EventType::Split, { old_edge, new_edge1, new_edge2 });
+    }
+
+    const_iterator begin() const { return events_.begin(); }
+    const_iterator end() const { return events_.end(); }
+    size_t size() const { return events_.size(); }
+    bool empty() const { return events_.empty(); }
+
+    void clear() {
+        events_.clear();
+        edges_.clear();
+    }
+
+    const EdgeInfo &edge(const Event &event, size_t i) const {
+        VERIFY(event.edges_begin + i < event.edges_end);
+        return edges_[event.edges_begin + i];
+    }
+
+    /// @return information about the edge (or its conjugate) as of the
+    /// moment of the event, if the edge was involved in it
+    std::optional<EdgeInfo> Find(const Event &event, EdgeId e) const {
+        for (size_t i = event.edges_begin; i < event.edges_end; ++i) {
+            const EdgeInfo &info = edges_[i];
+            if (info.e == e)
+                return info;
+            if (info.conj == e)
+                return EdgeInfo{ info.conj, info.e, info.length };
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * Triggers the handler methods for the event in the same way as
+     * PairedHandlerApplier does, i.e. for the event itself and its
+     * reverse-complement counterpart.
+     */
+    template<class Handler>
+    void Apply(Handler &handler, const Event &event) const {
+        switch (event.type) {
+            case EventType::AddVertex:
+                handler.HandleAdd(event.vertex.v);
+                if (event.vertex.v != event.vertex.conj)
+                    handler.HandleAdd(event.vertex.conj);
+                break;
+            case EventType::DeleteVertex:
+                handler.HandleDelete(event.vertex.v);
+                if (event.vertex.v != event.vertex.conj)
+                    handler.HandleDelete(event.vertex.conj);
+                break;
+            case EventType::AddEdge: {
+                const EdgeInfo &info = edge(event, 0);
+                handler.HandleAdd(info.e);
+                if (info.e != info.conj)
+                    handler.HandleAdd(info.conj);
+                break;
+            }
+            case EventType::DeleteEdge: {
+                const EdgeInfo &info = edge(event, 0);
+                handler.HandleDelete(info.e);
+                if (info.e != info.conj)
+                    handler.HandleDelete(info.conj);
+                break;
+            }
+            case EventType::Merge: {
+                std::vector<EdgeId> path, rc_path;
+                for (size_t i = event.edges_begin; i + 1 < event.edges_end; ++i)
+                    path.push_back(edges_[i].e);
+                const EdgeInfo &new_edge = edges_[event.edges_end - 1];
+                handler.HandleMerge(path, new_edge.e);
+                if (new_edge.e != new_edge.conj) {
+                    for (size_t i = event.edges_end - 1; i-- > event.edges_begin; )
+                        rc_path.push_back(edges_[i].conj);
+                    handler.HandleMerge(rc_path, new_edge.conj);
+                }
+                break;
+            }
+            case EventType::Glue: {
+                const EdgeInfo &new_edge = edge(event, 0), &edge1 = edge(event, 1), &edge2 = edge(event, 2);
+                handler.HandleGlue(new_edge.e, edge1.e, edge2.e);
+                if (edge1.e != edge1.conj)
+                    handler.HandleGlue(new_edge.conj, edge1.conj, edge2.conj);
+                break;
+            }
+            case EventType::Split: {
+                const EdgeInfo &old_edge = edge(event, 0), &new_edge1 = edge(event, 1), &new_edge2 = edge(event, 2);
+                handler.HandleSplit(old_edge.e, new_edge1.e, new_edge2.e);
+                if (old_edge.e != old_edge.conj)
+                    handler.HandleSplit(old_edge.conj, new_edge2.conj, new_edge1.conj);
+                break;
+            }
+        }
+    }
+
+private:
+    template<class Graph>
+    static EdgeInfo Info(const Graph &g, EdgeId e) {
+        return { e, g.conjugate(e), g.length(e) };
+    }
+
+    template<class Graph>
+    void AddVertexEvent(const Graph &g, EventType type, VertexId v) {
+        events_.push_back({ type, { v, g.conjugate(v) }, edges_.size(), edges_.size() });
+    }
+
+    template<class Graph>
+    void AddEdgeEvent(const Graph &g, EventType type, std::initializer_list<EdgeId> edges) {
+        size_t begin = edges_.size();
+        for (EdgeId e : edges)
+            edges_.push_back(Info(g, e));
+        events_.push_back({ type, {}, begin, edges_.size() });
+    }
+
+    std::vector<Event> events_;
+    std::vector<EdgeInfo> edges_;
+};
+
+}
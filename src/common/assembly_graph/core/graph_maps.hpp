@@ -0,0 +1,49 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "graph_iterators.hpp"
+#include "adt/id_map.hpp"
+
+namespace omnigraph {
+
+/**
+ * @brief Per-edge property map indexed by the edge ids.
+ * @detail Use instead of the hash maps keyed by EdgeId when the property is defined for a
+ *         considerable fraction of edges: the storage is sized by the graph id bound and
+ *         grows when new edges get larger ids.
+ */
+template<class Graph, class V>
+class EdgeMap : public adt::id_map<V, typename Graph::EdgeId> {
+    typedef adt::id_map<V, typename Graph::EdgeId> base;
+
+  public:
+    explicit EdgeMap(const Graph &g)
+            : base(g.max_eid()) {}
+};
+
+/// Per-vertex property map indexed by the vertex ids, see EdgeMap
+template<class Graph, class V>
+class VertexMap : public adt::id_map<V, typename Graph::VertexId> {
+    typedef adt::id_map<V, typename Graph::VertexId> base;
+
+  public:
+    explicit VertexMap(const Graph &g)
+            : base(g.max_vid()) {}
+};
+
+/// EdgeMap forgetting the values of the deleted edges, so the reused ids start from scratch
+template<class Graph, class V>
+class SmartEdgeMap : public SmartContainer<EdgeMap<Graph, V>, Graph> {
+    typedef SmartContainer<EdgeMap<Graph, V>, Graph> base;
+
+  public:
+    explicit SmartEdgeMap(const Graph &g)
+            : base(g, g) {}
+};
+
+}
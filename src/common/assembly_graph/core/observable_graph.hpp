@@ -11,10 +11,14 @@
 #include "utils/logger/logger.hpp"
 #include "graph_core.hpp"
 #include "graph_iterators.hpp"
+#include "graph_event_log.hpp"
+
+#include "utils/parallel/openmp_wrapper.h"
 
 #include <vector>
 #include <set>
 #include <cstring>
+#include <mutex>
 
 namespace omnigraph {
 
@@ -34,12 +38,34 @@ public:
     typedef SmartVertexIterator<ObservableGraph> SmartVertexIt;
     typedef SmartEdgeIterator<ObservableGraph> SmartEdgeIt;
     typedef ActionHandler<VertexId, EdgeId> Handler;
+    typedef GraphEventLog<VertexId, EdgeId> EventLog;
 
 private:
    //todo switch to smart iterators
    mutable std::vector<Handler*> action_handler_list_;
    std::unique_ptr<const HandlerApplier<VertexId, EdgeId>> applier_;
 
+   // Batch mode state, see BeginBatch()
+   mutable unsigned batch_depth_ = 0;
+   mutable EventLog event_log_;
+   mutable std::mutex event_log_mutex_;
+
+   // Serializes notifications of the handlers that are not thread-safe when
+   // events are fired concurrently by parallel graph processing algorithms
+   mutable std::mutex handler_mutex_;
+
+   bool Deferred(const Handler *handler) const {
+       return batch_depth_ && handler->IsDeferrable();
+   }
+
+   template<class F>
+   void Notify(const Handler *handler, F f) const;
+
+   template<class F>
+   void LogEvent(F f) const;
+
+   void DispatchEventLog() const;
+
 public:
 //todo move to graph core
     typedef ConstructionHelper<DataMaster> HelperT;
@@ -60,12 +86,29 @@ public:
 
     bool AllHandlersThreadSafe() const;
 
+    /**
+     * Starts batch mode. Until the matching CommitBatch() call, events for deferrable handlers
+     * (see ActionHandler::IsDeferrable()) are recorded into the event log, all other handlers
+     * are notified immediately as usual. Batches could be nested, only the outermost one is
+     * committed. Must not be called from a parallel region.
+     */
+    void BeginBatch() const;
+
+    /**
+     * Finishes batch mode and passes the recorded events to deferrable handlers, possibly
+     * processing different handlers concurrently.
+     */
+    void CommitBatch() const;
+
+    bool InBatch() const { return batch_depth_ > 0; }
+
    // TODO: for debug. remove.
     void PrintHandlersNames() const;
 
     void FireGameOver() const;
     
    //todo make Fire* protected once again with helper friend class
+   //Fire* could be called from a parallel region, handlers that are not thread-safe are then notified one at a time
     void FireAddVertex(VertexId v) const;
 
     void FireAddEdge(EdgeId e) const;
@@ -156,6 +199,26 @@ private:
     DECL_LOGGER("ObservableGraph")
 };
 
+/// RAII guard for graph batch mode, see ObservableGraph::BeginBatch()
+template<class Graph>
+class GraphEventBatch {
+public:
+    explicit GraphEventBatch(const Graph &g)
+            : g_(g) {
+        g_.BeginBatch();
+    }
+
+    ~GraphEventBatch() {
+        g_.CommitBatch();
+    }
+
+    GraphEventBatch(const GraphEventBatch &) = delete;
+    GraphEventBatch &operator=(const GraphEventBatch &) = delete;
+
+private:
+    const Graph &g_;
+};
+
 template<class DataMaster>
 typename ObservableGraph<DataMaster>::VertexId
 ObservableGraph<DataMaster>::AddVertex(VertexData data, VertexId id1, VertexId id2) {
@@ -265,6 +328,10 @@ std::vector<typename ObservableGraph<DataMaster>::VertexId>
 
 template<class DataMaster>
 void ObservableGraph<DataMaster>::AddActionHandler(Handler* action_handler) const {
+    // New handler should not receive events which happened before it was added
+    if (batch_depth_ && action_handler->IsDeferrable())
+        DispatchEventLog();
+
 #pragma omp critical(action_handler_list_modification)
     {
         TRACE("Action handler " << action_handler->name() << " added");
@@ -293,16 +360,87 @@ bool ObservableGraph<DataMaster>::RemoveActionHandler(const Handler* action_hand
     return result;
 }
 
+// Deferred handlers are not notified while the batch is open, so they do not
+// prevent parallel processing. Note that such handlers must not be queried
+// within the batch either (see EdgesPositionHandler)
 template<class DataMaster>
 bool ObservableGraph<DataMaster>::AllHandlersThreadSafe() const {
     for (Handler* handler : action_handler_list_) {
-        if (handler->IsAttached() && !handler->IsThreadSafe()) {
+        if (handler->IsAttached() && !handler->IsThreadSafe() && !Deferred(handler)) {
             return false;
         }
     }
     return true;
 }
 
+template<class DataMaster>
+void ObservableGraph<DataMaster>::BeginBatch() const {
+    VERIFY(!omp_in_parallel());
+    batch_depth_ += 1;
+}
+
+template<class DataMaster>
+void ObservableGraph<DataMaster>::CommitBatch() const {
+    VERIFY(!omp_in_parallel());
+    VERIFY(batch_depth_ > 0);
+    if (batch_depth_ == 1)
+        DispatchEventLog();
+    batch_depth_ -= 1;
+}
+
+template<class DataMaster>
+void ObservableGraph<DataMaster>::DispatchEventLog() const {
+    if (event_log_.empty())
+        return;
+
+    std::vector<Handler*> deferred;
+    for (Handler* handler : action_handler_list_) {
+        if (handler->IsAttached() && handler->IsDeferrable())
+            deferred.push_back(handler);
+    }
+
+    TRACE("Dispatching " << event_log_.size() << " events to " << deferred.size() << " handlers");
+    // Handlers are independent, so they could process the batch concurrently
+    #pragma omp parallel for schedule(dynamic, 1) if(deferred.size() > 1)
+    for (size_t i = 0; i < deferred.size(); ++i)
+        deferred[i]->HandleBatch(event_log_);
+
+    event_log_.clear();
+}
+
+template<class DataMaster>
+template<class F>
+void ObservableGraph<DataMaster>::LogEvent(F f) const {
+    if (!batch_depth_)
+        return;
+
+    bool has_deferred = false;
+    for (Handler* handler : action_handler_list_) {
+        if (handler->IsAttached() && handler->IsDeferrable()) {
+            has_deferred = true;
+            break;
+        }
+    }
+    if (!has_deferred)
+        return;
+
+    // Events could be fired concurrently by parallel graph processing algorithms
+    std::lock_guard<std::mutex> lock(event_log_mutex_);
+    f(event_log_);
+}
+
+template<class DataMaster>
+template<class F>
+void ObservableGraph<DataMaster>::Notify(const Handler *handler, F f) const {
+    if (handler->IsThreadSafe() || !omp_in_parallel()) {
+        f();
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(handler_mutex_);
+    f();
+}
+
 template<class DataMaster>
 void ObservableGraph<DataMaster>::PrintHandlersNames() const {
     for (Handler* handler : action_handler_list_) {
@@ -321,65 +459,72 @@ void ObservableGraph<DataMaster>::FireGameOver() const {
 
 template<class DataMaster>
 void ObservableGraph<DataMaster>::FireAddVertex(VertexId v) const {
+    LogEvent([&](EventLog &log) { log.AddVertex(*this, v); });
     for (Handler* handler_ptr : action_handler_list_) {
-        if (handler_ptr->IsAttached()) {
+        if (handler_ptr->IsAttached() && !Deferred(handler_ptr)) {
             TRACE("FireAddVertex to handler " << handler_ptr->name());
-            applier_->ApplyAdd(*handler_ptr, v);
+            Notify(handler_ptr, [&] { applier_->ApplyAdd(*handler_ptr, v); });
         }
     }
 }
 
 template<class DataMaster>
 void ObservableGraph<DataMaster>::FireAddEdge(EdgeId e) const {
+    LogEvent([&](EventLog &log) { log.AddEdge(*this, e); });
     for (Handler* handler_ptr : action_handler_list_) {
-        if (handler_ptr->IsAttached()) {
+        if (handler_ptr->IsAttached() && !Deferred(handler_ptr)) {
             TRACE("FireAddEdge to handler " << handler_ptr->name());
-            applier_->ApplyAdd(*handler_ptr, e);
+            Notify(handler_ptr, [&] { applier_->ApplyAdd(*handler_ptr, e); });
         }
     }
 }
 
 template<class DataMaster>
 void ObservableGraph<DataMaster>::FireDeleteVertex(VertexId v) const {
+    LogEvent([&](EventLog &log) { log.DeleteVertex(*this, v); });
     for (auto it = action_handler_list_.rbegin(); it != action_handler_list_.rend(); ++it) {
-        if ((*it)->IsAttached()) {
-            applier_->ApplyDelete(**it, v);
+        if ((*it)->IsAttached() && !Deferred(*it)) {
+            Notify(*it, [&] { applier_->ApplyDelete(**it, v); });
         }
     }
 }
 
 template<class DataMaster>
 void ObservableGraph<DataMaster>::FireDeleteEdge(EdgeId e) const {
+    LogEvent([&](EventLog &log) { log.DeleteEdge(*this, e); });
     for (auto it = action_handler_list_.rbegin(); it != action_handler_list_.rend(); ++it) {
-        if ((*it)->IsAttached()) {
-            applier_->ApplyDelete(**it, e);
+        if ((*it)->IsAttached() && !Deferred(*it)) {
+            Notify(*it, [&] { applier_->ApplyDelete(**it, e); });
         }
     };
 }
 
 template<class DataMaster>
 void ObservableGraph<DataMaster>::FireMerge(const std::vector<EdgeId> &old_edges, EdgeId new_edge) const {
+    LogEvent([&](EventLog &log) { log.Merge(*this, old_edges, new_edge); });
     for (Handler* handler_ptr : action_handler_list_) {
-        if (handler_ptr->IsAttached()) {
-            applier_->ApplyMerge(*handler_ptr, old_edges, new_edge);
+        if (handler_ptr->IsAttached() && !Deferred(handler_ptr)) {
+            Notify(handler_ptr, [&] { applier_->ApplyMerge(*handler_ptr, old_edges, new_edge); });
         }
     }
 }
 
 template<class DataMaster>
 void ObservableGraph<DataMaster>::FireGlue(EdgeId new_edge, EdgeId edge1, EdgeId edge2) const {
+    LogEvent([&](EventLog &log) { log.Glue(*this, new_edge, edge1, edge2); });
     for (Handler* handler_ptr : action_handler_list_) {
-        if (handler_ptr->IsAttached()) {
-            applier_->ApplyGlue(*handler_ptr, new_edge, edge1, edge2);
+        if (handler_ptr->IsAttached() && !Deferred(handler_ptr)) {
+            Notify(handler_ptr, [&] { applier_->ApplyGlue(*handler_ptr, new_edge, edge1, edge2); });
         }
     };
 }
 
 template<class DataMaster>
 void ObservableGraph<DataMaster>::FireSplit(EdgeId edge, EdgeId new_edge1, EdgeId new_edge2) const {
+    LogEvent([&](EventLog &log) { log.Split(*this, edge, new_edge1, new_edge2); });
     for (Handler* handler_ptr : action_handler_list_) {
-        if (handler_ptr->IsAttached()) {
-            applier_->ApplySplit(*handler_ptr, edge, new_edge1, new_edge2);
+        if (handler_ptr->IsAttached() && !Deferred(handler_ptr)) {
+            Notify(handler_ptr, [&] { applier_->ApplySplit(*handler_ptr, edge, new_edge1, new_edge2); });
         }
     }
 }
@@ -411,6 +556,10 @@ void ObservableGraph<DataMaster>::clear() {
 
 template<class DataMaster>
 ObservableGraph<DataMaster>::~ObservableGraph() {
+    if (batch_depth_) {
+        batch_depth_ = 1;
+        CommitBatch();
+    }
     FireGameOver();
     clear();
 }
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "assembly_graph/core/graph_iterators.hpp"
+#include "assembly_graph/core/observable_graph.hpp"
 #include "assembly_graph/graph_support/graph_processing_algorithm.hpp"
 
 #include "utils/parallel/openmp_wrapper.h"
@@ -87,7 +88,10 @@ public:
         typedef typename Condition::checked_type ElementType;
         std::vector<std::vector<ElementType>> of_interest(chunk_iterators.size() - 1);
 
-        #pragma omp parallel for schedule(guided)
+        // Conditions are run by the OpenMP team, as they might keep per-thread state
+        // indexed by omp_get_thread_num(). Chunks are handed out one by one, so the
+        // threads finishing the cheap chunks early take the remaining ones
+        #pragma omp parallel for schedule(dynamic, 1)
         for (size_t i = 0; i < chunk_iterators.size() - 1; ++i) {
             DEBUG("Processing chunk " << i << " by thread " << omp_get_thread_num());
             size_t cnt = 0;
@@ -148,6 +152,16 @@ public:
     virtual size_t Run(bool force_primary_launch = false,
                        double iter_run_progress = 1.) = 0;
 
+    /**
+     * Launches graph processing as a single graph batch, so deferrable
+     * handlers are notified about the changes once at the end of the run
+     */
+    size_t BatchedRun(bool force_primary_launch = false,
+                      double iter_run_progress = 1.) {
+        GraphEventBatch<Graph> batch(g_);
+        return Run(force_primary_launch, iter_run_progress);
+    }
+
 protected:
     DECL_LOGGER("Simplification");
 };
@@ -167,7 +181,7 @@ public:
                  double iter_run_progress = 1.) {
         if (!comment.empty()) {INFO("Running " << comment);}
         TIME_TRACE_SCOPE(comment);
-        size_t triggered = algo.Run(force_primary_launch, iter_run_progress);
+        size_t triggered = algo.BatchedRun(force_primary_launch, iter_run_progress);
         if (!comment.empty()) {INFO(comment << " triggered " << triggered << " times");}
         return triggered;
     }
@@ -187,7 +201,7 @@ public:
         size_t total_triggered = 0;
         for (size_t i = 0; i < iteration_cnt; ++i) {
             DEBUG("Iteration " << i);
-            size_t algo_triggered = algo.Run(all_primary || (i == 0 && first_primary),
+            size_t algo_triggered = algo.BatchedRun(all_primary || (i == 0 && first_primary),
                                 double(i + 1) / double(iteration_cnt));
             DEBUG("Triggered " << algo_triggered << " times on iteration " << (i + 1));
             total_triggered += algo_triggered;
@@ -207,7 +221,7 @@ public:
         for (size_t i = 0; i < max_it_cnt && (changed || i < min_it_cnt); ++i) {
             bool primary = all_primary || (first_primary && i == 0);
             DEBUG("Iteration " << (i + 1));
-            size_t algo_triggered = algo.Run(primary, iter_run_progress);
+            size_t algo_triggered = algo.BatchedRun(primary, iter_run_progress);
             DEBUG("Triggered " << algo_triggered << " times on iteration " << (i + 1));
             changed = (algo_triggered > 0);
             triggered += algo_triggered;
@@ -19,7 +19,12 @@
 #include "utils/stl_utils.hpp"
 #include "assembly_graph/paths/mapping_path.hpp"
 #include "assembly_graph/core/action_handlers.hpp"
-#include <map>
+
+#include <parallel_hashmap/phmap.h>
+
+#include <algorithm>
+#include <set>
+#include <vector>
 
 namespace omnigraph {
 
@@ -37,28 +42,128 @@ inline std::ostream &operator<<(std::ostream &os, const EdgePosition &ep) {
     return os << ep.contigId << " " << ep.mr;
 }
 
+/**
+ * @brief Positions of the edges on the reference sequences (genomes, contigs).
+ *
+ * @detail Contig names are interned, positions of every edge are kept in a flat vector
+ * sorted by contig and mapping range. Graph events gather the shifted positions of the
+ * old edges and merge them into the new edge in a single sort and sweep.
+ */
 template<class Graph>
 class EdgesPositionHandler: public GraphActionHandler<Graph> {
     typedef typename Graph::VertexId VertexId;
     typedef typename Graph::EdgeId EdgeId;
     typedef std::set<MappingRange> RangeSet;
 
+    struct Position {
+        uint32_t contig;
+        MappingRange mr;
+
+        bool operator<(const Position &other) const {
+            if (contig != other.contig)
+                return contig < other.contig;
+            return mr < other.mr;
+        }
+    };
+    // Sorted by contig, then by mapping range
+    typedef std::vector<Position> PositionList;
+
     size_t max_mapping_gap_;
     size_t max_gap_diff_;
-    std::map<EdgeId, std::map<std::string, RangeSet>> edges_positions_;
-    //TODO extract RangeSet aka set<MappingRange> as a storage class
+    std::vector<std::string> contig_names_;
+    phmap::flat_hash_map<std::string, uint32_t> contig_ids_;
+    phmap::flat_hash_map<EdgeId, PositionList> edges_positions_;
 
-    MappingRange EraseAndExtract(RangeSet &ranges, RangeSet::iterator position, const MappingRange &new_pos) const {
-        auto old_pos = *position;
+    uint32_t ContigId(const std::string &contig_id) {
+        auto [it, inserted] = contig_ids_.try_emplace(contig_id, uint32_t(contig_names_.size()));
+        if (inserted)
+            contig_names_.push_back(contig_id);
+        return it->second;
+    }
+
+    /// Merges new_pos with old_pos if they overlap or one continues another
+    bool TryMerge(const MappingRange &old_pos, MappingRange &new_pos) const {
         if (old_pos.IntersectLeftOf(new_pos) || old_pos.StrictlyContinuesWith(new_pos, max_mapping_gap_, max_gap_diff_)) {
-            ranges.erase(position);
-            return old_pos.Merge(new_pos);
+            new_pos = old_pos.Merge(new_pos);
+            return true;
         } else if (new_pos.IntersectLeftOf(old_pos) || new_pos.StrictlyContinuesWith(old_pos, max_mapping_gap_, max_gap_diff_)) {
-            ranges.erase(position);
-            return new_pos.Merge(old_pos);
-        } else {
-            return new_pos;
+            new_pos = new_pos.Merge(old_pos);
+            return true;
         }
+        return false;
+    }
+
+    static bool Equivalent(const MappingRange &a, const MappingRange &b) {
+        return !(a < b) && !(b < a);
+    }
+
+    void AddPosition(PositionList &positions, uint32_t contig, MappingRange new_pos) const {
+        auto contig_range = std::equal_range(positions.begin(), positions.end(), Position{ contig, MappingRange() },
+                                             [](const Position &a, const Position &b) { return a.contig < b.contig; });
+        size_t lo = contig_range.first - positions.begin(), hi = contig_range.second - positions.begin();
+        auto LowerBound = [&](const MappingRange &mr) {
+            return size_t(std::lower_bound(positions.begin() + lo, positions.begin() + hi, mr,
+                                           [](const Position &p, const MappingRange &r) { return p.mr < r; }) - positions.begin());
+        };
+
+        size_t i = LowerBound(new_pos);
+        if (i != hi && TryMerge(positions[i].mr, new_pos)) {
+            positions.erase(positions.begin() + i);
+            hi -= 1;
+            i = LowerBound(new_pos);
+        }
+        if (i != lo && TryMerge(positions[i - 1].mr, new_pos)) {
+            positions.erase(positions.begin() + i - 1);
+            hi -= 1;
+            i = LowerBound(new_pos);
+        }
+        if (i != hi && Equivalent(positions[i].mr, new_pos))
+            return;
+        positions.insert(positions.begin() + i, Position{ contig, new_pos });
+    }
+
+    /// Adds the batch of positions to the edge, all of them are merged in a single pass
+    void AddPositions(EdgeId edge, PositionList batch) {
+        batch.erase(std::remove_if(batch.begin(), batch.end(),
+                                   [](const Position &p) { return p.mr.empty(); }),
+                    batch.end());
+        if (batch.empty())
+            return;
+
+        PositionList &positions = edges_positions_[edge];
+        batch.insert(batch.end(), positions.begin(), positions.end());
+        std::sort(batch.begin(), batch.end());
+
+        positions.clear();
+        for (Position &pos : batch) {
+            if (!positions.empty() && positions.back().contig == pos.contig) {
+                MappingRange &last = positions.back().mr;
+                if (TryMerge(last, pos.mr)) {
+                    last = pos.mr;
+                    continue;
+                }
+                if (Equivalent(last, pos.mr))
+                    continue;
+            }
+            positions.push_back(pos);
+        }
+    }
+
+    /// Positions of the edge shifted along the new edge and fitted into it
+    void CollectShifted(PositionList &batch, EdgeId old_edge, EdgeId new_edge, int shift) const {
+        auto it = edges_positions_.find(old_edge);
+        if (it == edges_positions_.end())
+            return;
+        size_t length = this->length(new_edge);
+        for (const Position &pos : it->second)
+            batch.push_back(Position{ pos.contig, pos.mr.Shift(shift).Fit(length) });
+    }
+
+    // Positions are updated once the graph event batch is committed (see
+    // IsDeferrable()), so reading them within the batch would give stale data
+    void CheckUpToDate() const {
+        VERIFY(this->IsAttached());
+        CHECK_FATAL_ERROR(!this->g().InBatch(), "Edge positions could not be queried within graph event batch");
     }
 
     std::string RangeStr(const Range &range) const {
@@ -68,29 +173,22 @@ class EdgesPositionHandler: public GraphActionHandler<Graph> {
     }
 
 public:
-    MappingRange EraseAndExtract(RangeSet &ranges, MappingRange new_pos) const {
-        auto it = ranges.lower_bound(new_pos);
-        if (it != ranges.end()) {
-            new_pos = EraseAndExtract(ranges, it, new_pos);
-            it = ranges.lower_bound(new_pos);
-        }
-        if (it != ranges.begin()) {
-            new_pos = EraseAndExtract(ranges, std::prev(it), new_pos);
-        }
-        return new_pos;
-    }
-
     RangeSet GetEdgePositions(EdgeId edge, const std::string &contig_id) const {
-        VERIFY(this->IsAttached());
+        CheckUpToDate();
         auto edge_it = edges_positions_.find(edge);
         if (edge_it == edges_positions_.end())
             return {};
-        const auto &positions = edge_it->second;
-        auto it = positions.find(contig_id);
-        if (it == positions.end())
+        auto contig_it = contig_ids_.find(contig_id);
+        if (contig_it == contig_ids_.end())
             return {};
-        else
-            return it->second;
+
+        const auto &positions = edge_it->second;
+        auto contig_range = std::equal_range(positions.begin(), positions.end(), Position{ contig_it->second, MappingRange() },
+                                             [](const Position &a, const Position &b) { return a.contig < b.contig; });
+        RangeSet result;
+        for (auto it = contig_range.first; it != contig_range.second; ++it)
+            result.insert(result.end(), it->mr);
+        return result;
     }
 
     MappingRange GetUniqueEdgePosition(EdgeId edge, const std::string &contig_id) const {
@@ -99,17 +197,18 @@ public:
         return *poss.begin();
     }
 
+    /// Positions of the edge ordered by contig name and mapping range
     std::vector<EdgePosition> GetEdgePositions(EdgeId edge) const {
-        VERIFY(this->IsAttached());
+        CheckUpToDate();
         auto edge_it = edges_positions_.find(edge);
         if (edge_it == edges_positions_.end())
             return {};
         std::vector<EdgePosition> result;
-        for (const auto &i : edge_it->second) {
-            for (const auto &pos : i.second) {
-                result.push_back(EdgePosition(i.first, pos));
-            }
-        }
+        result.reserve(edge_it->second.size());
+        for (const auto &pos : edge_it->second)
+            result.emplace_back(contig_names_[pos.contig], pos.mr);
+        std::stable_sort(result.begin(), result.end(),
+                         [](const EdgePosition &a, const EdgePosition &b) { return a.contigId < b.contigId; });
         return result;
     }
 
@@ -122,30 +221,20 @@ public:
         VERIFY(this->IsAttached());
         if (new_pos.empty())
             return;
-        auto &new_set = edges_positions_[edge][contig_id];
-        new_pos = EraseAndExtract(new_set, new_pos);
-        new_set.insert(new_pos);
-    }
-
-    void AddAndShiftEdgePositions(EdgeId edge, const std::map<std::string, RangeSet> &contig_map, int shift = 0) {
-        VERIFY(this->IsAttached());
-        for (const auto &contig : contig_map) {
-            for (const auto &e : contig.second) {
-                AddEdgePosition(edge, contig.first, e.Shift(shift).Fit(this->g().length(edge)));
-            }
-        }
+        uint32_t contig = ContigId(contig_id);
+        AddPosition(edges_positions_[edge], contig, new_pos);
     }
 
     template<typename Iter>
     void AddEdgePositions(EdgeId edge, Iter begin, Iter end) {
         VERIFY(this->IsAttached());
-        for (auto it = begin; it != end; ++it) {
-            AddEdgePosition(edge, it->contigId, it->mr);
-        }
+        PositionList batch;
+        for (auto it = begin; it != end; ++it)
+            batch.push_back(Position{ ContigId(it->contigId), it->mr });
+        AddPositions(edge, std::move(batch));
     }
 
     std::string str(EdgeId edge) const {
-        VERIFY(this->IsAttached());
         std::vector<EdgePosition> positions = GetEdgePositions(edge);
         size_t counter = 0;
         std::stringstream ss;
@@ -178,34 +267,42 @@ public:
         TRACE("~EdgePositionHandler ok");
     }
 
+    // Positions are not used during simplification, so they could be updated
+    // once per batch. Queries within the batch are rejected
+    bool IsDeferrable() const override {
+        return true;
+    }
+
     virtual void HandleGlue(EdgeId new_edge, EdgeId edge1, EdgeId edge2) {
-//        TRACE("Handle glue ");
-        auto positions1 = GetEdgePositions(edge1);
-        auto positions2 = GetEdgePositions(edge2);
-        AddEdgePositions(new_edge, positions1.begin(), positions1.end());
-        AddEdgePositions(new_edge, positions2.begin(), positions2.end());
+        PositionList batch;
+        for (EdgeId e : { edge1, edge2 }) {
+            auto it = edges_positions_.find(e);
+            if (it != edges_positions_.end())
+                batch.insert(batch.end(), it->second.begin(), it->second.end());
+        }
+        AddPositions(new_edge, std::move(batch));
     }
 
     virtual void HandleSplit(EdgeId oldEdge, EdgeId newEdge1, EdgeId newEdge2) {
-        if (oldEdge == this->g().conjugate(oldEdge)) {
+        if (oldEdge == this->conjugate(oldEdge)) {
             WARN("EdgesPositionHandler does not support self-conjugate splits");
             return;
         }
-        if (edges_positions_.count(oldEdge) != 0) {
-            auto contig_map = edges_positions_[oldEdge];
-            AddAndShiftEdgePositions(newEdge1, contig_map, 0);
-            AddAndShiftEdgePositions(newEdge2, contig_map, -int(this->g().length(newEdge1)));
-        }
+        PositionList batch1, batch2;
+        CollectShifted(batch1, oldEdge, newEdge1, 0);
+        CollectShifted(batch2, oldEdge, newEdge2, -int(this->length(newEdge1)));
+        AddPositions(newEdge1, std::move(batch1));
+        AddPositions(newEdge2, std::move(batch2));
     }
 
     virtual void HandleMerge(const std::vector<EdgeId> &oldEdges, EdgeId newEdge) {
+        PositionList batch;
         int shift = 0;
         for (const auto &e : oldEdges) {
-            if (edges_positions_.count(e)) {
-                AddAndShiftEdgePositions(newEdge, edges_positions_[e], shift);
-            }
-            shift += int(this->g().length(e));
+            CollectShifted(batch, e, newEdge, shift);
+            shift += int(this->length(e));
         }
+        AddPositions(newEdge, std::move(batch));
     }
 
     virtual void HandleAdd(EdgeId /*e*/) {
@@ -217,6 +314,8 @@ public:
 
     void clear() {
         edges_positions_.clear();
+        contig_ids_.clear();
+        contig_names_.clear();
     }
 
 private:
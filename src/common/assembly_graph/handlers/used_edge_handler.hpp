@@ -4,7 +4,7 @@
 //****************************************************************************
 #pragma once
 #include "assembly_graph/core/action_handlers.hpp"
-#include <unordered_map>
+#include "assembly_graph/core/graph_maps.hpp"
 
 using namespace omnigraph;
 
@@ -14,12 +14,12 @@ namespace omnigraph {
     class UsedEdgeHandler : omnigraph::GraphActionHandler<Graph> {
         typedef typename Graph::EdgeId EdgeId;
 
-        std::unordered_map<EdgeId, size_t> storage_;
+        EdgeMap<Graph, size_t> storage_;
         size_t banned_bases_ = 0;
 
     public:
         UsedEdgeHandler(const Graph &g) :
-                omnigraph::GraphActionHandler<Graph>(g, "UsedEdgeHandler"), storage_() { }
+                omnigraph::GraphActionHandler<Graph>(g, "UsedEdgeHandler"), storage_(g) { }
 
         void HandleAdd(EdgeId e) override {
             storage_.emplace(e, 0);
@@ -34,9 +34,8 @@ namespace omnigraph {
             size_t sum = 0;
             for (EdgeId e : old_edges) {
                 DEBUG(e.int_id());
-                auto it = storage_.find(e);
-                if (it != storage_.end())
-                    sum += it->second;
+                if (storage_.count(e))
+                    sum += storage_[e];
             }
             DEBUG("into " << new_edge.int_id());
             storage_[new_edge] = sum;
@@ -52,10 +51,7 @@ namespace omnigraph {
         }
 
         void AddUsed(EdgeId e) {
-            size_t was_used = 0;
-            auto it = storage_.find(e);
-            if (it != storage_.end())
-                was_used = it->second;
+            size_t was_used = storage_.count(e) ? storage_[e] : 0;
 
             size_t new_used = this->g().length(e);
             VERIFY(new_used >= was_used);
@@ -64,8 +60,7 @@ namespace omnigraph {
         }
 
         size_t GetUsedLength(EdgeId e) const {
-                auto it = storage_.find(e);
-                return it != storage_.end() ? it->second : 0;
+                return storage_.count(e) ? storage_[e] : 0;
         }
 
         size_t size() const {
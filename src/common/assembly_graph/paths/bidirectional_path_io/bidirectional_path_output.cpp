@@ -30,12 +30,13 @@ std::string PathWriter::ToPathString(const BidirectionalPath &path) const {
 
 void FastgPathWriter::WritePaths(const ScaffoldStorage &scaffold_storage, const std::filesystem::path &fn) const {
     std::ofstream os(fn);
-    for (const auto& scaffold_info : scaffold_storage) {
-        os << scaffold_info.name << "\n"
-           << path_writer_.ToPathString(*scaffold_info.path) << "\n"
-           << scaffold_info.name << "'" << "\n"
-           << path_writer_.ToPathString(*scaffold_info.path->GetConjPath()) << "\n";
-    }
+    io::OrderedWriter(os).Write(scaffold_storage.size(), [&](size_t i, std::string &buf) {
+        const auto& scaffold_info = scaffold_storage[i];
+        buf += scaffold_info.name + "\n";
+        buf += path_writer_.ToPathString(*scaffold_info.path) + "\n";
+        buf += scaffold_info.name + "'" + "\n";
+        buf += path_writer_.ToPathString(*scaffold_info.path->GetConjPath()) + "\n";
+    });
 }
 
 void GFAPathWriter::WritePath(const std::string &name, size_t segment_id,
@@ -193,50 +194,58 @@ void GFAPathWriter::WritePaths12(const ScaffoldStorage &scaffold_storage) {
 
     WriteJumpLinks(jump_links);
 
-    for (const auto& scaffold_info : scaffold_storage) {
-        const path_extend::BidirectionalPath &p = *scaffold_info.path;
+    io::OrderedWriter(os_).Write(scaffold_storage.size(), [&](size_t idx, std::string &buf) {
+        const path_extend::BidirectionalPath &p = *scaffold_storage[idx].path;
         if (p.Size() == 0)
-            continue;
+            return;
 
-        os_ << 'P' << '\t'
-            << scaffold_info.name << '\t';
-        std::string delimiter = "";
+        buf += "P\t" + scaffold_storage[idx].name + '\t';
         for (size_t i = 0; i < p.Size() - 1; ++i) {
             EdgeId e = p[i];
-            os_ << delimiter << edge_namer_.EdgeOrientationString(e);
-            delimiter = (graph_.EdgeEnd(e) == graph_.EdgeStart(p[i+1]) ? "," : ";");
+            buf += edge_namer_.EdgeOrientationString(e);
+            buf += (graph_.EdgeEnd(e) == graph_.EdgeStart(p[i+1]) ? ',' : ';');
         }
-        os_ << delimiter << edge_namer_.EdgeOrientationString(p.Back())
-            << '\t' << '*';
+        buf += edge_namer_.EdgeOrientationString(p.Back()) + "\t*";
         if (p.IsCircular())
-            os_ << '\t' << "TP:Z:circular";
-        os_ << '\n';
-    }
+            buf += "\tTP:Z:circular";
+        buf += '\n';
+    });
 }
 
 void GFAPathWriter::WritePaths11(const ScaffoldStorage &scaffold_storage) {
-    for (const auto& scaffold_info : scaffold_storage) {
+    io::OrderedWriter(os_).Write(scaffold_storage.size(), [&](size_t idx, std::string &buf) {
+        const auto& scaffold_info = scaffold_storage[idx];
         const path_extend::BidirectionalPath &p = *scaffold_info.path;
         if (p.Size() == 0)
-            continue;
+            return;
+
+        // Same layout as WritePath() produces
+        auto append_segment = [&](size_t segment_id, size_t from, size_t to, const char *flags) {
+            buf += "P\t" + scaffold_info.name + '_' + std::to_string(segment_id) + '\t';
+            for (size_t i = from; i < to; ++i) {
+                if (i != from)
+                    buf += ',';
+                buf += edge_namer_.EdgeOrientationString(p[i]);
+            }
+            buf += "\t*";
+            if (*flags)
+                buf += std::string("\t") + flags;
+            buf += '\n';
+        };
 
-        std::vector<std::string> segmented_path;
-        // size_t id = p.GetId();
-        size_t segment_id = 1;
+        size_t segment_id = 1, segment_start = 0;
         for (size_t i = 0; i < p.Size() - 1; ++i) {
             EdgeId e = p[i];
-            segmented_path.push_back(edge_namer_.EdgeOrientationString(e));
             if (graph_.EdgeEnd(e) != graph_.EdgeStart(p[i+1]) || p.GapAt(i+1).gap > 0) {
-                WritePath(scaffold_info.name, segment_id, segmented_path);
+                append_segment(segment_id, segment_start, i + 1, "");
                 segment_id++;
-                segmented_path.clear();
+                segment_start = i + 1;
             }
         }
 
-        segmented_path.push_back(edge_namer_.EdgeOrientationString(p.Back()));
-        WritePath(scaffold_info.name, segment_id, segmented_path,
-                  segment_id == 1 && p.IsCircular() ? "TP:Z:circular" : "");
-    }
+        append_segment(segment_id, segment_start, p.Size(),
+                       segment_id == 1 && p.IsCircular() ? "TP:Z:circular" : "");
+    });
 }
 
 
@@ -245,17 +254,24 @@ void ContigWriter::OutputPaths(const PathContainer &paths, const std::vector<Pat
 
     ScaffoldSequenceMaker scaffold_maker(g_);
     DEBUG("started" << paths.size());
+    std::vector<const BidirectionalPath*> nonempty;
     for (auto iter = paths.begin(); iter != paths.end(); ++iter) {
         const BidirectionalPath &path = iter.get();
         DEBUG("path: " <<  path.Length());
-        if (path.Length() <= 0)
-            continue;
-        auto path_string = scaffold_maker.MakeSequence(path);
-        if (path_string.length() >= g_.k()) {
-            storage.emplace_back(path_string, &path);
-        }
-        DEBUG("over");
+        if (path.Length() > 0)
+            nonempty.push_back(&path);
+    }
+
+    // Sequences are assembled in parallel, but kept in the order of paths
+    std::vector<std::string> sequences(nonempty.size());
+    parallel::parallel_for(size_t(0), nonempty.size(), [&](size_t i) {
+        sequences[i] = scaffold_maker.MakeSequence(*nonempty[i]);
+    });
+    for (size_t i = 0; i < nonempty.size(); ++i) {
+        if (sequences[i].length() >= g_.k())
+            storage.emplace_back(std::move(sequences[i]), nonempty[i]);
     }
+    DEBUG("over");
     DEBUG("sort");
     //sorting by length and coverage
     std::sort(storage.begin(), storage.end(), [] (const ScaffoldInfo &a, const ScaffoldInfo &b) {
@@ -14,6 +14,7 @@
 #include "io/graph/gfa_writer.hpp"
 #include "io/graph/fastg_writer.hpp"
 #include "io/reads/osequencestream.hpp"
+#include "io/utils/ordered_writer.hpp"
 
 #include <unordered_set>
 
@@ -109,14 +110,15 @@ class ContigWriter {
     std::shared_ptr<ContigNameGenerator> name_generator_;
 
 public:
+    /// Records are formatted in parallel; the output is gzipped if fn ends with .gz
     static void WriteScaffolds(const ScaffoldStorage &scaffold_storage, const std::filesystem::path &fn) {
-        io::OFastaReadStream oss(fn);
-        std::ofstream os_fastg;
-
-        for (const auto& scaffold_info : scaffold_storage) {
+        std::ofstream os(fn, std::ios::binary);
+        io::OrderedWriter writer(os, fn.extension() == ".gz");
+        writer.Write(scaffold_storage.size(), [&](size_t i, std::string &buf) {
+            const auto &scaffold_info = scaffold_storage[i];
             TRACE("Scaffold " << scaffold_info.name << " originates from path " << scaffold_info.path->str());
-            oss << io::SingleRead(scaffold_info.name, scaffold_info.sequence);
-        }
+            io::AppendFasta(buf, scaffold_info.name, scaffold_info.sequence);
+        });
     }
 
     static PathsWriterT BasicFastaWriter(const std::filesystem::path &fn) {
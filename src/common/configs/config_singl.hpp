@@ -25,6 +25,12 @@ struct config {
         is_initialized() = true;
     }
 
+    // Drops the loaded config, so it could be loaded from scratch again
+    static void reset() {
+        inner_cfg() = Config();
+        is_initialized() = false;
+    }
+
     static Config const &get() {
         VERIFY_MSG(is_initialized(), "Config not initialized");
         return inner_cfg();
@@ -126,6 +126,12 @@ std::vector<std::string> BrokenScaffoldsModeNames() {
                                              {"break_all", output_broken_scaffolds::break_all}}, output_broken_scaffolds::total);
 }
 
+std::vector<std::string> ConstructionModeNames() {
+    return CheckedNames<construction_mode>({
+                    {"extension", construction_mode::extension},
+                    {"minimizer", construction_mode::minimizer}}, construction_mode::total);
+}
+
 template<class T>
 void LoadFromYaml(const std::filesystem::path& filename, T &t) {
     auto ifs = fs::open_file(filename, std::ios::binary);
@@ -209,6 +215,13 @@ void load(output_broken_scaffolds &obs, boost::property_tree::ptree const &pt,
     }
 }
 
+void load(construction_mode &cm, boost::property_tree::ptree const &pt,
+          std::string const &key, bool complete) {
+    if (complete || pt.find(key) != pt.not_found()) {
+        cm = ModeByName<construction_mode>(pt.get<std::string>(key), ConstructionModeNames());
+    }
+}
+
 void load(debruijn_config::construction::early_tip_clipper& etc,
           boost::property_tree::ptree const& pt, bool) {
     using config_common::load;
@@ -220,6 +233,7 @@ void load(debruijn_config::construction::early_tip_clipper& etc,
 void load(debruijn_config::construction& con,
           boost::property_tree::ptree const& pt, bool complete) {
     using config_common::load;
+    load(con.con_mode, pt, "mode", complete);
     load(con.keep_perfect_loops, pt, "keep_perfect_loops", complete);
     load(con.read_buffer_size, pt, "read_buffer_size", complete);
     load(con.read_cov_threshold, pt, "read_cov_threshold", complete);
@@ -561,6 +575,8 @@ void load(debruijn_config::time_tracing& tt,
   using config_common::load;
   load(tt.enable, pt, "time_tracer_enabled", true);
   load(tt.granularity, pt, "granularity", 500);
+  load(tt.telemetry, pt, "telemetry_enabled", true);
+  load(tt.telemetry_interval, pt, "telemetry_interval", true);
 }
 
 void load(debruijn_config::hmm_matching& hm,
@@ -700,6 +716,7 @@ void load_launch_info(debruijn_config &cfg, boost::property_tree::ptree const &p
     load(cfg.log_filename, pt, "log_filename");
 
     cfg.checkpoints = ModeByNameOrName<Checkpoints>(pt.get("checkpoints", "none"), {"none", "last", "all"});
+    load(cfg.async_checkpoints, pt, "async_checkpoints");
 
     load(cfg.developer_mode, pt, "developer_mode");
     if (cfg.developer_mode) {
@@ -730,6 +747,7 @@ void load_launch_info(debruijn_config &cfg, boost::property_tree::ptree const &p
 
     load(cfg.max_threads, pt, "max_threads");
     cfg.max_threads = spades_set_omp_threads(cfg.max_threads);
+    load(cfg.pin_task_workers, pt, "pin_task_workers");
 
     load(cfg.max_memory, pt, "max_memory");
 
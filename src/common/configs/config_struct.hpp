@@ -87,6 +87,15 @@ enum class output_broken_scaffolds: char {
     total
 };
 
+enum class construction_mode : char {
+    extension = 0,
+    minimizer,
+
+    total
+};
+
+std::vector<std::string> ConstructionModeNames();
+
 enum class Checkpoints : char {
     None = 0,
     Last,
@@ -312,11 +321,13 @@ struct debruijn_config {
             early_tip_clipper() : enable(false) {}
         };
 
+        construction_mode con_mode;
         early_tip_clipper early_tc;
         bool keep_perfect_loops;
         unsigned read_cov_threshold;
         size_t read_buffer_size;
         construction() :
+                con_mode(construction_mode::extension),
                 keep_perfect_loops(true),
                 read_cov_threshold(0),
                 read_buffer_size(0) {}
@@ -415,6 +426,8 @@ struct debruijn_config {
     struct time_tracing {
         bool enable;
         unsigned granularity;
+        bool telemetry;
+        unsigned telemetry_interval;
     };
     
     typedef std::map<info_printer_pos, info_printer> info_printers_t;
@@ -425,6 +438,7 @@ struct debruijn_config {
     std::filesystem::path output_dir;
     std::filesystem::path tmp_dir;
     std::variant<Checkpoints, std::string> checkpoints;
+    bool async_checkpoints;
     std::filesystem::path output_saves;
     std::filesystem::path log_filename;
     std::string series_analysis;
@@ -487,6 +501,7 @@ struct debruijn_config {
     bool main_iteration;
 
     unsigned max_threads;
+    bool pin_task_workers;
     size_t max_memory;
 
     resolving_mode rm;
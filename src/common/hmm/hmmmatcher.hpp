@@ -27,6 +27,9 @@ struct hmmer_cfg {
     bool cut_ga; bool cut_nc; bool cut_tc;
     size_t Z;
     bool max; double F1; double F2; double F3; bool nobias;
+    // Reseed the RNG of the domain definition for every sequence, so the results
+    // do not depend on the order (and the grouping) of the matched sequences
+    bool reseed;
 
     hmmer_cfg()
             : acc(false), noali(false),
@@ -34,7 +37,8 @@ struct hmmer_cfg {
               incE(0.01), incT(0.0), incdomE(0.01), incdomT(0),
               cut_ga(false), cut_nc(false), cut_tc(false),
               Z(0),
-              max(false), F1(0.02), F2(1e-3), F3(1e-5), nobias(false)
+              max(false), F1(0.02), F2(1e-3), F3(1e-5), nobias(false),
+              reseed(false)
     {}
 };
 
@@ -130,6 +134,8 @@ class HMMMatcher {
     HMMMatcher(const HMM &hmmw,
                const hmmer_cfg &cfg);
     void match(const char *name, const char *seq, const char *desc = NULL);
+    /// Matches the sequence already digitized with the alphabet of the profile type
+    void match(const ESL_SQ *dbsq);
 
     void reset();
     void summarize();
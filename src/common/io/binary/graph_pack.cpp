@@ -18,6 +18,14 @@
 #include "positions.hpp"
 #include "trusted_paths.hpp"
 
+#include "utils/filesystem/file_opener.hpp"
+#include "utils/parallel/openmp_wrapper.h"
+
+#include <zlib.h>
+
+#include <filesystem>
+#include <streambuf>
+
 namespace io {
 
 namespace binary {
@@ -198,6 +206,9 @@ void BasePackIO::Save(const std::string &basename, const Type &gp) {
 }
 
 bool BasePackIO::Load(const std::string &basename, Type &gp) {
+    if (PackSnapshot::Exists(basename))
+        return PackSnapshot::Load(basename, gp, /*full*/false);
+
     Loader loader(basename, gp);
 
     using namespace omnigraph;
@@ -298,6 +309,9 @@ void FullPackIO::Save(const std::string &basename, const Type &gp) {
 }
 
 bool FullPackIO::Load(const std::string &basename, Type &gp) {
+    if (PackSnapshot::Exists(basename))
+        return PackSnapshot::Load(basename, gp, /*full*/true);
+
     using namespace omnigraph::de;
     using namespace debruijn_graph;
 
@@ -386,6 +400,250 @@ bool FullPackIO::BinRead(std::istream &is, Type &gp) {
     return true;
 }
 
+namespace {
+
+/**
+ * @brief  Appends everything written into the stream to the string without
+ *         intermediate copies.
+ */
+class StringOutBuf : public std::streambuf {
+public:
+    StringOutBuf(std::string &str)
+        : str_(str) {}
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (!traits_type::eq_int_type(ch, traits_type::eof()))
+            str_.push_back(traits_type::to_char_type(ch));
+        return ch;
+    }
+
+    std::streamsize xsputn(const char *s, std::streamsize n) override {
+        str_.append(s, size_t(n));
+        return n;
+    }
+
+private:
+    std::string &str_;
+};
+
+/**
+ * @brief  Reads from the string without copying it.
+ */
+class StringInBuf : public std::streambuf {
+public:
+    StringInBuf(std::string &str) {
+        setg(str.data(), str.data(), str.data() + str.size());
+    }
+};
+
+using GraphPack = graph_pack::GraphPack;
+
+struct SnapshotComponentIO {
+    const char *name;
+    bool base; // processed by BasePackIO
+    void (*write)(std::ostream &, const GraphPack &);
+    void (*read)(std::istream &, GraphPack &);
+};
+
+template<typename T>
+SnapshotComponentIO AttachedComponentIO(const char *name) {
+    return { name, true,
+             [](std::ostream &os, const GraphPack &gp) { BinWriter(os, gp).Write<T>(); },
+             [](std::istream &is, GraphPack &gp) { BinReader(is, gp).Read<T>(); } };
+}
+
+/**
+ * @brief  Components of the snapshot. The graph must go first, since the rest
+ *         of the components refer to its edges.
+ */
+const std::vector<SnapshotComponentIO> &SnapshotComponents() {
+    using namespace omnigraph;
+    using namespace omnigraph::de;
+    using namespace debruijn_graph;
+
+    static const std::vector<SnapshotComponentIO> components = {
+        { "graph", true,
+          [](std::ostream &os, const GraphPack &gp) { BasicGraphIO<Graph>().BinWrite(os, gp.get<Graph>()); },
+          [](std::istream &is, GraphPack &gp) { BasicGraphIO<Graph>().BinRead(is, gp.get_mutable<Graph>()); } },
+        AttachedComponentIO<EdgesPositionHandler<Graph>>("positions"),
+        AttachedComponentIO<EdgeIndex<Graph>>("edge_index"),
+        AttachedComponentIO<KmerMapper<Graph>>("kmer_mapper"),
+        AttachedComponentIO<FlankingCoverage<Graph>>("flanking_coverage"),
+        { "paired_indices", false,
+          [](std::ostream &os, const GraphPack &gp) { BinWriteComponent<UnclusteredPairedInfoIndicesT<Graph>>(os, gp); },
+          [](std::istream &is, GraphPack &gp) { BinReadComponent<UnclusteredPairedInfoIndicesT<Graph>>(is, gp); } },
+        { "clustered_indices", false,
+          [](std::ostream &os, const GraphPack &gp) { BinWriteComponent<PairedInfoIndicesT<Graph>>(os, gp, "clustered_indices"); },
+          [](std::istream &is, GraphPack &gp) { BinReadComponent<PairedInfoIndicesT<Graph>>(is, gp, "clustered_indices"); } },
+        { "scaffolding_indices", false,
+          [](std::ostream &os, const GraphPack &gp) { BinWriteComponent<PairedInfoIndicesT<Graph>>(os, gp, "scaffolding_indices"); },
+          [](std::istream &is, GraphPack &gp) { BinReadComponent<PairedInfoIndicesT<Graph>>(is, gp, "scaffolding_indices"); } },
+        { "long_reads", false,
+          [](std::ostream &os, const GraphPack &gp) { BinWriteComponent<LongReadContainer<Graph>>(os, gp); },
+          [](std::istream &is, GraphPack &gp) { BinReadComponent<LongReadContainer<Graph>>(is, gp); } },
+        { "genomic_info", false,
+          [](std::ostream &os, const GraphPack &gp) { BinWriteComponent<GenomicInfo>(os, gp); },
+          [](std::istream &is, GraphPack &gp) { BinReadComponent<GenomicInfo>(is, gp); } },
+        { "ss_coverage", false,
+          [](std::ostream &os, const GraphPack &gp) { BinWriteComponent<SSCoverageContainer>(os, gp); },
+          [](std::istream &is, GraphPack &gp) { BinReadComponent<SSCoverageContainer>(is, gp); } },
+        { "trusted_paths", false,
+          [](std::ostream &os, const GraphPack &gp) { BinWriteComponent<path_extend::TrustedPathsContainer>(os, gp); },
+          [](std::istream &is, GraphPack &gp) { BinReadComponent<path_extend::TrustedPathsContainer>(is, gp); } },
+    };
+
+    return components;
+}
+
+const uint64_t SNAPSHOT_MAGIC = 0x3130535047534453ull; // "SDSGPS01"
+const size_t SNAPSHOT_BLOCK_SIZE = 16 << 20;
+
+} // namespace
+
+PackSnapshot PackSnapshot::Take(const GraphPack &gp, int compression_level) {
+    const auto &ios = SnapshotComponents();
+
+    PackSnapshot snapshot;
+    snapshot.components_.resize(ios.size());
+
+    // Serialize all of the components, then split into blocks
+    std::vector<std::string> raw(ios.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < ios.size(); ++i) {
+        StringOutBuf buf(raw[i]);
+        std::ostream os(&buf);
+        ios[i].write(os, gp);
+        snapshot.components_[i].name = ios[i].name;
+    }
+
+    std::vector<std::pair<size_t, size_t>> blocks;
+    for (size_t i = 0; i < raw.size(); ++i) {
+        size_t block_cnt = (raw[i].size() + SNAPSHOT_BLOCK_SIZE - 1) / SNAPSHOT_BLOCK_SIZE;
+        snapshot.components_[i].blocks.resize(block_cnt);
+        for (size_t j = 0; j < block_cnt; ++j)
+            blocks.emplace_back(i, j);
+    }
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        auto [i, j] = blocks[b];
+        const char *start = raw[i].data() + j * SNAPSHOT_BLOCK_SIZE;
+        size_t size = std::min(SNAPSHOT_BLOCK_SIZE, raw[i].size() - j * SNAPSHOT_BLOCK_SIZE);
+
+        Block &block = snapshot.components_[i].blocks[j];
+        block.raw_size = size;
+        uLongf compressed_size = compressBound(uLong(size));
+        block.data.resize(compressed_size);
+        int res = compress2(reinterpret_cast<Bytef *>(block.data.data()), &compressed_size,
+                            reinterpret_cast<const Bytef *>(start), uLong(size), compression_level);
+        VERIFY_MSG(res == Z_OK, "Failed to compress " << snapshot.components_[i].name << ", error " << res);
+        block.data.resize(compressed_size);
+        block.data.shrink_to_fit();
+    }
+
+    DEBUG("Snapshot taken, " << snapshot.raw_size() << " bytes compressed to " << snapshot.compressed_size());
+    return snapshot;
+}
+
+void PackSnapshot::Save(const std::string &basename) const {
+    std::filesystem::path filename = basename + ext;
+    std::ofstream os(filename, std::ios::binary);
+    CHECK_FATAL_ERROR(os, "Cannot open " << filename << " for writing");
+    DEBUG("Saving snapshot into " << filename);
+
+    BinWrite(os, SNAPSHOT_MAGIC, components_.size());
+    for (const auto &component : components_) {
+        BinWrite(os, component.name, component.blocks.size());
+        for (const auto &block : component.blocks)
+            BinWrite(os, block.raw_size, block.data);
+    }
+
+    os.close();
+    CHECK_FATAL_ERROR(os, "Failed to write " << filename);
+}
+
+bool PackSnapshot::Exists(const std::string &basename) {
+    return std::filesystem::exists(basename + ext);
+}
+
+bool PackSnapshot::Load(const std::string &basename, GraphPack &gp, bool full) {
+    std::filesystem::path filename = basename + ext;
+    auto is = fs::open_file(filename, std::ios::binary);
+    INFO("Loading snapshot from " << filename);
+
+    // Failures are reported via std::ios_base::failure, so the stage manager
+    // could roll back to the previous checkpoint
+    if (BinRead<uint64_t>(is) != SNAPSHOT_MAGIC)
+        throw std::ios_base::failure(filename.string() + " is not a graph pack snapshot");
+    size_t component_cnt = BinRead<size_t>(is);
+
+    const auto &ios = SnapshotComponents();
+    for (size_t c = 0; c < component_cnt; ++c) {
+        Component component;
+        component.name = BinRead<std::string>(is);
+        component.blocks.resize(BinRead<size_t>(is));
+        for (auto &block : component.blocks)
+            BinRead(is, block.raw_size, block.data);
+
+        auto io = std::find_if(ios.begin(), ios.end(),
+                               [&](const SnapshotComponentIO &io) { return component.name == io.name; });
+        if (io == ios.end()) {
+            WARN("Unknown graph pack component " << component.name << ", skipping");
+            continue;
+        }
+        if (!full && !io->base)
+            continue;
+
+        std::vector<size_t> offsets{0};
+        for (const auto &block : component.blocks)
+            offsets.push_back(offsets.back() + block.raw_size);
+
+        std::string raw(offsets.back(), '\0');
+        bool corrupted = false;
+        #pragma omp parallel for schedule(dynamic)
+        for (size_t j = 0; j < component.blocks.size(); ++j) {
+            const Block &block = component.blocks[j];
+            uLongf size = uLongf(block.raw_size);
+            int res = uncompress(reinterpret_cast<Bytef *>(raw.data() + offsets[j]), &size,
+                                 reinterpret_cast<const Bytef *>(block.data.data()), uLong(block.data.size()));
+            if (res != Z_OK || size != block.raw_size) {
+                #pragma omp atomic write
+                corrupted = true;
+            }
+        }
+        if (corrupted)
+            throw std::ios_base::failure("Failed to decompress " + component.name + " from " + filename.string());
+
+        StringInBuf buf(raw);
+        std::istream component_is(&buf);
+        component_is.exceptions(std::ios_base::failbit | std::ios_base::badbit);
+        try {
+            io->read(component_is, gp);
+        } catch (const std::ios_base::failure &) {
+            throw std::ios_base::failure("Failed to read " + component.name + " from " + filename.string());
+        }
+    }
+
+    return true;
+}
+
+size_t PackSnapshot::raw_size() const {
+    size_t res = 0;
+    for (const auto &component : components_)
+        for (const auto &block : component.blocks)
+            res += block.raw_size;
+    return res;
+}
+
+size_t PackSnapshot::compressed_size() const {
+    size_t res = 0;
+    for (const auto &component : components_)
+        for (const auto &block : component.blocks)
+            res += block.data.size();
+    return res;
+}
+
 } // namespace binary
 
 } // namespace io
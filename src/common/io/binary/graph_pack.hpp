@@ -10,6 +10,10 @@
 #include "basic.hpp"
 #include "pipeline/graph_pack.hpp"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 namespace io {
 
 namespace binary {
@@ -50,6 +54,51 @@ public:
     bool BinRead(std::istream &is, Type &gp) override;
 };
 
+/**
+ * @brief  Compressed in-memory image of the graph pack. The components are serialized
+ *         and compressed (in blocks) in parallel, so the snapshot is taken quickly and
+ *         could be written to disk later, e.g. from a background thread, while the
+ *         graph pack itself is already being modified.
+ *
+ *         The snapshot is stored as a single <basename>.gps file. BasePackIO / FullPackIO
+ *         load it transparently if it is present.
+ */
+class PackSnapshot {
+public:
+    static constexpr const char *ext = ".gps";
+
+    static PackSnapshot Take(const graph_pack::GraphPack &gp, int compression_level = 1);
+
+    void Save(const std::string &basename) const;
+
+    static bool Exists(const std::string &basename);
+
+    /**
+     * @param full  whether to load all of the components, or only the ones
+     *              processed by BasePackIO
+     * @throw std::ios_base::failure if the snapshot is missing, truncated or corrupted
+     */
+    static bool Load(const std::string &basename, graph_pack::GraphPack &gp, bool full = true);
+
+    size_t raw_size() const;
+    size_t compressed_size() const;
+
+private:
+    struct Block {
+        uint64_t raw_size;
+        std::string data;
+    };
+
+    struct Component {
+        std::string name;
+        std::vector<Block> blocks;
+    };
+
+    std::vector<Component> components_;
+
+    DECL_LOGGER("PackSnapshot");
+};
+
 } // namespace binary
 
 } // namespace io
@@ -0,0 +1,91 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "resident_reads.hpp"
+
+#include "io/reads/rc_reader_wrapper.hpp"
+#include "utils/logger/logger.hpp"
+#include "utils/parallel/openmp_wrapper.h"
+
+namespace io {
+
+ResidentReadStore &ResidentReadStore::instance() {
+    static ResidentReadStore store;
+    return store;
+}
+
+void ResidentReadStore::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    chunks_.clear();
+    used_bytes_ = 0;
+}
+
+size_t ResidentReadStore::EstimateBytes(const DataSet<LibraryData> &dataset_info,
+                                        const std::vector<size_t> &libs) {
+    // Packed nucleotides plus per-read Sequence overhead
+    size_t res = 0;
+    for (size_t lib : libs) {
+        const auto &data = dataset_info[lib].data();
+        res += data.total_nucls / 4 + data.read_count * (sizeof(SingleReadSeq) + 32);
+    }
+
+    return res;
+}
+
+BinarySingleStreams ResidentReadStore::single_readers_for_libs(DataSet<LibraryData> &dataset_info,
+                                                               const std::vector<size_t> &libs,
+                                                               bool followed_by_rc,
+                                                               bool including_paired_reads) {
+    if (!enabled())
+        return single_binary_readers_for_libs(dataset_info, libs, followed_by_rc, including_paired_reads);
+
+    Key key;
+    key.second = including_paired_reads;
+    for (size_t lib : libs)
+        key.first.push_back(dataset_info[lib].data().binary_reads_info.single_read_prefix);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto entry = chunks_.find(key);
+    if (entry == chunks_.end()) {
+        size_t bytes = EstimateBytes(dataset_info, libs);
+        if (used_bytes_ + bytes > max_bytes_) {
+            INFO("Reads do not fit into resident storage (" << bytes / 1024 / 1024 << "MB required), "
+                 "streaming from disk");
+            return single_binary_readers_for_libs(dataset_info, libs, followed_by_rc, including_paired_reads);
+        }
+
+        INFO("Loading reads into resident storage");
+        auto streams = single_binary_readers_for_libs(dataset_info, libs,
+                                                      /* followed_by_rc */ false, including_paired_reads);
+        Chunks chunks(streams.size());
+#       pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = 0; i < streams.size(); ++i) {
+            auto chunk = std::make_shared<Chunk>();
+            SingleReadSeq read;
+            auto &stream = streams[i];
+            while (!stream.eof()) {
+                stream >> read;
+                chunk->push_back(read);
+            }
+            chunk->shrink_to_fit();
+            chunks[i] = std::move(chunk);
+        }
+
+        used_bytes_ += bytes;
+        entry = chunks_.emplace(std::move(key), std::move(chunks)).first;
+    }
+
+    BinarySingleStreams res;
+    for (const auto &chunk : entry->second)
+        res.push_back(SharedVectorReadStream<SingleReadSeq>(chunk));
+
+    if (followed_by_rc)
+        res = RCWrap<SingleReadSeq>(std::move(res));
+
+    return res;
+}
+
+}
@@ -0,0 +1,86 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "read_converter.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace io {
+
+/**
+ * Stream over reads stored in memory. The storage is shared between all the
+ * streams, so creating the stream is cheap.
+ */
+template<class ReadType>
+class SharedVectorReadStream {
+public:
+    typedef std::vector<ReadType> Storage;
+
+    explicit SharedVectorReadStream(std::shared_ptr<const Storage> data)
+            : data_(std::move(data)), pos_(0), closed_(false) {}
+
+    bool is_open() const { return !closed_; }
+    bool eof() const { return pos_ == data_->size(); }
+
+    SharedVectorReadStream &operator>>(ReadType &read) {
+        VERIFY(!eof());
+        read = (*data_)[pos_++];
+        return *this;
+    }
+
+    void close() { closed_ = true; }
+    void reset() { pos_ = 0; }
+
+private:
+    std::shared_ptr<const Storage> data_;
+    size_t pos_;
+    bool closed_;
+};
+
+/**
+ * Process-wide storage of binary reads that survives the graph pack. Used when
+ * several K iterations are run within single process: the reads used for graph
+ * construction are loaded once and then served from memory. The storage is
+ * disabled by default and refuses to hold the reads if they do not fit into
+ * the memory limit specified.
+ */
+class ResidentReadStore {
+public:
+    static ResidentReadStore &instance();
+
+    void enable(size_t max_bytes) { max_bytes_ = max_bytes; }
+    bool enabled() const { return max_bytes_ != 0; }
+    void clear();
+
+    /// Same as single_binary_readers_for_libs(), but with reads served from
+    /// memory whenever possible
+    BinarySingleStreams single_readers_for_libs(DataSet<LibraryData> &dataset_info,
+                                                const std::vector<size_t> &libs,
+                                                bool followed_by_rc = true,
+                                                bool including_paired_reads = true);
+
+private:
+    using Chunk = SharedVectorReadStream<SingleReadSeq>::Storage;
+    using Chunks = std::vector<std::shared_ptr<const Chunk>>;
+    using Key = std::pair<std::vector<std::string>, bool>;
+
+    ResidentReadStore() = default;
+
+    static size_t EstimateBytes(const DataSet<LibraryData> &dataset_info,
+                                const std::vector<size_t> &libs);
+
+    size_t max_bytes_ = 0;
+    size_t used_bytes_ = 0;
+    std::map<Key, Chunks> chunks_;
+    std::mutex mutex_;
+};
+
+}
@@ -0,0 +1,246 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "utils/parallel/openmp_wrapper.h"
+#include "utils/verify.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace io {
+
+/**
+ * @brief Pipelined batch processing of read streams.
+ * @detail Reads are parsed in batches by a dedicated reader thread, processed by a pool of
+ *         OpenMP worker threads (each worker takes the next available batch, so the load is
+ *         balanced dynamically) and, optionally, written in the original order by a dedicated
+ *         writer thread. All three stages run concurrently, so the throughput is limited by
+ *         the slowest one rather than by their sum. The number of batches in flight is bounded,
+ *         so the memory consumption does not depend on the input size.
+ *         The operation is called concurrently from the workers (omp_get_thread_num() is valid
+ *         inside it) and should be thread-safe.
+ */
+template<class Read>
+class BatchPipeline {
+    struct Batch {
+        size_t id = 0;
+        size_t size = 0;
+        std::vector<Read> reads;
+        std::vector<uint8_t> keep;
+    };
+
+  public:
+    BatchPipeline(unsigned nthreads, size_t batch_size = 1 << 12, size_t max_batches = 0)
+            : nthreads_(nthreads ? nthreads : 1),
+              batch_size_(batch_size),
+              max_batches_(max_batches ? max_batches : 4 * nthreads_ + 2) {}
+
+    /**
+     * @brief Processes all the reads and outputs the ones for which op(read) returned true.
+     * @return the number of reads written
+     */
+    template<class Reader, class Op, class Writer>
+    size_t Run(Reader &irs, Op &&op, Writer &writer) {
+        Reset();
+        std::thread reader([&] { ReadBatches(irs); });
+        std::thread output([&] { WriteBatches(writer); });
+        ProcessBatches([&](Batch &b) {
+            for (size_t i = 0; i < b.size; ++i)
+                b.keep[i] = op(static_cast<const Read&>(b.reads[i]));
+        }, /* ordered */ true);
+        reader.join();
+        output.join();
+        VERIFY(read_ == processed_);
+
+        return written_;
+    }
+
+    /**
+     * @brief Processes the reads until the end of the stream or until op(read) returns true.
+     *        In the latter case no new reads are taken from the stream, however all the
+     *        reads already read are still processed (as ReadProcessor does).
+     * @return true if the processing was stopped
+     */
+    template<class Reader, class Op>
+    bool Run(Reader &irs, Op &&op) {
+        Reset();
+        std::thread reader([&] { ReadBatches(irs); });
+        ProcessBatches([&](Batch &b) {
+            bool stop = false;
+            for (size_t i = 0; i < b.size; ++i)
+                stop |= op(static_cast<const Read&>(b.reads[i]));
+            if (stop) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+        }, /* ordered */ false);
+        reader.join();
+        VERIFY(read_ == processed_);
+
+        return stop_;
+    }
+
+    size_t read() const { return read_; }
+
+    size_t processed() const { return processed_; }
+
+    size_t written() const { return written_; }
+
+  private:
+    void Reset() {
+        ready_.clear();
+        done_.clear();
+        free_.clear();
+        pool_.clear();
+        read_ = processed_ = written_ = 0;
+        batches_read_ = 0;
+        input_done_ = stop_ = false;
+    }
+
+    Batch *AcquireBatch() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (free_.empty() && pool_.size() < max_batches_) {
+            pool_.emplace_back(new Batch());
+            pool_.back()->reads.resize(batch_size_);
+            pool_.back()->keep.resize(batch_size_);
+            return pool_.back().get();
+        }
+        free_cv_.wait(lock, [this] { return !free_.empty(); });
+        Batch *b = free_.back();
+        free_.pop_back();
+        return b;
+    }
+
+    void ReleaseBatch(Batch *b) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            free_.push_back(b);
+        }
+        free_cv_.notify_one();
+    }
+
+    template<class Reader>
+    void ReadBatches(Reader &irs) {
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stop_ || irs.eof())
+                    break;
+            }
+
+            Batch *b = AcquireBatch();
+            size_t cnt = 0;
+            while (cnt < batch_size_ && !irs.eof())
+                irs >> b->reads[cnt++];
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                b->id = batches_read_++;
+                b->size = cnt;
+                read_ += cnt;
+                ready_.push_back(b);
+            }
+            ready_cv_.notify_one();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            input_done_ = true;
+        }
+        ready_cv_.notify_all();
+        done_cv_.notify_all();
+    }
+
+    template<class F>
+    void ProcessBatches(F &&process, bool ordered) {
+#       pragma omp parallel num_threads(nthreads_)
+        {
+            while (true) {
+                Batch *b = nullptr;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    ready_cv_.wait(lock, [this] { return !ready_.empty() || input_done_; });
+                    if (ready_.empty())
+                        break;
+                    b = ready_.front();
+                    ready_.pop_front();
+                }
+
+                process(*b);
+
+                if (ordered) {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        processed_ += b->size;
+                        done_.emplace(b->id, b);
+                    }
+                    done_cv_.notify_one();
+                } else {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        processed_ += b->size;
+                    }
+                    ReleaseBatch(b);
+                }
+            }
+        }
+    }
+
+    template<class Writer>
+    void WriteBatches(Writer &writer) {
+        for (size_t next = 0; ; ++next) {
+            Batch *b = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                done_cv_.wait(lock, [&] {
+                    return done_.count(next) || (input_done_ && next == batches_read_);
+                });
+                auto it = done_.find(next);
+                if (it == done_.end())
+                    break;
+                b = it->second;
+                done_.erase(it);
+            }
+
+            size_t written = 0;
+            for (size_t i = 0; i < b->size; ++i) {
+                if (b->keep[i]) {
+                    writer << b->reads[i];
+                    written += 1;
+                }
+            }
+            written_ += written;
+
+            ReleaseBatch(b);
+        }
+    }
+
+    unsigned nthreads_;
+    size_t batch_size_;
+    size_t max_batches_;
+
+    std::vector<std::unique_ptr<Batch>> pool_;
+    std::vector<Batch*> free_;
+    std::deque<Batch*> ready_;
+    std::map<size_t, Batch*> done_;
+
+    size_t read_ = 0, processed_ = 0, written_ = 0;
+    size_t batches_read_ = 0;
+    bool input_done_ = false, stop_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable free_cv_, ready_cv_, done_cv_;
+};
+
+}
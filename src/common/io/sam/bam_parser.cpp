@@ -7,40 +7,67 @@
 
 #include "bam_parser.hpp"
 
-#include <bamtools/api/BamReader.h>
+#include "utils/parallel/openmp_wrapper.h"
+
+#include <algorithm>
 
 namespace io {
 
+namespace {
+// Records are decoded in batches to amortize the reader overhead
+const size_t BAM_PARSER_BATCH_SIZE = 1 << 12;
+// Parsers are frequently opened per-thread, so do not oversubscribe the CPU
+// with decompression threads; a few threads saturate the downstream consumer anyway
+const int BAM_PARSER_MAX_THREADS = 4;
+}
+
 BAMParser& BAMParser::operator>>(SingleRead& read) {
     if (!is_open_ || eof_)
         return *this;
 
-    if (flags_.use_name && flags_.use_quality)
-        read = SingleRead(seq_.Name, "", seq_.QueryBases, seq_.Qualities, flags_.offset,
+    BamRecordView rec = batch_[next_++];
+    rec.seq(seq_);
+    if (flags_.use_name && flags_.use_quality) {
+        name_.assign(rec.name());
+        rec.qual(qual_);
+        read = SingleRead(name_, "", seq_, qual_, flags_.offset,
                           0, 0, flags_.validate);
-    else if (flags_.use_name)
-        read = SingleRead(seq_.Name, "", seq_.QueryBases,
+    } else if (flags_.use_name) {
+        name_.assign(rec.name());
+        read = SingleRead(name_, "", seq_,
                           0, 0, flags_.validate);
-    else
-        read = SingleRead(seq_.QueryBases,
+    } else
+        read = SingleRead(seq_,
                           0, 0, flags_.validate);
 
-    eof_ = (false == reader_.GetNextAlignment(seq_));
+    fill();
 
     return *this;
 }
 
+void BAMParser::fill() {
+    if (next_ < batch_.size())
+        return;
+
+    next_ = 0;
+    eof_ = (0 == reader_->Read(batch_, BAM_PARSER_BATCH_SIZE));
+}
+
 void BAMParser::close() {
-    reader_.Close();
+    reader_.reset();
+    batch_.clear();
     is_open_ = false;
     eof_ = true;
 }
 
 void BAMParser::open() {
-    reader_.Open(filename_);
+    unsigned nthreads = unsigned(std::min(omp_get_max_threads(), BAM_PARSER_MAX_THREADS));
+    reader_.reset(new BamRecordReader(filename_, nthreads));
     is_open_ = true;
+    next_ = 0;
+    batch_.clear();
 
-    eof_ = (false == reader_.GetNextAlignment(seq_));
+    fill();
 }
 
 }
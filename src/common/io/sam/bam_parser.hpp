@@ -8,12 +8,13 @@
 
 #pragma once
 
+#include "bam_record_reader.hpp"
+
 #include "io/reads/file_read_flags.hpp"
 #include "io/reads/single_read.hpp"
 #include "io/reads/parser.hpp"
 
-#include "bamtools/api/BamReader.h"
-
+#include <memory>
 #include <string>
 
 namespace io {
@@ -37,10 +38,13 @@ public:
     void operator=(const BAMParser& parser) = delete;
 
 private:
-    BamTools::BamReader reader_;
-    BamTools::BamAlignment seq_;
+    std::unique_ptr<BamRecordReader> reader_;
+    BamRecordBatch batch_;
+    size_t next_ = 0;
+    std::string name_, seq_, qual_;
 
     void open();
+    void fill();
 };
 
 }
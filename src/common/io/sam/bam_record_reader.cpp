@@ -0,0 +1,77 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "bam_record_reader.hpp"
+
+#include "utils/verify.hpp"
+
+namespace io {
+
+namespace {
+const size_t BAM_CORE_SIZE = 32;
+}
+
+BamRecordReader::BamRecordReader(const std::filesystem::path &filename, unsigned nthreads)
+        : bgzf_(filename, nthreads), filename_(filename) {
+    ReadHeader();
+}
+
+void BamRecordReader::ReadHeader() {
+    char magic[4];
+    CHECK_FATAL_ERROR(bgzf_.read(magic, 4) == 4 && memcmp(magic, "BAM\1", 4) == 0,
+                      "Not a BAM file " << filename_);
+
+    auto read_i32 = [this]() {
+        int32_t res;
+        CHECK_FATAL_ERROR(bgzf_.read(&res, sizeof(res)) == sizeof(res), "Truncated BAM header in " << filename_);
+        return res;
+    };
+
+    int32_t l_text = read_i32();
+    CHECK_FATAL_ERROR(l_text >= 0, "Invalid BAM header in " << filename_);
+    header_text_.resize(size_t(l_text));
+    CHECK_FATAL_ERROR(bgzf_.read(&header_text_[0], header_text_.size()) == header_text_.size(),
+                      "Truncated BAM header in " << filename_);
+    // The text might be zero-padded
+    header_text_.resize(strnlen(header_text_.data(), header_text_.size()));
+
+    int32_t n_ref = read_i32();
+    CHECK_FATAL_ERROR(n_ref >= 0, "Invalid BAM header in " << filename_);
+    references_.reserve(size_t(n_ref));
+    for (int32_t i = 0; i < n_ref; ++i) {
+        int32_t l_name = read_i32();
+        CHECK_FATAL_ERROR(l_name > 0, "Invalid BAM header in " << filename_);
+        std::string name(size_t(l_name), '\0');
+        CHECK_FATAL_ERROR(bgzf_.read(&name[0], name.size()) == name.size(),
+                          "Truncated BAM header in " << filename_);
+        name.resize(name.size() - 1);
+        int32_t l_ref = read_i32();
+        references_.emplace_back(std::move(name), uint32_t(l_ref));
+    }
+}
+
+size_t BamRecordReader::Read(BamRecordBatch &batch, size_t max_records) {
+    batch.clear();
+    batch.offsets_.push_back(0);
+    while (batch.size() < max_records) {
+        int32_t block_size;
+        size_t cnt = bgzf_.read(&block_size, sizeof(block_size));
+        if (cnt == 0)
+            break;
+        CHECK_FATAL_ERROR(cnt == sizeof(block_size) && block_size >= int32_t(BAM_CORE_SIZE),
+                          "Invalid BAM record in " << filename_);
+
+        size_t offset = batch.arena_.size();
+        batch.arena_.resize(offset + size_t(block_size));
+        CHECK_FATAL_ERROR(bgzf_.read(batch.arena_.data() + offset, size_t(block_size)) == size_t(block_size),
+                          "Truncated BAM record in " << filename_);
+        batch.offsets_.push_back(batch.arena_.size());
+    }
+
+    return batch.size();
+}
+
+}
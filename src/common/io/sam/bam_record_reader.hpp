@@ -0,0 +1,155 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "bgzf_reader.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace io {
+
+/**
+ * @brief Non-owning view of a single BAM record stored in BamRecordBatch.
+ * @detail Fixed fields are decoded on access; sequence and qualities are
+ *         unpacked into the buffers provided by the caller, so the buffers
+ *         could be reused between the records.
+ */
+class BamRecordView {
+  public:
+    explicit BamRecordView(const uint8_t *data, size_t size)
+            : data_(data), size_(size) {}
+
+    size_t size() const { return size_; }
+
+    int32_t ref_id() const { return Load<int32_t>(0); }
+    int32_t pos() const { return Load<int32_t>(4); }
+    uint8_t map_qual() const { return data_[9]; }
+    uint16_t flag() const { return Load<uint16_t>(14); }
+    int32_t mate_ref_id() const { return Load<int32_t>(20); }
+    int32_t mate_pos() const { return Load<int32_t>(24); }
+    int32_t template_len() const { return Load<int32_t>(28); }
+
+    bool is_aligned() const { return (flag() & 0x4) == 0; }
+    bool is_main_alignment() const { return (flag() & 0x900) == 0; }
+    bool strand() const { return (flag() & 0x10) == 0; }
+
+    std::string_view name() const {
+        // l_read_name includes the terminating zero
+        return std::string_view(reinterpret_cast<const char*>(data_ + CORE_SIZE), size_t(data_[8]) - 1);
+    }
+
+    size_t cigar_len() const { return Load<uint16_t>(12); }
+
+    /// Raw CIGAR operation (length << 4 | op), see bam_cigar_oplen / bam_cigar_op
+    uint32_t cigar(size_t i) const { return Load<uint32_t>(cigar_offset() + 4 * i); }
+
+    size_t seq_len() const { return size_t(Load<int32_t>(16)); }
+
+    /// Unpacks the sequence (in IUPAC letters) into out
+    void seq(std::string &out) const {
+        static const char LOOKUP[] = "=ACMGRSVTWYHKDBN";
+        size_t len = seq_len();
+        const uint8_t *packed = data_ + seq_offset();
+        out.resize(len);
+        for (size_t i = 0; i + 1 < len; i += 2) {
+            out[i] = LOOKUP[packed[i / 2] >> 4];
+            out[i + 1] = LOOKUP[packed[i / 2] & 0xF];
+        }
+        if (len & 1)
+            out[len - 1] = LOOKUP[packed[len / 2] >> 4];
+    }
+
+    /// Unpacks the qualities into out as Phred+33 characters. Missing qualities are returned as 0xFF.
+    void qual(std::string &out) const {
+        size_t len = seq_len();
+        const uint8_t *q = data_ + seq_offset() + (len + 1) / 2;
+        out.resize(len);
+        if (len && q[0] == 0xFF) {
+            std::fill(out.begin(), out.end(), char(0xFF));
+            return;
+        }
+        for (size_t i = 0; i < len; ++i)
+            out[i] = char(q[i] + 33);
+    }
+
+  private:
+    static constexpr size_t CORE_SIZE = 32;
+
+    template<class T>
+    T Load(size_t offset) const {
+        T res;
+        memcpy(&res, data_ + offset, sizeof(T));
+        return res;
+    }
+
+    size_t cigar_offset() const { return CORE_SIZE + data_[8]; }
+    size_t seq_offset() const { return cigar_offset() + 4 * cigar_len(); }
+
+    const uint8_t *data_;
+    size_t size_;
+};
+
+/**
+ * @brief Batch of raw BAM records stored back to back in a flat arena.
+ * @detail The arena memory is retained between the batches, so reading into
+ *         the same batch repeatedly does not allocate.
+ */
+class BamRecordBatch {
+  public:
+    size_t size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    BamRecordView operator[](size_t i) const {
+        return BamRecordView(arena_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+    void clear() {
+        arena_.clear();
+        offsets_.clear();
+    }
+
+  private:
+    friend class BamRecordReader;
+
+    std::vector<uint8_t> arena_;
+    std::vector<size_t> offsets_;
+};
+
+/**
+ * @brief Reads BAM files in batches of records with multithreaded BGZF decompression.
+ */
+class BamRecordReader {
+  public:
+    typedef std::pair<std::string, uint32_t> Reference;
+
+    BamRecordReader(const std::filesystem::path &filename, unsigned nthreads);
+
+    /// Reads up to max_records next records into batch (replacing its previous content)
+    /// @return number of records read, zero at the end of file
+    size_t Read(BamRecordBatch &batch, size_t max_records);
+
+    bool eof() { return bgzf_.eof(); }
+
+    const std::string &header_text() const { return header_text_; }
+    const std::vector<Reference> &references() const { return references_; }
+
+  private:
+    void ReadHeader();
+
+    BgzfReader bgzf_;
+    std::filesystem::path filename_;
+    std::string header_text_;
+    std::vector<Reference> references_;
+};
+
+}
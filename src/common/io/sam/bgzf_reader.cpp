@@ -0,0 +1,164 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "bgzf_reader.hpp"
+
+#include "utils/parallel/openmp_wrapper.h"
+#include "utils/verify.hpp"
+
+#include <zlib.h>
+
+#include <cstring>
+
+namespace io {
+
+namespace {
+const size_t BGZF_HEADER_SIZE = 12;  // gzip header up to XLEN inclusive
+const size_t BGZF_FOOTER_SIZE = 8;   // CRC32 + ISIZE
+const size_t BGZF_MAX_BLOCK_SIZE = 1 << 16;
+
+uint16_t LoadU16(const uint8_t *p) {
+    return uint16_t(p[0] | (p[1] << 8));
+}
+
+uint32_t LoadU32(const uint8_t *p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+struct RawBlock {
+    std::vector<uint8_t> data;
+    size_t cdata_offset = 0, cdata_size = 0;
+    uint32_t crc = 0, isize = 0;
+};
+
+void Inflate(const RawBlock &block, char *out, const std::filesystem::path &filename) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    // Raw deflate stream, the gzip wrapper is parsed by us
+    int res = inflateInit2(&zs, -15);
+    VERIFY_MSG(res == Z_OK, "inflateInit2 failed: " << res);
+    zs.next_in = const_cast<Bytef*>(block.data.data() + block.cdata_offset);
+    zs.avail_in = uInt(block.cdata_size);
+    zs.next_out = reinterpret_cast<Bytef*>(out);
+    zs.avail_out = uInt(block.isize);
+    res = inflate(&zs, Z_FINISH);
+    inflateEnd(&zs);
+    CHECK_FATAL_ERROR(res == Z_STREAM_END && zs.avail_out == 0,
+                      "Corrupted BGZF block in " << filename);
+    CHECK_FATAL_ERROR(crc32(0, reinterpret_cast<const Bytef*>(out), uInt(block.isize)) == block.crc,
+                      "CRC mismatch in BGZF block in " << filename);
+}
+}
+
+BgzfReader::BgzfReader(const std::filesystem::path &filename, unsigned nthreads)
+        : is_(filename, std::ios::binary), filename_(filename),
+          nthreads_(nthreads ? nthreads : 1),
+          // Up to 256 KiB of decompressed data per thread in a batch
+          batch_blocks_(4 * nthreads_),
+          pos_(0) {
+    CHECK_FATAL_ERROR(is_.good(), "Cannot open BGZF file " << filename);
+    Prefetch();
+}
+
+BgzfReader::~BgzfReader() {
+    if (next_.valid())
+        next_.wait();
+}
+
+BgzfReader::Batch BgzfReader::ReadBatch() {
+    Batch batch;
+    std::vector<RawBlock> blocks;
+    while (blocks.size() < batch_blocks_) {
+        uint8_t header[BGZF_HEADER_SIZE];
+        is_.read(reinterpret_cast<char*>(header), BGZF_HEADER_SIZE);
+        if (is_.gcount() == 0) {
+            batch.last = true;
+            break;
+        }
+        CHECK_FATAL_ERROR(size_t(is_.gcount()) == BGZF_HEADER_SIZE &&
+                          header[0] == 31 && header[1] == 139 && header[2] == 8 && (header[3] & 4),
+                          "Invalid BGZF block header in " << filename_);
+
+        RawBlock block;
+        uint16_t xlen = LoadU16(header + 10);
+        std::vector<uint8_t> extra(xlen);
+        is_.read(reinterpret_cast<char*>(extra.data()), xlen);
+        CHECK_FATAL_ERROR(size_t(is_.gcount()) == xlen, "Truncated BGZF block in " << filename_);
+
+        // Search for the BC subfield with the total block size
+        size_t bsize = 0;
+        for (size_t i = 0; i + 4 <= xlen; ) {
+            uint16_t slen = LoadU16(extra.data() + i + 2);
+            if (extra[i] == 'B' && extra[i + 1] == 'C' && slen == 2 && i + 6 <= xlen)
+                bsize = size_t(LoadU16(extra.data() + i + 4)) + 1;
+            i += 4 + slen;
+        }
+        CHECK_FATAL_ERROR(bsize > BGZF_HEADER_SIZE + xlen + BGZF_FOOTER_SIZE && bsize <= BGZF_MAX_BLOCK_SIZE,
+                          "Not a BGZF file " << filename_);
+
+        size_t rest = bsize - BGZF_HEADER_SIZE - xlen;
+        block.data.resize(rest);
+        is_.read(reinterpret_cast<char*>(block.data.data()), rest);
+        CHECK_FATAL_ERROR(size_t(is_.gcount()) == rest, "Truncated BGZF block in " << filename_);
+        block.cdata_size = rest - BGZF_FOOTER_SIZE;
+        block.crc = LoadU32(block.data.data() + block.cdata_size);
+        block.isize = LoadU32(block.data.data() + block.cdata_size + 4);
+        CHECK_FATAL_ERROR(block.isize <= BGZF_MAX_BLOCK_SIZE, "Invalid BGZF block size in " << filename_);
+
+        blocks.push_back(std::move(block));
+    }
+
+    std::vector<size_t> offsets(blocks.size() + 1, 0);
+    for (size_t i = 0; i < blocks.size(); ++i)
+        offsets[i + 1] = offsets[i] + blocks[i].isize;
+    batch.data.resize(offsets.back());
+
+#   pragma omp parallel for num_threads(nthreads_) schedule(dynamic, 1)
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (blocks[i].isize)
+            Inflate(blocks[i], &batch.data[offsets[i]], filename_);
+    }
+    TRACE("Inflated " << blocks.size() << " blocks, " << batch.data.size() << " bytes");
+
+    return batch;
+}
+
+void BgzfReader::Prefetch() {
+    next_ = std::async(std::launch::async, [this] { return ReadBatch(); });
+}
+
+bool BgzfReader::NextBatch() {
+    while (pos_ == current_.data.size()) {
+        if (!next_.valid())
+            return false;
+
+        current_ = next_.get();
+        pos_ = 0;
+        if (!current_.last)
+            Prefetch();
+    }
+
+    return true;
+}
+
+size_t BgzfReader::read(void *buf, size_t size) {
+    char *out = static_cast<char*>(buf);
+    size_t done = 0;
+    while (done < size && NextBatch()) {
+        size_t cnt = std::min(size - done, current_.data.size() - pos_);
+        memcpy(out + done, current_.data.data() + pos_, cnt);
+        pos_ += cnt;
+        done += cnt;
+    }
+
+    return done;
+}
+
+bool BgzfReader::eof() {
+    return !NextBatch();
+}
+
+}
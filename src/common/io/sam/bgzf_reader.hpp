@@ -0,0 +1,64 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "utils/logger/logger.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace io {
+
+/**
+ * @brief Reader of BGZF-compressed files (e.g. BAM).
+ * @detail BGZF file is a series of independent gzip blocks of at most 64 KiB
+ *         each, so the blocks could be decompressed independently. The reader
+ *         takes a batch of blocks from the file and inflates them in parallel
+ *         (via OpenMP) in background while the previous batch is being
+ *         consumed.
+ */
+class BgzfReader {
+  public:
+    BgzfReader(const std::filesystem::path &filename, unsigned nthreads);
+    ~BgzfReader();
+
+    BgzfReader(const BgzfReader &) = delete;
+    BgzfReader &operator=(const BgzfReader &) = delete;
+
+    /// Reads up to size bytes of the decompressed data
+    /// @return number of bytes read (less than size only at the end of file)
+    size_t read(void *buf, size_t size);
+
+    bool eof();
+
+  private:
+    struct Batch {
+        std::string data;
+        bool last = false;
+    };
+
+    Batch ReadBatch();
+    void Prefetch();
+    bool NextBatch();
+
+    std::ifstream is_;
+    std::filesystem::path filename_;
+    unsigned nthreads_;
+    size_t batch_blocks_;
+
+    Batch current_;
+    size_t pos_;
+    std::future<Batch> next_;
+
+    DECL_LOGGER("BgzfReader");
+};
+
+}
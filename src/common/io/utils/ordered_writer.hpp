@@ -0,0 +1,114 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "utils/parallel/task_scheduler.hpp"
+#include "utils/verify.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace io {
+
+/// Appends FASTA record with the sequence wrapped to the lines of max_width
+/// (same layout as FastaWriter produces)
+inline void AppendFasta(std::string &out, const std::string &name, const std::string &seq,
+                        size_t max_width = 60) {
+    out.reserve(out.size() + name.size() + seq.size() + seq.size() / max_width + 3);
+    out += '>';
+    out += name;
+    out += '\n';
+    for (size_t cur = 0; cur < seq.size(); cur += max_width) {
+        out.append(seq, cur, max_width);
+        out += '\n';
+    }
+}
+
+/**
+ * @brief Writes the records which are formatted in parallel, preserving their order.
+ * @detail Records are formatted by blocks into separate buffers on the task scheduler
+ *         workers, so the output does not depend on the number of threads. The formatted
+ *         blocks are written by a background thread in large chunks while the next
+ *         portion of records is being formatted. Optionally each block is gzip-compressed
+ *         on the worker as a separate gzip member; the concatenation of the members is a
+ *         valid gzip file.
+ */
+class OrderedWriter {
+  public:
+    OrderedWriter(std::ostream &os, bool compress = false, int compression_level = 1,
+                  size_t block_size = 1 << 10)
+            : os_(os), compress_(compress), level_(compression_level),
+              block_size_(std::max<size_t>(block_size, 1)) {}
+
+    /// Calls format(i, buffer) for i in [0, count) to append the i-th record to the buffer
+    /// and writes the buffers in the order of i. The format function is called concurrently.
+    template<class Format>
+    void Write(size_t count, Format &&format) {
+        auto &scheduler = parallel::TaskScheduler::instance();
+        const size_t nblocks = (count + block_size_ - 1) / block_size_;
+        // Blocks formatted at once; the previous window is written meanwhile
+        const size_t window = 4 * size_t(scheduler.concurrency());
+
+        std::vector<std::string> current, writing;
+        std::future<void> written;
+        for (size_t start = 0; start < nblocks; start += window) {
+            size_t end = std::min(nblocks, start + window);
+            current.resize(end - start);
+            parallel::parallel_for(start, end, [&](size_t b) {
+                std::string &buf = current[b - start];
+                buf.clear();
+                for (size_t i = b * block_size_; i < std::min(count, (b + 1) * block_size_); ++i)
+                    format(i, buf);
+                if (compress_)
+                    buf = Compress(buf);
+            }, 1, scheduler);
+
+            if (written.valid())
+                written.get();
+            std::swap(current, writing);
+            written = std::async(std::launch::async, [this, &writing] {
+                for (const auto &buf : writing)
+                    os_.write(buf.data(), std::streamsize(buf.size()));
+            });
+        }
+        if (written.valid())
+            written.get();
+        os_.flush();
+    }
+
+  private:
+    std::string Compress(const std::string &data) const {
+        z_stream zs;
+        memset(&zs, 0, sizeof(zs));
+        // 15 + 16: gzip wrapper around the deflate stream
+        int res = deflateInit2(&zs, level_, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        VERIFY_MSG(res == Z_OK, "deflateInit2 failed: " << res);
+        std::string out(deflateBound(&zs, uLong(data.size())), '\0');
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        zs.avail_in = uInt(data.size());
+        zs.next_out = reinterpret_cast<Bytef*>(&out[0]);
+        zs.avail_out = uInt(out.size());
+        res = deflate(&zs, Z_FINISH);
+        VERIFY_MSG(res == Z_STREAM_END, "deflate failed: " << res);
+        out.resize(zs.total_out);
+        deflateEnd(&zs);
+        return out;
+    }
+
+    std::ostream &os_;
+    bool compress_;
+    int level_;
+    size_t block_size_;
+};
+
+}
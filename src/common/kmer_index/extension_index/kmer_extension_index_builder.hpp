@@ -14,6 +14,7 @@
 #include "kmer_index/ph_map/perfect_hash_map_builder.hpp"
 #include "kmer_index/kmer_counting.hpp"
 #include "io/reads/multifile_reader.hpp"
+#include "sequence/kmer_width.hpp"
 
 namespace kmers {
 
@@ -60,6 +61,23 @@ public:
     }
 
 public:
+    /// Counts distinct k-mers of the reads. Splitting is done using the narrowest k-mer
+    /// type suitable for K, the result is the same for all of them.
+    template<class KmerFilter, class Streams>
+    kmers::KMerDiskStorage<RtSeq>
+    CountKMers(fs::TmpDir workdir, unsigned K,
+               Streams &streams,
+               size_t read_buffer_size = 0) const {
+        unsigned nthreads = (unsigned) streams.size();
+        return DispatchKMerWidth(K, [&](auto width) {
+            using Splitter = DeBruijnReadKMerSplitter<typename Streams::ReadT, KmerFilter,
+                                                      typename decltype(width)::type>;
+            kmers::KMerDiskCounter<RtSeq> counter(workdir,
+                                                  Splitter(workdir, K, streams, read_buffer_size));
+            return counter.Count(10 * nthreads, nthreads);
+        });
+    }
+
     template<class Index, class Streams>
     kmers::KMerDiskStorage<RtSeq>
     BuildExtensionIndexFromStream(fs::TmpDir workdir, Index &index,
@@ -69,10 +87,7 @@ public:
         using KmerFilter = StoringTypeFilter<typename Index::storing_type>;
 
         // First, build a k+1-mer index
-        using Splitter = DeBruijnReadKMerSplitter<typename Streams::ReadT, KmerFilter>;
-        kmers::KMerDiskCounter<RtSeq> counter(workdir,
-                                              Splitter(workdir, index.k() + 1, streams, read_buffer_size));
-        auto kmers = counter.Count(10 * nthreads, nthreads);
+        auto kmers = CountKMers<KmerFilter>(workdir, index.k() + 1, streams, read_buffer_size);
 
         BuildExtensionIndexFromKPOMers(workdir, index, kmers,
                                        nthreads, read_buffer_size);
@@ -87,15 +102,18 @@ public:
         VERIFY(kpomers.k() == index.k() + 1);
 
         // Now, count unique k-mers from k+1-mers
-        using Splitter = DeBruijnKMerKMerSplitter<StoringTypeFilter<typename Index::storing_type>,
-                                                  typename KMerStorage::kmer_iterator>;
-        Splitter splitter(workdir, index.k(),
-                          index.k() + 1, Index::storing_type::IsInvertable(), read_buffer_size);
-        for (unsigned i = 0; i < kpomers.num_buckets(); ++i)
-            splitter.AddKMers(adt::make_range(kpomers.bucket_begin(i), kpomers.bucket_end(i)));
-        kmers::KMerDiskCounter<RtSeq> counter(workdir, std::move(splitter));
-
-        BuildIndex(index, counter, kpomers.num_buckets(), nthreads);
+        DispatchKMerWidth(index.k() + 1, [&](auto width) {
+            using Splitter = DeBruijnKMerKMerSplitter<StoringTypeFilter<typename Index::storing_type>,
+                                                      typename KMerStorage::kmer_iterator,
+                                                      typename decltype(width)::type>;
+            Splitter splitter(workdir, index.k(),
+                              index.k() + 1, Index::storing_type::IsInvertable(), read_buffer_size);
+            for (unsigned i = 0; i < kpomers.num_buckets(); ++i)
+                splitter.AddKMers(adt::make_range(kpomers.bucket_begin(i), kpomers.bucket_end(i)));
+            kmers::KMerDiskCounter<RtSeq> counter(workdir, std::move(splitter));
+
+            BuildIndex(index, counter, kpomers.num_buckets(), nthreads);
+        });
 
         // Build the kmer extensions
         INFO("Building k-mer extensions from k+1-mers");
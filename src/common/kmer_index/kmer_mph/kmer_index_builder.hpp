@@ -240,7 +240,7 @@ public:
   template<class Splitter>
   KMerDiskCounter(fs::TmpDir work_dir,
                   Splitter splitter)
-      : __super(splitter.K()), splitter_(new Splitter{std::move(splitter)}), work_dir_(work_dir) {}
+      : __super(splitter.K()), splitter_(MakeSplitter(work_dir, std::move(splitter))), work_dir_(work_dir) {}
 
   template<class Splitter>
   KMerDiskCounter(const std::filesystem::path &work_dir,
@@ -293,6 +293,16 @@ private:
   std::unique_ptr<kmers::KMerSplitter<Seq>> splitter_;
   fs::TmpDir work_dir_;
 
+  // The splitter might work with narrower k-mers (see DispatchKMerWidth), the raw
+  // k-mers it produces are the same
+  template<class Splitter>
+  static std::unique_ptr<kmers::KMerSplitter<Seq>> MakeSplitter(fs::TmpDir work_dir, Splitter splitter) {
+    if constexpr (std::is_same<typename Splitter::KMerSeq, Seq>::value)
+      return std::unique_ptr<kmers::KMerSplitter<Seq>>(new Splitter{std::move(splitter)});
+    else
+      return std::unique_ptr<kmers::KMerSplitter<Seq>>(new KMerWidthSplitter<Seq, Splitter>(work_dir, std::move(splitter)));
+  }
+
   size_t MergeKMers(const std::filesystem::path &ifname, const std::filesystem::path &ofname) {
     MMappedRecordArrayReader<typename Seq::DataType> ins(ifname, Seq::GetDataSize(this->k()), /* unlink */ true);
 
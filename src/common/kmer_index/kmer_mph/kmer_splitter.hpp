@@ -18,12 +18,14 @@
 #include <pdqsort/pdqsort_pod.h>
 #include <string>
 #include <cstdio>
+#include <type_traits>
 
 namespace kmers {
 
 template<class Seq>
 class KMerSplitter {
 public:
+    typedef Seq KMerSeq;
     typedef typename kmer::KMerSegmentPolicy<Seq> KMerBuckets;
     typedef std::vector<fs::DependentTmpFile> RawKMers;
 
@@ -176,4 +178,27 @@ protected:
     }
 };
 
+// Exposes the splitter working with the k-mers of another width (see DispatchKMerWidth)
+// as the splitter of Seq k-mers. The raw k-mers and their distribution over the files
+// do not depend on the width, so only the bucket policy needs to be re-typed.
+template<class Seq, class Splitter>
+class KMerWidthSplitter : public KMerSplitter<Seq> {
+    static_assert(std::is_same<typename Seq::DataType, typename Splitter::KMerSeq::DataType>::value,
+                  "k-mers of different widths must share the raw data layout");
+public:
+    using typename KMerSplitter<Seq>::RawKMers;
+
+    KMerWidthSplitter(fs::TmpDir work_dir, Splitter splitter)
+            : KMerSplitter<Seq>(work_dir, splitter.K()), splitter_(std::move(splitter)) {}
+
+    RawKMers Split(size_t num_files, unsigned nthreads) override {
+        RawKMers res = splitter_.Split(num_files, nthreads);
+        this->bucket_.reset(splitter_.bucket_policy().num_segments());
+        return res;
+    }
+
+private:
+    Splitter splitter_;
+};
+
 }
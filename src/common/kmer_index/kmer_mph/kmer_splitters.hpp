@@ -18,8 +18,8 @@ namespace kmers {
 
 using RtSeqKMerSplitter = kmers::KMerSortingSplitter<RtSeq>;
 
-template<class KmerFilter>
-class DeBruijnKMerSplitter : public RtSeqKMerSplitter {
+template<class KmerFilter, class Seq = RtSeq>
+class DeBruijnKMerSplitter : public kmers::KMerSortingSplitter<Seq> {
  private:
   KmerFilter kmer_filter_;
  protected:
@@ -30,7 +30,7 @@ class DeBruijnKMerSplitter : public RtSeqKMerSplitter {
       if (seq.size() < this->K_)
         return false;
 
-      RtSeq kmer = seq.start<RtSeq>(this->K_) >> 'A';
+      Seq kmer = seq.start<Seq>(this->K_) >> 'A';
       bool stop = false;
       for (size_t j = this->K_ - 1; j < seq.size(); ++j) {
         kmer <<= seq[j];
@@ -43,12 +43,12 @@ class DeBruijnKMerSplitter : public RtSeqKMerSplitter {
       return stop;
   }
 
-    bool FillBufferFromSequence(const RtSeq &seq,
+    bool FillBufferFromSequence(const Seq &seq,
                                 unsigned thread_id) {
       if (seq.size() < this->K_)
         return false;
 
-      RtSeq kmer = seq.start(this->K_) >> 'A';
+      Seq kmer = seq.start(this->K_) >> 'A';
       bool stop = false;
       for (size_t j = this->K_ - 1; j < seq.size(); ++j) {
         kmer <<= seq[j];
@@ -64,14 +64,14 @@ class DeBruijnKMerSplitter : public RtSeqKMerSplitter {
  public:
   DeBruijnKMerSplitter(fs::TmpDir work_dir,
                        unsigned K, KmerFilter kmer_filter, size_t read_buffer_size = 0)
-      : RtSeqKMerSplitter(work_dir, K), kmer_filter_(kmer_filter), read_buffer_size_(read_buffer_size) {
+      : kmers::KMerSortingSplitter<Seq>(work_dir, K), kmer_filter_(kmer_filter), read_buffer_size_(read_buffer_size) {
   }
  protected:
   DECL_LOGGER("DeBruijnKMerSplitter");
 };
 
-template<class Read, class KmerFilter>
-class DeBruijnReadKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
+template<class Read, class KmerFilter, class Seq = RtSeq>
+class DeBruijnReadKMerSplitter : public DeBruijnKMerSplitter<KmerFilter, Seq> {
   io::ReadStreamList<Read>& streams_;
 
   template<class ReadStream>
@@ -79,22 +79,22 @@ class DeBruijnReadKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
   FillBufferFromStream(ReadStream& stream, unsigned thread_id);
 
  public:
-  using typename DeBruijnKMerSplitter<KmerFilter>::RawKMers;
+  using typename DeBruijnKMerSplitter<KmerFilter, Seq>::RawKMers;
   DeBruijnReadKMerSplitter(fs::TmpDir work_dir,
                            unsigned K,
                            io::ReadStreamList<Read>& streams,
                            size_t read_buffer_size = 0,
                            KmerFilter filter = KmerFilter())
-      : DeBruijnKMerSplitter<KmerFilter>(work_dir, K, filter, read_buffer_size),
+      : DeBruijnKMerSplitter<KmerFilter, Seq>(work_dir, K, filter, read_buffer_size),
       streams_(streams) {}
 
   RawKMers Split(size_t num_files, unsigned nthreads) override;
 };
 
-template<class Read, class KmerFilter> template<class ReadStream>
+template<class Read, class KmerFilter, class Seq> template<class ReadStream>
 size_t
-DeBruijnReadKMerSplitter< Read, KmerFilter>::FillBufferFromStream(ReadStream &stream,
-                                                                  unsigned thread_id) {
+DeBruijnReadKMerSplitter<Read, KmerFilter, Seq>::FillBufferFromStream(ReadStream &stream,
+                                                                       unsigned thread_id) {
   typename ReadStream::ReadT r;
   size_t reads = 0;
 
@@ -109,9 +109,9 @@ DeBruijnReadKMerSplitter< Read, KmerFilter>::FillBufferFromStream(ReadStream &st
   return reads;
 }
 
-template<class Read, class KmerFilter>
-typename DeBruijnReadKMerSplitter<Read, KmerFilter>::RawKMers
-DeBruijnReadKMerSplitter<Read, KmerFilter>::Split(size_t num_files, unsigned nthreads) {
+template<class Read, class KmerFilter, class Seq>
+typename DeBruijnReadKMerSplitter<Read, KmerFilter, Seq>::RawKMers
+DeBruijnReadKMerSplitter<Read, KmerFilter, Seq>::Split(size_t num_files, unsigned nthreads) {
   auto out = this->PrepareBuffers(num_files, nthreads, this->read_buffer_size_);
 
   size_t counter = 0, n = 15;
@@ -135,8 +135,8 @@ DeBruijnReadKMerSplitter<Read, KmerFilter>::Split(size_t num_files, unsigned nth
   return out;
 }
 
-template<class KmerFilter, class KMerIterator>
-class DeBruijnKMerKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
+template<class KmerFilter, class KMerIterator, class Seq = RtSeq>
+class DeBruijnKMerKMerSplitter : public DeBruijnKMerSplitter<KmerFilter, Seq> {
   using kmer_range = adt::iterator_range<KMerIterator>;
   unsigned K_source_;
   std::vector<kmer_range> kmers_;
@@ -145,11 +145,11 @@ class DeBruijnKMerKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
   size_t FillBufferFromKMers(kmer_range &range, size_t thread_id);
 
  public:
-  using typename DeBruijnKMerSplitter<KmerFilter>::RawKMers;
+  using typename DeBruijnKMerSplitter<KmerFilter, Seq>::RawKMers;
 
   DeBruijnKMerKMerSplitter(fs::TmpDir work_dir,
                            unsigned K_target, unsigned K_source, bool add_rc, size_t read_buffer_size = 0)
-      : DeBruijnKMerSplitter<KmerFilter>(work_dir, K_target, KmerFilter(), read_buffer_size),
+      : DeBruijnKMerSplitter<KmerFilter, Seq>(work_dir, K_target, KmerFilter(), read_buffer_size),
         K_source_(K_source), add_rc_(add_rc) {}
 
   void AddKMers(kmer_range range) {
@@ -159,12 +159,12 @@ class DeBruijnKMerKMerSplitter : public DeBruijnKMerSplitter<KmerFilter> {
   RawKMers Split(size_t num_files, unsigned nthreads) override;
 };
 
-template<class KmerFilter, class KMerIterator>
-inline size_t DeBruijnKMerKMerSplitter<KmerFilter, KMerIterator>::FillBufferFromKMers(kmer_range &range,
-                                                                                      size_t thread_id) {
+template<class KmerFilter, class KMerIterator, class Seq>
+inline size_t DeBruijnKMerKMerSplitter<KmerFilter, KMerIterator, Seq>::FillBufferFromKMers(kmer_range &range,
+                                                                                           size_t thread_id) {
   size_t seqs = 0;
   for (auto &it = range.begin(); it != range.end(); ++it) {
-    RtSeq nucls(K_source_, it->first); // FIXME: temporary
+    Seq nucls(K_source_, it->first); // FIXME: temporary
     seqs += 1;
 
     bool stop = this->FillBufferFromSequence(nucls, unsigned(thread_id));
@@ -178,9 +178,9 @@ inline size_t DeBruijnKMerKMerSplitter<KmerFilter, KMerIterator>::FillBufferFrom
   return seqs;
 }
 
-template<class KmerFilter, class KMerIterator>
-typename DeBruijnKMerKMerSplitter<KmerFilter,  KMerIterator>::RawKMers
-DeBruijnKMerKMerSplitter<KmerFilter, KMerIterator>::Split(size_t num_files, unsigned nthreads) {
+template<class KmerFilter, class KMerIterator, class Seq>
+typename DeBruijnKMerKMerSplitter<KmerFilter, KMerIterator, Seq>::RawKMers
+DeBruijnKMerKMerSplitter<KmerFilter, KMerIterator, Seq>::Split(size_t num_files, unsigned nthreads) {
   auto out = this->PrepareBuffers(num_files, nthreads, this->read_buffer_size_);
 
   size_t counter = 0, n = 10;
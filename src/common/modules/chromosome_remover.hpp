@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "assembly_graph/components/graph_analytics.hpp"
 #include "assembly_graph/core/graph.hpp"
 #include "pipeline/graph_pack.hpp"
 #include "configs/config_struct.hpp"
@@ -17,8 +18,8 @@ namespace debruijn_graph {
 class ChromosomeRemover {
 public:
     ChromosomeRemover(graph_pack::GraphPack &gp, size_t ext_limit, config::debruijn_config::plasmid plasmid_config)
-            : gp_(gp), ext_limit_(ext_limit), plasmid_config_(plasmid_config), chromosome_coverage_((double) ext_limit), long_component_(), long_vertex_component_(),
-              deadends_count_(), component_list_(), full_name_(std::string("chromosome_removal") + (ext_limit == 0 ? std::string(""):std::to_string(ext_limit))) {
+            : gp_(gp), ext_limit_(ext_limit), plasmid_config_(plasmid_config), chromosome_coverage_((double) ext_limit),
+              components_(gp.get<Graph>()), deadends_count_(), component_order_(), full_name_(std::string("chromosome_removal") + (ext_limit == 0 ? std::string(""):std::to_string(ext_limit))) {
     }
 
     void run(graph_pack::GraphPack &gp, const char *);
@@ -31,15 +32,21 @@ private:
     size_t ext_limit_;
     config::debruijn_config::plasmid plasmid_config_;
     double chromosome_coverage_;
-    std::unordered_map <EdgeId, size_t> long_component_;
-    std::unordered_map <VertexId, size_t> long_vertex_component_;
-    std::unordered_map <EdgeId, size_t> deadends_count_;
-    std::vector<std::vector<EdgeId>> component_list_;
+    // Components (together with the conjugates) from the last CalculateComponents() call
+    omnigraph::ConnectedComponents<Graph> components_;
+    std::vector<size_t> deadends_count_;
+    // Components with edges in the order of their discovery along the graph edges
+    std::vector<size_t> component_order_;
 
     std::string full_name_;
     const size_t max_iteration_count = 30;
 
-    size_t CalculateComponentSize(debruijn_graph::EdgeId e, const Graph &g);
+    void CalculateComponents(const Graph &g);
+    bool HasComponent(EdgeId e) const;
+    // Total length of the component (0 for the edges and vertices unknown at the moment of calculation)
+    size_t ComponentSize(EdgeId e) const;
+    size_t ComponentSize(VertexId v) const;
+    size_t ComponentDeadends(EdgeId e) const;
 
     double RemoveLongGenomicEdges(size_t long_edge_bound, double coverage_limits,
                                   double external_chromosome_coverage = 0);
@@ -13,6 +13,7 @@
 
 #include "assembly_graph/construction/debruijn_graph_constructor.hpp"
 #include "assembly_graph/construction/early_simplification.hpp"
+#include "assembly_graph/construction/superkmer_graph_constructor.hpp"
 #include "assembly_graph/graph_support/coverage_filling.hpp"
 
 #include "alignment/edge_index.hpp"
@@ -62,10 +63,24 @@ KMerFiles ConstructGraphUsingExtensionIndex(const config::debruijn_config::const
     return kmers;
 }
 
+template<class Read>
+KMerFiles ConstructGraphUsingSuperKMers(const config::debruijn_config::construction &params,
+                                        fs::TmpDir workdir,
+                                        io::ReadStreamList<Read>& streams, Graph& g) {
+    INFO("Constructing DeBruijn graph for k=" << g.k() << " from minimizer buckets");
+    if (params.early_tc.enable)
+        INFO("Early tip clipping is not available in minimizer construction mode, skipped");
+
+    return SuperKMerGraphConstructor<Graph>(g, workdir, params.read_buffer_size).ConstructGraph(streams, params.keep_perfect_loops);
+}
+
 //FIXME these methods are tested, but not used!
 template<class Streams>
 KMerFiles ConstructGraph(const config::debruijn_config::construction &params,
                          fs::TmpDir workdir, Streams& streams, Graph& g) {
+    if (params.con_mode == config::construction_mode::minimizer)
+        return ConstructGraphUsingSuperKMers(params, workdir, streams, g);
+
     return ConstructGraphUsingExtensionIndex(params, workdir, streams, g);
 }
 
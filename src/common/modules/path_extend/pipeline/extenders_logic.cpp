@@ -11,6 +11,7 @@
 
 #include "extenders_logic.hpp"
 #include "modules/path_extend/scaffolder2015/extension_chooser2015.hpp"
+#include "paired_info/frozen_paired_index.hpp"
 
 
 namespace path_extend {
@@ -65,7 +66,7 @@ shared_ptr<SimpleExtender> ExtendersGenerator::MakeLongReadsExtender(size_t lib_
 
 shared_ptr<SimpleExtender> ExtendersGenerator::MakeLongEdgePEExtender(size_t lib_index,
                                                                       bool investigate_loops) const {
-    const auto &clustered_indices = gp_.get<PairedInfoIndicesT<Graph>>("clustered_indices");
+    const auto &clustered_indices = gp_.get<FrozenPairedInfoIndicesT<Graph>>("clustered_indices");
 
     const auto &lib = dataset_info_.reads[lib_index];
     auto paired_lib = MakeNewLib(graph_, lib, clustered_indices[lib_index]);
@@ -207,7 +208,7 @@ shared_ptr<PathExtender> ExtendersGenerator::MakeMatePairScaffoldingExtender(siz
     const auto &lib = dataset_info_.reads[lib_index];
     const auto &pset = params_.pset;
     const auto &paired_indices = gp_.get<UnclusteredPairedInfoIndicesT<Graph>>();
-    const auto &clustered_indices = gp_.get<PairedInfoIndicesT<Graph>>("clustered_indices");
+    const auto &clustered_indices = gp_.get<FrozenPairedInfoIndicesT<Graph>>("clustered_indices");
 
     shared_ptr<PairedInfoLibrary> paired_lib;
     INFO("Creating Scaffolding 2015 extender for lib #" << lib_index);
@@ -249,7 +250,7 @@ shared_ptr<PathExtender> ExtendersGenerator::MakeMatePairScaffoldingExtender(siz
 
 shared_ptr<SimpleExtender> ExtendersGenerator::MakeCoordCoverageExtender(size_t lib_index) const {
     const auto& lib = dataset_info_.reads[lib_index];
-    const auto &clustered_indices = gp_.get<PairedInfoIndicesT<Graph>>("clustered_indices");
+    const auto &clustered_indices = gp_.get<FrozenPairedInfoIndicesT<Graph>>("clustered_indices");
     auto paired_lib = MakeNewLib(graph_, lib, clustered_indices[lib_index]);
 
     auto provider = make_shared<CoverageAwareIdealInfoProvider>(graph_, paired_lib, lib.data().unmerged_read_length);
@@ -281,7 +282,7 @@ shared_ptr<SimpleExtender> ExtendersGenerator::MakeCoordCoverageExtender(size_t
 shared_ptr<SimpleExtender> ExtendersGenerator::MakeRNAExtender(size_t lib_index, bool investigate_loops) const {
 
     const auto &lib = dataset_info_.reads[lib_index];
-    const auto &clustered_indices = gp_.get<PairedInfoIndicesT<Graph>>("clustered_indices");
+    const auto &clustered_indices = gp_.get<FrozenPairedInfoIndicesT<Graph>>("clustered_indices");
     auto paired_lib = MakeNewLib(graph_, lib, clustered_indices[lib_index]);
 //    INFO("Threshold for lib #" << lib_index << ": " << paired_lib->GetSingleThreshold());
 
@@ -327,7 +328,7 @@ shared_ptr<SimpleExtender> ExtendersGenerator::MakeSimpleCoverageExtender(size_t
 
 shared_ptr<SimpleExtender> ExtendersGenerator::MakePEExtender(size_t lib_index, bool investigate_loops) const {
     const auto &lib = dataset_info_.reads[lib_index];
-    const auto &clustered_indices = gp_.get<PairedInfoIndicesT<Graph>>("clustered_indices");
+    const auto &clustered_indices = gp_.get<FrozenPairedInfoIndicesT<Graph>>("clustered_indices");
     shared_ptr<PairedInfoLibrary> paired_lib = MakeNewLib(graph_, lib, clustered_indices[lib_index]);
     VERIFY_MSG(!paired_lib->IsMp(), "Tried to create PE extender for MP library");
     auto opts = params_.pset.extension_options;
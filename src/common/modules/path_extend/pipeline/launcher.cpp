@@ -19,6 +19,7 @@
 #include "alignment/rna/ss_coverage.hpp"
 #include "assembly_graph/core/basic_graph_stats.hpp"
 #include "assembly_graph/graph_support/coverage_uniformity_analyzer.hpp"
+#include "paired_info/frozen_paired_index.hpp"
 
 #include <unordered_set>
 
@@ -40,7 +41,7 @@ PathExtendLauncher::ConstructPairedConnectionConditions(const ScaffoldingUniqueE
             if (lib.is_mate_pair())
                 paired_lib = MakeNewLib(graph_, lib, gp_.get<UnclusteredPairedInfoIndicesT<Graph>>()[lib_index]);
             else if (lib.type() == io::LibraryType::PairedEnd)
-                paired_lib = MakeNewLib(graph_, lib, gp_.get<PairedInfoIndicesT<Graph>>("clustered_indices")[lib_index]);
+                paired_lib = MakeNewLib(graph_, lib, gp_.get<FrozenPairedInfoIndicesT<Graph>>("clustered_indices")[lib_index]);
             else {
                 INFO("Unusable for scaffold graph paired lib #" << lib_index);
                 continue;
@@ -7,6 +7,7 @@
 
 #include "scaff_supplementary.hpp"
 #include "assembly_graph/dijkstra/dijkstra_helper.hpp"
+#include "paired_info/frozen_paired_index.hpp"
 
 #include <algorithm>
 
@@ -243,7 +244,7 @@ bool ScaffoldingUniqueEdgeAnalyzer::FindCommonChildren(const vector<pair<EdgeId,
 
 bool ScaffoldingUniqueEdgeAnalyzer::FindCommonChildren(EdgeId from, size_t lib_index) const{
     DEBUG("processing unique edge " << graph_.int_id(from));
-    const auto &clustered_indices = gp_.get<omnigraph::de::PairedInfoIndicesT<Graph>>("clustered_indices");
+    const auto &clustered_indices = gp_.get<omnigraph::de::FrozenPairedInfoIndicesT<Graph>>("clustered_indices");
     auto next_edges = clustered_indices[lib_index].Get(from);
     vector<pair<EdgeId, double>> next_weights;
     for (auto hist_pair: next_edges) {
@@ -172,6 +172,10 @@ public:
 
     }
 
+    bool HasCallbacks() const {
+        return opt_callback_ || removal_handler_;
+    }
+
     void operator()(EdgeId edge, const std::vector<EdgeId>& path) {
         if (opt_callback_ && opt_callback_(edge, path)) {
                 return;
@@ -404,7 +408,7 @@ private:
     typedef typename Graph::VertexId VertexId;
     typedef InterestingFinderPtr<Graph, EdgeId> CandidateFinderPtr;
     typedef SmartSetIterator<Graph, EdgeId, CoverageComparator<Graph>> SmartEdgeSet;
-    typedef phmap::flat_hash_set<EdgeId> EdgeSet;
+    typedef phmap::flat_hash_set<VertexId> VertexSet;
     
     size_t buff_size_;
     double buff_cov_diff_;
@@ -473,28 +477,58 @@ private:
         return smart_set;
     }
 
-    bool CheckInteracting(const BulgeInfo &info, const EdgeSet &involved_edges) const {
-        if (involved_edges.count(info.e))
-            return true;
+    //vertices whose edges might be removed or replaced by gluing of the bulge
+    template<class F>
+    void ForEachInvolvedVertex(const BulgeInfo &info, F f) const {
+        const Graph &g = this->g();
+        f(g.EdgeStart(info.e));
+        f(g.EdgeEnd(info.e));
         for (EdgeId e : info.alternative)
-            if (involved_edges.count(e))
-                return true;
-        return false;
+            f(g.EdgeEnd(e));
     }
 
-    void AccountEdge(EdgeId e, EdgeSet& involved_edges) const {
-        TRACE("Pushing edge " << this->g().str(e));
-        involved_edges.insert(e);
-        EdgeId conj = this->g().conjugate(e);
-        TRACE("Pushing edge " << this->g().str(conj));
-        involved_edges.insert(conj);
+    //compression of the bulge ends after gluing also relinks edges of their neighbours
+    template<class F>
+    void ForEachTouchedVertex(const BulgeInfo &info, F f) const {
+        const Graph &g = this->g();
+        ForEachInvolvedVertex(info, f);
+        for (VertexId v : {g.EdgeStart(info.e), g.EdgeEnd(info.e)}) {
+            for (EdgeId e : g.IncomingEdges(v))
+                f(g.EdgeStart(e));
+            for (EdgeId e : g.OutgoingEdges(v))
+                f(g.EdgeEnd(e));
+        }
     }
 
-    void AccountEdges(const BulgeInfo& info, EdgeSet& involved_edges) const {
-        AccountEdge(info.e, involved_edges);
-        for (EdgeId e : info.alternative) {
-            AccountEdge(e, involved_edges);
-        }
+    //bulges are considered interfering if they touch any common vertex (or its conjugate),
+    //so that independent bulges could be glued concurrently
+    bool CheckInteracting(const BulgeInfo &info, const VertexSet &touched_vertices) const {
+        bool interacting = false;
+        ForEachTouchedVertex(info, [&](VertexId v) {
+            interacting |= touched_vertices.count(v) > 0;
+        });
+        return interacting;
+    }
+
+    //edges of the bulge (and thus its alternative) are affected only if it shares a vertex with the glued ones
+    bool CheckInvalidated(const BulgeInfo &info, const VertexSet &glued_vertices) const {
+        bool invalidated = false;
+        ForEachInvolvedVertex(info, [&](VertexId v) {
+            invalidated |= glued_vertices.count(v) > 0;
+        });
+        return invalidated;
+    }
+
+    void AccountVertices(const BulgeInfo& info, VertexSet& touched_vertices, VertexSet& glued_vertices) const {
+        ForEachTouchedVertex(info, [&](VertexId v) {
+            TRACE("Pushing vertex " << this->g().str(v));
+            touched_vertices.insert(v);
+            touched_vertices.insert(this->g().conjugate(v));
+        });
+        ForEachInvolvedVertex(info, [&](VertexId v) {
+            glued_vertices.insert(v);
+            glued_vertices.insert(this->g().conjugate(v));
+        });
     }
 
     //returns false if time to stop
@@ -539,7 +573,9 @@ private:
         return !exhausted;
     }
 
-    std::vector<std::vector<BulgeInfo>> FindBulges(const std::vector<EdgeId>& edge_buffer) const {
+    //ids of the bulges default to the positions in the buffer
+    std::vector<std::vector<BulgeInfo>> FindBulges(const std::vector<EdgeId>& edge_buffer,
+                                                   const std::vector<size_t>& ids = {}) const {
         DEBUG("Looking for bulges in parallel");
         utils::perf_counter perf;
         std::vector<std::vector<BulgeInfo>> bulge_buffers(omp_get_max_threads());
@@ -551,7 +587,8 @@ private:
             EdgeId e = edge_buffer[i];
             auto alternative = alternatives_analyzer_(e);
             if (!alternative.empty()) {
-                bulge_buffers[omp_get_thread_num()].push_back(BulgeInfo(i, e, std::move(alternative)));
+                bulge_buffers[omp_get_thread_num()].push_back(BulgeInfo(ids.empty() ? i : ids[i], e,
+                                                                        std::move(alternative)));
             }
         }
         DEBUG("Bulges found (in parallel) in " << perf.time() << " seconds");
@@ -577,25 +614,24 @@ private:
         return merged_bulges;
     }
 
-    SmartEdgeSet RetainIndependentBulges(std::vector<BulgeInfo>& bulges) const {
+    //returns the bulges interfering with the retained ones
+    std::vector<BulgeInfo> RetainIndependentBulges(std::vector<BulgeInfo>& bulges, VertexSet& glued_vertices) const {
         DEBUG("Looking for independent bulges");
         size_t total_cnt = bulges.size();
         utils::perf_counter perf;
 
-        std::vector<BulgeInfo> filtered;
+        std::vector<BulgeInfo> filtered, interacting;
         filtered.reserve(bulges.size());
-        //fixme switch to involved vertices to bring fully parallel glueing closer
-        EdgeSet involved_edges;
-        SmartEdgeSet interacting_edges(this->g(), false, CoverageComparator<Graph>(this->g()));
+        VertexSet touched_vertices;
 
         for (BulgeInfo& info : bulges) {
             TRACE("Analyzing interactions of " << info.str(this->g()));
-            if (CheckInteracting(info, involved_edges)) {
+            if (CheckInteracting(info, touched_vertices)) {
                 TRACE("Interacting");
-                interacting_edges.push(info.e);
+                interacting.push_back(std::move(info));
             } else {
                 TRACE("Independent");
-                AccountEdges(info, involved_edges);
+                AccountVertices(info, touched_vertices, glued_vertices);
                 filtered.push_back(std::move(info));
             }
         }
@@ -603,10 +639,10 @@ private:
 
         DEBUG("Independent bulges identified in " << perf.time() << " seconds");
         DEBUG("Independent cnt " << bulges.size());
-        DEBUG("Interacting cnt " << interacting_edges.size());
-        VERIFY(bulges.size() + interacting_edges.size() == total_cnt);
+        DEBUG("Interacting cnt " << interacting.size());
+        VERIFY(bulges.size() + interacting.size() == total_cnt);
 
-        return interacting_edges;
+        return interacting;
     }
 
     size_t BasicProcessBulges(SmartEdgeSet& edges) {
@@ -624,24 +660,87 @@ private:
         return triggered;
     }
 
-    size_t ProcessBulges(const std::vector<BulgeInfo>& independent_bulges, SmartEdgeSet& interacting_edges) {
-        DEBUG("Processing bulges");
+    //Independent bulges touch disjoint sets of vertices, so they are glued concurrently. Ids of the new
+    //graph elements are reserved beforehand, handlers that are not thread-safe are notified one at a time.
+    //Callbacks are not expected to be thread-safe, in this case bulges are glued sequentially.
+    size_t GlueIndependentBulges(const std::vector<BulgeInfo>& independent_bulges) {
         utils::perf_counter perf;
+        if (gluer_.HasCallbacks()) {
+            for (const BulgeInfo& info : independent_bulges) {
+                TRACE("Processing bulge " << info.str(this->g()));
+                gluer_(info.e, info.alternative);
+            }
+        } else {
+            //every alternative edge costs at most a split and a glue, ends compression adds two more edges
+            size_t vertex_cnt = 0, edge_cnt = 0;
+            for (const BulgeInfo& info : independent_bulges) {
+                vertex_cnt += 2 * info.alternative.size();
+                edge_cnt += 2 * (3 * info.alternative.size() + 2);
+            }
+            this->g().reserve(this->g().size() + vertex_cnt, this->g().e_size() + edge_cnt);
+
+            #pragma omp parallel for schedule(guided)
+            for (size_t i = 0; i < independent_bulges.size(); ++i) {
+                const BulgeInfo& info = independent_bulges[i];
+                TRACE("Processing bulge " << info.str(this->g()));
+                gluer_(info.e, info.alternative);
+            }
+        }
+        DEBUG("Independent bulges glued in " << perf.time() << " seconds");
+        return independent_bulges.size();
+    }
 
+    //Bulges are glued in rounds. Each round glues a set of pairwise independent bulges.
+    //Alternatives of the interfering ones, which share vertices with the glued bulges,
+    //are searched again in parallel for the next round, the rest are carried over as is.
+    //Only the small remainder is processed in a usual sequential way.
+    size_t ProcessBulges(std::vector<BulgeInfo>&& bulges) {
+        DEBUG("Processing bulges");
         size_t triggered = 0;
+        for (size_t round = 0; ; ++round) {
+            VertexSet glued_vertices;
+            auto interacting = RetainIndependentBulges(bulges, glued_vertices);
+
+            std::vector<BulgeInfo> valid;
+            SmartEdgeSet invalidated_edges(this->g(), false, CoverageComparator<Graph>(this->g()));
+            phmap::flat_hash_map<EdgeId, size_t> invalidated_ids;
+            for (BulgeInfo& info : interacting) {
+                if (CheckInvalidated(info, glued_vertices)) {
+                    invalidated_edges.push(info.e);
+                    invalidated_ids[info.e] = info.id;
+                } else {
+                    valid.push_back(std::move(info));
+                }
+            }
 
-        for (const BulgeInfo& info : independent_bulges) {
-            TRACE("Processing bulge " << info.str(this->g()));
-            triggered++;
-            gluer_(info.e, info.alternative);
-        }
+            DEBUG("Round " << round << ": gluing " << bulges.size() << " independent bulges, "
+                  << valid.size() << " bulges stay valid");
+            triggered += GlueIndependentBulges(bulges);
 
-        DEBUG("Independent bulges glued in " << perf.time() << " seconds");
-        perf.reset();
+            if (valid.size() + invalidated_edges.size() < SMALL_BUFFER_THR) {
+                utils::perf_counter perf;
+                for (const BulgeInfo& info : valid)
+                    invalidated_edges.push(info.e);
+                DEBUG("Processing remaining interacting bulges " << invalidated_edges.size());
+                triggered += BasicProcessBulges(invalidated_edges);
+                DEBUG("Interacting edges processed in " << perf.time() << " seconds");
+                break;
+            }
+
+            //edges removed by gluing were already dropped from the smart set
+            std::vector<EdgeId> edge_buffer;
+            std::vector<size_t> ids;
+            edge_buffer.reserve(invalidated_edges.size());
+            ids.reserve(invalidated_edges.size());
+            for (; !invalidated_edges.IsEnd(); ++invalidated_edges) {
+                edge_buffer.push_back(*invalidated_edges);
+                ids.push_back(invalidated_ids[*invalidated_edges]);
+            }
+            auto bulge_buffers = FindBulges(edge_buffer, ids);
+            bulge_buffers.push_back(std::move(valid));
+            bulges = MergeBuffers(std::move(bulge_buffers));
+        }
 
-        DEBUG("Processing remaining interacting bulges " << interacting_edges.size());
-        triggered += BasicProcessBulges(interacting_edges);
-        DEBUG("Interacting edges processed in " << perf.time() << " seconds");
         return triggered;
     }
 
@@ -717,9 +816,7 @@ public:
                 inner_triggered = BasicProcessBulges(edges);
                 DEBUG("Small buffer processed in " << perf.time() << " seconds");
             } else {
-                auto bulges = MergeBuffers(FindBulges(edge_buffer));
-                auto interacting_edges = RetainIndependentBulges(bulges);
-                inner_triggered = ProcessBulges(bulges, interacting_edges);
+                inner_triggered = ProcessBulges(MergeBuffers(FindBulges(edge_buffer)));
             }
 
             proceed |= (inner_triggered > 0);
@@ -9,6 +9,8 @@
 #include "distance_estimation.hpp"
 #include "assembly_graph/paths/path_processor.hpp"
 
+#include <numeric>
+
 namespace omnigraph {
 namespace de {
 
@@ -23,10 +25,18 @@ std::vector<size_t> GraphDistanceFinder::GetGraphDistancesLengths(EdgeId e1, Edg
     return m[e2];
 }
 
+std::unique_ptr<GraphDistanceFinder::PathProcessorT> GraphDistanceFinder::CreatePathProcessor(EdgeId e1) const {
+    size_t path_upper_bound = PairInfoPathLengthUpperBound(graph_.k(), insert_size_, delta_);
+    return std::make_unique<PathProcessorT>(graph_, graph_.EdgeEnd(e1), path_upper_bound);
+}
+
 void GraphDistanceFinder::FillGraphDistancesLengths(EdgeId e1, LengthMap &second_edges) const {
-    std::vector<size_t> path_lower_bounds;
+    FillGraphDistancesLengths(*CreatePathProcessor(e1), e1, second_edges);
+}
+
+void GraphDistanceFinder::FillGraphDistancesLengths(const PathProcessorT &paths_proc, EdgeId e1,
+                                                    LengthMap &second_edges) const {
     size_t path_upper_bound = PairInfoPathLengthUpperBound(graph_.k(), insert_size_, delta_);
-    PathProcessor <Graph> paths_proc(graph_, graph_.EdgeEnd(e1), path_upper_bound);
 
     for (auto &entry : second_edges) {
         EdgeId e2 = entry.first;
@@ -53,8 +63,12 @@ void GraphDistanceFinder::FillGraphDistancesLengths(EdgeId e1, LengthMap &second
     }
 }
 
-void AbstractDistanceEstimator::FillGraphDistancesLengths(EdgeId e1, LengthMap &second_edges) const {
-    distance_finder_.FillGraphDistancesLengths(e1, second_edges);
+void AbstractDistanceEstimator::FillGraphDistancesLengths(EdgeId e1, LengthMap &second_edges,
+                                                          const PathProcessorT *paths_proc) const {
+    if (paths_proc)
+        distance_finder_.FillGraphDistancesLengths(*paths_proc, e1, second_edges);
+    else
+        distance_finder_.FillGraphDistancesLengths(e1, second_edges);
 }
 
 AbstractDistanceEstimator::OutHistogram AbstractDistanceEstimator::ClusterResult(EdgePair,
@@ -89,12 +103,78 @@ void DistanceEstimator::Estimate(PairedInfoIndexT<Graph> &result, size_t nthread
     for (EdgeId e : this->graph().edges())
         edges.push_back(e);
 
-    DEBUG("Processing");
-    PairedInfoBuffersT<Graph> buffer(this->graph(), nthreads);
-#   pragma omp parallel for num_threads(nthreads) schedule(guided, 10)
+    // The cost of an edge is roughly proportional to the size of its
+    // neighbourhood, which is heavily skewed (especially for mate pairs): a few
+    // hub edges might have most of the pairs. Split the neighbourhoods into
+    // tasks of bounded size and process the largest ones first. Neighbourhoods
+    // are collected once, so the task is just a range of its first edge's one.
+    std::vector<size_t> offsets(edges.size() + 1, 0);
+#   pragma omp parallel for num_threads(nthreads) schedule(guided)
+    for (size_t i = 0; i < edges.size(); ++i) {
+        size_t degree = 0;
+        for (auto it : index.GetHalf(edges[i])) {
+            (void)it;
+            degree += 1;
+        }
+        offsets[i + 1] = degree;
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::vector<EdgeId> neighbours(offsets.back());
+#   pragma omp parallel for num_threads(nthreads) schedule(guided)
     for (size_t i = 0; i < edges.size(); ++i) {
-        EdgeId edge = edges[i];
-        ProcessEdge(edge, index, buffer[omp_get_thread_num()]);
+        size_t pos = offsets[i];
+        for (auto it : index.GetHalf(edges[i]))
+            neighbours[pos++] = it.first;
+    }
+
+    const size_t MIN_TASK_SIZE = 16, TASKS_PER_THREAD = 16;
+    size_t total = neighbours.size();
+    size_t task_size = std::max(MIN_TASK_SIZE, total / (nthreads * TASKS_PER_THREAD));
+
+    struct Task {
+        size_t edge;
+        size_t begin, end;
+    };
+    std::vector<Task> tasks;
+    std::vector<size_t> hubs;
+    for (size_t i = 0; i < edges.size(); ++i) {
+        for (size_t begin = offsets[i]; begin < offsets[i + 1]; begin += task_size)
+            tasks.push_back({ i, begin, std::min(offsets[i + 1], begin + task_size) });
+        if (offsets[i + 1] - offsets[i] > task_size)
+            hubs.push_back(i);
+    }
+    std::stable_sort(tasks.begin(), tasks.end(),
+                     [](const Task &lhs, const Task &rhs) { return lhs.end - lhs.begin > rhs.end - rhs.begin; });
+    DEBUG("Processing " << total << " edge pairs in " << tasks.size() << " tasks");
+
+    // The paths from the edge split between several tasks are found only once and shared by them
+    std::vector<std::unique_ptr<PathProcessorT>> hub_paths(edges.size());
+#   pragma omp parallel for num_threads(nthreads) schedule(dynamic, 1)
+    for (size_t i = 0; i < hubs.size(); ++i)
+        hub_paths[hubs[i]] = this->CreatePathProcessor(edges[hubs[i]]);
+
+    // Thread-local results are flushed into the resulting index as soon as
+    // they become large enough, so the merge is overlapped with the estimation
+    // in other threads and the memory consumption stays bounded.
+    const size_t FLUSH_SIZE = 1 << 16;
+    PairedInfoBuffersT<Graph> buffer(this->graph(), nthreads);
+#   pragma omp parallel for num_threads(nthreads) schedule(dynamic, 1)
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        const Task &task = tasks[i];
+        typename base::LengthMap second_edges;
+        for (size_t j = task.begin; j < task.end; ++j)
+            second_edges[neighbours[j]];
+
+        auto &local = buffer[omp_get_thread_num()];
+        ProcessEdge(edges[task.edge], second_edges, index, local, hub_paths[task.edge].get());
+        if (local.size() > FLUSH_SIZE) {
+#           pragma omp critical(distance_estimation_merge)
+            {
+                result.Merge(local);
+            }
+            local.clear();
+        }
     }
 
     for (size_t i = 0; i < nthreads; ++i) {
@@ -113,8 +193,10 @@ DistanceEstimator::EstimHist DistanceEstimator::EstimateEdgePairDistances(EdgePa
 
     TRACE("Bounds are " << minD << " " << maxD);
     EstimHist result;
-    std::vector<DEDistance> forward;
-    forward.reserve(raw_forward.size());
+    // Scratch buffers are reused between the calls in the same thread
+    static thread_local std::vector<DEDistance> forward;
+    static thread_local std::vector<DEWeight> weights;
+    forward.clear();
     for (auto raw_length : raw_forward) {
         int length = int(raw_length);
         if (minD - int(max_distance_) <= length && length <= maxD + int(max_distance_))
@@ -124,7 +206,7 @@ DistanceEstimator::EstimHist DistanceEstimator::EstimateEdgePairDistances(EdgePa
         return result;
 
     size_t cur_dist = 0;
-    std::vector<DEWeight> weights(forward.size(), 0);
+    weights.assign(forward.size(), 0);
     for (auto point : histogram) {
         if (ls(2 * point.d + DEDistance(second_len), DEDistance(first_len)))
             continue;
@@ -158,13 +240,9 @@ DistanceEstimator::EstimHist DistanceEstimator::EstimateEdgePairDistances(EdgePa
     return result;
 }
 
-void DistanceEstimator::ProcessEdge(EdgeId e1, const InPairedIndex &pi, PairedInfoBuffer<Graph> &result) const {
-    typename base::LengthMap second_edges;
-    auto inner_map = pi.GetHalf(e1);
-    for (auto i : inner_map)
-        second_edges[i.first];
-
-    this->FillGraphDistancesLengths(e1, second_edges);
+void DistanceEstimator::ProcessEdge(EdgeId e1, LengthMap &second_edges, const InPairedIndex &pi,
+                                    PairedInfoBuffer<Graph> &result, const PathProcessorT *paths_proc) const {
+    this->FillGraphDistancesLengths(e1, second_edges, paths_proc);
 
     for (const auto &entry: second_edges) {
         EdgeId e2 = entry.first;
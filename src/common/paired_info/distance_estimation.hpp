@@ -13,10 +13,13 @@
 #include "pair_info_bounds.hpp"
 
 #include "assembly_graph/core/graph.hpp"
+#include "assembly_graph/paths/path_processor.hpp"
 #include "utils/parallel/openmp_wrapper.h"
 
 #include "math/xmath.h"
 
+#include <memory>
+
 namespace omnigraph {
 
 namespace de {
@@ -28,6 +31,8 @@ class GraphDistanceFinder {
     typedef std::map<debruijn_graph::EdgeId, GraphLengths> LengthMap;
 
 public:
+    typedef PathProcessor<debruijn_graph::Graph> PathProcessorT;
+
     GraphDistanceFinder(const debruijn_graph::Graph &graph, size_t insert_size, size_t read_length, size_t delta) :
             graph_(graph), insert_size_(insert_size), gap_((int) (insert_size - 2 * read_length)),
             delta_((double) delta) { }
@@ -37,6 +42,12 @@ public:
     // finds all distances from a current edge to a set of edges
     void FillGraphDistancesLengths(debruijn_graph::EdgeId e1, LengthMap &second_edges) const;
 
+    // the same, reusing the paths from e1 found beforehand (the processor could be shared between threads)
+    void FillGraphDistancesLengths(const PathProcessorT &paths_proc, debruijn_graph::EdgeId e1,
+                                   LengthMap &second_edges) const;
+
+    std::unique_ptr<PathProcessorT> CreatePathProcessor(debruijn_graph::EdgeId e1) const;
+
 private:
     DECL_LOGGER("GraphDistanceFinder");
     const debruijn_graph::Graph &graph_;
@@ -69,12 +80,19 @@ protected:
     typedef std::vector<std::pair<int, double>> EstimHist;
     typedef std::vector<size_t> GraphLengths;
     typedef std::map<debruijn_graph::EdgeId, GraphLengths> LengthMap;
+    typedef GraphDistanceFinder::PathProcessorT PathProcessorT;
 
     const debruijn_graph::Graph &graph() const { return graph_; }
 
     const InPairedIndex &index() const { return index_; }
 
-    void FillGraphDistancesLengths(debruijn_graph::EdgeId e1, LengthMap &second_edges) const;
+    // paths_proc (if any) holds the paths from e1 shared by the calls for its different second edges
+    void FillGraphDistancesLengths(debruijn_graph::EdgeId e1, LengthMap &second_edges,
+                                   const PathProcessorT *paths_proc = nullptr) const;
+
+    std::unique_ptr<PathProcessorT> CreatePathProcessor(debruijn_graph::EdgeId e1) const {
+        return distance_finder_.CreatePathProcessor(e1);
+    }
 
     OutHistogram ClusterResult(EdgePair /*ep*/, const EstimHist &estimated) const;
 
@@ -126,9 +144,16 @@ protected:
                                                 const GraphLengths &raw_forward) const;
 
 private:
+    /**
+     * @brief Estimates distances from e1 to the second edges given (a part of the
+     *        half-neighbourhood of e1, large neighbourhoods are split between several calls
+     *        sharing the paths from e1 in paths_proc).
+     */
     virtual void ProcessEdge(debruijn_graph::EdgeId e1,
+                             LengthMap &second_edges,
                              const InPairedIndex &pi,
-                             PairedInfoBuffer<debruijn_graph::Graph> &result) const;
+                             PairedInfoBuffer<debruijn_graph::Graph> &result,
+                             const PathProcessorT *paths_proc) const;
 
     virtual const std::string Name() const {
         static const std::string my_name = "SIMPLE";
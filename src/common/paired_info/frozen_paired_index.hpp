@@ -0,0 +1,484 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "paired_info.hpp"
+
+#include "io/kmers/mmapped_reader.hpp"
+#include "utils/logger/logger.hpp"
+#include "utils/verify.hpp"
+
+#include <boost/iterator/iterator_facade.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace omnigraph {
+
+namespace de {
+
+/**
+ * @brief Immutable compact form of the clustered paired index.
+ * @detail After the clustering, PairedInfoIndexT is never modified, but its btree-of-btrees layout
+ *         (with a separately allocated histogram per edge pair) is rather wasteful. The frozen index
+ *         stores the same data in a handful of flat arrays:
+ *         - CSR over first edges: sorted first edges and offsets of their rows;
+ *         - sorted second edges of each row together with the ids of their histograms
+ *           (a pair and its conjugate share the very same histogram, as in PairedIndex);
+ *         - offsets of the histograms into point columns;
+ *         - separate columns for gaps, weights and variances of the points (no padding inside GapPoint).
+ *         The in-memory image is exactly the on-disk one, so Load() just maps the file.
+ *         Data accessors mimic the ones of PairedIndex, so the frozen index could be used as a drop-in
+ *         replacement in the read-only code templated on the index type.
+ */
+template<class G>
+class FrozenPairedIndex {
+    typedef FrozenPairedIndex<G> self;
+
+  public:
+    typedef G Graph;
+    typedef typename Graph::EdgeId EdgeId;
+    typedef std::pair<EdgeId, EdgeId> EdgePair;
+    typedef PointTraits::Expanded Point;
+    typedef omnigraph::de::Histogram<Point> Histogram;
+    typedef PairedInfoIndexT<Graph> Source;
+
+  private:
+    static_assert(std::is_trivially_copyable<EdgeId>::value, "Edge ids are stored as raw memory");
+
+    static constexpr uint64_t MAGIC = 0x315844495a5246ULL; // "FRZIDX1"
+
+    struct Header {
+        uint64_t magic;
+        uint64_t rows, entries, hists, points;
+        uint64_t size;
+    };
+
+    struct Layout {
+        size_t row_edges, row_offsets, entry_edges, entry_hists, hist_offsets, d, weight, var, total;
+
+        explicit Layout(const Header &h) {
+            size_t pos = sizeof(Header);
+            row_edges = Place(pos, h.rows * sizeof(EdgeId));
+            row_offsets = Place(pos, (h.rows + 1) * sizeof(uint64_t));
+            entry_edges = Place(pos, h.entries * sizeof(EdgeId));
+            entry_hists = Place(pos, h.entries * sizeof(uint32_t));
+            hist_offsets = Place(pos, (h.hists + 1) * sizeof(uint64_t));
+            d = Place(pos, h.points * sizeof(DEGap));
+            weight = Place(pos, h.points * sizeof(DECropWeight));
+            var = Place(pos, h.points * sizeof(DEVariance));
+            total = pos;
+        }
+
+      private:
+        // All arrays are 8-byte aligned
+        static size_t Place(size_t &pos, size_t bytes) {
+            size_t res = pos;
+            pos = (pos + bytes + 7) / 8 * 8;
+            return res;
+        }
+    };
+
+  public:
+    /**
+     * @brief Proxy set of points between two edges, see PairedIndex::HistProxy.
+     */
+    class HistProxy {
+      public:
+        class Iterator: public boost::iterator_facade<Iterator, Point, boost::bidirectional_traversal_tag, Point> {
+          public:
+            Iterator(const FrozenPairedIndex *index, size_t pos, DEDistance offset, bool back = false)
+                    : index_(index), pos_(pos), offset_(offset), back_(back)
+            {}
+
+          private:
+            friend class boost::iterator_core_access;
+
+            Point dereference() const {
+                Point result = index_->ExpandPoint(back_ ? pos_ - 1 : pos_, offset_);
+                if (back_)
+                    result.d = -result.d;
+                return result;
+            }
+
+            void increment() {
+                back_ ? --pos_ : ++pos_;
+            }
+
+            void decrement() {
+                back_ ? ++pos_ : --pos_;
+            }
+
+            bool equal(const Iterator &other) const {
+                return pos_ == other.pos_ && back_ == other.back_;
+            }
+
+            const FrozenPairedIndex *index_;
+            size_t pos_; //current position in point columns
+            DEDistance offset_; //edge length
+            bool back_;
+        };
+
+        HistProxy(const FrozenPairedIndex &index, size_t begin, size_t end, DEDistance offset = 0, bool back = false)
+                : index_(&index), begin_(begin), end_(end), offset_(offset), back_(back)
+        {}
+
+        Iterator begin() const {
+            return Iterator(index_, back_ ? end_ : begin_, offset_, back_);
+        }
+
+        Iterator end() const {
+            return Iterator(index_, back_ ? begin_ : end_, offset_, back_);
+        }
+
+        Point min() const {
+            VERIFY(!empty());
+            return *begin();
+        }
+
+        Point max() const {
+            VERIFY(!empty());
+            return *--end();
+        }
+
+        Histogram Unwrap() const {
+            return Histogram(begin(), end());
+        }
+
+        size_t size() const {
+            return end_ - begin_;
+        }
+
+        bool empty() const {
+            return begin_ == end_;
+        }
+
+      private:
+        const FrozenPairedIndex *index_;
+        size_t begin_, end_;
+        DEDistance offset_;
+        bool back_;
+    };
+
+    typedef typename HistProxy::Iterator HistIterator;
+
+    using EdgeHist = std::pair<EdgeId, HistProxy>;
+
+    /**
+     * @brief Proxy map representing neighbourhood of an edge, see PairedIndex::EdgeProxy.
+     */
+    class EdgeProxy {
+      public:
+        class Iterator: public boost::iterator_facade<Iterator, EdgeHist, boost::forward_traversal_tag, EdgeHist> {
+            void Skip() { //For a half iterator, skip conjugate pairs
+                while (half_ && pos_ != stop_ && !index_->IsCanonical(edge_, index_->entry_edges_[pos_]))
+                    ++pos_;
+            }
+
+          public:
+            Iterator(const FrozenPairedIndex &index, size_t pos, size_t stop, EdgeId edge, bool half)
+                    : index_(&index), pos_(pos), stop_(stop), edge_(edge), half_(half) {
+                Skip();
+            }
+
+          private:
+            friend class boost::iterator_core_access;
+
+            void increment() {
+                ++pos_;
+                Skip();
+            }
+
+            bool equal(const Iterator &other) const {
+                return pos_ == other.pos_;
+            }
+
+            EdgeHist dereference() const {
+                return std::make_pair(index_->entry_edges_[pos_], index_->EntryHist(pos_, edge_));
+            }
+
+            const FrozenPairedIndex *index_;
+            size_t pos_, stop_;
+            EdgeId edge_;
+            bool half_;
+        };
+
+        EdgeProxy(const FrozenPairedIndex &index, size_t begin, size_t end, EdgeId edge, bool half = false)
+                : index_(index), begin_(begin), end_(end), edge_(edge), half_(half)
+        {}
+
+        Iterator begin() const {
+            return Iterator(index_, begin_, end_, edge_, half_);
+        }
+
+        Iterator end() const {
+            return Iterator(index_, end_, end_, edge_, half_);
+        }
+
+        HistProxy operator[](EdgeId e2) const {
+            if (half_ && !index_.IsCanonical(edge_, e2))
+                return index_.EmptyHist();
+            return index_.Get(edge_, e2);
+        }
+
+        bool empty() const {
+            return begin_ == end_;
+        }
+
+      private:
+        const FrozenPairedIndex &index_;
+        size_t begin_, end_;
+        EdgeId edge_;
+        bool half_;
+    };
+
+    typedef typename EdgeProxy::Iterator EdgeIterator;
+
+    //---------------- Constructors ----------------
+
+    /**
+     * @brief Creates an empty index. Use Load() to fill it in.
+     */
+    FrozenPairedIndex(const Graph &graph)
+            : graph_(&graph) {
+        Header h{};
+        h.magic = MAGIC;
+        Allocate(h);
+    }
+
+    /**
+     * @brief Freezes the clustered index. The source index is not needed afterwards and could be cleared.
+     */
+    explicit FrozenPairedIndex(const Source &index)
+            : graph_(&index.graph()) {
+        typedef typename Source::InnerMap::mapped_type::pointer HistPtr;
+
+        Header h{};
+        h.magic = MAGIC;
+        h.size = index.size();
+        // Histogram ids in the order of their first occurrence
+        std::unordered_map<HistPtr, uint32_t> hist_ids;
+        for (auto it = index.data_begin(); it != index.data_end(); ++it) {
+            h.rows += 1;
+            for (const auto &entry : it->second) {
+                h.entries += 1;
+                if (hist_ids.emplace(entry.second.get(), uint32_t(h.hists)).second) {
+                    h.hists += 1;
+                    h.points += entry.second->size();
+                }
+            }
+        }
+        VERIFY_MSG(h.hists <= std::numeric_limits<uint32_t>::max(), "Too many histograms in paired index");
+        Allocate(h);
+
+        std::vector<bool> filled(h.hists, false);
+        size_t row = 0, entry = 0, point = 0;
+        row_offsets_[0] = 0;
+        for (auto it = index.data_begin(); it != index.data_end(); ++it) {
+            row_edges_[row] = it->first;
+            for (const auto &e : it->second) {
+                uint32_t hist = hist_ids[e.second.get()];
+                entry_edges_[entry] = e.first;
+                entry_hists_[entry] = hist;
+                entry += 1;
+
+                if (filled[hist])
+                    continue;
+                // Histograms are numbered in the order of their first occurrence,
+                // so the next unfilled one always goes right after the previous ones
+                VERIFY(hist_offsets_[hist] == point);
+                for (const auto &p : *e.second) {
+                    d_[point] = p.d;
+                    weight_[point] = p.weight;
+                    var_[point] = p.var;
+                    point += 1;
+                }
+                hist_offsets_[hist + 1] = point;
+                filled[hist] = true;
+            }
+            row += 1;
+            row_offsets_[row] = entry;
+        }
+        VERIFY(row == h.rows && entry == h.entries && point == h.points);
+    }
+
+    FrozenPairedIndex(const FrozenPairedIndex &) = delete;
+    FrozenPairedIndex &operator=(const FrozenPairedIndex &) = delete;
+    FrozenPairedIndex(FrozenPairedIndex &&) = default;
+    FrozenPairedIndex &operator=(FrozenPairedIndex &&) = default;
+
+    //---------------- Serialization ----------------
+
+    void Save(const std::filesystem::path &filename) const {
+        std::ofstream os(filename, std::ios::binary);
+        os.write(reinterpret_cast<const char*>(data_), Layout(*header_).total);
+        CHECK_FATAL_ERROR(!os.fail(), "Failed to write frozen paired index " << filename);
+    }
+
+    /**
+     * @brief Maps the previously saved index into memory. The data is paged in lazily on access.
+     */
+    void Load(const std::filesystem::path &filename) {
+        auto mapped = std::make_unique<MMappedReader>(filename, /* unlink */ false, -1ULL);
+        const uint8_t *data = static_cast<const uint8_t*>(mapped->data());
+        CHECK_FATAL_ERROR(mapped->data_size() >= sizeof(Header), "Truncated frozen paired index " << filename);
+        const Header &h = *reinterpret_cast<const Header*>(data);
+        CHECK_FATAL_ERROR(h.magic == MAGIC, "Invalid frozen paired index " << filename);
+        CHECK_FATAL_ERROR(mapped->data_size() == Layout(h).total, "Truncated frozen paired index " << filename);
+
+        buffer_.clear();
+        buffer_.shrink_to_fit();
+        mapped_ = std::move(mapped);
+        Attach(data);
+    }
+
+    //---------------- Data accessing methods ----------------
+
+    const Graph &graph() const { return *graph_; }
+
+    /**
+     * @brief Returns the physical index size (total count of all points), the same as of the source index.
+     */
+    size_t size() const { return header_->size; }
+
+    /**
+     * @brief Returns the number of bytes occupied by the index data.
+     */
+    size_t data_size() const { return Layout(*header_).total; }
+
+    EdgePair ConjugatePair(EdgeId e1, EdgeId e2) const {
+        return std::make_pair(graph_->conjugate(e2), graph_->conjugate(e1));
+    }
+
+    bool IsCanonical(EdgeId e1, EdgeId e2) const {
+        auto ep = std::make_pair(e1, e2);
+        return ep <= this->ConjugatePair(e1, e2);
+    }
+
+    EdgeProxy Get(EdgeId e) const {
+        auto row = FindRow(e);
+        return EdgeProxy(*this, row.first, row.second, e);
+    }
+
+    EdgeProxy GetHalf(EdgeId e) const {
+        auto row = FindRow(e);
+        return EdgeProxy(*this, row.first, row.second, e, true);
+    }
+
+    EdgeProxy operator[](EdgeId e) const {
+        return Get(e);
+    }
+
+    HistProxy Get(EdgeId e1, EdgeId e2) const {
+        size_t entry = FindEntry(e1, e2);
+        if (entry == -1ULL)
+            return EmptyHist();
+        return EntryHist(entry, e1);
+    }
+
+    HistProxy operator[](EdgePair p) const {
+        return Get(p.first, p.second);
+    }
+
+    bool contains(EdgeId edge) const {
+        auto row = FindRow(edge), conj_row = FindRow(graph_->conjugate(edge));
+        return row.first != row.second || conj_row.first != conj_row.second;
+    }
+
+    bool contains(EdgeId e1, EdgeId e2) const {
+        return FindEntry(e1, e2) != -1ULL;
+    }
+
+  private:
+    void Allocate(const Header &h) {
+        buffer_.assign((Layout(h).total + sizeof(uint64_t) - 1) / sizeof(uint64_t), 0);
+        uint8_t *data = reinterpret_cast<uint8_t*>(buffer_.data());
+        *reinterpret_cast<Header*>(data) = h;
+        Attach(data);
+    }
+
+    void Attach(const uint8_t *data) {
+        data_ = data;
+        header_ = reinterpret_cast<const Header*>(data);
+        Layout layout(*header_);
+        // The arrays are writable only while the index is being built from the owned buffer
+        uint8_t *mdata = const_cast<uint8_t*>(data);
+        row_edges_ = reinterpret_cast<EdgeId*>(mdata + layout.row_edges);
+        row_offsets_ = reinterpret_cast<uint64_t*>(mdata + layout.row_offsets);
+        entry_edges_ = reinterpret_cast<EdgeId*>(mdata + layout.entry_edges);
+        entry_hists_ = reinterpret_cast<uint32_t*>(mdata + layout.entry_hists);
+        hist_offsets_ = reinterpret_cast<uint64_t*>(mdata + layout.hist_offsets);
+        d_ = reinterpret_cast<DEGap*>(mdata + layout.d);
+        weight_ = reinterpret_cast<DECropWeight*>(mdata + layout.weight);
+        var_ = reinterpret_cast<DEVariance*>(mdata + layout.var);
+    }
+
+    //Returns the range of entries of the edge row (empty if there is no such row)
+    std::pair<size_t, size_t> FindRow(EdgeId e) const {
+        const EdgeId *begin = row_edges_, *end = row_edges_ + header_->rows;
+        const EdgeId *it = std::lower_bound(begin, end, e);
+        if (it == end || *it != e)
+            return { 0, 0 };
+        size_t row = it - begin;
+        return { row_offsets_[row], row_offsets_[row + 1] };
+    }
+
+    size_t FindEntry(EdgeId e1, EdgeId e2) const {
+        auto row = FindRow(e1);
+        const EdgeId *begin = entry_edges_ + row.first, *end = entry_edges_ + row.second;
+        const EdgeId *it = std::lower_bound(begin, end, e2);
+        if (it == end || *it != e2)
+            return -1ULL;
+        return it - entry_edges_;
+    }
+
+    HistProxy EntryHist(size_t entry, EdgeId e1) const {
+        uint32_t hist = entry_hists_[entry];
+        return HistProxy(*this, hist_offsets_[hist], hist_offsets_[hist + 1], CalcOffset(e1));
+    }
+
+    HistProxy EmptyHist() const {
+        return HistProxy(*this, 0, 0);
+    }
+
+    Point ExpandPoint(size_t pos, DEDistance offset) const {
+        return PointTraits::Expand(GapPoint(d_[pos], weight_[pos], var_[pos]), offset);
+    }
+
+    size_t CalcOffset(EdgeId e) const {
+        return this->graph().length(e);
+    }
+
+    const Graph *graph_;
+    std::vector<uint64_t> buffer_; //owned image, when not mapped
+    std::unique_ptr<MMappedReader> mapped_;
+
+    const uint8_t *data_;
+    const Header *header_;
+    EdgeId *row_edges_;
+    uint64_t *row_offsets_;
+    EdgeId *entry_edges_;
+    uint32_t *entry_hists_;
+    uint64_t *hist_offsets_;
+    DEGap *d_;
+    DECropWeight *weight_;
+    DEVariance *var_;
+};
+
+template<class Graph>
+using FrozenPairedInfoIndicesT = PairedIndices<FrozenPairedIndex<Graph>>;
+
+}
+
+}
@@ -257,6 +257,15 @@ struct PointT : public RawPointT<D, W> {
     }
 
     DEVariance variance() { return this->var; } //TODO: remove
+
+    // The ones of RawPointT would drop the variance
+    void BinWrite(std::ostream &str) const {
+        str.write(reinterpret_cast<const char *>(this), sizeof(Self));
+    }
+
+    void BinRead(std::istream &str) {
+        str.read(reinterpret_cast<char *>(this), sizeof(Self));
+    }
 };
 
 typedef PointT<DEDistance, DEWeight> Point;
@@ -26,6 +26,13 @@ using namespace debruijn_graph;
 
 using EdgePairCounter = hll::hll_with_hasher<std::pair<EdgeId, EdgeId>>;
 
+uint64_t EdgePairHasher::operator()(const EdgePair &e, uint64_t seed) const {
+    // Note that EdgeId::hash is essentially an identity function, so we'd need to
+    // combine them properly
+    std::array<uint64_t, 2> hashes = { e.first.hash(), e.second.hash() };
+    return XXH3_64bits_withSeed(hashes.data(), sizeof(hashes), seed);
+}
+
 class EdgePairCounterFiller : public SequenceMapperListener {
     static uint64_t EdgePairHash(const std::pair<EdgeId, EdgeId> &e) {
         // Note that EdgeId::hash is essentially an identity function, so we'd need to
@@ -205,14 +212,10 @@ std::unique_ptr<PairedInfoFilter> FillEdgePairFilter(const Graph &graph,
                                                      const SequenceMapperNotifier::SequenceMapperT &mapper,
                                                      SequencingLib &reads,
                                                      size_t edgepairs) {
-    auto filter = std::make_unique<paired_info::PairedInfoFilter>(
-        [](const std::pair<EdgeId, EdgeId> &e, uint64_t seed) {
-            // Note that EdgeId::hash is essentially an identity function, so we'd need to
-            // combine them properly
-            std::array<uint64_t, 2> hashes = { e.first.hash(), e.second.hash() };
-            return XXH3_64bits_withSeed(hashes.data(), sizeof(hashes), seed);
-        },
-        12 * edgepairs);
+    // Blocked filter needs more cells than the ordinary one for the same false
+    // positive rate: 14 cells per pair give ~1.0% of singletons reported as
+    // repeated, ordinary filter had ~1.1% with 12 cells (see bf_test)
+    auto filter = std::make_unique<paired_info::PairedInfoFilter>(EdgePairHasher(), 14 * edgepairs);
 
     SequenceMapperNotifier notifier;
     DEFilter filter_counter(*filter, graph);
@@ -18,8 +18,13 @@
 namespace paired_info {
 
 using SequencingLib = io::SequencingLibrary<debruijn_graph::config::LibraryData>;
-using PairedInfoFilter = bf::counting_bloom_filter<std::pair<debruijn_graph::Graph::EdgeId,
-                                                             debruijn_graph::Graph::EdgeId>, 2>;
+using EdgePair = std::pair<debruijn_graph::Graph::EdgeId, debruijn_graph::Graph::EdgeId>;
+
+struct EdgePairHasher {
+    uint64_t operator()(const EdgePair &e, uint64_t seed) const;
+};
+
+using PairedInfoFilter = bf::blocked_counting_bloom_filter<EdgePair, 2, EdgePairHasher>;
 using PairedIndex = omnigraph::de::UnclusteredPairedInfoIndexT<debruijn_graph::Graph>;
 
 bool CollectLibInformation(const debruijn_graph::Graph &gp,
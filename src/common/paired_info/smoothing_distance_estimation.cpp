@@ -82,14 +82,10 @@ SmoothingDistanceEstimator::EstimHist SmoothingDistanceEstimator::FindEdgePairDi
     return new_result;
 }
 
-void SmoothingDistanceEstimator::ProcessEdge(EdgeId e1, const InPairedIndex &pi,
-                                             PairedInfoBuffer<Graph> &result) const {
-    typename base::LengthMap second_edges;
-    auto inner_map = pi.GetHalf(e1);
-    for (auto I : inner_map)
-        second_edges[I.first];
-
-    this->FillGraphDistancesLengths(e1, second_edges);
+void SmoothingDistanceEstimator::ProcessEdge(EdgeId e1, LengthMap &second_edges, const InPairedIndex &pi,
+                                             PairedInfoBuffer<Graph> &result,
+                                             const PathProcessorT *paths_proc) const {
+    this->FillGraphDistancesLengths(e1, second_edges, paths_proc);
 
     for (const auto &entry: second_edges) {
         EdgeId e2 = entry.first;
@@ -82,8 +82,10 @@ private:
                                     const TempHistogram &raw_hist) const;
 
     void ProcessEdge(debruijn_graph::EdgeId e1,
+                     LengthMap &second_edges,
                      const InPairedIndex &pi,
-                     PairedInfoBuffer<debruijn_graph::Graph> &result) const override;
+                     PairedInfoBuffer<debruijn_graph::Graph> &result,
+                     const PathProcessorT *paths_proc) const override;
 
     bool IsTipTip(debruijn_graph::EdgeId e1, debruijn_graph::EdgeId e2) const;
 
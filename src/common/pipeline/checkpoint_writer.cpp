@@ -0,0 +1,92 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "checkpoint_writer.hpp"
+
+#include "utils/logger/logger.hpp"
+
+namespace spades {
+
+CheckpointWriter::CheckpointWriter()
+        : busy_(false), stop_(false) {
+    thread_ = std::thread(&CheckpointWriter::worker, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    job_cv_.notify_all();
+    thread_.join();
+
+    if (error_) {
+        try {
+            std::rethrow_exception(error_);
+        } catch (const std::exception &e) {
+            ERROR("Checkpoint was not saved: " << e.what());
+        } catch (...) {
+            ERROR("Checkpoint was not saved");
+        }
+    }
+}
+
+void CheckpointWriter::rethrow() {
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void CheckpointWriter::submit(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rethrow();
+        jobs_.push_back(std::move(job));
+    }
+    job_cv_.notify_one();
+}
+
+void CheckpointWriter::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+    rethrow();
+}
+
+void CheckpointWriter::worker() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // Pending jobs are finished even if we're asked to stop
+        job_cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+        if (jobs_.empty())
+            break;
+
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+        busy_ = true;
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            job();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        busy_ = false;
+        if (error) {
+            // Do not proceed with the subsequent jobs: they might e.g. mark
+            // the failed checkpoint as complete
+            error_ = error;
+            jobs_.clear();
+        }
+        done_cv_.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,51 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace spades {
+
+/// Executes checkpoint writing jobs in a background thread, so the pipeline
+/// could proceed to the next stage while the previous checkpoint is still
+/// being written. Jobs are executed one by one in the order of submission.
+/// An exception thrown by a job is rethrown from the next submit() / wait().
+class CheckpointWriter {
+  public:
+    typedef std::function<void()> Job;
+
+    CheckpointWriter();
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter &) = delete;
+    CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+
+    void submit(Job job);
+
+    /// Blocks until all the submitted jobs are finished
+    void wait();
+
+  private:
+    void worker();
+    void rethrow();
+
+    std::deque<Job> jobs_;
+    bool busy_;
+    bool stop_;
+    std::exception_ptr error_;
+
+    std::mutex mutex_;
+    std::condition_variable job_cv_, done_cv_;
+    std::thread thread_;
+};
+
+}
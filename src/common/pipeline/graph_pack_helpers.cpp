@@ -16,10 +16,14 @@
 #include "assembly_graph/graph_support/genomic_quality.hpp"
 #include "assembly_graph/handlers/edges_position_handler.hpp"
 #include "assembly_graph/paths/bidirectional_path_container.hpp"
+#include "io/binary/paired_index.hpp"
+#include "paired_info/frozen_paired_index.hpp"
 #include "paired_info/paired_info.hpp"
 #include "sequence/genome_storage.hpp"
 #include "visualization/position_filler.hpp"
 
+#include <memory>
+
 namespace graph_pack {
 
 using namespace debruijn_graph;
@@ -106,6 +110,55 @@ void ClearRRIndicesAndPaths(GraphPack& gp) {
     gp.get_mutable<path_extend::PathContainer>("exSPAnder paths").clear();
 }
 
+static std::string ClusteredIndicesBasename(const GraphPack& gp) {
+    return gp.workdir() / "clustered_indices";
+}
+
+static std::filesystem::path FrozenIndexFile(const GraphPack& gp, size_t i) {
+    return gp.workdir() / ("clustered_index_" + std::to_string(i) + ".frz");
+}
+
+// Clustered indices are read-only during the repeat resolution. The source is saved to disk and
+// replaced by the frozen indices mapped into memory under the same key, so the peak RSS of the
+// path extension no longer includes the btree-of-btrees of all the libraries.
+void FreezeClusteredIndices(GraphPack& gp) {
+    using Indices = omnigraph::de::PairedInfoIndicesT<Graph>;
+    using FrozenIndices = omnigraph::de::FrozenPairedInfoIndicesT<Graph>;
+
+    std::unique_ptr<Indices> clustered(gp.release<Indices>("clustered_indices"));
+    io::binary::Save(ClusteredIndicesBasename(gp), *clustered);
+
+    size_t lib_num = clustered->size();
+    for (size_t i = 0; i < lib_num; ++i) {
+        omnigraph::de::FrozenPairedIndex<Graph>((*clustered)[i]).Save(FrozenIndexFile(gp, i));
+        (*clustered)[i].clear();
+    }
+    clustered.reset();
+
+    auto &frozen = gp.emplace_with_key<FrozenIndices>("clustered_indices", gp.get<Graph>(), lib_num);
+    for (size_t i = 0; i < lib_num; ++i)
+        frozen[i].Load(FrozenIndexFile(gp, i));
+}
+
+void ThawClusteredIndices(GraphPack& gp) {
+    using Indices = omnigraph::de::PairedInfoIndicesT<Graph>;
+    using FrozenIndices = omnigraph::de::FrozenPairedInfoIndicesT<Graph>;
+
+    size_t lib_num;
+    {
+        std::unique_ptr<FrozenIndices> frozen(gp.release<FrozenIndices>("clustered_indices"));
+        lib_num = frozen->size();
+    }
+    for (size_t i = 0; i < lib_num; ++i)
+        std::filesystem::remove(FrozenIndexFile(gp, i));
+
+    auto &clustered = gp.emplace_with_key<Indices>("clustered_indices", gp.get<Graph>(), lib_num);
+    bool loaded = io::binary::Load(ClusteredIndicesBasename(gp), clustered);
+    CHECK_FATAL_ERROR(loaded, "Failed to restore clustered indices from " << ClusteredIndicesBasename(gp));
+    for (size_t i = 0; i < lib_num; ++i)
+        std::filesystem::remove(ClusteredIndicesBasename(gp) + "_" + std::to_string(i) + ".prd");
+}
+
 void DetachAll(GraphPack& gp) {
     gp.DetachAll();
 }
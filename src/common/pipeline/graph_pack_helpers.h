@@ -23,6 +23,8 @@ void EnsureDebugInfo(graph_pack::GraphPack& gp);
 
 void InitRRIndices(graph_pack::GraphPack& gp);
 void ClearRRIndicesAndPaths(graph_pack::GraphPack& gp);
+void FreezeClusteredIndices(graph_pack::GraphPack& gp);
+void ThawClusteredIndices(graph_pack::GraphPack& gp);
 
 void DetachAll(graph_pack::GraphPack& gp);
 void DetachEdgeIndex(graph_pack::GraphPack& gp);
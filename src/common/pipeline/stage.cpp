@@ -18,6 +18,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <sstream>
 
 namespace spades {
 
@@ -45,13 +46,45 @@ void AssemblyStage::save(const graph_pack::GraphPack& gp,
                          const char* prefix) const {
     if (!prefix) prefix = id_;
     auto dir = save_to / prefix;
-    INFO("Saving current state to " << dir);
-    remove_all(dir);
-    create_directory(dir);
 
-    auto p = dir / BASE_NAME;
-    io::binary::FullPackIO().Save(p, gp);
-    debruijn_graph::config::write_lib_data(p);
+    // The checkpoint is written into the temporary directory which is renamed
+    // only when complete, so an interrupted save never leaves a partial checkpoint
+    auto tmp_dir = dir;
+    tmp_dir += ".tmp";
+    auto p = tmp_dir / BASE_NAME;
+
+    CheckpointWriter *writer = parent_ ? parent_->checkpoint_writer() : nullptr;
+    if (!writer) {
+        INFO("Saving current state to " << dir);
+        remove_all(tmp_dir);
+        create_directory(tmp_dir);
+        io::binary::FullPackIO().Save(p, gp);
+        debruijn_graph::config::write_lib_data(p);
+        remove_all(dir);
+        rename(tmp_dir, dir);
+        return;
+    }
+
+    // Keep at most one snapshot in memory
+    writer->wait();
+
+    INFO("Taking snapshot of current state");
+    auto snapshot = std::make_shared<io::binary::PackSnapshot>(io::binary::PackSnapshot::Take(gp));
+    INFO("Snapshot size: " << snapshot->compressed_size() / 1024 / 1024 << "M"
+         << " (" << snapshot->raw_size() / 1024 / 1024 << "M uncompressed)");
+    std::ostringstream lib_data;
+    debruijn_graph::config::write_lib_data(lib_data);
+
+    writer->submit([snapshot, lib_data = lib_data.str(), dir, tmp_dir, p] {
+        INFO("Saving current state to " << dir);
+        remove_all(tmp_dir);
+        create_directory(tmp_dir);
+        snapshot->Save(p);
+        std::ofstream(p.string() + ".lib_data") << lib_data;
+        remove_all(dir);
+        rename(tmp_dir, dir);
+        INFO("Current state saved to " << dir);
+    });
 }
 
 class StageIdComparator {
@@ -111,6 +144,7 @@ void CompositeStageBase::run(graph_pack::GraphPack& gp,
             composite_id += ":";
             composite_id += prev_phase->id();
             TIME_TRACE_SCOPE("load phase", composite_id);
+            TelemetryScope ts(parent_->telemetry(), "load phase", composite_id, "load");
             prev_phase->load(gp, parent_->saves_policy().LoadPath(), composite_id.c_str());
         }
     }
@@ -121,6 +155,8 @@ void CompositeStageBase::run(graph_pack::GraphPack& gp,
         INFO("PROCEDURE == " << phase->name() << " (id: " << id() << ":" << phase->id() << ")");
         {
             TIME_TRACE_SCOPE(phase->name());
+            TelemetryScope ts(parent_->telemetry(), phase->name(),
+                              std::string(id()) + ":" + phase->id(), "phase");
             phase->run(gp, started_from);
         }
 
@@ -130,6 +166,7 @@ void CompositeStageBase::run(graph_pack::GraphPack& gp,
             composite_id += phase->id();
 
             TIME_TRACE_SCOPE("save phase", composite_id);
+            TelemetryScope ts(parent_->telemetry(), "save phase", composite_id, "save");
             phase->save(gp, parent_->saves_policy().SavesPath(), composite_id.c_str());
             //TODO: currently no phases are writing saves.
             //When they will, erase the previous saves when SavesPolicy::Last
@@ -171,6 +208,7 @@ void StageManager::run(graph_pack::GraphPack& g,
 
         {
             TIME_TRACE_SCOPE("load", saves_policy_.LoadPath().c_str());
+            TelemetryScope ts(telemetry(), "load", "load", "load");
             while (start_stage != stages_.begin()) {
                 try {
                     (*std::prev(start_stage))->load(g, saves_policy_.LoadPath());
@@ -190,21 +228,36 @@ void StageManager::run(graph_pack::GraphPack& g,
         stage->prepare(g, start_from);        
         {
             TIME_TRACE_SCOPE(stage->name());
+            TelemetryScope ts(telemetry(), stage->name(), stage->id(), "stage");
             stage->run(g, start_from);
         }
 
         if (saves_policy_.EnabledCheckpoints(stage->id())) {
-            auto prev_saves = saves_policy_.GetLastCheckpoint();
             {
                 TIME_TRACE_SCOPE("save", static_cast<llvm::StringRef>(saves_policy_.SavesPath()));
+                TelemetryScope ts(telemetry(), "save", stage->id(), "save");
                 stage->save(g, saves_policy_.SavesPath());
             }
-            saves_policy_.UpdateCheckpoint(stage->id());
-            if (!prev_saves.empty() && saves_policy_.RemovePreviousCheckpoint()) {
-                remove_all(saves_policy_.SavesPath() / prev_saves);
-            }
+
+            // Must be run after the checkpoint is written
+            auto commit = [this, id = stage->id()] {
+                auto prev_saves = saves_policy_.GetLastCheckpoint();
+                saves_policy_.UpdateCheckpoint(id);
+                if (!prev_saves.empty() && prev_saves != id && saves_policy_.RemovePreviousCheckpoint()) {
+                    remove_all(saves_policy_.SavesPath() / prev_saves);
+                }
+            };
+            if (checkpoint_writer_)
+                checkpoint_writer_->submit(commit);
+            else
+                commit();
         }
     }
+
+    if (checkpoint_writer_) {
+        TIME_TRACE_SCOPE("wait for checkpoints");
+        checkpoint_writer_->wait();
+    }
 }
 
 }
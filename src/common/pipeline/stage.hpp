@@ -9,7 +9,9 @@
 #ifndef __STAGE_HPP__
 #define __STAGE_HPP__
 
+#include "checkpoint_writer.hpp"
 #include "graph_pack.hpp"
+#include "telemetry.hpp"
 
 #include "configs/config_struct.hpp"
 #include "utils/logger/logger.hpp"
@@ -196,7 +198,11 @@ public:
     }
 
     void UpdateCheckpoint(const char *name) const {
-        std::ofstream(saves_path_ / CHECKPOINT_FILE) << name;
+        // Rename is atomic, so the checkpoint file always names a complete checkpoint
+        auto tmp = saves_path_ / CHECKPOINT_FILE;
+        tmp += ".tmp";
+        std::ofstream(tmp) << name;
+        std::filesystem::rename(tmp, saves_path_ / CHECKPOINT_FILE);
     }
 
 private:
@@ -235,11 +241,33 @@ public:
         return saves_policy_;
     }
 
+    template<typename ... Args>
+    void enable_telemetry(Args&&... args) {
+        telemetry_.reset(new StageTelemetry(std::forward<Args>(args)...));
+    }
+
+    StageTelemetry *telemetry() const {
+        return telemetry_.get();
+    }
+
+    /// Checkpoints of the stages will be written in background while the
+    /// subsequent stages are running. Only the disk write is asynchronous:
+    /// the snapshot is serialized and compressed before the next stage starts
+    void enable_async_checkpoints() {
+        checkpoint_writer_.reset(new CheckpointWriter());
+    }
+
+    CheckpointWriter *checkpoint_writer() const {
+        return checkpoint_writer_.get();
+    }
+
 private:
     using Stages = std::vector<std::unique_ptr<AssemblyStage> >;
 
     Stages stages_;
     SavesPolicy saves_policy_;
+    std::unique_ptr<StageTelemetry> telemetry_;
+    std::unique_ptr<CheckpointWriter> checkpoint_writer_;
 
     DECL_LOGGER("StageManager");
 };
@@ -0,0 +1,287 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "telemetry.hpp"
+
+#include "utils/logger/logger.hpp"
+#include "utils/verify.hpp"
+
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <sys/resource.h>
+#include <sys/statvfs.h>
+#include <sys/time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+
+namespace spades {
+
+namespace {
+
+// Parses "<key>: <value> [kB]" / "<key>: <value>" style /proc files
+template<class F>
+void parse_proc(const char *fn, F f) {
+    std::ifstream is(fn);
+    std::string line, key;
+    while (std::getline(is, line)) {
+        std::istringstream ss(line);
+        size_t value;
+        if (ss >> key >> value)
+            f(key, value);
+    }
+}
+
+double to_seconds(const timeval &tv) {
+    return double(tv.tv_sec) + double(tv.tv_usec) * 1e-6;
+}
+
+double wall_clock() {
+    using namespace std::chrono;
+    return double(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count()) * 1e-6;
+}
+
+int64_t to_us(double seconds) {
+    return int64_t(seconds * 1e6);
+}
+
+template<class F>
+std::string json_object(F f) {
+    std::string res;
+    llvm::raw_string_ostream os(res);
+    llvm::json::OStream J(os);
+    J.object([&] { f(J); });
+    os.flush();
+    return res;
+}
+
+}
+
+struct StageTelemetry::Record {
+    std::string name, id;
+    const char *kind;
+    std::string parent;
+    double start, wall;
+    double user, sys;
+    size_t rss, peak_rss;
+    size_t read_bytes, written_bytes;
+    size_t disk_read_bytes, disk_written_bytes;
+    size_t tmp, peak_tmp;
+};
+
+void StageTelemetry::write_attributes(llvm::json::OStream &J, const Record &record) const {
+    J.attribute("K", K_);
+    J.attribute("name", record.name);
+    J.attribute("id", record.id);
+    J.attribute("kind", record.kind);
+    J.attribute("parent", record.parent);
+    J.attribute("start", record.start);
+    J.attribute("wall", record.wall);
+    J.attribute("user", record.user);
+    J.attribute("sys", record.sys);
+    J.attribute("threads", nthreads_);
+    J.attribute("thread_utilization", record.wall > 0 ? (record.user + record.sys) / (record.wall * nthreads_) : 0.0);
+    J.attribute("rss", int64_t(record.rss));
+    J.attribute("peak_rss", int64_t(record.peak_rss));
+    J.attribute("read_bytes", int64_t(record.read_bytes));
+    J.attribute("written_bytes", int64_t(record.written_bytes));
+    J.attribute("disk_read_bytes", int64_t(record.disk_read_bytes));
+    J.attribute("disk_written_bytes", int64_t(record.disk_written_bytes));
+    J.attribute("tmp_disk", int64_t(record.tmp));
+    J.attribute("peak_tmp_disk", int64_t(record.peak_tmp));
+}
+
+ResourceUsage ResourceUsage::current() {
+    ResourceUsage res;
+    res.wall = wall_clock();
+
+    rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        res.user = to_seconds(ru.ru_utime);
+        res.sys = to_seconds(ru.ru_stime);
+        // ru_maxrss is in kilobytes on Linux
+        res.peak_rss = size_t(ru.ru_maxrss) * 1024;
+    }
+
+    parse_proc("/proc/self/status", [&](const std::string &key, size_t value) {
+        if (key == "VmRSS:")
+            res.rss = value * 1024;
+        else if (key == "VmHWM:")
+            res.peak_rss = value * 1024;
+    });
+    parse_proc("/proc/self/io", [&](const std::string &key, size_t value) {
+        if (key == "rchar:")
+            res.read_bytes = value;
+        else if (key == "wchar:")
+            res.written_bytes = value;
+        else if (key == "read_bytes:")
+            res.disk_read_bytes = value;
+        else if (key == "write_bytes:")
+            res.disk_written_bytes = value;
+    });
+
+    return res;
+}
+
+StageTelemetry::StageTelemetry(const std::filesystem::path &output_dir,
+                               size_t K, unsigned nthreads,
+                               const std::filesystem::path &tmp_dir,
+                               unsigned sample_interval)
+        : output_dir_(output_dir), K_(K), nthreads_(std::max(nthreads, 1u)),
+          tmp_dir_(tmp_dir), sample_interval_(std::max(sample_interval, 1u)),
+          base_used_space_(0),
+          jsonl_(output_dir / "telemetry.jsonl", std::ios::app),
+          trace_(output_dir / "telemetry_trace.json"),
+          trace_empty_(true), stop_(false) {
+    CHECK_FATAL_ERROR(jsonl_.is_open(), "Cannot open " << output_dir / "telemetry.jsonl" << " for writing");
+    if (!trace_.is_open())
+        WARN("Cannot write telemetry trace to " << output_dir / "telemetry_trace.json");
+    base_used_space_ = used_space();
+
+    trace_ << "[\n";
+    append_event(json_object([&](llvm::json::OStream &J) {
+        J.attribute("name", "process_name");
+        J.attribute("ph", "M");
+        J.attribute("pid", K_);
+        J.attributeObject("args", [&] { J.attribute("name", "K" + std::to_string(K_)); });
+    }));
+
+    sampler_ = std::thread(&StageTelemetry::sampler, this);
+}
+
+StageTelemetry::~StageTelemetry() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    stop_cv_.notify_all();
+    sampler_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    append_samples();
+    trace_ << "\n]\n";
+}
+
+size_t StageTelemetry::used_space() const {
+    // The temporary directory might be not created yet, use its closest existing parent then
+    std::filesystem::path dir = tmp_dir_;
+    struct statvfs st;
+    while (statvfs(dir.c_str(), &st) != 0) {
+        if (!dir.has_relative_path())
+            return 0;
+        dir = dir.parent_path();
+    }
+
+    return size_t(st.f_blocks - st.f_bfree) * size_t(st.f_frsize);
+}
+
+size_t StageTelemetry::tmp_usage() const {
+    size_t used = used_space();
+    return used > base_used_space_ ? used - base_used_space_ : 0;
+}
+
+void StageTelemetry::update_peaks(size_t rss, size_t tmp) {
+    for (auto &frame : stack_) {
+        frame.peak_rss = std::max(frame.peak_rss, rss);
+        frame.peak_tmp = std::max(frame.peak_tmp, tmp);
+    }
+}
+
+void StageTelemetry::sampler() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_cv_.wait_for(lock, std::chrono::milliseconds(sample_interval_), [this] { return stop_; })) {
+        // Do not hold the lock while reading the counters
+        lock.unlock();
+        size_t tmp = tmp_usage();
+        ResourceUsage usage = ResourceUsage::current();
+        lock.lock();
+
+        samples_.push_back({ usage.wall, usage.rss, tmp });
+        update_peaks(usage.rss, tmp);
+    }
+}
+
+void StageTelemetry::enter(const std::string &name, const std::string &id, const char *kind) {
+    size_t tmp = tmp_usage();
+    ResourceUsage usage = ResourceUsage::current();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stack_.push_back({ name, id, kind, usage, usage.rss, tmp });
+}
+
+void StageTelemetry::leave() {
+    size_t tmp = tmp_usage();
+    ResourceUsage end = ResourceUsage::current();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    VERIFY(!stack_.empty());
+    update_peaks(end.rss, tmp);
+
+    Frame frame = std::move(stack_.back());
+    stack_.pop_back();
+    const ResourceUsage &start = frame.start;
+
+    // VmHWM is process-wide, though if it grew within the scope, then the
+    // new maximum was reached here
+    size_t peak_rss = frame.peak_rss;
+    if (end.peak_rss > start.peak_rss)
+        peak_rss = std::max(peak_rss, end.peak_rss);
+
+    Record record{ std::move(frame.name), std::move(frame.id), frame.kind,
+                   stack_.empty() ? "" : stack_.back().id,
+                   start.wall, end.wall - start.wall,
+                   end.user - start.user, end.sys - start.sys,
+                   end.rss, peak_rss,
+                   end.read_bytes - start.read_bytes, end.written_bytes - start.written_bytes,
+                   end.disk_read_bytes - start.disk_read_bytes, end.disk_written_bytes - start.disk_written_bytes,
+                   tmp, frame.peak_tmp };
+
+    jsonl_ << json_object([&](llvm::json::OStream &J) { write_attributes(J, record); }) << std::endl;
+
+    INFO("Resources used by " << record.name << ": wall " << record.wall << "s, cpu " << record.user + record.sys << "s"
+         << ", peak RSS " << record.peak_rss / 1024 / 1024 << "M, peak temporary disk " << record.peak_tmp / 1024 / 1024 << "M");
+    append_event(json_object([&](llvm::json::OStream &J) {
+        J.attribute("name", record.name);
+        J.attribute("cat", record.kind);
+        J.attribute("ph", "X");
+        J.attribute("pid", K_);
+        J.attribute("tid", 0);
+        J.attribute("ts", to_us(record.start));
+        J.attribute("dur", to_us(record.wall));
+        J.attributeObject("args", [&] { write_attributes(J, record); });
+    }));
+
+    // Keep the trace up to date after each top-level stage in case we crash later
+    if (stack_.empty()) {
+        append_samples();
+        trace_.flush();
+    }
+}
+
+void StageTelemetry::append_event(const std::string &event) {
+    trace_ << (trace_empty_ ? "" : ",\n") << event;
+    trace_empty_ = false;
+}
+
+void StageTelemetry::append_samples() {
+    for (const auto &sample : samples_) {
+        append_event(json_object([&](llvm::json::OStream &J) {
+            J.attribute("name", "resources");
+            J.attribute("ph", "C");
+            J.attribute("pid", K_);
+            J.attribute("ts", to_us(sample.wall));
+            J.attributeObject("args", [&] {
+                J.attribute("rss_mb", double(sample.rss) / 1024 / 1024);
+                J.attribute("tmp_disk_mb", double(sample.tmp) / 1024 / 1024);
+            });
+        }));
+    }
+    samples_.clear();
+}
+
+}
@@ -0,0 +1,132 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace llvm::json {
+class OStream;
+}
+
+namespace spades {
+
+/// Snapshot of process-wide resource counters. All sizes are in bytes, all
+/// times are in seconds. Counters that are not available on the current
+/// platform are left zero.
+struct ResourceUsage {
+    double wall = 0;              // seconds since epoch
+    double user = 0, sys = 0;     // CPU time of all threads
+    size_t rss = 0, peak_rss = 0; // VmRSS / VmHWM
+    size_t read_bytes = 0, written_bytes = 0;           // rchar / wchar
+    size_t disk_read_bytes = 0, disk_written_bytes = 0; // actual storage I/O
+
+    static ResourceUsage current();
+};
+
+/// Collects resource usage of pipeline stages and phases. For every finished
+/// scope a record is appended to <output_dir>/telemetry.jsonl (one JSON
+/// object per line) and a complete event is appended to the Chrome trace
+/// <output_dir>/telemetry_trace.json (JSON array format, the closing bracket
+/// is written on destruction, though trace viewers accept the file without it).
+/// Timestamps are absolute and the K value is used as trace pid, so files
+/// produced by different K iterations could be merged by concatenation of the
+/// lines / trace events.
+///
+/// Peak RSS and temporary disk usage high-water marks are tracked by a
+/// background thread sampling the counters every sample_interval ms. The
+/// temporary disk usage is estimated as the growth of the used space of the
+/// file system holding tmp_dir, so it is O(1) to sample, but includes any
+/// other files written to the same file system meanwhile.
+class StageTelemetry {
+  public:
+    StageTelemetry(const std::filesystem::path &output_dir,
+                   size_t K, unsigned nthreads,
+                   const std::filesystem::path &tmp_dir,
+                   unsigned sample_interval = 1000);
+    ~StageTelemetry();
+
+    StageTelemetry(const StageTelemetry &) = delete;
+    StageTelemetry &operator=(const StageTelemetry &) = delete;
+
+    void enter(const std::string &name, const std::string &id, const char *kind);
+    void leave();
+
+  private:
+    struct Frame {
+        std::string name, id;
+        const char *kind;
+        ResourceUsage start;
+        size_t peak_rss;
+        size_t peak_tmp;
+    };
+
+    struct Record;
+
+    struct Sample {
+        double wall;
+        size_t rss;
+        size_t tmp;
+    };
+
+    size_t used_space() const;
+    size_t tmp_usage() const;
+    void update_peaks(size_t rss, size_t tmp);
+    void sampler();
+    void write_attributes(llvm::json::OStream &J, const Record &record) const;
+    void append_event(const std::string &event);
+    void append_samples();
+
+    std::filesystem::path output_dir_;
+    size_t K_;
+    unsigned nthreads_;
+    std::filesystem::path tmp_dir_;
+    unsigned sample_interval_;
+    size_t base_used_space_;
+
+    std::ofstream jsonl_;
+    std::ofstream trace_;
+    bool trace_empty_;
+    // Samples not appended to the trace yet
+    std::vector<Sample> samples_;
+    std::vector<Frame> stack_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable stop_cv_;
+    bool stop_;
+    std::thread sampler_;
+};
+
+/// RAII guard marking a stage / phase scope. No-op if telemetry is not enabled.
+class TelemetryScope {
+  public:
+    TelemetryScope(StageTelemetry *telemetry,
+                   const std::string &name, const std::string &id, const char *kind)
+            : telemetry_(telemetry) {
+        if (telemetry_)
+            telemetry_->enter(name, id, kind);
+    }
+
+    ~TelemetryScope() {
+        if (telemetry_)
+            telemetry_->leave();
+    }
+
+    TelemetryScope(const TelemetryScope &) = delete;
+    TelemetryScope &operator=(const TelemetryScope &) = delete;
+
+  private:
+    StageTelemetry *telemetry_;
+};
+
+}
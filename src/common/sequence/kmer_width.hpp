@@ -0,0 +1,48 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "rtseq.hpp"
+
+#include "utils/verify.hpp"
+
+/**
+ * Selection of the k-mer type by the runtime K.
+ *
+ * RtSeq is sized for the maximal K, so every copy, shift and comparison of it deals
+ * with MAX_TS machine words. The code which is generic over the k-mer type could
+ * be instantiated for the narrower RuntimeSeq's as well and the instantiation is
+ * selected by K via DispatchKMerWidth(). Raw k-mer data (k-mer buckets, KMerVector,
+ * hashes) has the same layout for all widths, namely GetDataSize(K) words per k-mer,
+ * so the data produced by one instantiation could be consumed by another.
+ */
+template<class Seq>
+struct KMerWidth {
+    typedef Seq type;
+};
+
+/// Maximal K for the k-mers stored in the given number of words
+constexpr size_t KMerWidthLimit(size_t words) {
+    return get_k_by_ts(words);
+}
+
+/// Calls f(KMerWidth<KMer>()) with the narrowest KMer able to store K nucleotides:
+/// RuntimeSeq of one or two words for small K and RtSeq otherwise.
+template<class F>
+decltype(auto) DispatchKMerWidth(size_t K, F &&f) {
+    VERIFY_MSG(K <= RtSeq::max_size, "K = " << K << " exceeds the maximal k-mer size " << RtSeq::max_size);
+
+    if constexpr (KMerWidthLimit(1) < UPPER_BOUND) {
+        if (K <= KMerWidthLimit(1))
+            return f(KMerWidth<RuntimeSeq<KMerWidthLimit(1)>>());
+    }
+    if constexpr (KMerWidthLimit(2) < UPPER_BOUND) {
+        if (K <= KMerWidthLimit(2))
+            return f(KMerWidth<RuntimeSeq<KMerWidthLimit(2)>>());
+    }
+    return f(KMerWidth<RtSeq>());
+}
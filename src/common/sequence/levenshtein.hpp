@@ -8,98 +8,137 @@
 
 #pragma once
 
+#include "utils/stl_utils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <vector>
-#include "utils/stl_utils.hpp"
+
+namespace levenshtein {
 
 /*
- * Little modified copy-paste from http://www.merriampark.com/ldcpp.htm
+ * Bit-parallel edit distance of Myers (1999) in the multi-word form, extended
+ * with transpositions of adjacent characters after Hyyro (2003). Column of the
+ * DP matrix is kept as vertical deltas packed in 64-bit words, so a single
+ * column step costs O(m / 64) word operations.
+ *
+ * Blocks of rows lying entirely above the diagonal band of the width
+ * 2 * max_dist + 1 are dropped (Ukkonen's cut-off): their cells could not be
+ * within max_dist, so the row right above the first remaining block is
+ * treated as a new zero row. Rows below the band are still computed: the
+ * transposition vectors rely on the exact history of the previous columns.
+ * The computation stops as soon as all the remaining cells exceed max_dist.
+ *
+ * Transpositions are counted only beyond the first two characters of both
+ * strings; this mirrors the historical DP implementation.
+ *
+ * @return the distance if it does not exceed max_dist, max_dist + 1 otherwise
  */
-inline size_t edit_distance(const std::string &source, const std::string &target) {
-
-    // Step 1
-
-    const size_t n = source.length();
-    const size_t m = target.length();
-    if (n == 0) {
-        return m;
-    }
-    if (m == 0) {
+template<class Seq>
+size_t BitParallelDistance(const Seq &source, const Seq &target, size_t max_dist) {
+    // Distance is symmetric, keep the shorter string in the bit vectors
+    const Seq &pattern = source.size() <= target.size() ? source : target;
+    const Seq &text = source.size() <= target.size() ? target : source;
+    const size_t m = pattern.size(), n = text.size();
+    // Distance never exceeds n, so the band need not be wider
+    const size_t k = std::min(max_dist, n);
+
+    if (n - m > k)
+        return max_dist + 1;
+    if (m == 0)
         return n;
-    }
-
-    // Good form to declare a TYPEDEF
-
-    typedef std::vector<std::vector<size_t> > Tmatrix;
 
-    Tmatrix matrix(n + 1);
+    typedef uint64_t Word;
+    const size_t W = (m + 63) / 64;
 
-    // Size the vectors in the 2.nd dimension. Unfortunately C++ doesn't
-    // allow for allocation on declaration of 2.nd dimension of vec of vec
-
-    for (size_t i = 0; i <= n; i++) {
-        matrix[i].resize(m + 1);
-    }
-
-    // Step 2
-
-    for (size_t i = 0; i <= n; i++) {
-        matrix[i][0] = i;
-    }
-
-    for (size_t j = 0; j <= m; j++) {
-        matrix[0][j] = j;
+    // Slot 0 of match masks stands for the characters absent in the pattern
+    std::array<uint16_t, 256> code{};
+    size_t sigma = 0;
+    for (size_t i = 0; i < m; ++i) {
+        uint16_t &c = code[uint8_t(pattern[i])];
+        if (!c)
+            c = uint16_t(++sigma);
     }
-
-    // Step 3
-
-    for (size_t i = 1; i <= n; i++) {
-
-        const char s_i = source[i - 1];
-
-        // Step 4
-
-        for (size_t j = 1; j <= m; j++) {
-
-            const char t_j = target[j - 1];
-
-            // Step 5
-
-            size_t cost;
-            if (s_i == t_j) {
-                cost = 0;
-            }
-            else {
-                cost = 1;
+    std::vector<Word> peq((sigma + 1) * W, 0);
+    for (size_t i = 0; i < m; ++i)
+        peq[code[uint8_t(pattern[i])] * W + i / 64] |= Word(1) << (i % 64);
+
+    std::vector<Word> vp(W, ~Word(0)), vn(W, 0), d0(W, ~Word(0));
+    // D value at the last row of each block
+    std::vector<size_t> bscore(W);
+    for (size_t b = 0; b < W; ++b)
+        bscore[b] = 64 * (b + 1);
+
+    const Word last_mask = Word(1) << ((m - 1) % 64);
+    size_t first = 0;
+    size_t score = m;
+
+    const Word *prev_eq = nullptr;
+    for (size_t j = 1; j <= n; ++j) {
+        // Rows above j - k could not have distance within k
+        if (j > k)
+            first = std::max(first, (j - k - 1) / 64);
+
+        const Word *eq = &peq[code[uint8_t(text[j - 1])] * W];
+        // Boundary above the first block behaves like the zero row: +1 per column
+        Word add_carry = 0, hp_carry = 1, hn_carry = 0, tc_carry = 0;
+        size_t min_score = std::numeric_limits<size_t>::max();
+        for (size_t b = first; b < W; ++b) {
+            Word pm = eq[b], v_p = vp[b], v_n = vn[b];
+
+            Word x = pm & v_p;
+            Word sum = x + v_p;
+            Word carry = sum < x;
+            sum += add_carry;
+            add_carry = carry | (sum < add_carry);
+
+            Word tc = 0, tc_src = ~d0[b] & pm;
+            if (prev_eq) {
+                tc = ((tc_src << 1) | tc_carry) & prev_eq[b];
+                if (b == 0)
+                    tc &= ~Word(3);
             }
+            tc_carry = tc_src >> 63;
 
-            // Step 6
+            Word diag = tc | (sum ^ v_p) | pm | v_n;
+            Word hp = v_n | ~(diag | v_p);
+            Word hn = v_p & diag;
 
-            const size_t above = matrix[i - 1][j];
-            const size_t left = matrix[i][j - 1];
-            const size_t diag = matrix[i - 1][j - 1];
-            size_t cell = std::min(above + 1, std::min(left + 1, diag + cost));
+            bscore[b] += (hp >> 63) - (hn >> 63);
+            if (b == W - 1)
+                score += size_t((hp & last_mask) != 0) - size_t((hn & last_mask) != 0);
+            min_score = std::min(min_score, bscore[b]);
 
-            // Step 6A: Cover transposition, in addition to deletion,
-            // insertion and substitution. This step is taken from:
-            // Berghel, Hal ; Roach, David : "An Extension of Ukkonen's
-            // Enhanced Dynamic Programming ASM Algorithm"
-            // (http://www.acm.org/~hlb/publications/asm/asm.html)
-
-            if (i > 2 && j > 2) {
-                size_t trans = matrix[i - 2][j - 2] + 1;
-                if (source[i - 2] != t_j) trans++;
-                if (s_i != target[j - 2]) trans++;
-                if (cell > trans) cell = trans;
-            }
+            Word hp_shift = (hp << 1) | hp_carry, hn_shift = (hn << 1) | hn_carry;
+            hp_carry = hp >> 63;
+            hn_carry = hn >> 63;
 
-            matrix[i][j] = cell;
+            vp[b] = hn_shift | ~(diag | hp_shift);
+            vn[b] = hp_shift & diag;
+            d0[b] = diag;
         }
+
+        // Cells within a block differ from its last row by at most 63
+        if (min_score > k + 63)
+            return max_dist + 1;
+        prev_eq = j >= 2 ? eq : nullptr;
     }
 
-    // Step 7
+    return score > k ? max_dist + 1 : score;
+}
+
+}
+
+inline size_t edit_distance(const std::string &source, const std::string &target) {
+    return levenshtein::BitParallelDistance(source, target, std::numeric_limits<size_t>::max() - 1);
+}
 
-    return matrix[n][m];
+/// @return the edit distance if it does not exceed max_dist, max_dist + 1 otherwise
+inline size_t edit_distance(const std::string &source, const std::string &target, size_t max_dist) {
+    return levenshtein::BitParallelDistance(source, target, max_dist);
 }
 
 inline std::pair<std::pair<int, int>, std::string> best_edit_distance_cigar(const std::string &source,
@@ -240,7 +240,7 @@ public:
         VERIFY_DEV(k <= max_size_);
         std::fill(data_.begin(), data_.end(), 0);
 
-        size_t data_size = GetDataSize(size_);
+        size_t data_size = this->data_size();
         memcpy(data_.data(), data_array, data_size * sizeof(T));
 
         if (NuclsRemain(size_)) {
@@ -252,7 +252,7 @@ public:
         VERIFY_DEV(k <= max_size_);
         std::fill(data_.begin(), data_.end(), 0);
 
-        size_t data_size = GetDataSize(size_);
+        size_t data_size = this->data_size();
         memcpy(data_.data(), data_array, data_size * sizeof(T));
 
         if (NuclsRemain(size_)) {
@@ -437,7 +437,7 @@ public:
         RuntimeSeq<max_size_, T> res(*this);
         std::array<T, DataSize> &data = res.data_;
 
-        size_t data_size = GetDataSize(size_);
+        size_t data_size = this->data_size();
 
         if (data_size != 0) { // unless empty sequence
             T rm = data[data_size - 1] & 3;
@@ -461,7 +461,7 @@ public:
             c = dignucl(c);
         }
 
-        size_t data_size = GetDataSize(size_);
+        size_t data_size = this->data_size();
 
         if (data_size == 0) {
             return;
@@ -503,7 +503,7 @@ public:
         }
 
         size_ += 1;
-        size_t data_size = GetDataSize(size_);
+        size_t data_size = this->data_size();
 
         data_[data_size - 1] |= ((T) c << (((size_ - 1) & (TNucl - 1)) << 1));
     }
@@ -550,7 +550,7 @@ public:
         }
 
         size_ += 1;
-        size_t data_size = GetDataSize(size_);
+        size_t data_size = this->data_size();
 
         T rm = c;
         for (size_t i = 0; i < data_size; ++i) {
@@ -573,7 +573,7 @@ public:
         VERIFY_DEV(is_dignucl(c));
 
         RuntimeSeq<max_size_, T> res(*this);
-        size_t data_size = GetDataSize(size_);
+        size_t data_size = this->data_size();
 
         T rm = c;
         for (size_t i = 0; i < data_size; ++i) {
@@ -594,7 +594,7 @@ public:
         }
         VERIFY_DEV(is_dignucl(c));
 
-        size_t data_size = GetDataSize(size_);
+        size_t data_size = this->data_size();
 
         T rm = (T) c;
         for (size_t i = 0; i < data_size; ++i) {
@@ -609,7 +609,7 @@ public:
     bool operator==(const RuntimeSeq<max_size_, T> &s) const {
         VERIFY_DEV(size_ == s.size_);
 
-        size_t data_size = GetDataSize(size_);
+        size_t data_size = this->data_size();
         for (size_t i = 0; i < data_size; ++i)
             if (data_[i] != s.data_[i])
                 return false;
@@ -655,8 +655,11 @@ public:
         return size_;
     }
 
+    /// Same as GetDataSize(size()), but bounded by DataSize, so the compiler
+    /// could unroll the loops over the data of the narrow k-mers completely
     size_t data_size() const {
-        return GetDataSize(size_);
+        size_t data_size = GetDataSize(size_);
+        return data_size < DataSize ? data_size : DataSize;
     }
 
     const T *data() const {
@@ -692,7 +695,7 @@ public:
     }
 
     size_t GetHash(uint64_t seed = 0) const {
-        return GetHash(data_.data(), GetDataSize(size_), seed);
+        return GetHash(data_.data(), data_size(), seed);
     }
 
     struct hash {
@@ -60,9 +60,8 @@ inline Sequence MergeOverlappingSequences(const std::vector<Sequence>& ss,
     return sb.BuildSequence();
 }
 
-//TODO:: should it be replaced by edlib fast edit distance?
 inline size_t EditDistance(const Sequence& s1, const Sequence& s2) {
-    return edit_distance(s1.str(), s2.str());
+    return levenshtein::BitParallelDistance(s1, s2, std::numeric_limits<size_t>::max() - 1);
 }
 
 inline bool Relax(int& val, int new_val) {
@@ -10,8 +10,10 @@
 
 #include "alignment/edge_index.hpp"
 #include "assembly_graph/construction/early_simplification.hpp"
+#include "assembly_graph/construction/superkmer_graph_constructor.hpp"
 #include "io/dataset_support/dataset_readers.hpp"
 #include "io/dataset_support/read_converter.hpp"
+#include "io/dataset_support/resident_reads.hpp"
 #include "io/reads/coverage_filtering_read_wrapper.hpp"
 #include "io/reads/multifile_reader.hpp"
 #include "kmer_index/ph_map/coverage_hash_map_builder.hpp"
@@ -127,7 +129,7 @@ void Construction::init(graph_pack::GraphPack &gp, const char *) {
     storage().params = cfg::get().con;
     storage().workdir = fs::tmp::make_temp_dir(gp.workdir(), "construction");
     //FIXME needs to be changed if we move to hash only filtering
-    storage().read_streams = io::single_binary_readers_for_libs(dataset.reads, libs_for_construction);
+    storage().read_streams = io::ResidentReadStore::instance().single_readers_for_libs(dataset.reads, libs_for_construction);
 
     //Updating dataset stats
     VERIFY(dataset.RL == 0 && dataset.aRL == 0.);
@@ -158,6 +160,9 @@ void Construction::init(graph_pack::GraphPack &gp, const char *) {
 
 void Construction::fini(graph_pack::GraphPack &) {
     reset_storage();
+    // No further K iterations would need the reads
+    if (cfg::get().main_iteration)
+        io::ResidentReadStore::instance().clear();
 }
 
 Construction::~Construction() {}
@@ -232,14 +237,9 @@ public:
 
         io::ReadStreamList<io::SingleReadSeq> merge_streams = temp_merge_read_streams(read_streams, contigs_streams);
 
-        unsigned nthreads = (unsigned)merge_streams.size();
-        using Splitter =  kmers::DeBruijnReadKMerSplitter<io::SingleReadSeq,
-                                                          kmers::StoringTypeFilter<storing_type>>;
-
-        kmers::KMerDiskCounter<RtSeq>
-                counter(storage().workdir,
-                        Splitter(storage().workdir, index.k() + 1, merge_streams, buffer_size));
-        auto kmers = counter.Count(10 * nthreads, nthreads);
+        using KmerFilter = kmers::StoringTypeFilter<storing_type>;
+        auto kmers = kmers::DeBruijnExtensionIndexBuilder().CountKMers<KmerFilter>(storage().workdir, index.k() + 1,
+                                                                                  merge_streams, buffer_size);
         storage().kmers.reset(new kmers::KMerDiskStorage<RtSeq>(std::move(kmers)));
     }
 
@@ -368,6 +368,45 @@ public:
     }
 };
 
+class SuperKMerGraphBuilder : public Construction::Phase {
+public:
+    SuperKMerGraphBuilder()
+            : Construction::Phase("Minimizer-based graph construction", "superkmer_graph_construction") { }
+
+    virtual ~SuperKMerGraphBuilder() = default;
+
+    void run(graph_pack::GraphPack &gp, const char*) override {
+        auto &read_streams = storage().read_streams;
+        auto &contigs_streams = storage().contigs_streams;
+        VERIFY_MSG(read_streams.size(), "No input streams specified");
+        // Early simplification works on the extension index, which is not built here
+        if (storage().params.early_tc.enable)
+            INFO("Early tip clipping is not available in minimizer construction mode, skipped");
+
+        auto &index = gp.get_mutable<EdgeIndex<Graph>>();
+        if (index.IsAttached())
+            index.Detach();
+
+        io::ReadStreamList<io::SingleReadSeq> merge_streams = temp_merge_read_streams(read_streams, contigs_streams);
+        auto kmers = SuperKMerGraphConstructor<Graph>(gp.get_mutable<Graph>(), storage().workdir,
+                                                      storage().params.read_buffer_size)
+                .ConstructGraph(merge_streams, storage().params.keep_perfect_loops);
+        storage().kmers.reset(new kmers::KMerDiskStorage<RtSeq>(std::move(kmers)));
+    }
+
+    void load(graph_pack::GraphPack&,
+              const std::filesystem::path &,
+              const char*) override {
+        VERIFY_MSG(false, "implement me");
+    }
+
+    void save(const graph_pack::GraphPack&,
+              const std::filesystem::path &,
+              const char*) const override {
+        // VERIFY_MSG(false, "implement me");
+    }
+};
+
 //FIXME unused?
 class EdgeIndexFiller : public Construction::Phase {
 public:
@@ -468,6 +507,12 @@ Construction::Construction()
     if (cfg::get().con.read_cov_threshold)
         add<CoverageFilter>();
 
+    if (cfg::get().con.con_mode == config::construction_mode::minimizer) {
+        add<SuperKMerGraphBuilder>();
+        add<PHMCoverageFiller>();
+        return;
+    }
+
     add<KMerCounting>();
 
     add<ExtensionIndexBuilder>();
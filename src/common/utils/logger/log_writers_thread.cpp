@@ -7,12 +7,24 @@
 
 #include "log_writers_thread.hpp"
 #include "utils/parallel/openmp_wrapper.h"
+#include "utils/verify.hpp"
+
+#include <algorithm>
+#include <chrono>
 
 namespace logging {
 
+// Set by the async_writer thread to the number of the thread the message
+// being written was logged from
+static thread_local int log_thread_override = -1;
+
+int log_thread_num() {
+    return log_thread_override >= 0 ? log_thread_override : omp_get_thread_num();
+}
+
 void console_writer_thread::write_msg(double time, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num,
                                       const char *source, const char *msg) {
-    int thread = omp_get_thread_num();
+    int thread = log_thread_num();
     if (cmem != -1ull)
         std::cout << fmt::format("thread #{:<2d} {:14s} {:>5s} / {:<5s} {:6.6s} {:24.24s} ({:26.26s}:{:4d})   {:s}",
                                  thread,
@@ -30,7 +42,7 @@ void console_writer_thread::write_msg(double time, size_t cmem, size_t max_rss,
 
 void file_writer_thread::write_msg(double time, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num,
                                    const char *source, const char *msg) {
-    int thread = omp_get_thread_num();
+    int thread = log_thread_num();
     if (cmem != -1ull)
         fout << fmt::format("thread #{:<2d} {:14s} {:>5s} / {:<5s} {:6.6s} {:24.24s} ({:26.26s}:{:4d})   {:s}",
                             thread,
@@ -46,4 +58,212 @@ void file_writer_thread::write_msg(double time, size_t cmem, size_t max_rss, lev
              << std::endl;
 }
 
+struct async_writer::message {
+    uint64_t seq;
+    double time;
+    size_t cmem, max_rss;
+    level l;
+    size_t line_num;
+    const char *source;
+    int thread;
+    std::filesystem::path file;
+    std::string msg;
+};
+
+// Single-producer single-consumer ring buffer
+class async_writer::ring {
+public:
+    ring(size_t capacity)
+            : slots_(capacity), head_(0), tail_(0) {}
+
+    bool full() const {
+        return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire) == slots_.size();
+    }
+
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return slots_.size(); }
+
+    // Must be called only if the ring is not full
+    message &back() {
+        return slots_[tail_.load(std::memory_order_relaxed) % slots_.size()];
+    }
+    void push() {
+        tail_.fetch_add(1, std::memory_order_release);
+    }
+
+    void pop_all(std::vector<message> &out) {
+        size_t head = head_.load(std::memory_order_relaxed), tail = tail_.load(std::memory_order_acquire);
+        for (; head != tail; ++head)
+            out.push_back(std::move(slots_[head % slots_.size()]));
+        head_.store(head, std::memory_order_release);
+    }
+
+private:
+    std::vector<message> slots_;
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::atomic<size_t> tail_;
+};
+
+static std::atomic<uint64_t> async_writer_id{0};
+
+// Alive async writers to be flushed on crash
+static std::mutex &async_writers_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+static std::vector<async_writer*> &async_writers() {
+    static std::vector<async_writer*> writers;
+    return writers;
+}
+
+void flush_async_writers() {
+    // The crash might happen while the list is being modified
+    std::unique_lock<std::mutex> lock(async_writers_mutex(), std::try_to_lock);
+    if (!lock.owns_lock())
+        return;
+    for (async_writer *writer : async_writers())
+        writer->flush(std::chrono::seconds(1));
+}
+
+async_writer::async_writer(writer_ptr writer, size_t capacity)
+        : writer_(std::move(writer)), capacity_(std::max<size_t>(capacity, 2)),
+          id_(++async_writer_id),
+          logged_(0), written_(0), waiters_(0), stop_(false) {
+    thread_ = std::thread(&async_writer::process, this);
+
+    std::lock_guard<std::mutex> lock(async_writers_mutex());
+    async_writers().push_back(this);
+}
+
+async_writer::~async_writer() {
+    {
+        std::lock_guard<std::mutex> lock(async_writers_mutex());
+        auto &writers = async_writers();
+        writers.erase(std::remove(writers.begin(), writers.end(), this), writers.end());
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
 }
+
+async_writer::ring &async_writer::local_ring() {
+    // Thread could log to several writers, writer ids are never reused
+    static thread_local std::vector<std::pair<uint64_t, ring*>> rings;
+    for (const auto &entry : rings)
+        if (entry.first == id_)
+            return *entry.second;
+
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    rings_.emplace_back(new ring(capacity_));
+    rings.emplace_back(id_, rings_.back().get());
+    return *rings_.back();
+}
+
+void async_writer::write_msg(double time, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num,
+                             const char *source, const char *msg) {
+    ring &r = local_ring();
+    if (r.full())
+        wait_space(r);
+
+    message &m = r.back();
+    m.seq = logged_.fetch_add(1, std::memory_order_relaxed);
+    m.time = time;
+    m.cmem = cmem;
+    m.max_rss = max_rss;
+    m.l = l;
+    m.line_num = line_num;
+    m.source = source;
+    m.thread = omp_get_thread_num();
+    m.file = file;
+    m.msg = msg;
+    r.push();
+
+    if (l >= L_ERROR)
+        flush();
+    else if (r.size() == r.capacity() / 2)
+        wake_.notify_one();
+}
+
+// Back-pressure: blocks until the writer thread frees some space in the ring
+void async_writer::wait_space(ring &r) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters_ += 1;
+    wake_.notify_one();
+    // The ring is drained before written_ is updated under the lock, so the
+    // notification could not be missed
+    written_cv_.wait(lock, [&] { return !r.full(); });
+    waiters_ -= 1;
+}
+
+void async_writer::flush() {
+    uint64_t target = logged_.load();
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters_ += 1;
+    wake_.notify_one();
+    written_cv_.wait(lock, [&] { return written_ >= target; });
+    waiters_ -= 1;
+}
+
+bool async_writer::flush(std::chrono::milliseconds timeout) {
+    if (std::this_thread::get_id() == thread_.get_id())
+        return false;
+
+    uint64_t target = logged_.load();
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters_ += 1;
+    wake_.notify_one();
+    bool flushed = written_cv_.wait_for(lock, timeout, [&] { return written_ >= target; });
+    waiters_ -= 1;
+    return flushed;
+}
+
+void async_writer::drain(std::vector<message> &batch) {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    for (auto &r : rings_)
+        r->pop_all(batch);
+}
+
+void async_writer::process() {
+    std::vector<message> batch;
+    while (true) {
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait_for(lock, std::chrono::milliseconds(10),
+                           [&] { return stop_ || waiters_ > 0; });
+            stop = stop_;
+        }
+
+        drain(batch);
+        // Each ring is ordered, restore the order between threads
+        std::sort(batch.begin(), batch.end(),
+                  [](const message &lhs, const message &rhs) { return lhs.seq < rhs.seq; });
+        for (const auto &m : batch) {
+            log_thread_override = m.thread;
+            writer_->write_msg(m.time, m.cmem, m.max_rss, m.l, m.file, m.line_num, m.source, m.msg.c_str());
+        }
+        log_thread_override = -1;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            written_ += batch.size();
+        }
+        written_cv_.notify_all();
+
+        bool empty = batch.empty();
+        batch.clear();
+        // Producers are not allowed to log after the writer is destroyed,
+        // so nothing could appear after the final drain
+        if (stop && empty)
+            break;
+    }
+}
+
+} // logging
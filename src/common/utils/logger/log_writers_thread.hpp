@@ -10,8 +10,19 @@
 
 #include "logger.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace logging {
 
+/// Number of the thread the message being written was logged from. Same as
+/// omp_get_thread_num(), unless called from the async_writer thread.
+int log_thread_num();
+
 struct console_writer_thread : public writer {
     void write_msg(double time, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num,
                    const char *source, const char *msg);
@@ -28,4 +39,66 @@ private:
     std::ofstream fout;
 };
 
+/// Asynchronous writer decorator. Every logging thread gets its own
+/// single-producer ring buffer, so write_msg() is lock-free and only copies
+/// the message. A background thread drains the rings, restores the global
+/// order of messages and does the formatting and I/O via the underlying
+/// writer. If the ring of some thread is full, the thread blocks until the
+/// background writer frees some space, so memory usage is bounded and no
+/// messages are dropped. Errors are written synchronously.
+///
+/// Messages still buffered on abnormal termination are lost unless
+/// flush_async_writers() is called on the failure paths (see spades-core main).
+/// They are always lost on signals, e.g. segmentation faults.
+class async_writer : public writer {
+public:
+    async_writer(writer_ptr writer, size_t capacity = 1024);
+    ~async_writer();
+
+    void write_msg(double time, size_t cmem, size_t max_rss, level l, const std::filesystem::path& file, size_t line_num,
+                   const char *source, const char *msg);
+
+    /// Waits until all the messages logged so far are written
+    void flush();
+
+    /// Same as flush(), but gives up after the timeout
+    /// @return false if the messages were not written in time
+    bool flush(std::chrono::milliseconds timeout);
+
+private:
+    struct message;
+    class ring;
+
+    ring &local_ring();
+    void wait_space(ring &r);
+    void drain(std::vector<message> &batch);
+    void process();
+
+    writer_ptr writer_;
+    size_t capacity_;
+    uint64_t id_;
+
+    // Rings are never deallocated while the writer is alive, so the thread
+    // could cache the pointer to its ring
+    std::mutex rings_mutex_;
+    std::vector<std::unique_ptr<ring>> rings_;
+
+    std::atomic<uint64_t> logged_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_, written_cv_;
+    uint64_t written_;
+    // Threads waiting for the background writer, which should not sleep then
+    unsigned waiters_;
+    bool stop_;
+    std::thread thread_;
+};
+
+/// Writes out the messages buffered by all the alive async writers. Intended
+/// for the failure paths (failed VERIFY, std::terminate), so it does not wait
+/// for more than a second per writer and does nothing if called from the
+/// background writer thread itself. Takes locks, so must not be called from
+/// signal handlers.
+void flush_async_writers();
+
 } // logging
@@ -0,0 +1,253 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "task_scheduler.hpp"
+
+#include "utils/parallel/openmp_wrapper.h"
+#include "utils/logger/logger.hpp"
+
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace parallel {
+
+namespace {
+
+thread_local unsigned current_worker = 0;
+
+std::unique_ptr<TaskScheduler> &global_scheduler() {
+    static std::unique_ptr<TaskScheduler> scheduler;
+    return scheduler;
+}
+
+std::mutex global_scheduler_mutex;
+
+// Parses the cpulist format of sysfs, e.g. "0-3,8-11"
+std::vector<int> ParseCPUList(const std::string &list) {
+    std::vector<int> res;
+    std::istringstream is(list);
+    std::string range;
+    while (std::getline(is, range, ',')) {
+        if (range.empty() || !std::isdigit(range[0]))
+            continue;
+        size_t dash = range.find('-');
+        int from = std::stoi(range.substr(0, dash));
+        int to = dash == std::string::npos ? from : std::stoi(range.substr(dash + 1));
+        for (int cpu = from; cpu <= to; ++cpu)
+            res.push_back(cpu);
+    }
+    return res;
+}
+
+// CPUs grouped by NUMA node; a single group if the topology is unknown
+std::vector<std::vector<int>> NUMANodes() {
+    std::vector<std::vector<int>> nodes;
+#ifdef __linux__
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path root("/sys/devices/system/node");
+    for (const auto &entry : fs::directory_iterator(root, ec)) {
+        std::string name = entry.path().filename().string();
+        if (name.compare(0, 4, "node") != 0 || name.size() == 4 || !std::isdigit(name[4]))
+            continue;
+        std::ifstream is(entry.path() / "cpulist");
+        std::string list;
+        if (!std::getline(is, list))
+            continue;
+        std::vector<int> cpus = ParseCPUList(list);
+        if (!cpus.empty())
+            nodes.push_back(std::move(cpus));
+    }
+    std::sort(nodes.begin(), nodes.end());
+#endif
+    if (nodes.empty()) {
+        nodes.emplace_back();
+        for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu)
+            nodes.back().push_back(int(cpu));
+    }
+    return nodes;
+}
+
+}
+
+TaskScheduler::TaskScheduler(unsigned nthreads, bool pin_workers)
+        : pending_(0), stop_(false) {
+    nthreads = std::max(nthreads, 1u);
+    for (unsigned i = 0; i < nthreads; ++i)
+        queues_.emplace_back(new Queue());
+    PlanCPUs(pin_workers);
+
+    for (unsigned id = 1; id < nthreads; ++id)
+        workers_.emplace_back([this, id] { WorkerLoop(id); });
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wakeup_.notify_all();
+    for (auto &worker : workers_)
+        worker.join();
+}
+
+void TaskScheduler::PlanCPUs(bool pin_workers) {
+    unsigned nthreads = concurrency();
+    std::vector<unsigned> node_of(nthreads, 0);
+    if (pin_workers) {
+        // Fill the nodes one by one, so the workers which are close by index
+        // (and thus the neighbouring parts of the work) share the memory
+        std::vector<std::vector<int>> nodes = NUMANodes();
+        std::vector<std::pair<int, unsigned>> order;
+        for (unsigned n = 0; n < nodes.size(); ++n)
+            for (int cpu : nodes[n])
+                order.emplace_back(cpu, n);
+        for (unsigned id = 0; id < nthreads; ++id) {
+            cpus_.push_back(order[id % order.size()].first);
+            node_of[id] = order[id % order.size()].second;
+        }
+        INFO("Pinning " << nthreads - 1 << " task workers to CPUs of " << nodes.size() << " NUMA node(s)");
+    }
+
+    victims_.resize(nthreads);
+    for (unsigned id = 0; id < nthreads; ++id) {
+        // Same node first, then the others; start from the next worker to spread the thieves
+        for (unsigned d = 1; d < nthreads; ++d) {
+            unsigned victim = (id + d) % nthreads;
+            if (node_of[victim] == node_of[id])
+                victims_[id].push_back(victim);
+        }
+        for (unsigned d = 1; d < nthreads; ++d) {
+            unsigned victim = (id + d) % nthreads;
+            if (node_of[victim] != node_of[id])
+                victims_[id].push_back(victim);
+        }
+    }
+}
+
+TaskScheduler &TaskScheduler::instance() {
+    std::lock_guard<std::mutex> lock(global_scheduler_mutex);
+    auto &scheduler = global_scheduler();
+    if (!scheduler)
+        scheduler.reset(new TaskScheduler(unsigned(omp_get_max_threads())));
+    return *scheduler;
+}
+
+void TaskScheduler::init(unsigned nthreads, bool pin_workers) {
+    std::lock_guard<std::mutex> lock(global_scheduler_mutex);
+    auto &scheduler = global_scheduler();
+    scheduler.reset();
+    scheduler.reset(new TaskScheduler(nthreads, pin_workers));
+}
+
+unsigned TaskScheduler::worker_id() {
+    return current_worker;
+}
+
+void TaskScheduler::spawn(Task task) {
+    unsigned id = current_worker < concurrency() ? current_worker : 0;
+    // Taking the lock here guarantees that a worker going to sleep sees the new task.
+    // The counter is incremented first, so it never drops below the number of queued tasks.
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        pending_.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        Queue &q = *queues_[id];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.tasks.push_back(std::move(task));
+    }
+    wakeup_.notify_one();
+}
+
+bool TaskScheduler::Pop(unsigned id, Task &task) {
+    Queue &q = *queues_[id];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.tasks.empty())
+        return false;
+    task = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool TaskScheduler::Steal(unsigned id, Task &task) {
+    for (unsigned victim : victims_[id]) {
+        Queue &q = *queues_[victim];
+        std::unique_lock<std::mutex> lock(q.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || q.tasks.empty())
+            continue;
+        task = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+bool TaskScheduler::run_one() {
+    unsigned id = current_worker < concurrency() ? current_worker : 0;
+    Task task;
+    if (!Pop(id, task) && !Steal(id, task))
+        return false;
+
+    pending_.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+}
+
+void TaskScheduler::WorkerLoop(unsigned id) {
+    current_worker = id;
+#ifdef __linux__
+    if (!cpus_.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus_[id], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+
+    while (true) {
+        if (run_one())
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wakeup_.wait(lock, [this] { return stop_ || pending_.load(std::memory_order_relaxed) > 0; });
+        if (stop_)
+            return;
+        lock.unlock();
+        // Some task is pending, but it might be not queued yet or its queue
+        // might be locked by the owner, retry after a short pause
+        if (!run_one())
+            std::this_thread::yield();
+    }
+}
+
+void TaskGroup::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (active_.load(std::memory_order_acquire) > 0) {
+        lock.unlock();
+        bool executed = scheduler_.run_one();
+        lock.lock();
+        // The rest of the group is running in the other threads
+        if (!executed && active_.load(std::memory_order_acquire) > 0)
+            done_.wait_for(lock, std::chrono::milliseconds(1));
+    }
+
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+}
@@ -0,0 +1,181 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+/**
+ * @brief Process-wide pool of worker threads with work stealing.
+ * @detail Every worker owns a deque of tasks: it takes the most recently spawned
+ *         tasks from the back of its own deque (which are hot in its caches) and,
+ *         when its deque is empty, steals the oldest (i.e. the largest) tasks from
+ *         the front of the others' deques. Threads outside of the pool share an
+ *         extra deque and could execute tasks while waiting for them (see TaskGroup),
+ *         so nested parallelism does not oversubscribe the CPU and does not deadlock.
+ *
+ *         Workers could be pinned to CPUs. In such case the CPUs are taken NUMA node
+ *         by node and the workers steal from the workers of the same node first, so
+ *         the data produced by a task tends to stay within the memory of its node.
+ *
+ *         Unlike OpenMP threads, the workers do not have omp_get_thread_num() set,
+ *         use worker_id() for the per-thread storage instead.
+ */
+class TaskScheduler {
+  public:
+    typedef std::function<void()> Task;
+
+    /// @param nthreads total concurrency including the thread waiting for the tasks
+    explicit TaskScheduler(unsigned nthreads, bool pin_workers = false);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    /// The process-wide scheduler. Unless configured via init(), created on the
+    /// first use with omp_get_max_threads() threads.
+    static TaskScheduler &instance();
+    /// (Re)creates the process-wide scheduler; must not be called while it is in use
+    static void init(unsigned nthreads, bool pin_workers = false);
+
+    /// Total number of threads executing the tasks (workers + one outer thread)
+    unsigned concurrency() const { return unsigned(queues_.size()); }
+
+    /// Index of the calling thread in [0, concurrency()): workers have indices from 1,
+    /// threads outside of the pool share index 0
+    static unsigned worker_id();
+
+    void spawn(Task task);
+
+    /// Executes a single pending task in the calling thread
+    /// @return false if no task was available
+    bool run_one();
+
+  private:
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(unsigned id);
+    bool Pop(unsigned id, Task &task);
+    bool Steal(unsigned id, Task &task);
+    void PlanCPUs(bool pin_workers);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    // Victims in the stealing order for each queue
+    std::vector<std::vector<unsigned>> victims_;
+    std::vector<int> cpus_;
+    std::vector<std::thread> workers_;
+
+    std::atomic<size_t> pending_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wakeup_;
+    bool stop_;
+};
+
+/**
+ * @brief Set of tasks which could be waited for together.
+ * @detail The waiting thread executes pending tasks (not necessarily the ones of
+ *         the group) instead of blocking. When there is nothing to execute, it sleeps
+ *         until the group is done, waking up periodically to pick up the tasks spawned
+ *         by the running ones. The first exception thrown by a task is rethrown from wait().
+ */
+class TaskGroup {
+  public:
+    explicit TaskGroup(TaskScheduler &scheduler = TaskScheduler::instance())
+            : scheduler_(scheduler), active_(0) {}
+
+    ~TaskGroup() {
+        try {
+            wait();
+        } catch (...) {
+        }
+    }
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    template<class F>
+    void run(F &&f) {
+        active_.fetch_add(1, std::memory_order_relaxed);
+        scheduler_.spawn([this, f = std::forward<F>(f)]() mutable {
+            try {
+                f();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_)
+                    error_ = std::current_exception();
+            }
+            // The group could be destroyed as soon as the waiter sees zero,
+            // so the counter is updated under the lock the waiter checks it under
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (active_.fetch_sub(1, std::memory_order_release) == 1)
+                done_.notify_all();
+        });
+    }
+
+    void wait();
+
+    TaskScheduler &scheduler() const { return scheduler_; }
+
+  private:
+    TaskScheduler &scheduler_;
+    std::atomic<size_t> active_;
+    std::mutex mutex_;
+    std::condition_variable done_;
+    std::exception_ptr error_;
+};
+
+/**
+ * @brief Calls f(i) for all i in [begin, end) in parallel.
+ * @detail The range is split recursively, the halves are left for stealing, so the
+ *         idle threads take the largest pieces of the remaining work (this replaces
+ *         schedule(dynamic/guided) of OpenMP). Unless specified, the grain is chosen
+ *         to produce about 8 pieces per thread, which is enough to balance the load
+ *         while keeping the overhead negligible. Could be nested freely.
+ */
+template<class Index, class F>
+void parallel_for(Index begin, Index end, F &&f, size_t grain = 0,
+                  TaskScheduler &scheduler = TaskScheduler::instance()) {
+    if (!(begin < end))
+        return;
+
+    size_t size = size_t(end - begin);
+    if (!grain)
+        grain = std::max<size_t>(1, size / (8 * size_t(scheduler.concurrency())));
+    if (size <= grain || scheduler.concurrency() == 1) {
+        for (Index i = begin; i < end; ++i)
+            f(i);
+        return;
+    }
+
+    TaskGroup group(scheduler);
+    std::function<void(Index, Index)> split = [&](Index b, Index e) {
+        while (size_t(e - b) > grain) {
+            Index mid = b + Index(size_t(e - b) / 2);
+            group.run([&split, mid, e] { split(mid, e); });
+            e = mid;
+        }
+        for (Index i = b; i < e; ++i)
+            f(i);
+    };
+    split(begin, end);
+    group.wait();
+}
+
+}
@@ -50,9 +50,6 @@ private:
                 callback()();
         }
 
-        //TEST!!
-        exit(1);
-
         signal(signum, SIG_DFL);
         kill(getpid(), signum);
     }
@@ -16,6 +16,18 @@
 
 #include "config.hpp"
 
+namespace utils {
+
+typedef void (*verify_failure_hook_t)();
+
+/// Called on failed VERIFY_MSG before the message is printed, e.g. to write out the buffered log
+inline verify_failure_hook_t &verify_failure_hook() {
+    static verify_failure_hook_t hook = nullptr;
+    return hook;
+}
+
+}
+
 #define VERIFY(expr) do { assert(expr); } while(0);
 
 #ifdef SPADES_ENABLE_EXPENSIVE_CHECKS
@@ -27,6 +39,8 @@
 #define VERIFY_MSG(expr, msg)                                           \
     if (!(expr)) {                                                      \
         std::stringstream ss;                                           \
+        if (utils::verify_failure_hook())                               \
+            utils::verify_failure_hook()();                             \
         utils::print_stacktrace();                                      \
         ss << "Verification of expression '" << #expr << "' failed in function '" <<  __PRETTY_FUNCTION__ << \
                 "'. In file '" << __FILE__ << "' on line " << __LINE__ << ". Message '" << msg << "'." ; \
@@ -46,7 +46,36 @@ public:
 
     MappingPath Process(const io::SingleRead &read) const {
         MappingPath path = mapper_->MapRead(read);
-        const auto &name = read.name();
+        AddPositions(path, read.name());
+        return path;
+    }
+
+    /// References are mapped in parallel by batches, positions are added sequentially
+    void Process(io::SingleStream stream) const {
+        std::vector<io::SingleRead> reads;
+        std::vector<MappingPath> paths;
+        while (!stream.eof()) {
+            reads.clear();
+            io::SingleRead read;
+            while (reads.size() < kBatchSize && !stream.eof()) {
+                stream >> read;
+                reads.push_back(std::move(read));
+            }
+
+            paths.assign(reads.size(), MappingPath());
+#           pragma omp parallel for schedule(dynamic)
+            for (size_t i = 0; i < reads.size(); ++i)
+                paths[i] = mapper_->MapRead(reads[i]);
+
+            for (size_t i = 0; i < reads.size(); ++i)
+                AddPositions(paths[i], reads[i].name());
+        }
+    }
+
+private:
+    static constexpr size_t kBatchSize = 1024;
+
+    void AddPositions(const MappingPath &path, const std::string &name) const {
         TRACE("Contig " << name << " mapped on " << path.size() << " fragments.");
         for (size_t i = 0; i < path.size(); i++) {
             EdgeId ei = path[i].first;
@@ -69,18 +98,8 @@ public:
                                       mr.mapped_range.start_pos,
                                       mr.mapped_range.end_pos);
         }
-        return path;
-    }
-
-    void Process(io::SingleStream stream) const {
-        io::SingleRead read;
-        while (!stream.eof()) {
-            stream >> read;
-            Process(read);
-        }
     }
 
-private:
     DECL_LOGGER("PosFiller");
 };
 
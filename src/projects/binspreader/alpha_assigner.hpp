@@ -8,7 +8,7 @@
 #pragma once
 
 #include "binning.hpp"
-#include "id_map.hpp"
+#include "adt/id_map.hpp"
 
 #include "assembly_graph/core/graph.hpp"
 
@@ -10,7 +10,7 @@
 #include "binning.hpp"
 #include "binning_refiner.hpp"
 
-#include "id_map.hpp"
+#include "adt/id_map.hpp"
 
 namespace bin_stats {
 
@@ -7,7 +7,7 @@
 
 #pragma once
 
-#include "id_map.hpp"
+#include "adt/id_map.hpp"
 #include "assembly_graph/core/graph.hpp"
 
 #include "adt/small_pod_vector.hpp"
@@ -17,6 +17,8 @@
 #include "sequence/aa.hpp"
 #include "utils/parallel/openmp_wrapper.h"
 
+#include <memory>
+
 extern "C" {
     #include "easel.h"
     #include "esl_sqio.h"
@@ -24,23 +26,72 @@ extern "C" {
 
 namespace nrps {
 
-static void MatchContigsInternal(hmmer::HMMMatcher &matcher, const path_extend::BidirectionalPath &path,
-                                 const std::string &path_string,
-                                 const std::string &type, const std::string &desc,
-                                 ContigAlnInfo &res, io::OFastaReadStream &oss_contig, size_t model_length,
-                                 bool isAA = true) {
-    if (isAA) {
-        for (size_t shift = 0; shift < 3; ++shift) {
-            std::string ref_shift = std::to_string(path.GetId()) + "_" + std::to_string(shift);
-            std::string seq_aas = aa::translate(path_string.c_str() + shift);
-            matcher.match(ref_shift.c_str(), seq_aas.c_str());
+namespace {
+
+struct ScannedPath {
+    const path_extend::BidirectionalPath *path;
+    std::string seq;
+};
+
+typedef std::unique_ptr<ESL_SQ, void(*)(ESL_SQ*)> DigitalSeq;
+
+/// Sequences of the paths [begin, end) digitized once for all the HMMs of the same alphabet type:
+/// three translated frames per path for the amino acid models, the path itself for the DNA ones
+class DigitalFrames {
+  public:
+    DigitalFrames(const std::vector<ScannedPath> &paths, size_t begin, size_t end, bool isAA)
+            : abc_(esl_alphabet_Create(isAA ? eslAMINO : eslDNA), esl_alphabet_Destroy),
+              begin_(begin), nframes_(isAA ? 3 : 1) {
+        frames_.reserve((end - begin) * nframes_);
+        for (size_t i = 0; i < (end - begin) * nframes_; ++i)
+            frames_.emplace_back(nullptr, esl_sq_Destroy);
+
+#       pragma omp parallel for schedule(dynamic, 64)
+        for (size_t i = 0; i < end - begin; ++i) {
+            const ScannedPath &path = paths[begin + i];
+            for (size_t shift = 0; shift < nframes_; ++shift) {
+                std::string name = std::to_string(path.path->GetId()) + "_" + std::to_string(shift);
+                std::string seq = isAA ? aa::translate(path.seq.c_str() + shift) : path.seq;
+                ESL_SQ *sq = esl_sq_CreateFrom(name.c_str(), seq.c_str(), NULL, NULL, NULL);
+                esl_sq_Digitize(abc_.get(), sq);
+                frames_[i * nframes_ + shift].reset(sq);
+            }
         }
-    } else {
-            std::string ref_shift = std::to_string(path.GetId()) + "_0";
-            matcher.match(ref_shift.c_str(), path_string.c_str());
     }
+
+    size_t nframes() const { return nframes_; }
+    const ESL_SQ *frame(size_t path, size_t shift) const { return frames_[(path - begin_) * nframes_ + shift].get(); }
+
+  private:
+    std::unique_ptr<ESL_ALPHABET, void(*)(ESL_ALPHABET*)> abc_;
+    size_t begin_;
+    size_t nframes_;
+    std::vector<DigitalSeq> frames_;
+};
+
+/// Unit of work: single HMM against the consecutive block of paths
+struct ScanTask {
+    size_t hmm;
+    size_t begin, end;
+    size_t cost;
+
+    ContigAlnInfo alns;
+    // Path of each alignment to be written to restricted edges
+    std::vector<size_t> aln_paths;
+};
+
+}
+
+static void MatchContigsInternal(hmmer::HMMMatcher &matcher, const ScannedPath &path,
+                                 const DigitalFrames &frames, size_t path_idx,
+                                 const hmmer::HMM &hmm, ScanTask &task) {
+    bool isAA = frames.nframes() == 3;
+    size_t model_length = hmm.length();
+    for (size_t shift = 0; shift < frames.nframes(); ++shift)
+        matcher.match(frames.frame(path_idx, shift));
     matcher.summarize();
 
+    const std::string &path_string = path.seq;
     for (const auto &hit : matcher.hits()) {
         if (!hit.reported() || !hit.included())
             continue;
@@ -59,49 +110,27 @@ static void MatchContigsInternal(hmmer::HMMMatcher &matcher, const path_extend::
             seqpos.second = seqpos.second * (isAA ? 3 : 1)  + shift;
 
             std::string name(hit.name());
-#pragma omp critical
-            {
-                oss_contig << io::SingleRead(name, path_string);
-            }
             DEBUG(name);
             DEBUG("First - " << seqpos.first << ", second - " << seqpos.second);
-            res.push_back({name, type, desc,
-                           unsigned(seqpos.first), unsigned(seqpos.second),
-                           static_cast<std::string>(path_string).substr(seqpos.first, std::max(seqpos.second - seqpos.first, (int)path.g().k() + 1))});
+            task.alns.push_back({name, hmm.name(), hmm.desc() ? hmm.desc() : "",
+                                 unsigned(seqpos.first), unsigned(seqpos.second),
+                                 path_string.substr(seqpos.first, std::max(seqpos.second - seqpos.first, (int)path.path->g().k() + 1))});
+            task.aln_paths.push_back(path_idx);
         }
     }
     matcher.reset_top_hits();
 }
 
-static void MatchContigs(const path_extend::PathContainer &contig_paths, const path_extend::ScaffoldSequenceMaker &scaffold_maker,
+static void MatchContigs(const std::vector<ScannedPath> &paths, const DigitalFrames &frames,
                          const hmmer::HMM &hmm, const hmmer::hmmer_cfg &cfg,
-                         ContigAlnInfo &res, io::OFastaReadStream &oss_contig) {
-    DEBUG("Total contigs: " << contig_paths.size());
+                         ScanTask &task) {
+    DEBUG("Matching paths " << task.begin << " - " << task.end << " with " << hmm.name());
     DEBUG("Model length - " << hmm.length());
     hmmer::HMMMatcher matcher(hmm, cfg);
-    bool isAA = hmm.abc()->type == eslAMINO;
-    for (auto iter = contig_paths.begin(); iter != contig_paths.end(); ++iter) {
-        const path_extend::BidirectionalPath &path = iter.get();
-        if (path.Length() <= 0)
-            continue;
-
-        std::string path_string = scaffold_maker.MakeSequence(path);
-        MatchContigsInternal(matcher, path, path_string,
-                             hmm.name(), hmm.desc() ? hmm.desc() : "",
-                             res, oss_contig, hmm.length(), isAA);
-
-        const path_extend::BidirectionalPath& conj_path = iter.getConjugate();
-        if (conj_path.Length() <= 0)
-            continue;
-
-        std::string path_string_conj = scaffold_maker.MakeSequence(conj_path);
-        MatchContigsInternal(matcher, conj_path, path_string_conj,
-                             hmm.name(), hmm.desc() ? hmm.desc() : "",
-                             res, oss_contig, hmm.length(), isAA);
-    }
+    for (size_t i = task.begin; i < task.end; ++i)
+        MatchContigsInternal(matcher, paths[i], frames, i, hmm, task);
 }
 
-
 static void ParseHMMFile(std::vector<hmmer::HMM> &hmms, const std::filesystem::path &filename) {
     auto hmmfile = hmmer::open_file(filename);
     if (std::error_code ec = hmmfile.getError()) {
@@ -189,24 +218,121 @@ ContigAlnInfo DomainMatcher::MatchDomains(graph_pack::GraphPack &gp,
     // so it will be a bit conservative for nucleotide HMMs / sequences
     hcfg.Z = 3 * broken_scaffolds.size();
 
-#   pragma omp parallel for
+    // Reseeding makes the hits of a path independent of the other paths scanned by the
+    // same matcher, so the result does not depend on the splitting into the tasks
+    hcfg.reseed = true;
+
+    // Sequences (and their conjugates) are built once for all the HMMs
+    std::vector<ScannedPath> paths;
+    for (auto iter = broken_scaffolds.begin(); iter != broken_scaffolds.end(); ++iter) {
+        const path_extend::BidirectionalPath &path = iter.get();
+        if (path.Length() <= 0)
+            continue;
+        paths.push_back({&path, ""});
+
+        const path_extend::BidirectionalPath &conj_path = iter.getConjugate();
+        if (conj_path.Length() <= 0)
+            continue;
+        paths.push_back({&conj_path, ""});
+    }
+
+    size_t total_length = 0;
+#   pragma omp parallel for schedule(dynamic, 64) reduction(+ : total_length)
+    for (size_t i = 0; i < paths.size(); ++i) {
+        paths[i].seq = scaffold_maker.MakeSequence(*paths[i].path);
+        total_length += paths[i].seq.size();
+    }
+    INFO("Total paths to match: " << paths.size() << ", total length: " << total_length);
+
+    // Split the paths into blocks of about the same length, so the scanning of a
+    // single long HMM against a large graph is spread over the threads as well
+    const size_t kMinBlockLength = 1 << 18;
+    size_t block_length = std::max(kMinBlockLength,
+                                   total_length / (8 * size_t(omp_get_max_threads())));
+    std::vector<std::pair<size_t, size_t>> blocks;
+    std::vector<size_t> block_lengths;
+    for (size_t begin = 0, end = 0; begin < paths.size(); begin = end) {
+        size_t length = 0;
+        while (end < paths.size() && (end == begin || length < block_length))
+            length += paths[end++].seq.size();
+        blocks.emplace_back(begin, end);
+        block_lengths.push_back(length);
+    }
+
+    // Digitized sequences take about a byte per nucleotide for every alphabet, so the
+    // blocks are scanned in windows of bounded length and digitized per window
+    const size_t kMaxWindowLength = 1ull << 28;
+    std::vector<size_t> block_window(blocks.size());
+    size_t nwindows = 0;
+    for (size_t b = 0, length = 0; b < blocks.size(); ++b) {
+        if (b == 0 || length + block_lengths[b] > kMaxWindowLength) {
+            nwindows += 1;
+            length = 0;
+        }
+        length += block_lengths[b];
+        block_window[b] = nwindows - 1;
+    }
+
+    bool hasAA = false, hasDNA = false;
+    for (const auto &hmm : hmms)
+        (hmm.abc()->type == eslAMINO ? hasAA : hasDNA) = true;
+
+    // The tasks are ordered by HMM and path, the estimated cost of each one is
+    // proportional to the number of DP cells of the profile and the sequences
+    std::vector<ScanTask> tasks;
+    std::vector<size_t> task_window;
     for (size_t i = 0; i < hmms.size(); ++i) {
-        ContigAlnInfo local_res;
-        std::string name = hmms[i].name();
-#       pragma omp critical
-        {
-            INFO("Matching contigs with " << name);
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            tasks.push_back({i, blocks[b].first, blocks[b].second, hmms[i].length() * block_lengths[b], {}, {}});
+            task_window.push_back(block_window[b]);
+        }
+    }
+
+    INFO("Matching " << hmms.size() << " HMMs in " << tasks.size() << " tasks, " << nwindows << " window(s)");
+    for (size_t w = 0; w < nwindows; ++w) {
+        // Most expensive tasks go first, so the cheap ones fill the gaps at the end
+        std::vector<size_t> order;
+        for (size_t t = 0; t < tasks.size(); ++t) {
+            if (task_window[t] == w)
+                order.push_back(t);
+        }
+        if (order.empty())
+            continue;
+        std::stable_sort(order.begin(), order.end(),
+                         [&](size_t a, size_t b) { return tasks[a].cost > tasks[b].cost; });
+
+        // The window sequences are released as soon as all the HMMs are matched against them
+        size_t begin = tasks[order.front()].begin, end = tasks[order.front()].end;
+        for (size_t t : order) {
+            begin = std::min(begin, tasks[t].begin);
+            end = std::max(end, tasks[t].end);
         }
+        std::unique_ptr<DigitalFrames> aa_frames, dna_frames;
+        if (hasAA)
+            aa_frames = std::make_unique<DigitalFrames>(paths, begin, end, true);
+        if (hasDNA)
+            dna_frames = std::make_unique<DigitalFrames>(paths, begin, end, false);
 
-        MatchContigs(broken_scaffolds, scaffold_maker,
-                     hmms[i], hcfg,
-                     local_res, oss_contig);
+#       pragma omp parallel for schedule(dynamic, 1)
+        for (size_t i = 0; i < order.size(); ++i) {
+            ScanTask &task = tasks[order[i]];
+            const hmmer::HMM &hmm = hmms[task.hmm];
+            const auto &frames = hmm.abc()->type == eslAMINO ? *aa_frames : *dna_frames;
+            MatchContigs(paths, frames, hmm, hcfg, task);
+        }
+    }
 
-#       pragma omp critical
-        {
-            INFO("Matches for '" << name << "': " << local_res.size());
-            res.insert(res.end(), std::make_move_iterator(local_res.begin()), std::make_move_iterator(local_res.end()));
+    // Collect the results in the deterministic order
+    for (size_t i = 0, t = 0; i < hmms.size(); ++i) {
+        size_t matches = 0;
+        for (; t < tasks.size() && tasks[t].hmm == i; ++t) {
+            ScanTask &task = tasks[t];
+            for (size_t j = 0; j < task.alns.size(); ++j)
+                oss_contig << io::SingleRead(task.alns[j].name, paths[task.aln_paths[j]].seq);
+            matches += task.alns.size();
+            res.insert(res.end(), std::make_move_iterator(task.alns.begin()), std::make_move_iterator(task.alns.end()));
         }
+        INFO("Matches for '" << hmms[i].name() << "': " << matches);
     }
 
     INFO("Total domain matches: " << res.size());
@@ -8,14 +8,20 @@
 
 #include "configs/config_struct.hpp"
 
+#include "io/dataset_support/resident_reads.hpp"
 #include "utils/logger/log_writers.hpp"
+#include "utils/logger/log_writers_thread.hpp"
 #include "utils/memory_limit.hpp"
+#include "utils/parallel/task_scheduler.hpp"
 #include "utils/segfault_handler.hpp"
 #include "utils/perf/timetracer.hpp"
 
 #include "k_range.hpp"
 #include "version.hpp"
 
+#include <cstring>
+#include <exception>
+
 namespace spades {
 void assemble_genome();
 }
@@ -63,11 +69,41 @@ void create_console_logger(const std::filesystem::path& dir, std::filesystem::pa
         log_prop_fn = dir / log_prop_fn;
 
     logger *lg = create_logger(exists(log_prop_fn) ? log_prop_fn : "");
-    lg->add_writer(std::make_shared<console_writer>());
-    //lg->add_writer(std::make_shared<mutex_writer>(std::make_shared<console_writer>()));
+    // Formatting and output are done by the separate thread, so DEBUG / TRACE
+    // messages from parallel loops do not serialize the workers
+    lg->add_writer(std::make_shared<async_writer>(std::make_shared<console_writer>()));
     attach_logger(lg);
 }
 
+static void assemble_iteration(const char *program_name) {
+    using namespace debruijn_graph;
+
+    VERIFY(cfg::get().K >= runtime_k::MIN_K && cfg::get().K < runtime_k::MAX_K);
+    VERIFY(cfg::get().K % 2 != 0);
+
+    INFO("Assembling dataset (" << cfg::get().dataset_file << ") with K=" << cfg::get().K);
+    INFO("Maximum # of threads to use (adjusted due to OMP capabilities): " << cfg::get().max_threads);
+    std::unique_ptr<TimeTracerRAII> traceraii;
+    if (cfg::get().tt.enable || cfg::get().developer_mode) {
+        traceraii.reset(new TimeTracerRAII(program_name,
+                                           cfg::get().tt.granularity,
+                                           cfg::get().output_dir, std::to_string(cfg::get().K)));
+        INFO("Time tracing is enabled");
+    }
+
+    TIME_TRACE_SCOPE("spades");
+    spades::assemble_genome();
+}
+
+static std::terminate_handler default_terminate = nullptr;
+
+static void flush_log_and_terminate() {
+    logging::flush_async_writers();
+    if (default_terminate)
+        default_terminate();
+    std::abort();
+}
+
 int main(int argc, char **argv) {
     utils::perf_counter pc;
 
@@ -76,43 +112,56 @@ int main(int argc, char **argv) {
     srand(42);
     srandom(42);
 
+    // The log is written in background, so write out the buffered messages
+    // before the failure is reported. This is not possible for segmentation
+    // faults: flushing is not async-signal-safe
+    utils::segfault_handler sh;
+    utils::verify_failure_hook() = logging::flush_async_writers;
+    default_terminate = std::set_terminate(flush_log_and_terminate);
+
     try {
         using namespace debruijn_graph;
 
         std::filesystem::path cfg_dir = std::filesystem::path(argv[1]).parent_path();
 
-        std::vector<std::filesystem::path> cfg_fns;
+        // Several K iterations could be run within a single process: config
+        // sets for different iterations are separated by "--". The reads used
+        // for graph construction are kept in memory between the iterations then.
+        std::vector<std::vector<std::filesystem::path>> iterations(1);
         for (int i = 1; i < argc; ++i) {
-           cfg_fns.push_back(argv[i]);
+            if (strcmp(argv[i], "--") == 0) {
+                iterations.emplace_back();
+                continue;
+            }
+            iterations.back().push_back(argv[i]);
         }
 
-        // read configuration file (dataset path etc.)
-        load_config(cfg_fns);
-
-        create_console_logger(cfg_dir, cfg::get().log_filename);
-        for (const auto& cfg_fn : cfg_fns)
-            INFO("Loaded config from " << cfg_fn);
-
-        VERIFY(cfg::get().K >= runtime_k::MIN_K && cfg::get().K < runtime_k::MAX_K);
-        VERIFY(cfg::get().K % 2 != 0);
-
-        utils::limit_memory(cfg::get().max_memory * GB);
-
-        // assemble it!
-        START_BANNER("SPAdes");
-        INFO("Maximum k-mer length: " << runtime_k::MAX_K);
-        INFO("Assembling dataset (" << cfg::get().dataset_file << ") with K=" << cfg::get().K);
-        INFO("Maximum # of threads to use (adjusted due to OMP capabilities): " << cfg::get().max_threads);
-        std::unique_ptr<TimeTracerRAII> traceraii;
-        if (cfg::get().tt.enable || cfg::get().developer_mode) {
-            traceraii.reset(new TimeTracerRAII(argv[0],
-                                               cfg::get().tt.granularity,
-                                               cfg::get().output_dir, std::to_string(cfg::get().K)));
-            INFO("Time tracing is enabled");
-        }
+        for (size_t i = 0; i < iterations.size(); ++i) {
+            if (i > 0)
+                cfg::reset();
+
+            // read configuration file (dataset path etc.)
+            load_config(iterations[i]);
 
-        TIME_TRACE_SCOPE("spades");
-        spades::assemble_genome();
+            if (i == 0) {
+                create_console_logger(cfg_dir, cfg::get().log_filename);
+
+                utils::limit_memory(cfg::get().max_memory * GB);
+                parallel::TaskScheduler::init(cfg::get().max_threads, cfg::get().pin_task_workers);
+
+                START_BANNER("SPAdes");
+                INFO("Maximum k-mer length: " << runtime_k::MAX_K);
+                if (iterations.size() > 1) {
+                    INFO("Running " << iterations.size() << " K iterations within single process");
+                    io::ResidentReadStore::instance().enable(cfg::get().max_memory * GB / 4);
+                }
+            }
+            for (const auto& cfg_fn : iterations[i])
+                INFO("Loaded config from " << cfg_fn);
+
+            // assemble it!
+            assemble_iteration(argv[0]);
+        }
     } catch (std::bad_alloc const &e) {
         std::cerr << "Not enough memory to run SPAdes. " << e.what() << std::endl;
         return EINTR;
@@ -227,8 +227,15 @@ void assemble_genome() {
     StageManager SPAdes(SavesPolicy(cfg::get().checkpoints,
                                     cfg::get().output_saves, cfg::get().load_from));
 
-    if (SPAdes.saves_policy().EnabledAnyCheckpoint())
+    if (SPAdes.saves_policy().EnabledAnyCheckpoint()) {
         create_directory(cfg::get().output_saves);
+        if (cfg::get().async_checkpoints)
+            SPAdes.enable_async_checkpoints();
+    }
+
+    if (cfg::get().tt.telemetry)
+        SPAdes.enable_telemetry(cfg::get().output_dir, cfg::get().K, cfg::get().max_threads,
+                                cfg::get().tmp_dir, cfg::get().tt.telemetry_interval);
 
     bool two_step_rr = cfg::get().two_step_rr && cfg::get().rr_enable;
     INFO("Two-step repeat resolution " << (two_step_rr ? "enabled" : "disabled"));
@@ -707,6 +707,12 @@ def add_hidden_args(pgroup_hidden):
                              help="enable time tracker"
                              if show_help_hidden else argparse.SUPPRESS,
                              action="store_true")
+    debug_group.add_argument("--telemetry",
+                             dest="telemetry",
+                             default=None,
+                             help="write per-stage resource usage (time, memory, I/O, temporary disk)"
+                             if show_help_hidden else argparse.SUPPRESS,
+                             action="store_true")
 
     pgroup_hidden.add_argument("--stop-after",
                                metavar="<cp>",
@@ -769,6 +775,12 @@ def add_hidden_args(pgroup_hidden):
                                help="Enables saving graph pack before repeat resolution (even without --debug)"
                                if show_help_hidden else argparse.SUPPRESS,
                                action="store_true")
+    pgroup_hidden.add_argument("--single-process-k",
+                               dest="single_process_k",
+                               default=None,
+                               help="runs all K iterations within single spades-core process, keeping reads in memory"
+                               if show_help_hidden else argparse.SUPPRESS,
+                               action="store_true")
     pgroup_hidden.add_argument("--hidden-cov-cutoff",
                                metavar="<float>",
                                type=lcer_cutoff,
@@ -937,6 +949,7 @@ def add_to_cfg(cfg, log, bin_home, spades_home, args):
     cfg["common"].__dict__["sewage_matrix"] = os.path.join(spades_home, "sewage/usher_barcodes.csv")
 
     cfg["common"].__dict__["time_tracer"] = args.time_tracer
+    cfg["common"].__dict__["telemetry"] = args.telemetry
     if args.series_analysis:
         cfg["common"].__dict__["series_analysis"] = args.series_analysis
 
@@ -998,6 +1011,7 @@ def add_to_cfg(cfg, log, bin_home, spades_home, args):
         cfg["assembly"].__dict__["cov_cutoff"] = args.cov_cutoff
         cfg["assembly"].__dict__["lcer_cutoff"] = args.lcer_cutoff
         cfg["assembly"].__dict__["save_gp"] = args.save_gp
+        cfg["assembly"].__dict__["single_process_k"] = args.single_process_k
         if args.read_buffer_size:
             cfg["assembly"].__dict__["read_buffer_size"] = args.read_buffer_size
         cfg["assembly"].__dict__["gfa11"] = args.gfa11
@@ -1203,6 +1217,8 @@ def set_default_values():
         options_storage.args.developer_mode = False
     if options_storage.args.time_tracer is None:
         options_storage.args.time_tracer = False        
+    if options_storage.args.telemetry is None:
+        options_storage.args.telemetry = False
     if options_storage.args.qvoffset == "auto":
         options_storage.args.qvoffset = None
     if options_storage.args.cov_cutoff is None:
@@ -1213,6 +1229,8 @@ def set_default_values():
         options_storage.args.large_genome = False
     if options_storage.args.save_gp is None:
         options_storage.args.save_gp = False
+    if options_storage.args.single_process_k is None:
+        options_storage.args.single_process_k = False
     if options_storage.args.only_assembler is None:
         options_storage.args.only_assembler = False
     if options_storage.args.only_error_correction is None:
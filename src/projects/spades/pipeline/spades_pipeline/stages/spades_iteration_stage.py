@@ -68,6 +68,7 @@ def prepare_config_spades(filename, cfg, log, additional_contigs_fname, K, stage
     subst_dict["sewage_matrix"] = cfg.sewage_matrix
 
     subst_dict["time_tracer_enabled"] = bool_to_str(cfg.time_tracer)
+    subst_dict["telemetry_enabled"] = bool_to_str(cfg.telemetry)
     subst_dict["gap_closer_enable"] = bool_to_str(last_one or K >= options_storage.GAP_CLOSER_ENABLE_MIN_K)
     subst_dict["rr_enable"] = bool_to_str(last_one and cfg.rr_enable)
     subst_dict["gfa11"] = bool_to_str(cfg.gfa11)
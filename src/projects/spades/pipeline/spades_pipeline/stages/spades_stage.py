@@ -375,12 +375,35 @@ class SpadesStage(stage.Stage):
         for stage in self.stages:
             stage.generate_config(self.cfg)
 
+    # Runs all K iterations by single spades-core, so the reads used for graph
+    # construction are loaded once. Config sets of iterations are separated by "--"
+    def merge_iteration_commands(self, commands):
+        args = []
+        for command in commands:
+            if args:
+                args.append("--")
+            args += command.args
+        return [commands_parser.Command(STAGE="K%d-K%d" % (self.used_K[0], self.used_K[-1]),
+                                        path=commands[0].path,
+                                        args=args,
+                                        config_dir=commands[0].config_dir,
+                                        short_name=commands[0].short_name)]
+
     def get_command(self, cfg):
+        iteration_commands = [x for stage in self.stages
+                              if isinstance(stage, spades_iteration_stage.IterationStage)
+                              for x in stage.get_command(self.cfg)]
+        if self.cfg.single_process_k and len(iteration_commands) > 1:
+            iteration_commands = self.merge_iteration_commands(iteration_commands)
+
         return [commands_parser.Command(STAGE=self.STAGE_NAME,
                                         path="true",
                                         args=[],
                                         short_name=self.short_name + "_start")] + \
-               [x for stage in self.stages for x in stage.get_command(self.cfg)] + \
+               iteration_commands + \
+               [x for stage in self.stages
+                if not isinstance(stage, spades_iteration_stage.IterationStage)
+                for x in stage.get_command(self.cfg)] + \
                [commands_parser.Command(STAGE=self.STAGE_NAME,
                                         path="true",
                                         args=[],
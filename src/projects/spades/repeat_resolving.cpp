@@ -10,6 +10,7 @@
 
 #include "assembly_graph/stats/picture_dump.hpp"
 #include "modules/path_extend/pipeline/launcher.hpp"
+#include "pipeline/graph_pack_helpers.h"
 #include "utils/logger/logger.hpp"
 
 namespace debruijn_graph {
@@ -24,8 +25,12 @@ static void PEResolving(graph_pack::GraphPack& gp) {
                                                   cfg::get().avoid_rc_connections,
                                                   cfg::get().use_scaffolder);
 
-    path_extend::PathExtendLauncher exspander(cfg::get().ds, params, gp);
-    exspander.Launch();
+    graph_pack::FreezeClusteredIndices(gp);
+    {
+        path_extend::PathExtendLauncher exspander(cfg::get().ds, params, gp);
+        exspander.Launch();
+    }
+    graph_pack::ThawClusteredIndices(gp);
 }
 
 static bool HasValidLibs() {
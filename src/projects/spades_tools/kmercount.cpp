@@ -10,7 +10,7 @@
 
 #include "library/library.hpp"
 
-#include "io/reads/read_processor.hpp"
+#include "io/reads/batch_pipeline.hpp"
 #include "io/reads/io_helper.hpp"
 
 #include "kmer_index/ph_map/kmer_maps.hpp"
@@ -62,11 +62,11 @@ class ParallelSortingSplitter : public kmers::KMerSortingSplitter<RtSeq> {
 
       size_t processed() const { return processed_; }
 
-      bool operator()(std::unique_ptr<io::SingleRead> r) {
+      bool operator()(const io::SingleRead &r) {
 #         pragma omp atomic
           processed_ += 1;
 
-          const Sequence &seq = r->sequence();
+          const Sequence &seq = r.sequence();
 
           if (seq.size() < this->K_)
               return false;
@@ -101,11 +101,11 @@ class ParallelSortingSplitter : public kmers::KMerSortingSplitter<RtSeq> {
         for (const auto &file : files_) {
             INFO("Processing " << file);
             auto irs = io::EasyStream(file, true, true);
+            io::BatchPipeline<io::SingleRead> pipeline(nthreads);
             while (!irs.eof()) {
-                hammer::ReadProcessor rp(nthreads);
-                rp.Run(irs, filler);
+                pipeline.Run(irs, filler);
                 DumpBuffers(out);
-                VERIFY_MSG(rp.read() == rp.processed(), "Queue unbalanced");
+                VERIFY_MSG(pipeline.read() == pipeline.processed(), "Queue unbalanced");
 
                 if (filler.processed() >> n) {
                     INFO("Processed " << filler.processed() << " reads");
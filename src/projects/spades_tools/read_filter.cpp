@@ -7,6 +7,7 @@
 //***************************************************************************
 
 #include "io/dataset_support/read_converter.hpp"
+#include "io/reads/batch_pipeline.hpp"
 #include "io/reads/file_read_flags.hpp"
 #include "io/reads/osequencestream.hpp"
 #include "io/reads/coverage_filtering_read_wrapper.hpp"
@@ -80,49 +81,16 @@ void process_cmdline(int argc, char **argv, read_filter::Args &args) {
 }
 
 template<class IS, class OS, class Filter>
-void filter_reads(IS &input, OS &output, const Filter& filter, unsigned buffer_size, unsigned nthreads) {
-    std::vector<typename OS::ReadT> reads_buffer(buffer_size);
-    std::vector<bool> need_to_out(buffer_size);
-    std::vector<unsigned> chunk_start(nthreads), chunk_end(nthreads);
-
-    size_t read_count = 0, retained = 0;
-    while (!input.eof()) {
-        unsigned reads_cnt = 0;
-        while (!input.eof() && reads_cnt < reads_buffer.size()) {
-            input >> reads_buffer[reads_cnt];
-            ++reads_cnt; ++read_count;
-        }
-
-        unsigned reads_per_thread = reads_cnt/nthreads;
-        chunk_start[0] = 0;
-        chunk_end[0] = reads_per_thread;
-        for (unsigned i = 1; i < nthreads; ++i) {
-            chunk_start[i] = chunk_end[i - 1];
-            chunk_end[i] = chunk_start[i] + reads_per_thread;
-        }
-        chunk_end[nthreads - 1] = reads_cnt;
-
-#       pragma omp parallel for
-        for (unsigned i = 0; i < nthreads; ++i) {
-            for (unsigned j = chunk_start[i]; j < chunk_end[i]; ++j) {
-                typename OS::ReadT longest_valid_read = reads_buffer[j];
-                io::LongestValid(longest_valid_read);
-
-                need_to_out[j] = filter(longest_valid_read);
-            }
-        }
-
-        for (size_t i = 0; i < reads_cnt; ++i) {
-            if (need_to_out[i]) {
-                output << reads_buffer[i];
-                retained += 1;
-            }
-            need_to_out[i] = false;
-        }
-
-        VERBOSE_POWER(read_count, " reads processed");
-    }
-    INFO("Total " << read_count << " reads processed, " << retained << " reads left after filtering");
+void filter_reads(IS &input, OS &output, const Filter& filter, unsigned nthreads) {
+    io::BatchPipeline<typename IS::ReadT> pipeline(nthreads);
+    size_t retained = pipeline.Run(input,
+                                   [&](const typename IS::ReadT &read) {
+                                       typename IS::ReadT longest_valid_read = read;
+                                       io::LongestValid(longest_valid_read);
+                                       return filter(longest_valid_read);
+                                   },
+                                   output);
+    INFO("Total " << pipeline.read() << " reads processed, " << retained << " reads left after filtering");
 }
 
 int main(int argc, char* argv[]) {
@@ -178,8 +146,6 @@ int main(int argc, char* argv[]) {
         kmers::FillCoverageHistogram(cqf, args.k, hasher, single_readers, args.thr + 1);
         INFO("Kmer coverage filled");
 
-        const unsigned FILTER_READS_BUFF_SIZE = 1 << 20;
-
         io::DataSet<debruijn_graph::config::LibraryData> outdataset;
         for (size_t i = 0; i < dataset.lib_count(); ++i) {
             auto outlib = dataset[i];
@@ -200,14 +166,14 @@ int main(int argc, char* argv[]) {
                     std::filesystem::path right = to_string(i + 1) + ".2.fasta";
 
                     io::OFastaPairedStream ostream(args.workdir / left, args.workdir / right);
-                    filter_reads(paired_reads_stream, ostream, filter, FILTER_READS_BUFF_SIZE, args.nthreads);
+                    filter_reads(paired_reads_stream, ostream, filter, args.nthreads);
                     outlib.push_back_paired(left, right);
                 } else {
                     std::filesystem::path left = args.workdir / (to_string(i + 1) + ".1.fastq");
                     std::filesystem::path right = args.workdir / (to_string(i + 1) + ".2.fastq");
 
                     io::OFastqPairedStream ostream(left, right);
-                    filter_reads(paired_reads_stream, ostream, filter, FILTER_READS_BUFF_SIZE, args.nthreads);
+                    filter_reads(paired_reads_stream, ostream, filter, args.nthreads);
                     outlib.push_back_paired(left, right);
                 }
             }
@@ -221,12 +187,12 @@ int main(int argc, char* argv[]) {
                 if (args.drop_names || args.drop_quality) {
                     std::filesystem::path single = to_string(i + 1) + ".s.fasta";
                     io::OFastqReadStream ostream(args.workdir / single);
-                    filter_reads(single_reads_stream, ostream, filter, FILTER_READS_BUFF_SIZE, args.nthreads);
+                    filter_reads(single_reads_stream, ostream, filter, args.nthreads);
                     outlib.push_back_single(single);
                 } else {
                     std::filesystem::path single = args.workdir / (to_string(i + 1) + ".s.fastq");
                     io::OFastqReadStream ostream(single);
-                    filter_reads(single_reads_stream, ostream, filter, FILTER_READS_BUFF_SIZE, args.nthreads);
+                    filter_reads(single_reads_stream, ostream, filter, args.nthreads);
                     outlib.push_back_single(single);
                 }
             }
@@ -240,12 +206,12 @@ int main(int argc, char* argv[]) {
                 if (args.drop_names || args.drop_quality) {
                     std::filesystem::path merged = args.workdir / (to_string(i + 1) + ".m.fasta");
                     io::OFastaReadStream ostream(merged);
-                    filter_reads(single_reads_stream, ostream, filter, FILTER_READS_BUFF_SIZE, args.nthreads);
+                    filter_reads(single_reads_stream, ostream, filter, args.nthreads);
                     outlib.push_back_merged(merged);
                 } else {
                     std::filesystem::path merged = to_string(i + 1) + ".m.fastq";
                     io::OFastqReadStream ostream(args.workdir / merged);
-                    filter_reads(single_reads_stream, ostream, filter, FILTER_READS_BUFF_SIZE, args.nthreads);
+                    filter_reads(single_reads_stream, ostream, filter, args.nthreads);
                     outlib.push_back_merged(merged);
                 }
             }
@@ -52,6 +52,7 @@ template<> struct MappingTraits<sensitive_aligner::GapClosingConfig> {
         io.mapRequired("find_shortest_path", cfg.find_shortest_path);
         io.mapRequired("restore_mapping", cfg.restore_mapping);
         io.mapRequired("penalty_ratio", cfg.penalty_ratio);
+        io.mapOptional("bit_parallel", cfg.bit_parallel, false);
         io.mapRequired("max_ed_proportion", cfg.max_ed_proportion);
         io.mapRequired("ed_lower_bound", cfg.ed_lower_bound);
         io.mapRequired("ed_upper_bound", cfg.ed_upper_bound);
@@ -67,6 +68,7 @@ template<> struct MappingTraits<sensitive_aligner::EndsClosingConfig> {
         io.mapRequired("find_shortest_path", cfg.find_shortest_path);
         io.mapRequired("restore_mapping", cfg.restore_mapping);
         io.mapRequired("penalty_ratio", cfg.penalty_ratio);
+        io.mapOptional("bit_parallel", cfg.bit_parallel, false);
         io.mapRequired("max_ed_proportion", cfg.max_ed_proportion);
         io.mapRequired("ed_lower_bound", cfg.ed_lower_bound);
         io.mapRequired("ed_upper_bound", cfg.ed_upper_bound);
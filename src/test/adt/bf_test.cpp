@@ -0,0 +1,135 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "adt/bf.hpp"
+
+#include "utils/logger/logger.hpp"
+#include "utils/logger/log_writers.hpp"
+
+#include <vector>
+#include <numeric>
+
+#define XXH_INLINE_ALL
+#include "xxh/xxhash.h"
+
+#include <gtest/gtest.h>
+
+struct Hasher {
+    uint64_t operator()(uint64_t key, uint64_t seed) const {
+        return XXH3_64bits_withSeed(&key, sizeof(key), seed);
+    }
+};
+
+static constexpr size_t N = 1000000;
+
+static std::vector<uint64_t> Keys(size_t start, size_t n) {
+    std::vector<uint64_t> res(n);
+    std::iota(res.begin(), res.end(), start);
+    return res;
+}
+
+TEST(BloomFilterTest, blocked_no_false_negatives) {
+    bf::blocked_bloom_filter<uint64_t, Hasher> filter(Hasher(), 10 * N);
+    auto keys = Keys(0, N);
+    filter.add(keys.begin(), keys.end());
+
+    for (uint64_t key : keys)
+        ASSERT_EQ(filter.lookup(key), 1);
+
+    std::vector<size_t> res;
+    filter.lookup(keys.begin(), keys.end(), std::back_inserter(res));
+    ASSERT_EQ(res.size(), N);
+    for (size_t val : res)
+        ASSERT_EQ(val, 1);
+}
+
+TEST(BloomFilterTest, blocked_false_positive_rate) {
+    bf::blocked_bloom_filter<uint64_t, Hasher> filter(Hasher(), 10 * N);
+    bf::bloom_filter<uint64_t, Hasher> ref(Hasher(), 10 * N, 7);
+    for (uint64_t key : Keys(0, N)) {
+        filter.add(key);
+        ref.add(key);
+    }
+
+    size_t fp = 0, ref_fp = 0;
+    for (uint64_t key : Keys(N, N)) {
+        fp += filter.lookup(key);
+        ref_fp += ref.lookup(key);
+    }
+
+    INFO("Blocked FP: " << fp << ", ordinary FP: " << ref_fp);
+    // 10 bits per key: ~0.8% for ordinary filter, blocked one should be within 2x
+    EXPECT_LT(fp, 2 * ref_fp + N / 1000);
+}
+
+TEST(BloomFilterTest, blocked_add_reports_novelty) {
+    bf::blocked_bloom_filter<uint64_t, Hasher> filter(Hasher(), 1000);
+    EXPECT_TRUE(filter.add(42));
+    EXPECT_FALSE(filter.add(42));
+    filter.clear();
+    EXPECT_EQ(filter.lookup(42), 0);
+}
+
+TEST(BloomFilterTest, blocked_counting) {
+    bf::blocked_counting_bloom_filter<uint64_t, 2, Hasher> filter(Hasher(), 12 * N);
+    auto keys = Keys(0, N);
+    filter.add(keys.begin(), keys.end());
+    for (uint64_t key : Keys(0, N / 2))
+        filter.add(key);
+    for (uint64_t key : Keys(0, 10)) {
+        filter.add(key);
+        filter.add(key);
+    }
+
+    for (uint64_t key : Keys(0, 10))
+        EXPECT_EQ(filter.lookup(key), 3); // saturated
+    for (uint64_t key : Keys(10, N / 2 - 10))
+        ASSERT_GE(filter.lookup(key), 2);
+    for (uint64_t key : Keys(N / 2, N / 2))
+        ASSERT_GE(filter.lookup(key), 1);
+
+    size_t fp = 0;
+    for (uint64_t key : Keys(N, N))
+        fp += filter.lookup(key) > 1;
+    EXPECT_LT(fp, N / 100);
+}
+
+// The sizing of the paired info filter relies on this: with 14 cells per
+// element the blocked counting filter should not report singletons as repeated
+// more often than the ordinary one with 12 cells
+TEST(BloomFilterTest, blocked_counting_false_positive_rate) {
+    bf::blocked_counting_bloom_filter<uint64_t, 2, Hasher> filter(Hasher(), 14 * N);
+    bf::counting_bloom_filter<uint64_t, 2, Hasher> ref(Hasher(), 12 * N);
+    auto keys = Keys(0, N);
+    filter.add(keys.begin(), keys.end());
+    for (uint64_t key : keys)
+        ref.add(key);
+
+    size_t fp = 0, ref_fp = 0;
+    for (uint64_t key : keys) {
+        fp += filter.lookup(key) > 1;
+        ref_fp += ref.lookup(key) > 1;
+    }
+
+    INFO("Blocked FP: " << fp << ", ordinary FP: " << ref_fp);
+    // ~1.0% vs ~1.1%
+    EXPECT_LT(fp, ref_fp);
+}
+
+void create_console_logger() {
+    using namespace logging;
+
+    logger *lg = create_logger("");
+    lg->add_writer(std::make_shared<console_writer>());
+    attach_logger(lg);
+}
+
+GTEST_API_ int main(int argc, char **argv) {
+  create_console_logger();
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
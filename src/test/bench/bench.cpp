@@ -0,0 +1,174 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "bench.hpp"
+
+#include "utils/logger/log_writers.hpp"
+#include "utils/parallel/openmp_wrapper.h"
+#include "utils/segfault_handler.hpp"
+
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <clipp/clipp.h>
+
+#include <fstream>
+#include <iostream>
+#include <regex>
+
+namespace bench {
+
+std::vector<Benchmark> &registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+namespace {
+
+// Reads the field (in kB) from /proc/self/status
+size_t ProcStatus(const std::string &field) {
+    std::ifstream is("/proc/self/status");
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.compare(0, field.size(), field) == 0 && line[field.size()] == ':')
+            return std::stoul(line.substr(field.size() + 1));
+    }
+
+    return 0;
+}
+
+// Resets peak RSS (VmHWM) so it could be measured per benchmark
+void ResetPeakRSS() {
+    std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+void create_console_logger() {
+    using namespace logging;
+
+    logger *lg = create_logger("");
+    lg->add_writer(std::make_shared<console_writer>());
+    attach_logger(lg);
+}
+
+}
+}
+
+int main(int argc, char **argv) {
+    using namespace clipp;
+
+    utils::segfault_handler sh;
+    bench::Options opts;
+    opts.nthreads = omp_get_max_threads();
+    std::string filter = ".*", output, trace, workdir = ".";
+    bool list = false, print_help = false;
+
+    auto cli = (
+        (option("-t", "--threads") & integer("value", opts.nthreads)) % "# of threads to use",
+        (option("-s", "--scale") & number("value", opts.scale)) % "Problem size multiplier",
+        (option("--seed") & integer("value", opts.seed)) % "Random seed",
+        (option("-r", "--repeats") & integer("value", opts.repeats)) % "Number of runs of every benchmark",
+        (option("-f", "--filter") & value("regex", filter)) % "Run only benchmarks matching the regex",
+        (option("-w", "--workdir") & value("dir", workdir)) % "Working directory for temporary files",
+        (option("-o", "--output") & value("file", output)) % "Write results as JSON into the file",
+        (option("--time-trace") & value("file", trace)) % "Write per-phase time trace into the file",
+        option("-l", "--list").set(list) % "List available benchmarks",
+        option("-h", "--help").set(print_help) % "Show help"
+    );
+
+    if (!parse(argc, argv, cli) || print_help) {
+        std::cout << make_man_page(cli, argv[0]);
+        return print_help ? 0 : 1;
+    }
+
+    if (list) {
+        for (const auto &b : bench::registry())
+            std::cout << b.name << std::endl;
+        return 0;
+    }
+
+    bench::create_console_logger();
+    opts.workdir = workdir;
+    std::filesystem::create_directories(opts.workdir);
+    omp_set_num_threads(opts.nthreads);
+
+    if (!trace.empty())
+        llvm::timeTraceProfilerInitialize(0, "spades_bench");
+
+    std::string results;
+    llvm::raw_string_ostream rs(results);
+    {
+        llvm::json::OStream json(rs, 2);
+        json.objectBegin();
+        json.attribute("threads", opts.nthreads);
+        json.attribute("scale", opts.scale);
+        json.attribute("seed", int64_t(opts.seed));
+        json.attributeBegin("benchmarks");
+        json.arrayBegin();
+
+        std::regex re(filter);
+        for (const auto &b : bench::registry()) {
+            if (!std::regex_search(b.name, re))
+                continue;
+
+            for (unsigned run = 0; run < opts.repeats; ++run) {
+                INFO("Running " << b.name << " (" << run + 1 << "/" << opts.repeats << ")");
+                bench::ResetPeakRSS();
+                bench::State state(opts);
+                {
+                    TIME_TRACE_SCOPE(b.name);
+                    b.f(state);
+                }
+
+                json.objectBegin();
+                json.attribute("name", b.name);
+                json.attribute("run", run);
+                json.attribute("peak_rss_kb", int64_t(bench::ProcStatus("VmHWM")));
+                json.attribute("rss_kb", int64_t(bench::ProcStatus("VmRSS")));
+                json.attributeBegin("phases");
+                json.arrayBegin();
+                for (const auto &phase : state.phases()) {
+                    INFO("  " << phase.name << ": " << phase.seconds << " s, "
+                         << double(phase.items) / phase.seconds << " items/s");
+                    json.objectBegin();
+                    json.attribute("name", phase.name);
+                    json.attribute("seconds", phase.seconds);
+                    json.attribute("items", int64_t(phase.items));
+                    json.attribute("items_per_second", double(phase.items) / phase.seconds);
+                    json.objectEnd();
+                }
+                json.arrayEnd();
+                json.attributeEnd();
+                json.objectEnd();
+            }
+        }
+
+        json.arrayEnd();
+        json.attributeEnd();
+        json.objectEnd();
+    }
+    rs.flush();
+
+    if (output.empty()) {
+        std::cout << results << std::endl;
+    } else {
+        std::ofstream(output) << results << std::endl;
+        INFO("Results are written to " << output);
+    }
+
+    if (!trace.empty()) {
+        if (auto E = llvm::timeTraceProfilerWrite(trace, "spades_bench")) {
+            handleAllErrors(std::move(E),
+                            [&](const llvm::StringError &SE) {
+                                ERROR("" << SE.getMessage());
+                            });
+        } else {
+            INFO("Time trace is written to " << trace);
+        }
+        llvm::timeTraceProfilerCleanup();
+    }
+
+    return 0;
+}
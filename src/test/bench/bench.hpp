@@ -0,0 +1,94 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "utils/perf/timetracer.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct Options {
+    unsigned nthreads = 1;
+    // Multiplier of default problem sizes
+    double scale = 1.0;
+    uint64_t seed = 42;
+    unsigned repeats = 1;
+    std::filesystem::path workdir = ".";
+};
+
+struct PhaseResult {
+    std::string name;
+    double seconds = 0;
+    size_t items = 0;
+};
+
+/// Benchmark state. Every benchmark reports its measurements via phases: the
+/// setup code outside of the phases is not accounted for.
+class State {
+  public:
+    explicit State(const Options &opts)
+            : opts_(opts) {}
+
+    unsigned threads() const { return opts_.nthreads; }
+    uint64_t seed() const { return opts_.seed; }
+    const std::filesystem::path &workdir() const { return opts_.workdir; }
+
+    /// Problem size scaled according to the options
+    size_t scaled(size_t size) const {
+        return std::max<size_t>(1, size_t(double(size) * opts_.scale));
+    }
+
+    /// Runs and measures the phase. The phase function should return the
+    /// number of items processed, it will be used to compute the throughput.
+    void phase(const std::string &name, const std::function<size_t()> &f) {
+        TIME_TRACE_SCOPE(name);
+        auto start = std::chrono::steady_clock::now();
+        size_t items = f();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        phases_.push_back({ name, elapsed.count(), items });
+    }
+
+    const std::vector<PhaseResult> &phases() const { return phases_; }
+
+  private:
+    const Options &opts_;
+    std::vector<PhaseResult> phases_;
+};
+
+using BenchmarkF = std::function<void(State &)>;
+
+struct Benchmark {
+    std::string name;
+    BenchmarkF f;
+};
+
+std::vector<Benchmark> &registry();
+
+struct Registrar {
+    Registrar(const char *name, BenchmarkF f) {
+        registry().push_back({ name, std::move(f) });
+    }
+};
+
+/// Ensures the optimizer could not throw away the computed value
+template<class T>
+inline void do_not_optimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}
+
+#define SPADES_BENCHMARK(name)                                          \
+    static void bench_##name(bench::State &);                           \
+    static bench::Registrar registrar_##name(#name, bench_##name);      \
+    static void bench_##name(bench::State &state)
@@ -0,0 +1,110 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "assembly_graph/core/graph.hpp"
+#include "assembly_graph/dijkstra/dijkstra_helper.hpp"
+#include "io/graph/gfa_reader.hpp"
+#include "io/graph/gfa_writer.hpp"
+#include "io/reads/rc_reader_wrapper.hpp"
+#include "modules/graph_construction.hpp"
+#include "paired_info/paired_info.hpp"
+#include "utils/filesystem/temporary.hpp"
+
+#include <fstream>
+#include <random>
+
+using namespace debruijn_graph;
+
+namespace {
+
+// Graph of a synthetic diploid genome with repeats
+void BuildGraph(bench::State &state, Graph &g) {
+    bench::GenomeParams gparams;
+    gparams.length = state.scaled(2000000);
+    gparams.heterozygosity = 0.002;
+    auto reads = bench::SingleReads(bench::GenerateReads(bench::GenerateGenome(gparams, state.seed()),
+                                                         bench::ReadParams(), state.seed()));
+    auto streams = io::RCWrap<io::SingleRead>(bench::MakeStreams(reads, state.threads()));
+    auto workdir = fs::tmp::make_temp_dir(state.workdir(), "graph_bench");
+
+    state.phase("construction", [&] {
+        ConstructGraph(config::debruijn_config::construction(), workdir, streams, g);
+        return reads.size();
+    });
+}
+
+}
+
+SPADES_BENCHMARK(paired_index) {
+    Graph g(55);
+    BuildGraph(state, g);
+
+    std::vector<EdgeId> edges(g.e_begin(), g.e_end());
+    std::mt19937_64 rnd(state.seed());
+    std::uniform_int_distribution<size_t> edge(0, edges.size() - 1);
+    std::uniform_int_distribution<int> dist(-500, 500);
+    size_t n = state.scaled(5000000);
+
+    omnigraph::de::UnclusteredPairedInfoIndexT<Graph> index(g);
+    state.phase("insert", [&] {
+        for (size_t i = 0; i < n; ++i)
+            index.Add(edges[edge(rnd)], edges[edge(rnd)],
+                      omnigraph::de::RawPoint(float(dist(rnd)), 1.0f));
+        return n;
+    });
+
+    state.phase("iterate", [&] {
+        double weight = 0;
+        for (EdgeId e : edges)
+            for (auto entry : index.GetHalf(e))
+                for (auto point : entry.second)
+                    weight += point.weight;
+        bench::do_not_optimize(weight);
+        return index.size();
+    });
+}
+
+SPADES_BENCHMARK(dijkstra) {
+    Graph g(55);
+    BuildGraph(state, g);
+
+    std::vector<VertexId> vertices(g.begin(), g.end());
+    size_t n = std::min(vertices.size(), state.scaled(10000));
+    state.phase("bounded_dijkstra", [&] {
+        size_t reached = 0;
+#       pragma omp parallel for num_threads(state.threads()) reduction(+ : reached)
+        for (size_t i = 0; i < n; ++i) {
+            auto dijkstra = omnigraph::DijkstraHelper<Graph>::CreateBoundedDijkstra(g, 5000, 1000);
+            dijkstra.Run(vertices[i]);
+            reached += dijkstra.ReachedVertices().size();
+        }
+        bench::do_not_optimize(reached);
+        return n;
+    });
+}
+
+SPADES_BENCHMARK(gfa_io) {
+    Graph g(55);
+    BuildGraph(state, g);
+
+    auto filename = state.workdir() / "bench_graph.gfa";
+    state.phase("write", [&] {
+        std::ofstream os(filename);
+        gfa::GFAWriter(g, os).WriteSegmentsAndLinks();
+        return g.e_size();
+    });
+
+    state.phase("read", [&] {
+        Graph g2(55);
+        gfa::GFAReader(filename).to_graph(g2);
+        return g2.e_size();
+    });
+
+    std::filesystem::remove(filename);
+}
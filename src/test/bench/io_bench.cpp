@@ -0,0 +1,49 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "io/reads/binary_converter.hpp"
+#include "io/reads/binary_streams.hpp"
+#include "io/reads/vector_reader.hpp"
+
+SPADES_BENCHMARK(binary_reads) {
+    bench::GenomeParams gparams;
+    gparams.length = state.scaled(5000000);
+    auto reads = bench::GenerateReads(bench::GenerateGenome(gparams, state.seed()),
+                                      bench::ReadParams(), state.seed());
+    auto prefix = state.workdir() / "bench_reads";
+
+    state.phase("fastq_write", [&] {
+        bench::WriteFastq(reads, prefix.string() + ".fastq");
+        return 2 * reads.size();
+    });
+
+    const size_t nchunks = state.threads();
+    state.phase("binary_write", [&] {
+        io::ReadStream<io::PairedRead> stream{io::VectorReadStream<io::PairedRead>(reads)};
+        io::BinaryWriter(prefix).ToBinary(stream);
+        return 2 * reads.size();
+    });
+
+    state.phase("binary_read", [&] {
+        size_t nreads = 0;
+#       pragma omp parallel for num_threads(state.threads()) reduction(+ : nreads)
+        for (size_t i = 0; i < nchunks; ++i) {
+            io::BinaryFilePairedStream stream(prefix, 0, nchunks, i);
+            io::PairedReadSeq read;
+            while (!stream.eof()) {
+                stream >> read;
+                nreads += 2;
+            }
+        }
+        return nreads;
+    });
+
+    for (const auto &ext : { ".fastq", ".seq", ".off" })
+        std::filesystem::remove(prefix.string() + ext);
+}
@@ -0,0 +1,63 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "kmer_index/extension_index/kmer_extension_index.hpp"
+#include "kmer_index/kmer_mph/kmer_index_builder.hpp"
+#include "kmer_index/kmer_mph/kmer_splitters.hpp"
+#include "kmer_index/ph_map/perfect_hash_map_builder.hpp"
+#include "utils/filesystem/temporary.hpp"
+
+SPADES_BENCHMARK(kmer_index) {
+    bench::GenomeParams gparams;
+    gparams.length = state.scaled(2000000);
+    auto reads = bench::SingleReads(bench::GenerateReads(bench::GenerateGenome(gparams, state.seed()),
+                                                         bench::ReadParams(), state.seed()));
+    size_t nucls = 0;
+    for (const auto &r : reads)
+        nucls += r.size();
+
+    unsigned nthreads = state.threads();
+    auto streams = bench::MakeStreams(reads, nthreads);
+
+    unsigned k = 55;
+    using Map = kmers::PerfectHashMap<RtSeq, uint32_t, kmers::slim_kmer_index_traits<RtSeq>, kmers::DefaultStoring>;
+    using Splitter = kmers::DeBruijnReadKMerSplitter<io::SingleRead,
+                                                     kmers::StoringTypeFilter<kmers::DefaultStoring>>;
+    auto workdir = fs::tmp::make_temp_dir(state.workdir(), "kmer_bench");
+    Map index(k);
+
+    std::unique_ptr<kmers::KMerDiskStorage<RtSeq>> kmers;
+    state.phase("split_count", [&] {
+        kmers::KMerDiskCounter<RtSeq> counter(workdir, Splitter(workdir, k, streams));
+        kmers.reset(new kmers::KMerDiskStorage<RtSeq>(counter.Count(16 * nthreads, nthreads)));
+        return nucls;
+    });
+
+    state.phase("mphf_build", [&] {
+        kmers::PerfectHashMapBuilder().BuildIndex(index, *kmers, nthreads);
+        return kmers->total_kmers();
+    });
+
+    state.phase("lookup", [&] {
+        size_t found = 0;
+#       pragma omp parallel for num_threads(nthreads) reduction(+ : found)
+        for (size_t i = 0; i < reads.size(); ++i) {
+            const Sequence &seq = reads[i].sequence();
+            if (seq.size() < k)
+                continue;
+            auto kwh = index.ConstructKWH(seq.start<RtSeq>(k) >> 'A');
+            for (size_t j = k - 1; j < seq.size(); ++j) {
+                kwh <<= seq[j];
+                found += index.valid(kwh);
+            }
+        }
+        bench::do_not_optimize(found);
+        return nucls;
+    });
+}
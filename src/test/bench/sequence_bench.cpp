@@ -0,0 +1,101 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "adt/concurrent_dsu.hpp"
+#include "adt/cyclichash.hpp"
+#include "sequence/rtseq.hpp"
+#include "sequence/sequence.hpp"
+#include "utils/parallel/openmp_wrapper.h"
+
+#include <random>
+
+namespace {
+
+Sequence MakeSequence(size_t length, uint64_t seed) {
+    bench::GenomeParams params;
+    params.length = length;
+    params.repeats = 0;
+    return Sequence(bench::GenerateGenome(params, seed).front());
+}
+
+}
+
+SPADES_BENCHMARK(rtseq_shift_hash) {
+    Sequence seq = MakeSequence(state.scaled(10000000), state.seed());
+
+    for (unsigned k : { 21u, 55u, 127u }) {
+        std::string suffix = "_k" + std::to_string(k);
+
+        state.phase("shift" + suffix, [&] {
+            RtSeq kmer = seq.start<RtSeq>(k) >> 'A';
+            size_t acc = 0;
+            for (size_t j = k - 1; j < seq.size(); ++j) {
+                kmer <<= seq[j];
+                acc += kmer[0];
+            }
+            bench::do_not_optimize(acc);
+            return seq.size() - k + 1;
+        });
+
+        state.phase("shift_hash" + suffix, [&] {
+            RtSeq kmer = seq.start<RtSeq>(k) >> 'A';
+            size_t acc = 0;
+            for (size_t j = k - 1; j < seq.size(); ++j) {
+                kmer <<= seq[j];
+                acc ^= kmer.GetHash();
+            }
+            bench::do_not_optimize(acc);
+            return seq.size() - k + 1;
+        });
+    }
+}
+
+SPADES_BENCHMARK(cyclic_hash) {
+    Sequence seq = MakeSequence(state.scaled(10000000), state.seed());
+
+    for (unsigned k : { 21u, 55u, 127u }) {
+        rolling_hash::SymmetricCyclicHash<> hasher(k);
+        state.phase("rolling_k" + std::to_string(k), [&] {
+            auto hash = hasher(seq);
+            uint64_t acc = hash.value();
+            for (size_t j = k; j < seq.size(); ++j) {
+                hash = hasher.hash_update(hash, seq[j - k], seq[j]);
+                acc ^= hash.value();
+            }
+            bench::do_not_optimize(acc);
+            return seq.size() - k + 1;
+        });
+    }
+}
+
+SPADES_BENCHMARK(concurrent_dsu) {
+    size_t n = state.scaled(10000000);
+    std::mt19937_64 rnd(state.seed());
+    std::uniform_int_distribution<size_t> elt(0, n - 1);
+    std::vector<std::pair<size_t, size_t>> pairs(n);
+    for (auto &p : pairs)
+        p = { elt(rnd), elt(rnd) };
+
+    dsu::ConcurrentDSU dsu(n);
+    state.phase("unite", [&] {
+#       pragma omp parallel for num_threads(state.threads())
+        for (size_t i = 0; i < pairs.size(); ++i)
+            dsu.unite(pairs[i].first, pairs[i].second);
+        return pairs.size();
+    });
+
+    state.phase("find_set", [&] {
+        size_t acc = 0;
+#       pragma omp parallel for num_threads(state.threads()) reduction(^ : acc)
+        for (size_t i = 0; i < n; ++i)
+            acc ^= dsu.find_set(i);
+        bench::do_not_optimize(acc);
+        return n;
+    });
+}
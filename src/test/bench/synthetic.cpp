@@ -0,0 +1,133 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "synthetic.hpp"
+
+#include "io/reads/vector_reader.hpp"
+#include "sequence/nucl.hpp"
+#include "sequence/sequence_tools.hpp"
+
+#include <fstream>
+#include <random>
+
+namespace bench {
+
+static const char NUCLS[] = "ACGT";
+
+std::vector<std::string> GenerateGenome(const GenomeParams &params, uint64_t seed) {
+    std::mt19937_64 rnd(seed);
+    std::uniform_int_distribution<int> nucl(0, 3);
+
+    std::string genome(params.length, 'A');
+    for (auto &c : genome)
+        c = NUCLS[nucl(rnd)];
+
+    // Interspersed repeats: copies of a few random repeat units
+    if (params.repeat_length < params.length) {
+        std::string unit(params.repeat_length, 'A');
+        std::uniform_int_distribution<size_t> pos(0, params.length - params.repeat_length);
+        for (size_t i = 0; i < params.repeats; ++i) {
+            if (i % 10 == 0) {
+                for (auto &c : unit)
+                    c = NUCLS[nucl(rnd)];
+            }
+            genome.replace(pos(rnd), unit.size(), unit);
+        }
+    }
+
+    std::vector<std::string> res = { genome };
+    if (params.heterozygosity > 0) {
+        std::bernoulli_distribution snp(params.heterozygosity);
+        for (auto &c : genome) {
+            if (snp(rnd))
+                c = NUCLS[(dignucl(c) + 1 + nucl(rnd) % 3) % 4];
+        }
+        res.push_back(std::move(genome));
+    }
+
+    return res;
+}
+
+static std::string Mutate(std::string s, double error_rate, std::mt19937_64 &rnd) {
+    std::bernoulli_distribution error(error_rate);
+    std::uniform_int_distribution<int> shift(1, 3);
+    for (auto &c : s) {
+        if (error(rnd))
+            c = NUCLS[(dignucl(c) + shift(rnd)) % 4];
+    }
+
+    return s;
+}
+
+std::vector<io::PairedRead> GenerateReads(const std::vector<std::string> &genome,
+                                          const ReadParams &params, uint64_t seed) {
+    std::mt19937_64 rnd(seed);
+    std::normal_distribution<double> insert(double(params.insert_size), double(params.insert_size) / 10);
+    std::vector<io::PairedRead> res;
+
+    for (const auto &chr : genome) {
+        if (chr.size() < 2 * params.insert_size)
+            continue;
+
+        size_t npairs = size_t(params.coverage * double(chr.size()) / double(2 * params.read_length));
+        std::uniform_int_distribution<size_t> start(0, chr.size() - 2 * params.insert_size);
+        std::bernoulli_distribution strand(0.5);
+        res.reserve(res.size() + npairs);
+        for (size_t i = 0; i < npairs; ++i) {
+            size_t is = std::max(params.read_length,
+                                 std::min(size_t(std::max(0.0, insert(rnd))), 2 * params.insert_size));
+            std::string fragment = chr.substr(start(rnd), is);
+            if (strand(rnd))
+                fragment = ReverseComplement(fragment);
+
+            std::string name = "read_" + std::to_string(res.size());
+            io::SingleRead left(name + "/1",
+                                Mutate(fragment.substr(0, params.read_length), params.error_rate, rnd));
+            io::SingleRead right(name + "/2",
+                                 Mutate(ReverseComplement(fragment.substr(is - params.read_length)),
+                                        params.error_rate, rnd));
+            res.emplace_back(left, right, is);
+        }
+    }
+
+    return res;
+}
+
+std::vector<io::SingleRead> SingleReads(const std::vector<io::PairedRead> &reads) {
+    std::vector<io::SingleRead> res;
+    res.reserve(2 * reads.size());
+    for (const auto &r : reads) {
+        res.push_back(r.first());
+        res.push_back(r.second());
+    }
+
+    return res;
+}
+
+io::ReadStreamList<io::SingleRead> MakeStreams(const std::vector<io::SingleRead> &reads, unsigned nstreams) {
+    io::ReadStreamList<io::SingleRead> streams;
+    size_t chunk = (reads.size() + nstreams - 1) / nstreams;
+    for (unsigned i = 0; i < nstreams; ++i) {
+        size_t start = std::min(reads.size(), i * chunk), end = std::min(reads.size(), (i + 1) * chunk);
+        streams.push_back(io::VectorReadStream<io::SingleRead>(
+            std::vector<io::SingleRead>(reads.begin() + start, reads.begin() + end)));
+    }
+
+    return streams;
+}
+
+void WriteFastq(const std::vector<io::PairedRead> &reads, const std::filesystem::path &filename) {
+    std::ofstream os(filename);
+    for (const auto &r : reads) {
+        for (const auto *read : { &r.first(), &r.second() }) {
+            os << '@' << read->name() << '\n'
+               << read->GetSequenceString() << "\n+\n"
+               << std::string(read->size(), 'I') << '\n';
+        }
+    }
+}
+
+}
@@ -0,0 +1,52 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#pragma once
+
+#include "io/reads/paired_read.hpp"
+#include "io/reads/read_stream_vector.hpp"
+#include "io/reads/single_read.hpp"
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct GenomeParams {
+    size_t length = 1000000;
+    // Number and length of repeat copies inserted into the genome
+    size_t repeats = 50;
+    size_t repeat_length = 2000;
+    // Fraction of positions diverged between the two haplotypes
+    double heterozygosity = 0.0;
+};
+
+struct ReadParams {
+    size_t read_length = 150;
+    size_t insert_size = 350;
+    double coverage = 30.0;
+    double error_rate = 0.005;
+};
+
+/// Random genome with interspersed repeats (and optionally a second haplotype)
+std::vector<std::string> GenerateGenome(const GenomeParams &params, uint64_t seed);
+
+/// Paired-end reads sampled uniformly from both strands of the given genome
+std::vector<io::PairedRead> GenerateReads(const std::vector<std::string> &genome,
+                                          const ReadParams &params, uint64_t seed);
+
+/// Flattens paired reads into single reads
+std::vector<io::SingleRead> SingleReads(const std::vector<io::PairedRead> &reads);
+
+/// Splits reads into the given number of in-memory streams
+io::ReadStreamList<io::SingleRead> MakeStreams(const std::vector<io::SingleRead> &reads, unsigned nstreams);
+
+/// Writes paired reads into interlaced FASTQ file
+void WriteFastq(const std::vector<io::PairedRead> &reads, const std::filesystem::path &filename);
+
+}
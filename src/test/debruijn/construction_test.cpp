@@ -13,11 +13,13 @@
 #include "io/reads/read_stream_vector.hpp"
 #include "io/reads/vector_reader.hpp"
 #include "modules/graph_construction.hpp"
+#include "sequence/sequence_tools.hpp"
 #include "pipeline/graph_pack.hpp" // FIXME: get rid of it
 #include "utils/filesystem/temporary.hpp"
 
 #include <gtest/gtest.h>
 
+#include <random>
 #include <set>
 #include <vector>
 
@@ -94,6 +96,106 @@ TEST_F( GraphConstruction, TestKmerFreeIndex ) {
     CheckIndex(reads, tmp_folder(), 5);
 }
 
+// Edges of the graph together with the edges following them
+std::multiset<std::string> ConstructEdges(const std::vector<std::string> &reads, unsigned k,
+                                          config::construction_mode mode, bool keep_perfect_loops,
+                                          const std::filesystem::path &tmpdir, size_t &kpomers) {
+    typedef io::VectorReadStream<io::SingleRead> RawStream;
+    Graph graph(k);
+    auto workdir = fs::tmp::make_temp_dir(tmpdir, "tests");
+    io::ReadStreamList<io::SingleRead> streams(io::RCWrap<io::SingleRead>(RawStream(MakeReads(reads))));
+    config::debruijn_config::construction params;
+    params.con_mode = mode;
+    params.keep_perfect_loops = keep_perfect_loops;
+    kpomers = ConstructGraph(params, workdir, streams, graph).total_kmers();
+
+    std::multiset<std::string> edges;
+    for (EdgeId e : graph.edges()) {
+        std::set<std::string> next;
+        for (EdgeId out : graph.OutgoingEdges(graph.EdgeEnd(e)))
+            next.insert(graph.EdgeNucls(out).str());
+        std::string descr = graph.EdgeNucls(e).str() + ":";
+        for (const auto &s : next)
+            descr += " " + s;
+        edges.insert(descr);
+    }
+    return edges;
+}
+
+void CheckMinimizerConstruction(const std::vector<std::string> &reads, unsigned k,
+                                const std::filesystem::path &tmpdir) {
+    for (bool keep_perfect_loops : { true, false }) {
+        size_t ext_kpomers = 0, minimizer_kpomers = 0;
+        auto ext = ConstructEdges(reads, k, config::construction_mode::extension, keep_perfect_loops,
+                                  tmpdir, ext_kpomers);
+        auto minimizer = ConstructEdges(reads, k, config::construction_mode::minimizer, keep_perfect_loops,
+                                        tmpdir, minimizer_kpomers);
+        EXPECT_EQ(ext, minimizer);
+        EXPECT_EQ(ext_kpomers, minimizer_kpomers);
+    }
+}
+
+TEST_F( GraphConstruction, MinimizerSimple ) {
+    std::vector<std::string> reads = { "CGAAACCAC", "CGAAAACAC", "AACCACACC", "AAACACACC",
+                                       "ACAAACCACCA", "ACAAACAACCA" };
+    CheckMinimizerConstruction(reads, 5, tmp_folder());
+}
+
+TEST_F( GraphConstruction, MinimizerRandom ) {
+    std::mt19937 rnd(239);
+    auto random_seq = [&rnd](size_t len) {
+        std::string s;
+        for (size_t i = 0; i < len; ++i)
+            s += nucl(char(rnd() % 4));
+        return s;
+    };
+
+    // Genome with repeats, a hairpin and a circular chromosome
+    std::string repeat = random_seq(60), unique = random_seq(300);
+    std::string genome = random_seq(500) + repeat + random_seq(400) + repeat + unique +
+                         ReverseComplement(unique) + random_seq(200) + repeat;
+    std::string circle = random_seq(250);
+    std::string circular = circle + circle.substr(0, 100);
+
+    std::vector<std::string> reads;
+    for (const std::string &s : { genome, circular }) {
+        for (size_t pos = 0; pos + 100 <= s.size(); pos += 7)
+            reads.push_back(s.substr(pos, 100));
+    }
+    // Sequencing errors give tips and bulges
+    for (size_t i = 0; i < 20; ++i) {
+        std::string read = reads[rnd() % reads.size()];
+        read[rnd() % read.size()] = nucl(char(rnd() % 4));
+        reads.push_back(read);
+    }
+
+    for (unsigned k : { 5u, 21u, 55u })
+        CheckMinimizerConstruction(reads, k, tmp_folder());
+}
+
+TEST_F( GraphConstruction, MinimizerLoops ) {
+    std::mt19937 rnd(42);
+    auto random_seq = [&rnd](size_t len) {
+        std::string s;
+        for (size_t i = 0; i < len; ++i)
+            s += nucl(char(rnd() % 4));
+        return s;
+    };
+
+    // Perfect loop and the one which is reverse complement to itself
+    std::string circle = random_seq(300), half = random_seq(200);
+    std::string rc_circle = half + ReverseComplement(half);
+    std::vector<std::string> reads;
+    for (const std::string &s : { circle, rc_circle }) {
+        std::string wrapped = s + s.substr(0, 100);
+        for (size_t pos = 0; pos + 100 <= wrapped.size(); pos += 5)
+            reads.push_back(wrapped.substr(pos, 100));
+    }
+
+    for (unsigned k : { 21u, 55u })
+        CheckMinimizerConstruction(reads, k, tmp_folder());
+}
+
 TEST_F( GraphConstruction, SimpleTestEarlyPairedInfo ) {
     std::vector<MyPairedRead> paired_reads = {{"CCCAC", "CCACG"}, {"ACCAC", "CCACA"}};
     std::vector<MyEdge> edges = {"CCCA", "ACCA", "CCAC", "CACG", "CACA"};
@@ -0,0 +1,88 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "tmp_folder_fixture.hpp"
+
+#include "assembly_graph/core/graph.hpp"
+#include "assembly_graph/paths/bidirectional_path_container.hpp"
+#include "hmm/hmmfile.hpp"
+#include "pipeline/graph_pack.hpp"
+#include "projects/spades/domain_matcher.hpp"
+
+#include <cctype>
+#include <map>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+    #include "hmmer.h"
+}
+
+using namespace debruijn_graph;
+
+class DomainMatcher : public ::testing::Test, public TmpFolderFixture {};
+
+static const char *TE_HMM = "./src/projects/spades/biosynthetic_spades_hmms/TE.hmm.gz";
+
+// Consensus sequence of the first profile of the file
+static std::string ReadConsensus(const std::string &filename) {
+    auto hmmfile = hmmer::open_file(filename);
+    EXPECT_FALSE(hmmfile.getError());
+    auto hmm = hmmfile->read();
+    EXPECT_FALSE(hmm.getError());
+    const P7_HMM *p7hmm = hmm->get();
+    EXPECT_TRUE(p7hmm->flags & p7H_CONS);
+    std::string res;
+    for (int i = 1; i <= p7hmm->M; ++i)
+        res += char(std::toupper(p7hmm->consensus[i]));
+    return res;
+}
+
+static std::string BackTranslate(const std::string &protein) {
+    static const std::map<char, std::string> codons = {
+        {'A', "GCT"}, {'R', "CGT"}, {'N', "AAC"}, {'D', "GAC"}, {'C', "TGC"},
+        {'Q', "CAG"}, {'E', "GAA"}, {'G', "GGT"}, {'H', "CAC"}, {'I', "ATC"},
+        {'L', "CTG"}, {'K', "AAA"}, {'M', "ATG"}, {'F', "TTC"}, {'P', "CCG"},
+        {'S', "TCT"}, {'T', "ACC"}, {'W', "TGG"}, {'Y', "TAC"}, {'V', "GTT"}};
+    std::string res;
+    for (char aa : protein) {
+        auto it = codons.find(aa);
+        res += it == codons.end() ? "GCT" : it->second;
+    }
+    return res;
+}
+
+// Pins the matches of the thioesterase domain embedded into a single edge
+TEST_F(DomainMatcher, SingleDomain) {
+    const size_t k = 55, flank = 300;
+    std::mt19937 rnd(42);
+    std::string flank_left, flank_right;
+    for (size_t i = 0; i < flank; ++i) {
+        flank_left += nucl(char(rnd() % 4));
+        flank_right += nucl(char(rnd() % 4));
+    }
+    std::string domain = BackTranslate(ReadConsensus(TE_HMM));
+    ASSERT_EQ(3 * 231u, domain.size());
+
+    graph_pack::GraphPack gp(k, tmp_folder(), 0);
+    auto &g = gp.get_mutable<Graph>();
+    EdgeId e = g.AddEdge(g.AddVertex(), g.AddVertex(), Sequence(flank_left + domain + flank_right));
+    auto &paths = gp.get_mutable<path_extend::PathContainer>("exSPAnder paths");
+    paths.Create(g, e);
+
+    nrps::ContigAlnInfo res = nrps::DomainMatcher().MatchDomains(gp, TE_HMM, tmp_folder());
+    ASSERT_EQ(1u, res.size());
+    // Hit is named by the id of the scaffold path and the frame
+    EXPECT_EQ("_0", res[0].name.substr(res[0].name.size() - 2));
+    EXPECT_EQ("TE", res[0].type);
+    // HMMER positions are 1-based, so the start is shifted by a codon
+    EXPECT_EQ(flank + 3, res[0].posl);
+    EXPECT_EQ(flank + domain.size(), res[0].posr);
+    EXPECT_EQ(domain.substr(3), res[0].seq);
+    EXPECT_TRUE(exists(tmp_folder() / "restricted_edges.fasta"));
+}
@@ -6,16 +6,21 @@
 //***************************************************************************
 
 #include "graphio.hpp"
+#include "random_graph.hpp"
 
 #include "alignment/pacbio/g_aligner.hpp"
+#include "alignment/pacbio/graph_bit_aligner.hpp"
+#include "alignment/pacbio/vertex_distance_oracle.hpp"
 #include "assembly_graph/core/graph.hpp"
 #include "configs/config_struct.hpp"
 #include "edlib/edlib.h"
 #include "io/reads/io_helper.hpp"
+#include "sequence/sequence_tools.hpp"
 #include "utils/logger/log_writers.hpp"
 #include "utils/stl_utils.hpp"
 
 #include <gtest/gtest.h>
+#include <random>
 
 using namespace debruijn_graph;
 
@@ -165,6 +170,11 @@ TEST(GraphAligner, DijkstraOneEdgeTest ) {
     gap_filler.CloseGap();
     int score = gap_filler.edit_distance();
     EXPECT_EQ(ideal_score, score);
+
+    sensitive_aligner::BitParallelGraphAligner bit_aligner(g, gap_cfg, s, eid, 0, path_maxlen);
+    bit_aligner.CloseGap(eid, (int) s.size(), vertex_pathlen);
+    EXPECT_EQ(ideal_score, bit_aligner.edit_distance());
+    EXPECT_EQ(std::vector<EdgeId>{ eid }, bit_aligner.path());
 }
 
 
@@ -194,4 +204,264 @@ TEST(GraphAligner, DijkstraGrowEndsTest ) {
     ends_filler.CloseGap();
     int score = ends_filler.edit_distance();
     EXPECT_EQ(ideal_score, score);
+
+    sensitive_aligner::BitParallelGraphAligner bit_aligner(g, gap_cfg, s, eid, 0, path_maxlen);
+    bit_aligner.RestoreEnd();
+    EXPECT_EQ(ideal_score, bit_aligner.edit_distance());
+    EXPECT_EQ(ends_filler.path(), bit_aligner.path());
+    EXPECT_EQ(ends_filler.path_end_position(), bit_aligner.path_end_position());
+}
+
+namespace {
+int GlobalEditDistance(const std::string &a, const std::string &b) {
+    edlib::EdlibAlignResult result = edlib::edlibAlign(a.data(), (int) a.size(), b.data(), (int) b.size(),
+                                                       edlib::edlibDefaultAlignConfig());
+    int distance = result.editDistance;
+    edlib::edlibFreeAlignResult(result);
+    return distance;
+}
+
+// Sequence spelled by the path from start_p on its first edge up to end_p on the last one
+std::string SpellPath(const Graph &g, const std::vector<EdgeId> &path, size_t start_p, size_t end_p) {
+    std::string res;
+    for (size_t i = 0; i < path.size(); ++i) {
+        std::string nucls = g.EdgeNucls(path[i]).str();
+        size_t begin = i == 0 ? start_p : 0;
+        size_t end = i + 1 == path.size() ? end_p : g.length(path[i]);
+        res += nucls.substr(begin, end - begin);
+    }
+    return res;
+}
+
+bool IsConnectedPath(const Graph &g, const std::vector<EdgeId> &path) {
+    for (size_t i = 1; i < path.size(); ++i) {
+        if (g.EdgeEnd(path[i - 1]) != g.EdgeStart(path[i]))
+            return false;
+    }
+    return !path.empty();
+}
+
+// Random walk over the graph spelling at least min_length nucleotides with the errors introduced
+struct RandomWalk {
+    EdgeId start_e, end_e;
+    size_t start_p, end_p;
+    std::vector<EdgeId> path;
+    std::string seq;
+};
+
+bool GenerateWalk(const Graph &g, const std::vector<EdgeId> &edges, size_t min_length,
+                  std::mt19937 &rand, RandomWalk &walk) {
+    walk.path = { edges[rand() % edges.size()] };
+    walk.start_e = walk.path.front();
+    size_t len = g.length(walk.start_e);
+    // Start close to the edge end, so the walk goes through several edges
+    walk.start_p = len - 1 - rand() % std::min<size_t>(len, 100);
+
+    size_t spelled = len - walk.start_p;
+    while (spelled < min_length) {
+        VertexId v = g.EdgeEnd(walk.path.back());
+        size_t out_count = g.OutgoingEdgeCount(v);
+        if (out_count == 0)
+            return false;
+        EdgeId next = *std::next(g.OutgoingEdges(v).begin(), rand() % out_count);
+        walk.path.push_back(next);
+        spelled += g.length(next);
+        if (walk.path.size() > 50)
+            return false;
+    }
+    walk.end_e = walk.path.back();
+    walk.end_p = g.length(walk.end_e) - (spelled - min_length);
+
+    std::string seq = SpellPath(g, walk.path, walk.start_p, walk.end_p);
+    for (size_t mut = seq.size() / 20; mut > 0; --mut) {
+        size_t pos = rand() % seq.size();
+        switch (rand() % 3) {
+            case 0: seq.insert(seq.begin() + pos, nucl(char(rand() % 4))); break;
+            case 1: seq.erase(pos, 1); break;
+            default: seq[pos] = nucl(char(rand() % 4));
+        }
+    }
+    walk.seq = seq;
+    return true;
+}
+}
+
+// Compares the bit-parallel aligner with the Dijkstra on random multi-edge gaps and ends
+TEST(GraphAligner, BitParallelRandomPaths) {
+    Graph g(55);
+    graphio::ScanBasicGraph("./src/test/debruijn/graph_fragments/ecoli_400k/distance_estimation", g);
+    std::vector<EdgeId> edges;
+    for (EdgeId e : g.edges())
+        edges.push_back(e);
+
+    sensitive_aligner::GapClosingConfig gap_cfg;
+    gap_cfg.find_shortest_path = true;
+    gap_cfg.updates_limit = 10000000;
+    gap_cfg.penalty_ratio = 200;
+    gap_cfg.queue_limit = 1000000;
+    gap_cfg.iteration_limit = 1000000;
+
+    sensitive_aligner::EndsClosingConfig ends_cfg;
+    ends_cfg.find_shortest_path = true;
+    ends_cfg.updates_limit = 10000000;
+    ends_cfg.penalty_ratio = 0.1;
+    ends_cfg.queue_limit = 1000000;
+    ends_cfg.iteration_limit = 1000000;
+
+    std::mt19937 rand(239);
+    size_t gaps = 0, ends = 0, multi_edge = 0;
+    while (gaps < 20 || ends < 10) {
+        bool gap_mode = gaps < 20;
+        RandomWalk walk;
+        // Longer than a single word of the bit-parallel column
+        if (!GenerateWalk(g, edges, 65 + rand() % (gap_mode ? 1000 : 400), rand, walk))
+            continue;
+        const std::string &s = walk.seq;
+        int path_max_length = (int) s.size();
+
+        if (gap_mode) {
+            // Reachable vertices with the distances to the gap end, as GapFiller does
+            auto backward = omnigraph::DijkstraHelper<Graph>::CreateBackwardBoundedDijkstra(g, path_max_length);
+            backward.Run(g.EdgeStart(walk.end_e));
+            auto forward = omnigraph::DijkstraHelper<Graph>::CreateBoundedDijkstra(g, path_max_length);
+            forward.Run(g.EdgeEnd(walk.start_e));
+            std::unordered_map<VertexId, size_t> reachable;
+            for (auto entry : backward.reached()) {
+                if (forward.ReachedVertex(entry.first))
+                    reachable.emplace(entry.first, entry.second);
+            }
+            if (walk.path.size() > 1)
+                ASSERT_FALSE(reachable.empty());
+
+            sensitive_aligner::DijkstraGapFiller dijkstra(g, gap_cfg, s, walk.start_e, walk.end_e,
+                                                          (int) walk.start_p, (int) walk.end_p,
+                                                          path_max_length, reachable);
+            dijkstra.CloseGap();
+            sensitive_aligner::BitParallelGraphAligner bit_aligner(g, gap_cfg, s, walk.start_e,
+                                                                   (int) walk.start_p, path_max_length);
+            bit_aligner.CloseGap(walk.end_e, (int) walk.end_p, reachable);
+
+            ASSERT_NE(std::numeric_limits<int>::max(), dijkstra.edit_distance()) << s;
+            EXPECT_EQ(dijkstra.edit_distance(), bit_aligner.edit_distance()) << s;
+            for (const auto &path : { dijkstra.path(), bit_aligner.path() }) {
+                ASSERT_TRUE(IsConnectedPath(g, path)) << s;
+                EXPECT_EQ(walk.start_e, path.front());
+                EXPECT_EQ(walk.end_e, path.back());
+                EXPECT_EQ(bit_aligner.edit_distance(),
+                          GlobalEditDistance(SpellPath(g, path, walk.start_p, walk.end_p), s)) << s;
+            }
+            multi_edge += bit_aligner.path().size() > 1;
+            gaps += 1;
+        } else {
+            sensitive_aligner::DijkstraEndsReconstructor dijkstra(g, ends_cfg, s, walk.start_e,
+                                                                  (int) walk.start_p, path_max_length);
+            dijkstra.CloseGap();
+            sensitive_aligner::BitParallelGraphAligner bit_aligner(g, ends_cfg, s, walk.start_e,
+                                                                   (int) walk.start_p, path_max_length);
+            bit_aligner.RestoreEnd();
+
+            ASSERT_NE(std::numeric_limits<int>::max(), dijkstra.edit_distance()) << s;
+            EXPECT_EQ(dijkstra.edit_distance(), bit_aligner.edit_distance()) << s;
+            std::vector<std::pair<std::vector<EdgeId>, int>> results = {
+                { dijkstra.path(), dijkstra.path_end_position() },
+                { bit_aligner.path(), bit_aligner.path_end_position() } };
+            for (const auto &[path, end_p] : results) {
+                ASSERT_TRUE(IsConnectedPath(g, path)) << s;
+                EXPECT_EQ(walk.start_e, path.front());
+                EXPECT_EQ(bit_aligner.edit_distance(),
+                          GlobalEditDistance(SpellPath(g, path, walk.start_p, end_p), s)) << s;
+            }
+            multi_edge += bit_aligner.path().size() > 1;
+            ends += 1;
+        }
+    }
+    // Paths crossing the vertices exercise the column merging and the restoration across the edges
+    EXPECT_GT(multi_edge, 15u);
+}
+
+namespace {
+// Plain DP with transpositions of adjacent characters beyond the first two ones
+size_t NaiveEditDistance(const std::string &s, const std::string &t) {
+    std::vector<std::vector<size_t>> d(s.size() + 1, std::vector<size_t>(t.size() + 1));
+    for (size_t i = 0; i <= s.size(); ++i)
+        d[i][0] = i;
+    for (size_t j = 0; j <= t.size(); ++j)
+        d[0][j] = j;
+    for (size_t i = 1; i <= s.size(); ++i) {
+        for (size_t j = 1; j <= t.size(); ++j) {
+            d[i][j] = std::min({ d[i - 1][j] + 1, d[i][j - 1] + 1,
+                                 d[i - 1][j - 1] + (s[i - 1] != t[j - 1]) });
+            if (i > 2 && j > 2 && s[i - 2] == t[j - 1] && s[i - 1] == t[j - 2])
+                d[i][j] = std::min(d[i][j], d[i - 2][j - 2] + 1);
+        }
+    }
+    return d[s.size()][t.size()];
+}
+}
+
+TEST(GraphAligner, BitParallelEditDistance) {
+    EXPECT_EQ(edit_distance("", ""), 0);
+    EXPECT_EQ(edit_distance("ACGT", ""), 4);
+    EXPECT_EQ(edit_distance("", "ACG"), 3);
+    EXPECT_EQ(edit_distance("AC", "CA"), 2);
+    EXPECT_EQ(edit_distance("AAAC", "AACA"), 1);
+    EXPECT_EQ(EditDistance(Sequence("ACGTACGT"), Sequence("ACGACGTT")), 2);
+
+    std::mt19937 rand(42);
+    for (size_t it = 0; it < 2000; ++it) {
+        // Cover both single and multi-word patterns
+        size_t len = rand() % (it % 2 ? 40 : 300);
+        std::string s(len, 'A');
+        for (char &c : s)
+            c = nucl(char(rand() % 4));
+        std::string t = s;
+        for (size_t mut = rand() % (len / 4 + 2); mut > 0; --mut) {
+            size_t pos = rand() % (t.size() + 1);
+            switch (rand() % 4) {
+                case 0: t.insert(t.begin() + pos, nucl(char(rand() % 4))); break;
+                case 1: if (pos < t.size()) t.erase(pos, 1); break;
+                case 2: if (pos < t.size()) t[pos] = nucl(char(rand() % 4)); break;
+                default: if (pos + 1 < t.size()) std::swap(t[pos], t[pos + 1]);
+            }
+        }
+
+        size_t dist = NaiveEditDistance(s, t);
+        ASSERT_EQ(dist, edit_distance(s, t)) << s << " " << t;
+        size_t max_dist = rand() % (dist + 3);
+        ASSERT_EQ(std::min(dist, max_dist + 1), edit_distance(s, t, max_dist)) << s << " " << t;
+    }
+}
+
+TEST(GraphAligner, VertexDistanceOracle) {
+    using namespace debruijn_graph;
+    Graph g(55);
+    RandomGraph<Graph>(g, /*max_size*/100).Generate(/*iterations*/1000);
+    std::vector<VertexId> vertices(g.begin(), g.end());
+
+    const size_t max_length = 500, max_vertices = 50;
+    sensitive_aligner::VertexDistanceOracle oracle(g, max_length, max_vertices);
+    std::vector<size_t> distances(vertices.size() * vertices.size());
+    #pragma omp parallel for
+    for (size_t i = 0; i < distances.size(); ++i)
+        distances[i] = oracle.GetDistance(vertices[i / vertices.size()], vertices[i % vertices.size()]);
+
+    size_t reached = 0;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        auto dijkstra = omnigraph::DijkstraHelper<Graph>::CreateBoundedDijkstra(g, max_length, max_vertices);
+        dijkstra.Run(vertices[i]);
+        for (size_t j = 0; j < vertices.size(); ++j) {
+            size_t expected = dijkstra.DistanceCounted(vertices[j]) ? dijkstra.GetDistance(vertices[j]) : size_t(-1);
+            ASSERT_EQ(expected, distances[i * vertices.size() + j]);
+            ASSERT_EQ(expected, oracle.GetDistance(vertices[i], vertices[j]));
+            reached += (expected != size_t(-1));
+        }
+    }
+    EXPECT_GT(reached, vertices.size());
+
+    // The cache is dropped once it holds more than a couple of rows, distances are the same
+    sensitive_aligner::VertexDistanceOracle bounded(g, max_length, max_vertices, /*max_cached*/ 2 * max_vertices);
+    #pragma omp parallel for
+    for (size_t i = 0; i < distances.size(); ++i)
+        EXPECT_EQ(distances[i], bounded.GetDistance(vertices[i / vertices.size()], vertices[i % vertices.size()]));
+    EXPECT_LE(bounded.cached(), 2 * max_vertices);
 }
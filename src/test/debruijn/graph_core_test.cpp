@@ -5,8 +5,12 @@
 //* See file LICENSE for details.
 //***************************************************************************
 
+#include "assembly_graph/components/graph_analytics.hpp"
 #include "assembly_graph/core/graph.hpp"
+#include "assembly_graph/core/graph_maps.hpp"
+#include "assembly_graph/handlers/edges_position_handler.hpp"
 
+#include <atomic>
 #include <vector>
 #include <set>
 #include <string>
@@ -107,3 +111,179 @@ TEST( GraphCore, SelfRCEdgeMerge ) {
     EXPECT_EQ(1u, g.OutgoingEdgeCount(v1));
     EXPECT_EQ(Sequence("AACGCTATTCACGTGAATAGCGTT"), g.EdgeNucls(g.GetUniqueOutgoingEdge(v1)));
 }
+
+class MergeRecorder : public omnigraph::GraphActionHandler<Graph> {
+public:
+    MergeRecorder(const Graph &g, bool deferrable)
+            : omnigraph::GraphActionHandler<Graph>(g, "MergeRecorder"), deferrable_(deferrable) {}
+
+    bool IsDeferrable() const override { return deferrable_; }
+
+    void HandleMerge(const std::vector<EdgeId> &old_edges, EdgeId new_edge) override {
+        std::string event = "merge";
+        for (EdgeId e : old_edges)
+            event += " " + std::to_string(this->length(e));
+        event += " -> " + std::to_string(this->length(new_edge));
+        events.push_back(event);
+    }
+
+    void HandleDelete(EdgeId e) override {
+        events.push_back("delete " + std::to_string(this->length(e)) +
+                         (this->conjugate(e) == e ? " self" : ""));
+    }
+
+    std::vector<std::string> events;
+
+private:
+    bool deferrable_;
+};
+
+TEST( GraphCore, BatchedEvents ) {
+    Graph g(11);
+    auto data = createGraph(g, 3);
+    MergeRecorder immediate(g, false), deferred(g, true);
+    {
+        omnigraph::GraphEventBatch<Graph> batch(g);
+        g.DeleteEdge(data.second[2]);
+        EdgeId merged = g.MergePath({ data.second[0], data.second[1] });
+        // Merged edge is removed before the handlers see the merge event
+        g.DeleteEdge(merged);
+        EXPECT_FALSE(immediate.events.empty());
+        EXPECT_TRUE(deferred.events.empty());
+    }
+    EXPECT_EQ(immediate.events, deferred.events);
+}
+
+TEST( GraphCore, EdgePositions ) {
+    Graph g(11);
+    auto data = createGraph(g, 3);
+    const auto &e = data.second;
+    omnigraph::EdgesPositionHandler<Graph> edge_pos(g, 0);
+    edge_pos.AddEdgePosition(e[0], "ref", 0, 3, 0, 3);
+    // Continues the previous range
+    edge_pos.AddEdgePosition(e[0], "ref", 3, 6, 3, 6);
+    edge_pos.AddEdgePosition(e[1], "ref", 6, 12, 0, 6);
+    edge_pos.AddEdgePosition(e[2], "ref", 12, 18, 0, 6);
+    edge_pos.AddEdgePosition(e[2], "alt", 100, 106, 0, 6);
+    EXPECT_EQ(1u, edge_pos.GetEdgePositions(e[0], "ref").size());
+    EXPECT_TRUE(edge_pos.GetEdgePositions(e[0], "alt").empty());
+
+    EdgeId merged = g.MergePath({ e[0], e[1], e[2] });
+    auto positions = edge_pos.GetEdgePositions(merged);
+    ASSERT_EQ(2u, positions.size());
+    EXPECT_EQ("alt", positions[0].contigId);
+    EXPECT_EQ(Range(100, 106), positions[0].mr.initial_range);
+    EXPECT_EQ(Range(12, 18), positions[0].mr.mapped_range);
+    EXPECT_EQ("ref", positions[1].contigId);
+    EXPECT_EQ(Range(0, 18), positions[1].mr.initial_range);
+    EXPECT_EQ(Range(0, 18), positions[1].mr.mapped_range);
+
+    auto split = g.SplitEdge(merged, 4);
+    auto left = edge_pos.GetUniqueEdgePosition(split.first, "ref");
+    EXPECT_EQ(Range(0, 4), left.initial_range);
+    EXPECT_EQ(Range(0, 4), left.mapped_range);
+    EXPECT_TRUE(edge_pos.GetEdgePositions(split.first, "alt").empty());
+    auto right = edge_pos.GetUniqueEdgePosition(split.second, "ref");
+    EXPECT_EQ(Range(4, 18), right.initial_range);
+    EXPECT_EQ(Range(0, 14), right.mapped_range);
+    EXPECT_EQ(Range(8, 14), edge_pos.GetUniqueEdgePosition(split.second, "alt").mapped_range);
+}
+
+TEST( GraphCoreDeathTest, EdgePositionsWithinBatch ) {
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    Graph g(11);
+    auto data = createGraph(g, 3);
+    const auto &e = data.second;
+    omnigraph::EdgesPositionHandler<Graph> edge_pos(g, 0);
+    edge_pos.AddEdgePosition(e[0], "ref", 0, 6, 0, 6);
+    edge_pos.AddEdgePosition(e[1], "ref", 6, 12, 0, 6);
+
+    omnigraph::GraphEventBatch<Graph> batch(g);
+    EdgeId merged = g.MergePath({ e[0], e[1] });
+    // Merge is not replayed to the deferred handler yet. The error itself goes to the console logger
+    EXPECT_DEATH(edge_pos.GetEdgePositions(merged), "");
+    EXPECT_DEATH(edge_pos.GetEdgePositions(merged, "ref"), "");
+}
+
+TEST( GraphCore, ConnectedComponents ) {
+    Graph g(11);
+    auto data = createGraph(g, 3);
+    const auto &v = data.first;
+    VertexId tail = g.AddVertex();
+    EdgeId long_edge = g.AddEdge(v[3], tail, Sequence(std::string(111, 'C')));
+    VertexId isolated = g.AddVertex();
+
+    omnigraph::ConnectedComponents<Graph> components(g);
+    components.Calculate();
+    EXPECT_EQ(4u, components.size());
+    EXPECT_NE(components.component(v[0]), components.component(g.conjugate(v[0])));
+    EXPECT_EQ(components.component(v[0]), components.component(long_edge));
+    EXPECT_EQ(3 * 6 + 100u, components.length(components.component(tail)));
+
+    components.Calculate(/*join_conjugate*/ true);
+    EXPECT_EQ(2u, components.size());
+    size_t c = components.component(tail);
+    EXPECT_EQ(c, components.component(g.conjugate(data.second[0])));
+    EXPECT_EQ(10, std::distance(components.vertices(c).begin(), components.vertices(c).end()));
+    EXPECT_EQ(8, std::distance(components.edges(c).begin(), components.edges(c).end()));
+    EXPECT_EQ(2 * (3 * 6 + 100u), components.length(c));
+    EXPECT_EQ(0u, components.length(components.component(isolated)));
+
+    components.Calculate(/*join_conjugate*/ true, [&](EdgeId e) { return g.length(e) <= 50; });
+    EXPECT_EQ(3u, components.size());
+    EXPECT_NE(components.component(v[3]), components.component(tail));
+    EXPECT_EQ(omnigraph::ConnectedComponents<Graph>::kNoComponent, components.component(long_edge));
+
+    omnigraph::NeighbourhoodExtractor<Graph> extractor(g, 50);
+    EXPECT_EQ((std::vector<VertexId>{ v[0], v[1], v[2] }), extractor.Extract(v[0], 2));
+    EXPECT_EQ(4u, extractor.Extract(v[3], 5).size());
+    EXPECT_EQ(2u, extractor.Extract(v[0], 1).size());
+
+    auto neighbourhoods = omnigraph::ExtractNeighbourhoods(g, std::vector<VertexId>{ v[1], tail, isolated }, 1, 50);
+    ASSERT_EQ(3u, neighbourhoods.size());
+    EXPECT_EQ(3u, neighbourhoods[0].size());
+    EXPECT_EQ(1u, neighbourhoods[1].size());
+    EXPECT_EQ(1u, neighbourhoods[2].size());
+}
+
+TEST( GraphCore, EdgeMaps ) {
+    Graph g(11);
+    auto data = createGraph(g, 3);
+    const auto &e = data.second;
+
+    omnigraph::EdgeMap<Graph, size_t> lengths(g);
+    omnigraph::SmartEdgeMap<Graph, size_t> smart_lengths(g);
+    for (EdgeId edge : g.edges()) {
+        lengths[edge] = g.length(edge);
+        smart_lengths[edge] = g.length(edge);
+    }
+    EXPECT_TRUE(lengths.count(e[1]));
+    EXPECT_EQ(6u, lengths[e[1]]);
+    EXPECT_EQ(1u, lengths.erase(e[1]));
+    EXPECT_EQ(0u, lengths.erase(e[1]));
+    EXPECT_FALSE(lengths.count(e[1]));
+    EXPECT_EQ(5, std::distance(lengths.begin(), lengths.end()));
+
+    VertexId tail = g.AddVertex();
+    EdgeId long_edge = g.AddEdge(data.first[3], tail, Sequence(std::string(111, 'C')));
+    EXPECT_FALSE(lengths.count(long_edge));
+    lengths.emplace(long_edge, g.length(long_edge));
+    EXPECT_EQ(100u, lengths.at(long_edge));
+
+    std::atomic<size_t> total{0};
+    lengths.parallel_for_each([&](EdgeId edge, size_t len) {
+        EXPECT_EQ(g.length(edge), len);
+        total += len;
+    });
+    EXPECT_EQ(5 * 6 + 100u, total);
+
+    g.DeleteEdge(e[0]);
+    EXPECT_FALSE(smart_lengths.count(e[0]));
+    EXPECT_FALSE(smart_lengths.count(g.conjugate(e[0])));
+    EXPECT_TRUE(smart_lengths.count(e[2]));
+
+    omnigraph::VertexMap<Graph, EdgeId> outgoing(g);
+    outgoing[tail] = long_edge;
+    EXPECT_TRUE(outgoing.count(tail));
+    EXPECT_FALSE(outgoing.count(data.first[0]));
+}
@@ -8,15 +8,32 @@
 #include "graphio.hpp"
 #include "test_utils.hpp"
 #include "random_graph.hpp"
+#include "tmp_folder_fixture.hpp"
 #include "assembly_graph/handlers/id_track_handler.hpp"
 #include "io/binary/graph.hpp"
+#include "io/binary/graph_pack.hpp"
 #include "io/binary/kmer_mapper.hpp"
+#include "io/binary/long_reads.hpp"
 #include "io/binary/paired_index.hpp"
 #include "io/graph/gfa_reader.hpp"
 #include "io/graph/gfa_writer.hpp"
+#include "io/reads/batch_pipeline.hpp"
+#include "io/reads/osequencestream.hpp"
+#include "io/sam/bam_parser.hpp"
+#include "io/utils/ordered_writer.hpp"
+#include "paired_info/frozen_paired_index.hpp"
+#include "pipeline/graph_pack_helpers.h"
 
+#include "bamtools/api/BamAlignment.h"
+#include "bamtools/api/BamWriter.h"
+
+#include <atomic>
 #include <filesystem>
 #include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+
+#include <zlib.h>
 
 using namespace debruijn_graph;
 
@@ -144,6 +161,126 @@ TEST(Io, KmerMapper) {
     CompareContainers(kmer_mapper, new_mapper);
 }
 
+TEST(Io, LongReads) {
+    const auto &graph = CommonGraph();
+    std::vector<EdgeId> edges;
+    for (EdgeId e : graph.edges())
+        edges.push_back(e);
+    edges.resize(std::min<size_t>(edges.size(), 10));
+
+    // Few edges and short paths, so lots of paths are repeated
+    std::mt19937 rnd(42);
+    std::vector<std::vector<EdgeId>> paths(5000);
+    for (auto &path : paths) {
+        path.resize(1 + rnd() % 3);
+        for (EdgeId &e : path)
+            e = edges[rnd() % edges.size()];
+    }
+
+    std::map<std::vector<EdgeId>, size_t> expected;
+    for (const auto &path : paths) {
+        expected[path] += 1;
+        std::vector<EdgeId> rc_path;
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+            rc_path.push_back(graph.conjugate(*it));
+        expected[rc_path] += 1;
+    }
+
+    LongReadContainer<Graph> long_reads(graph, 1);
+    #pragma omp parallel for
+    for (size_t i = 0; i < paths.size(); ++i)
+        long_reads[0].AddPath(paths[i], 1, true);
+
+    auto CheckPaths = [&](const PathStorage<Graph> &storage) {
+        std::vector<PathInfo<Graph>> stored;
+        storage.SaveAllPaths(stored);
+        ASSERT_EQ(expected.size(), storage.size());
+        ASSERT_EQ(expected.size(), stored.size());
+        auto it = expected.begin();
+        for (const auto &path : stored) {
+            EXPECT_EQ(it->first, path.path());
+            EXPECT_EQ(it->second, path.weight());
+            ++it;
+        }
+    };
+    CheckPaths(long_reads[0]);
+
+    Save(file_name, long_reads);
+    LongReadContainer<Graph> new_long_reads(graph, 1);
+    Load(file_name, new_long_reads);
+    CheckPaths(new_long_reads[0]);
+}
+
+TEST(Io, PackSnapshot) {
+    using namespace omnigraph::de;
+    using Index = UnclusteredPairedInfoIndexT<Graph>;
+
+    graph_pack::GraphPack gp(55, "tmp", 1);
+    auto &graph = gp.get_mutable<Graph>();
+    RandomGraph<Graph>(graph, /*max_size*/100).Generate(/*iterations*/1000);
+    auto &pi = gp.get_mutable<UnclusteredPairedInfoIndicesT<Graph>>()[0];
+    RandomPairedIndex<Index>(pi, 100).Generate(100);
+
+    PackSnapshot::Take(gp).Save(file_name);
+    ASSERT_TRUE(PackSnapshot::Exists(file_name));
+
+    graph_pack::GraphPack new_gp(55, "tmp", 1);
+    FullPackIO().Load(file_name, new_gp);
+    std::filesystem::remove(std::string(file_name) + PackSnapshot::ext);
+
+    const auto &new_graph = new_gp.get<Graph>();
+    CompareGraphIterators(graph.SmartVertexBegin(), new_graph.SmartVertexBegin());
+    CompareGraphIterators(graph.SmartEdgeBegin(), new_graph.SmartEdgeBegin());
+    for (EdgeId e : graph.edges())
+        EXPECT_EQ(graph.EdgeNucls(e), new_graph.EdgeNucls(e));
+    EXPECT_EQ(pi.size(), new_gp.get<UnclusteredPairedInfoIndicesT<Graph>>()[0].size());
+}
+
+TEST(Io, FrozenClusteredIndices) {
+    using namespace omnigraph::de;
+    typedef std::vector<std::tuple<uint64_t, uint64_t, DEDistance, DEWeight, DEVariance>> Points;
+
+    TmpFolderFixture fixture("tmp_frozen");
+    graph_pack::GraphPack gp(55, fixture.tmp_folder(), 2);
+    auto &graph = gp.get_mutable<Graph>();
+    RandomGraph<Graph>(graph, /*max_size*/100).Generate(/*iterations*/1000);
+    std::vector<EdgeId> edges;
+    for (EdgeId e : graph.edges())
+        edges.push_back(e);
+    auto &clustered = gp.get_mutable<PairedInfoIndicesT<Graph>>("clustered_indices");
+    for (auto &index : clustered) {
+        for (size_t i = 0; i < 200; ++i)
+            index.Add(edges[rand() % edges.size()], edges[rand() % edges.size()],
+                      Point(DEDistance(rand() % 100), DEWeight(1 + rand() % 10), DEVariance(rand() % 5)));
+    }
+
+    auto GetPoints = [&](const auto &index) {
+        Points res;
+        for (EdgeId e1 : edges)
+            for (auto entry : index.Get(e1))
+                for (auto p : entry.second)
+                    res.emplace_back(e1.int_id(), entry.first.int_id(), p.d, p.weight, p.var);
+        return res;
+    };
+    std::vector<Points> expected;
+    for (const auto &index : clustered)
+        expected.push_back(GetPoints(index));
+
+    graph_pack::FreezeClusteredIndices(gp);
+    const auto &frozen = gp.get<FrozenPairedInfoIndicesT<Graph>>("clustered_indices");
+    ASSERT_EQ(2u, frozen.size());
+    for (size_t i = 0; i < frozen.size(); ++i)
+        EXPECT_EQ(expected[i], GetPoints(frozen[i]));
+
+    graph_pack::ThawClusteredIndices(gp);
+    const auto &thawed = gp.get<PairedInfoIndicesT<Graph>>("clustered_indices");
+    ASSERT_EQ(2u, thawed.size());
+    for (size_t i = 0; i < thawed.size(); ++i)
+        EXPECT_EQ(expected[i], GetPoints(thawed[i]));
+    // Temporary files are removed
+    EXPECT_TRUE(std::filesystem::is_empty(fixture.tmp_folder()));
+}
+
 TEST(Io, GFADBG) {
     std::filesystem::path gfa_out_base("src/test/debruijn/graph_fragments/gfa_saves");
 
@@ -152,3 +289,149 @@ TEST(Io, GFADBG) {
     //fixme support 0-in-2-out DBG vertices in GFAWriter
 //    CheckGFAInOut("src/test/debruijn/graph_fragments/topology_ec/big_bad", "big_bad", gfa_out_base);
 }
+
+namespace {
+struct VectorReadStream {
+    typedef size_t ReadT;
+
+    explicit VectorReadStream(size_t size) : size_(size) {}
+
+    bool eof() const { return pos_ == size_; }
+    VectorReadStream &operator>>(size_t &read) {
+        read = pos_++;
+        return *this;
+    }
+
+    size_t size_, pos_ = 0;
+};
+
+struct VectorWriteStream {
+    VectorWriteStream &operator<<(size_t read) {
+        reads.push_back(read);
+        return *this;
+    }
+
+    std::vector<size_t> reads;
+};
+}
+
+TEST(Io, BatchPipeline) {
+    const size_t N = 100000;
+    io::BatchPipeline<size_t> pipeline(4, /* batch size */ 100, /* max batches */ 5);
+
+    VectorReadStream input(N);
+    VectorWriteStream output;
+    size_t written = pipeline.Run(input, [](size_t read) { return read % 3 == 0; }, output);
+    EXPECT_EQ(N, pipeline.read());
+    EXPECT_EQ((N + 2) / 3, written);
+    ASSERT_EQ(written, output.reads.size());
+    for (size_t i = 0; i < output.reads.size(); ++i)
+        EXPECT_EQ(3 * i, output.reads[i]);
+
+    // Stopping: the reads already taken from the stream are still processed
+    VectorReadStream stop_input(N);
+    std::atomic<size_t> processed{0};
+    while (!stop_input.eof()) {
+        bool stop = pipeline.Run(stop_input, [&](size_t read) {
+            processed += 1;
+            return read % 10000 == 9999;
+        });
+        EXPECT_EQ(pipeline.read(), pipeline.processed());
+        EXPECT_TRUE(stop || stop_input.eof());
+    }
+    EXPECT_EQ(N, processed);
+}
+
+TEST(Io, BamParser) {
+    const size_t N = 20000;
+    std::filesystem::path tmp = std::filesystem::temp_directory_path() / "io_test_parser.bam";
+
+    std::mt19937 rand(42);
+    std::vector<io::SingleRead> reads;
+    {
+        BamTools::RefVector refs;
+        refs.emplace_back("ref", 100000);
+        BamTools::BamWriter writer;
+        ASSERT_TRUE(writer.Open(tmp.string(), "@HD\tVN:1.6\n", refs));
+        for (size_t i = 0; i < N; ++i) {
+            // Mix odd and even lengths to check the nibble unpacking
+            size_t len = 50 + rand() % 101;
+            std::string seq(len, 'A'), qual(len, 'I');
+            for (size_t j = 0; j < len; ++j) {
+                seq[j] = nucl(char(rand() % 4));
+                qual[j] = char(33 + rand() % 40);
+            }
+            std::string name = "read" + std::to_string(i);
+
+            BamTools::BamAlignment al;
+            al.Name = name;
+            al.QueryBases = seq;
+            al.Qualities = qual;
+            al.Length = int32_t(len);
+            al.RefID = -1;
+            al.Position = -1;
+            al.MateRefID = -1;
+            al.MatePosition = -1;
+            al.SetIsMapped(false);
+            ASSERT_TRUE(writer.SaveAlignment(al));
+            reads.emplace_back(name, "", seq, qual, io::PhredOffset);
+        }
+        writer.Close();
+    }
+
+    io::FileReadFlags flags;
+    io::BAMParser parser(tmp.string(), flags);
+    size_t cnt = 0;
+    for (io::SingleRead read; !parser.eof(); ++cnt) {
+        parser >> read;
+        ASSERT_LT(cnt, N);
+        EXPECT_EQ(reads[cnt].name(), read.name());
+        EXPECT_EQ(reads[cnt].GetSequenceString(), read.GetSequenceString());
+        EXPECT_EQ(reads[cnt].GetPhredQualityString(), read.GetPhredQualityString());
+    }
+    EXPECT_EQ(N, cnt);
+
+    std::filesystem::remove(tmp);
+}
+
+TEST(Io, OrderedWriter) {
+    const size_t N = 10000;
+    std::mt19937 rand(42);
+    std::vector<std::string> seqs(N);
+    for (auto &seq : seqs) {
+        seq.resize(rand() % 200);
+        for (char &c : seq)
+            c = nucl(char(rand() % 4));
+    }
+
+    std::ostringstream expected;
+    for (size_t i = 0; i < N; ++i) {
+        expected << '>' << "seq" << i << '\n';
+        io::WriteWrapped(seqs[i], expected);
+    }
+
+    auto format = [&](size_t i, std::string &buf) {
+        io::AppendFasta(buf, "seq" + std::to_string(i), seqs[i]);
+    };
+
+    std::ostringstream plain;
+    io::OrderedWriter(plain, false, 1, 100).Write(N, format);
+    EXPECT_EQ(expected.str(), plain.str());
+
+    std::filesystem::path tmp = std::filesystem::temp_directory_path() / "io_test_ordered.fa.gz";
+    {
+        std::ofstream os(tmp, std::ios::binary);
+        io::OrderedWriter(os, true, 1, 100).Write(N, format);
+    }
+    // gzip readers handle the concatenated members transparently
+    gzFile gz = gzopen(tmp.c_str(), "rb");
+    ASSERT_TRUE(gz);
+    std::string unpacked;
+    char buf[1 << 16];
+    for (int len; (len = gzread(gz, buf, sizeof(buf))) > 0; )
+        unpacked.append(buf, size_t(len));
+    gzclose(gz);
+    EXPECT_EQ(expected.str(), unpacked);
+
+    std::filesystem::remove(tmp);
+}
@@ -7,6 +7,8 @@
 
 #include "random_graph.hpp"
 
+#include "paired_info/distance_estimation.hpp"
+#include "paired_info/frozen_paired_index.hpp"
 #include "paired_info/index_point.hpp"
 #include "paired_info/paired_info_helpers.hpp"
 //#include "io/binary/paired_index.hpp"
@@ -459,3 +461,98 @@ TEST(PairedInfo, RandomSymmetry) {
         }
     }
 }
+
+template<class Index, class FrozenIndex, class EdgeRange>
+void CheckFrozen(const Index &pi, const FrozenIndex &fpi, const EdgeRange &edges) {
+    EXPECT_EQ(pi.size(), fpi.size());
+    for (auto e1 : edges) {
+        EXPECT_EQ(pi.contains(e1), fpi.contains(e1));
+        std::set<typename Index::EdgeId> neighbours, frozen_neighbours;
+        for (auto i : pi.Get(e1))
+            neighbours.insert(i.first);
+        for (auto i : fpi.Get(e1))
+            frozen_neighbours.insert(i.first);
+        EXPECT_EQ(neighbours, frozen_neighbours);
+        for (auto e2 : edges) {
+            EXPECT_EQ(pi.contains(e1, e2), fpi.contains(e1, e2));
+            EXPECT_EQ(pi.Get(e1, e2).Unwrap(), fpi.Get(e1, e2).Unwrap());
+            EXPECT_EQ(pi.Get(e1)[e2].Unwrap(), fpi.Get(e1)[e2].Unwrap());
+            EXPECT_EQ(pi.GetHalf(e1)[e2].Unwrap(), fpi.GetHalf(e1)[e2].Unwrap());
+        }
+        size_t half = 0, frozen_half = 0;
+        for (auto i : pi.GetHalf(e1))
+            half += i.second.size();
+        for (auto i : fpi.GetHalf(e1))
+            frozen_half += i.second.size();
+        EXPECT_EQ(half, frozen_half);
+    }
+}
+
+TEST(PairedInfo, Frozen) {
+    MockGraph graph;
+    MockClIndex pi(graph);
+    pi.Add(1, 8, {1, 3, 1});
+    pi.Add(1, 3, {2, 2, 0});
+    pi.Add(1, 3, {3, 1, 0.5});
+    pi.Add(4, 13, {10, 1, 0});
+    pi.Add(1, 1, {0, 1, 0});
+
+    FrozenPairedIndex<MockGraph> fpi(pi);
+    std::vector<MockGraph::EdgeId> edges = {1, 2, 3, 4, 5, 7, 8, 9, 13, 14};
+    CheckFrozen(pi, fpi, edges);
+
+    const char *file_name = "src/test/debruijn/graph_fragments/saves/test_frozen";
+    fpi.Save(file_name);
+    FrozenPairedIndex<MockGraph> lpi(graph);
+    EXPECT_EQ(lpi.size(), 0);
+    EXPECT_FALSE(lpi.contains(1));
+    lpi.Load(file_name);
+    CheckFrozen(pi, lpi, edges);
+    std::filesystem::remove(file_name);
+}
+
+TEST(PairedInfo, RandomFrozen) {
+    debruijn_graph::Graph graph(55);
+    debruijn_graph::RandomGraph<debruijn_graph::Graph>(graph, /*max_size*/100).Generate(/*iterations*/1000);
+    std::vector<debruijn_graph::EdgeId> edges;
+    for (debruijn_graph::EdgeId e : graph.edges())
+        edges.push_back(e);
+    ASSERT_FALSE(edges.empty());
+
+    PairedInfoIndexT<debruijn_graph::Graph> pi(graph);
+    for (size_t i = 0; i < 1000; ++i)
+        pi.Add(edges[rand() % edges.size()], edges[rand() % edges.size()],
+               Point(DEDistance(rand() % 100), DEWeight(1), DEVariance(rand() % 5)));
+
+    FrozenPairedIndex<debruijn_graph::Graph> fpi(pi);
+    CheckFrozen(pi, fpi, edges);
+}
+
+TEST(PairedInfo, ParallelDistanceEstimation) {
+    debruijn_graph::Graph graph(55);
+    debruijn_graph::RandomGraph<debruijn_graph::Graph>(graph, /*max_size*/100).Generate(/*iterations*/1000);
+
+    // Consistent pairs between adjacent edges, plus a hub edge paired with all the others
+    TestIndex pi(graph);
+    debruijn_graph::EdgeId hub = *graph.edges().begin();
+    for (debruijn_graph::EdgeId e1 : graph.edges()) {
+        pi.Add(e1, e1, RawPoint(0, 1));
+        for (debruijn_graph::EdgeId e2 : graph.OutgoingEdges(graph.EdgeEnd(e1)))
+            pi.Add(e1, e2, RawPoint(DEDistance(graph.length(e1) + rand() % 5), 1));
+        pi.Add(hub, e1, RawPoint(DEDistance(rand() % 300), 1));
+    }
+
+    GraphDistanceFinder dist_finder(graph, /*insert size*/300, /*read length*/100, /*delta*/50);
+    DistanceEstimator estimator(graph, pi, dist_finder, /*linkage distance*/0, /*max distance*/50);
+
+    PairedInfoIndexT<debruijn_graph::Graph> serial(graph), parallel(graph);
+    estimator.Estimate(serial, 1);
+    estimator.Estimate(parallel, 4);
+
+    EXPECT_GT(serial.size(), 0u);
+    EXPECT_EQ(serial.size(), parallel.size());
+    for (debruijn_graph::EdgeId e1 : graph.edges()) {
+        for (auto entry : serial.Get(e1))
+            EXPECT_EQ(entry.second.Unwrap(), parallel.Get(e1, entry.first).Unwrap());
+    }
+}
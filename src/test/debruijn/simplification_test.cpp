@@ -15,6 +15,8 @@
 
 #include <gtest/gtest.h>
 
+#include <random>
+
 using namespace debruijn_graph;
 using namespace debruijn_graph::config;
 
@@ -163,6 +165,67 @@ TEST_F( Simplification,  SimpleBulgeRemovalTest ) {
     EXPECT_EQ(4, g.size());
 }
 
+// Chain of bulges, each consisting of a well covered edge and an erroneous one
+static std::string AddBulgeChain(Graph &g, size_t bulge_cnt, size_t length, std::mt19937 &rnd) {
+    std::string genome(bulge_cnt * length + g.k(), 'A');
+    for (char &c : genome)
+        c = nucl(char(rnd() % 4));
+
+    VertexId v = g.AddVertex();
+    for (size_t i = 0; i < bulge_cnt; ++i) {
+        VertexId w = g.AddVertex();
+        std::string s = genome.substr(i * length, length + g.k());
+        EdgeId correct = g.AddEdge(v, w, Sequence(s));
+        char &c = s[s.size() / 2];
+        c = (c == 'A' ? 'C' : 'A');
+        EdgeId erroneous = g.AddEdge(v, w, Sequence(s));
+        for (EdgeId e : { correct, g.conjugate(correct) })
+            g.coverage_index().SetAvgCoverage(e, 10.);
+        for (EdgeId e : { erroneous, g.conjugate(erroneous) })
+            g.coverage_index().SetAvgCoverage(e, 1.);
+        v = w;
+    }
+    return genome;
+}
+
+static void CheckSingleEdge(const Graph &g, const std::string &genome) {
+    ASSERT_EQ(2u, g.e_size());
+    EdgeId e = *g.edges().begin();
+    std::string nucls = g.EdgeNucls(e).str();
+    EXPECT_TRUE(nucls == genome || nucls == ReverseComplement(genome));
+}
+
+// Neighbouring bulges interfere, so they are glued in several rounds
+TEST_F( Simplification,  ParallelBulgeRemovalTest ) {
+    const size_t bulge_cnt = 3000;
+    auto br_config = standard_br_config();
+    br_config.parallel = true;
+    int threads = omp_get_max_threads();
+
+    {
+        std::mt19937 rnd(42);
+        Graph g(55);
+        std::string genome = AddBulgeChain(g, bulge_cnt, 100, rnd);
+        // Independent bulges are glued concurrently
+        omp_set_num_threads(4);
+        debruijn::simplification::BRInstance(g, br_config, standard_simplif_relevant_info())->Run();
+        omp_set_num_threads(threads);
+        CheckSingleEdge(g, genome);
+    }
+
+    {
+        std::mt19937 rnd(239);
+        Graph g(55);
+        std::string genome = AddBulgeChain(g, bulge_cnt, 100, rnd);
+        // Callbacks force sequential gluing
+        size_t removed = 0;
+        debruijn::simplification::BRInstance(g, br_config, standard_simplif_relevant_info(), nullptr,
+                                             [&](EdgeId) { removed += 1; })->Run();
+        EXPECT_EQ(bulge_cnt, removed);
+        CheckSingleEdge(g, genome);
+    }
+}
+
 TEST_F( Simplification,  TipobulgeTest ) {
     Graph g(55);
     ASSERT_TRUE(graphio::ScanBasicGraph("./src/test/debruijn/graph_fragments/tipobulge/tipobulge", g));
@@ -0,0 +1,124 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "alignment/rna/ss_coverage.hpp"
+#include "assembly_graph/core/graph.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace debruijn_graph;
+
+static Sequence RandomSequence(size_t length, std::mt19937 &rnd) {
+    std::string s(length, 'A');
+    for (char &c : s)
+        c = nucl(char(rnd() % 4));
+    return Sequence(s);
+}
+
+// Edge of the given length between two new vertices
+static EdgeId AddRandomEdge(Graph &g, size_t length, std::mt19937 &rnd) {
+    VertexId v1 = g.AddVertex(), v2 = g.AddVertex();
+    return g.AddEdge(v1, v2, RandomSequence(length + g.k(), rnd));
+}
+
+static std::vector<size_t> EdgeLengths(const Graph &g) {
+    std::vector<size_t> lengths;
+    for (EdgeId e : g.edges())
+        lengths.push_back(g.length(e));
+    std::sort(lengths.begin(), lengths.end());
+    return lengths;
+}
+
+TEST( SSCoverage, Storage ) {
+    std::mt19937 rnd(239);
+    Graph g(55);
+    EdgeId e1 = AddRandomEdge(g, 100, rnd);
+    EdgeId e2 = AddRandomEdge(g, 200, rnd);
+
+    SSCoverageStorage a(g), b(g);
+    // Not preallocated, grows on demand
+    a.IncreaseKmerCount(e1, 5);
+    a.IncreaseKmerCount(e1, 5);
+    EXPECT_EQ(10., a.GetCoverage(e1));
+    EXPECT_EQ(0., a.GetCoverage(e1, true));
+    EXPECT_EQ(0., a.GetCoverage(e2));
+
+    // The edge added after the storage is allocated
+    EdgeId e3 = AddRandomEdge(g, 300, rnd);
+    EXPECT_EQ(0., a.GetCoverage(e3));
+    b.IncreaseKmerCount(e3, 30, true);
+    b.IncreaseKmerCount(e1, 2);
+    EXPECT_EQ(30., b.GetCoverage(e3));
+    EXPECT_EQ(30., b.GetCoverage(e3, true));
+
+    // The smaller storage is extended
+    a.MergeOther(b);
+    EXPECT_EQ(12., a.GetCoverage(e1));
+    EXPECT_EQ(0., a.GetCoverage(e2));
+    EXPECT_EQ(30., a.GetCoverage(e3));
+    EXPECT_EQ(30., a.GetCoverage(g.conjugate(e3)));
+
+    // Reset storage is merged into
+    b.Reset();
+    EXPECT_EQ(0., b.GetCoverage(e3));
+    b.MergeOther(a);
+    b.MergeOther(a);
+    EXPECT_EQ(24., b.GetCoverage(e1));
+    EXPECT_EQ(60., b.GetCoverage(e3, true));
+
+    a.RecalculateCoverage();
+    EXPECT_DOUBLE_EQ(12. / 100., a.GetCoverage(e1));
+    EXPECT_DOUBLE_EQ(30. / 300., a.GetCoverage(e3, true));
+
+    a.Clear();
+    EXPECT_EQ(0., a.GetCoverage(e1));
+}
+
+// Split positions are pinned to the ones of the original per-edge map based splitter
+TEST( SSCoverage, Splitter ) {
+    std::mt19937 rnd(42);
+    Graph g(55);
+    EdgeId switching = AddRandomEdge(g, 425, rnd);
+    EdgeId uniform = AddRandomEdge(g, 300, rnd);
+    EdgeId shortcut = AddRandomEdge(g, 120, rnd);
+    // Bins are laid out differently for the edge and its conjugate, use the one split is detected on
+    if (switching < g.conjugate(switching))
+        switching = g.conjugate(switching);
+    EXPECT_EQ(std::vector<size_t>({120, 120, 300, 300, 425, 425}), EdgeLengths(g));
+
+    SSCoverageSplitter splitter(g, 50, 150, 0., 2., 1.);
+    // Thread-local bins share the layout of the main splitter
+    SSCoverageSplitter::LocalBins conj_splitter(splitter);
+
+    // The first half of the edge is covered by the forward strand, the second one by the reverse
+    for (size_t i = 0; i < 10; ++i) {
+        splitter.IncreaseKmerCount(switching, Range(0, 200));
+        conj_splitter.IncreaseKmerCount(g.conjugate(switching), Range(0, 225));
+    }
+    splitter.IncreaseKmerCount(switching, Range(200, 424));
+    conj_splitter.IncreaseKmerCount(g.conjugate(switching), Range(225, 424));
+
+    for (size_t i = 0; i < 5; ++i) {
+        splitter.IncreaseKmerCount(uniform, Range(0, 299));
+        conj_splitter.IncreaseKmerCount(g.conjugate(uniform), Range(0, 299));
+    }
+    // Too short, ignored
+    splitter.IncreaseKmerCount(shortcut, Range(0, 120));
+
+    splitter.MergeOther(conj_splitter);
+    splitter.SplitEdges();
+    EXPECT_EQ(std::vector<size_t>({120, 120, 175, 175, 250, 250, 300, 300}), EdgeLengths(g));
+
+    // Nothing is split without the coverage
+    splitter.Init();
+    splitter.SplitEdges();
+    EXPECT_EQ(8u, EdgeLengths(g).size());
+}
@@ -0,0 +1,124 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "utils/logger/log_writers_thread.hpp"
+#include "utils/verify.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace logging;
+
+namespace {
+
+class recording_writer : public writer {
+public:
+    void write_msg(double, size_t, size_t, level, const std::filesystem::path&, size_t,
+                   const char*, const char *msg) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        messages_.emplace_back(msg);
+    }
+
+    std::vector<std::string> messages() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return messages_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::string> messages_;
+};
+
+struct stderr_writer : public writer {
+    void write_msg(double, size_t, size_t, level, const std::filesystem::path&, size_t,
+                   const char*, const char *msg) override {
+        std::cerr << msg << std::endl;
+    }
+};
+
+void Log(writer &w, const std::string &msg, level l = L_INFO) {
+    w.write_msg(0, 0, 0, l, __FILE__, __LINE__, "test", msg.c_str());
+}
+
+}
+
+TEST(AsyncWriter, Ordering) {
+    const size_t threads = 4, count = 1000;
+    auto recorder = std::make_shared<recording_writer>();
+    {
+        // Tiny rings, so the threads are blocked by the back-pressure all the time
+        async_writer w(recorder, 2);
+
+        Log(w, "start");
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t)
+            workers.emplace_back([&, t] {
+                for (size_t i = 0; i < count; ++i)
+                    Log(w, std::to_string(t) + " " + std::to_string(i));
+            });
+        for (auto &worker : workers)
+            worker.join();
+        Log(w, "finish");
+    }
+
+    auto messages = recorder->messages();
+    ASSERT_EQ(threads * count + 2, messages.size());
+    // Messages of the same thread and the ones ordered by the joins must not be reordered
+    EXPECT_EQ("start", messages.front());
+    EXPECT_EQ("finish", messages.back());
+    std::vector<size_t> next(threads, 0);
+    for (size_t j = 1; j + 1 < messages.size(); ++j) {
+        size_t t = std::stoul(messages[j]);
+        ASSERT_LT(t, threads);
+        EXPECT_EQ(std::to_string(t) + " " + std::to_string(next[t]), messages[j]);
+        next[t] += 1;
+    }
+}
+
+TEST(AsyncWriter, Flush) {
+    auto recorder = std::make_shared<recording_writer>();
+    async_writer w(recorder);
+
+    for (size_t i = 0; i < 10; ++i)
+        Log(w, std::to_string(i));
+    w.flush();
+    EXPECT_EQ(10u, recorder->messages().size());
+
+    Log(w, "10");
+    flush_async_writers();
+    EXPECT_EQ(11u, recorder->messages().size());
+}
+
+TEST(AsyncWriter, ErrorsAreWrittenSynchronously) {
+    auto recorder = std::make_shared<recording_writer>();
+    async_writer w(recorder);
+
+    for (size_t i = 0; i < 100; ++i)
+        Log(w, std::to_string(i));
+    Log(w, "error", L_ERROR);
+
+    // Everything logged before the error must be written by the time it returns
+    auto messages = recorder->messages();
+    ASSERT_EQ(101u, messages.size());
+    EXPECT_EQ("99", messages[99]);
+    EXPECT_EQ("error", messages[100]);
+}
+
+TEST(AsyncWriterDeathTest, FlushOnVerifyFailure) {
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+    EXPECT_DEATH({
+        async_writer w(std::make_shared<stderr_writer>());
+        utils::verify_failure_hook() = flush_async_writers;
+        Log(w, "logged before the failure");
+        VERIFY_MSG(false, "test failure");
+        std::abort();
+    }, "logged before the failure(.|\n)*Verification of expression 'false' failed");
+}
@@ -6,6 +6,7 @@
 //***************************************************************************
 
 #include "sequence/rtseq.hpp"
+#include "sequence/kmer_width.hpp"
 #include "sequence/sequence.hpp"
 #include "sequence/nucl.hpp"
 #include <string>
@@ -701,3 +702,39 @@ TEST( RtSeq, FirstLast ) {
     EXPECT_EQ(3, s2.first());
     EXPECT_EQ(3, s2.last());
 }
+
+TEST( RtSeq, DispatchKMerWidth ) {
+    auto words = [](size_t K) {
+        return DispatchKMerWidth(K, [](auto width) { return decltype(width)::type::DataSize; });
+    };
+    EXPECT_EQ(1u, words(21));
+    EXPECT_EQ(1u, words(32));
+    EXPECT_EQ(2u, words(33));
+    EXPECT_EQ(2u, words(64));
+    EXPECT_EQ(size_t(RtSeq::DataSize), words(RtSeq::max_size));
+}
+
+TEST( RtSeq, NarrowWidthRawData ) {
+    // k-mers of all widths must produce the same raw data and hashes
+    typedef RuntimeSeq<32> Seq1;
+    typedef RuntimeSeq<64> Seq2;
+    Sequence s("ACGTTGCAAGCTTAGCCGATAGGCTAACGTACGATCGATCGGCTAAGCTTGACCGTAGCTAGCTAGGATCCA");
+    for (size_t K : { 1, 7, 31, 32, 33, 55, 63, 64 }) {
+        RtSeq kmer = s.start<RtSeq>(K) >> 'A';
+        Seq2 kmer2 = s.start<Seq2>(K) >> 'A';
+        for (size_t j = K - 1; j < s.size(); ++j) {
+            kmer <<= s[j];
+            kmer2 <<= s[j];
+            ASSERT_EQ(kmer.data_size(), kmer2.data_size());
+            ASSERT_EQ(0, memcmp(kmer.data(), kmer2.data(), kmer.data_size() * sizeof(RtSeq::DataType)));
+            ASSERT_EQ(kmer.GetHash(), kmer2.GetHash());
+            ASSERT_EQ(kmer.IsMinimal(), kmer2.IsMinimal());
+            ASSERT_EQ(kmer.str(), kmer2.str());
+            if (K <= 32) {
+                Seq1 kmer1(K, kmer.data());
+                ASSERT_EQ(kmer.GetHash(), kmer1.GetHash());
+                ASSERT_EQ((!kmer).str(), (!kmer1).str());
+            }
+        }
+    }
+}
@@ -0,0 +1,98 @@
+//***************************************************************************
+//* Copyright (c) 2023-2024 SPAdes team
+//* All Rights Reserved
+//* See file LICENSE for details.
+//***************************************************************************
+
+#include "utils/parallel/task_scheduler.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace parallel;
+
+TEST(TaskScheduler, CoversRangeOnce) {
+    TaskScheduler scheduler(4);
+    for (size_t size : {0, 1, 7, 1000, 100003}) {
+        std::vector<std::atomic<unsigned>> visits(size);
+        for (auto &v : visits)
+            v = 0;
+        parallel_for(size_t(0), size, [&](size_t i) {
+            visits[i] += 1;
+        }, 0, scheduler);
+        for (size_t i = 0; i < size; ++i)
+            ASSERT_EQ(1u, visits[i]) << "index " << i << " of " << size;
+    }
+
+    // Nonzero begin and the explicit grain
+    std::vector<std::atomic<unsigned>> visits(1000);
+    for (auto &v : visits)
+        v = 0;
+    parallel_for(100, 1000, [&](int i) { visits[i] += 1; }, 3, scheduler);
+    for (size_t i = 0; i < visits.size(); ++i)
+        ASSERT_EQ(i < 100 ? 0u : 1u, visits[i]) << "index " << i;
+}
+
+TEST(TaskScheduler, Nested) {
+    TaskScheduler scheduler(4);
+    const size_t outer = 50, inner = 200;
+    std::vector<std::atomic<unsigned>> visits(outer * inner);
+    for (auto &v : visits)
+        v = 0;
+    parallel_for(size_t(0), outer, [&](size_t i) {
+        parallel_for(size_t(0), inner, [&](size_t j) {
+            EXPECT_LT(TaskScheduler::worker_id(), scheduler.concurrency());
+            visits[i * inner + j] += 1;
+        }, 1, scheduler);
+    }, 1, scheduler);
+    for (size_t i = 0; i < visits.size(); ++i)
+        ASSERT_EQ(1u, visits[i]) << "index " << i;
+}
+
+TEST(TaskScheduler, ExceptionIsRethrown) {
+    TaskScheduler scheduler(4);
+    std::atomic<size_t> done(0);
+    TaskGroup group(scheduler);
+    for (size_t i = 0; i < 100; ++i)
+        group.run([&, i] {
+            if (i == 42)
+                throw std::runtime_error("task failed");
+            done += 1;
+        });
+    EXPECT_THROW(group.wait(), std::runtime_error);
+    // The other tasks are still completed
+    EXPECT_EQ(99u, done);
+    // The error is reported once
+    EXPECT_NO_THROW(group.wait());
+
+    EXPECT_THROW(parallel_for(0, 1000, [](int i) {
+        if (i == 999)
+            throw std::out_of_range("last");
+    }, 1, scheduler), std::out_of_range);
+}
+
+TEST(TaskScheduler, SingleThread) {
+    TaskScheduler scheduler(1);
+    EXPECT_EQ(1u, scheduler.concurrency());
+
+    // Everything runs in the calling thread
+    std::thread::id caller = std::this_thread::get_id();
+    std::vector<unsigned> visits(1000, 0);
+    parallel_for(size_t(0), visits.size(), [&](size_t i) {
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        visits[i] += 1;
+    }, 1, scheduler);
+    for (size_t i = 0; i < visits.size(); ++i)
+        ASSERT_EQ(1u, visits[i]) << "index " << i;
+
+    size_t done = 0;
+    TaskGroup group(scheduler);
+    for (size_t i = 0; i < 10; ++i)
+        group.run([&] { done += 1; });
+    group.wait();
+    EXPECT_EQ(10u, done);
+}